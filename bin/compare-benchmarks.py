@@ -0,0 +1,107 @@
+#!/usr/bin/env python3
+# Copyright 2026 Huawei Cloud Computing Technology Co., Ltd.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+# Compare the results of the benchmarks in test/benchmarks between two
+# commits. Each argument is either the JSON output of a single benchmark
+# binary or a directory, in which all files named "stdout" are read. Such a
+# directory is obtained for each commit by
+#
+#   just-mr --main "just tests" install -o <dir> benchmarks TESTS
+#
+# As the benchmarks are not part of the regular test suite, they are only
+# run when requested explicitly.
+
+import json
+import os
+import sys
+from argparse import ArgumentParser
+from typing import Any, Dict, List, Tuple
+
+Results = Dict[Tuple[str, str], Dict[str, Any]]
+
+
+def read_file(path: str, results: Results) -> None:
+    with open(path) as f:
+        data = json.load(f)
+    for failed in data.get("failed", []):
+        print("Warning: test case %r failed in %s" % (failed, path),
+              file=sys.stderr)
+    for entry in data.get("benchmarks", []):
+        results[(entry["test_case"], entry["name"])] = entry
+
+
+def read_results(path: str) -> Results:
+    results: Results = {}
+    if not os.path.isdir(path):
+        read_file(path, results)
+        return results
+    for root, _, files in os.walk(path):
+        for name in files:
+            if name == "stdout":
+                read_file(os.path.join(root, name), results)
+    return results
+
+
+def format_ns(value: float) -> str:
+    for unit, factor in [("s", 1e9), ("ms", 1e6), ("us", 1e3)]:
+        if value >= factor:
+            return "%.2f %s" % (value / factor, unit)
+    return "%.2f ns" % (value, )
+
+
+def main() -> None:
+    parser = ArgumentParser(
+        description="Compare benchmark results of two commits")
+    parser.add_argument("old", help="Results of the baseline")
+    parser.add_argument("new", help="Results to compare against the baseline")
+    parser.add_argument(
+        "--threshold",
+        type=float,
+        default=0.1,
+        help="Relative slow-down of the mean considered a regression, if the"
+        " confidence intervals do not overlap (default: 0.1)")
+    args = parser.parse_args()
+
+    old = read_results(args.old)
+    new = read_results(args.new)
+
+    regressions: List[str] = []
+    for key in sorted(set(old.keys()) | set(new.keys())):
+        label = "%s: %s" % key
+        if key not in old or key not in new:
+            print("%-70s %s" % (label, "only in new" if key in new else
+                                "only in old"))
+            continue
+        old_mean = old[key]["mean"]
+        new_mean = new[key]["mean"]
+        change = new_mean["point"] / old_mean["point"] - 1.0
+        significant = (new_mean["lower_bound"] > old_mean["upper_bound"]
+                       or new_mean["upper_bound"] < old_mean["lower_bound"])
+        print("%-70s %12s -> %12s %+7.1f%%%s" %
+              (label, format_ns(old_mean["point"]),
+               format_ns(new_mean["point"]), 100.0 * change,
+               "" if significant else " (noise)"))
+        if significant and change > args.threshold:
+            regressions.append(label)
+
+    if regressions:
+        print("\nRegressions:", file=sys.stderr)
+        for label in regressions:
+            print("  %s" % (label, ), file=sys.stderr)
+        sys.exit(1)
+
+
+if __name__ == "__main__":
+    main()
@@ -63,12 +63,14 @@ auto CreateSourceTargetMap(
     const gsl::not_null<DirectoryEntriesMap*>& dirs,
     gsl::not_null<const RepositoryConfig*> const& repo_config,
     HashFunction::Type hash_type,
-    std::size_t jobs) -> SourceTargetMap {
-    auto src_target_reader = [dirs, repo_config, hash_type](auto ts,
-                                                            auto setter,
-                                                            auto logger,
-                                                            auto /* unused */,
-                                                            auto const& key) {
+    std::size_t jobs,
+    IGitHashesStore* git_hashes) -> SourceTargetMap {
+    auto src_target_reader = [dirs, repo_config, hash_type, git_hashes](
+                                 auto ts,
+                                 auto setter,
+                                 auto logger,
+                                 auto /* unused */,
+                                 auto const& key) {
         using std::filesystem::path;
         const auto& target = key.GetNamedTarget();
         auto name = path(target.name).lexically_normal();
@@ -83,13 +85,14 @@ auto CreateSourceTargetMap(
         auto const* ws_root = repo_config->WorkspaceRoot(target.repository);
 
         auto src_file_reader =
-            [key, name, setter, logger, dir, ws_root, hash_type](
+            [key, name, setter, logger, dir, ws_root, hash_type, git_hashes](
                 bool exists_in_ws_root) {
                 if (ws_root != nullptr and exists_in_ws_root) {
                     if (auto desc = ws_root->ToArtifactDescription(
                             hash_type,
                             path(key.GetNamedTarget().module) / name,
-                            key.GetNamedTarget().repository)) {
+                            key.GetNamedTarget().repository,
+                            git_hashes)) {
                         (*setter)(
                             as_target(key, ExpressionPtr{std::move(*desc)}));
                         return;
@@ -21,6 +21,7 @@
 #include "src/buildtool/build_engine/analysed_target/analysed_target.hpp"
 #include "src/buildtool/build_engine/base_maps/directory_map.hpp"
 #include "src/buildtool/build_engine/base_maps/entity_name_data.hpp"
+#include "src/buildtool/common/git_hashes_store.hpp"
 #include "src/buildtool/common/repository_config.hpp"
 #include "src/buildtool/crypto/hash_function.hpp"
 #include "src/buildtool/multithreading/async_map_consumer.hpp"
@@ -29,11 +30,14 @@ namespace BuildMaps::Base {
 
 using SourceTargetMap = AsyncMapConsumer<EntityName, AnalysedTargetPtr>;
 
+/// \param git_hashes   Optional store of compatible hashes of git blobs
+/// converted before, used in compatible mode.
 auto CreateSourceTargetMap(
     const gsl::not_null<DirectoryEntriesMap*>& dirs,
     gsl::not_null<const RepositoryConfig*> const& repo_config,
     HashFunction::Type hash_type,
-    std::size_t jobs = 0) -> SourceTargetMap;
+    std::size_t jobs = 0,
+    IGitHashesStore* git_hashes = nullptr) -> SourceTargetMap;
 
 }  // namespace BuildMaps::Base
 
@@ -15,13 +15,18 @@
 #include "src/buildtool/build_engine/expression/expression.hpp"
 
 #include <algorithm>
+#include <bit>
+#include <cstdint>
 #include <iterator>
 #include <optional>
 #include <string>
+#include <type_traits>
+#include <variant>
 
 #include "fmt/core.h"
 #include "src/buildtool/crypto/hash_function.hpp"
 #include "src/buildtool/crypto/hasher.hpp"
+#include "src/utils/cpp/fingerprint.hpp"
 #include "src/utils/cpp/gsl.hpp"
 #include "src/utils/cpp/json.hpp"
 
@@ -160,6 +165,10 @@ auto Expression::ToString() const -> std::string {
     return AbbreviateJson(ToJson(), len);
 }
 
+auto Expression::ToFingerprint() const noexcept -> Fingerprint {
+    return fingerprint_.SetOnceAndGet([this] { return ComputeFingerprint(); });
+}
+
 auto Expression::ToHash() const noexcept -> std::string {
     return hash_.SetOnceAndGet([this] { return ComputeHash(); });
 }
@@ -222,6 +231,100 @@ auto Expression::TypeString() const noexcept -> std::string {
     return TypeStringForIndex();
 }
 
+auto Expression::ComputeFingerprint() const noexcept -> Fingerprint {
+    // Distinguish the types by a prefix, as for ComputeHash. Composite values
+    // are fingerprinted over the fingerprints of their parts, which are cached,
+    // and leaves directly from their data, avoiding the JSON serialization.
+    // Equal expressions must have equal fingerprints, so results are
+    // fingerprinted over the same map they are serialized as.
+    try {
+        std::string data{};
+        if (IsNone()) {
+            data = "n";
+        }
+        else if (IsBool()) {
+            data = Bool() ? "t" : "f";
+        }
+        else if (IsNumber()) {
+            auto const number = Number();
+            data = "d";
+            data.append(reinterpret_cast<char const*>(&number),  // NOLINT
+                        sizeof(number));
+        }
+        else if (IsString()) {
+            data = "s" + String();
+        }
+        else if (IsArtifact()) {
+            // the artifact identifier is the hash of its JSON representation
+            data = "@" + Artifact().Id();
+        }
+        else if (IsResult()) {
+            auto const& result = Result();
+            data = "=";
+            result.artifact_stage->ToFingerprint().AppendTo(&data);
+            result.runfiles->ToFingerprint().AppendTo(&data);
+            result.provides->ToFingerprint().AppendTo(&data);
+        }
+        else if (IsNode()) {
+            data = "#" + ToString();
+        }
+        else if (IsName()) {
+            data = "$" + ToString();
+        }
+        else if (IsList()) {
+            auto const& list = List();
+            data.reserve(1 + (list.size() * sizeof(Fingerprint)));
+            data = "[";
+            for (auto const& el : list) {
+                el->ToFingerprint().AppendTo(&data);
+            }
+        }
+        else if (IsMap()) {
+            data = "{";
+            for (auto const& [key, value] : Map()) {
+                auto const size = static_cast<std::uint64_t>(key.size());
+                data.append(reinterpret_cast<char const*>(&size),  // NOLINT
+                            sizeof(size));
+                data += key;
+                value->ToFingerprint().AppendTo(&data);
+            }
+        }
+        return Fingerprint::Of(data);
+    } catch (...) {
+        EnsuresAudit(false);  // ensure that the try-block never throws
+    }
+    return Fingerprint{};
+}
+
+auto Expression::HasEqualData(Expression const& other) const noexcept
+    -> bool {
+    // Equal exactly if the JSON representations (with the type prefix) are,
+    // i.e., if the hashes are, so numbers are compared by their bits.
+    try {
+        if (data_.index() != other.data_.index()) {
+            return false;
+        }
+        if (IsNumber()) {
+            return std::bit_cast<std::uint64_t>(Number()) ==
+                   std::bit_cast<std::uint64_t>(other.Number());
+        }
+        if (IsList()) {
+            auto const& list = List();
+            auto const& other_list = other.List();
+            return list.size() == other_list.size() and
+                   std::equal(list.begin(), list.end(), other_list.begin());
+        }
+        return std::visit(
+            [&other](auto const& data) -> bool {
+                using T = std::remove_cvref_t<decltype(data)>;
+                return data == std::get<T>(other.data_);
+            },
+            data_);
+    } catch (...) {
+        return false;
+    }
+}
+
 auto Expression::ComputeHash() const noexcept -> std::string {
     auto hash = std::string{};
 
@@ -37,6 +37,7 @@
 #include "src/buildtool/build_engine/expression/target_result.hpp"
 #include "src/buildtool/common/artifact_description.hpp"
 #include "src/buildtool/multithreading/atomic_value.hpp"
+#include "src/utils/cpp/fingerprint.hpp"
 #include "src/utils/cpp/hex_string.hpp"
 
 class Expression {
@@ -194,7 +195,11 @@ class Expression {
     template <class T>
     [[nodiscard]] auto operator==(T const& other) const noexcept -> bool {
         if constexpr (std::is_same_v<T, Expression>) {
-            return (&data_ == &other.data_) or (ToHash() == other.ToHash());
+            // Fingerprints are not collision resistant, so they can only
+            // tell expressions apart; equality is confirmed structurally.
+            return (&data_ == &other.data_) or
+                   ((ToFingerprint() == other.ToFingerprint()) and
+                    HasEqualData(other));
         }
         else {
             return IsValidType<T>() and (GetIndexOf<T>() == data_.index()) and
@@ -229,6 +234,13 @@ class Expression {
     [[nodiscard]] auto IsCacheable() const -> bool;
     [[nodiscard]] auto ToString() const -> std::string;
     [[nodiscard]] auto ToAbbrevString(std::size_t len) const -> std::string;
+    /// \brief Fast structural hash, used for hash containers and to tell
+    /// expressions apart quickly. Different expressions may share the same
+    /// fingerprint. Only valid within this process; see ToHash for a stable
+    /// and collision resistant identifier.
+    [[nodiscard]] auto ToFingerprint() const noexcept -> Fingerprint;
+    /// \brief SHA256 of the expression, computed on first use. Stable between
+    /// processes and hence used for all persisted and ordered identifiers.
     [[nodiscard]] auto ToHash() const noexcept -> std::string;
     [[nodiscard]] auto ToIdentifier() const noexcept -> std::string {
         return ToHexString(ToHash());
@@ -264,6 +276,7 @@ class Expression {
                  map_t>
         data_{none_t{}};
 
+    AtomicValue<Fingerprint> fingerprint_;
     AtomicValue<std::string> hash_;
     AtomicValue<bool> is_cachable_;
 
@@ -348,6 +361,12 @@ class Expression {
     template <std::size_t kIndex = 0>
     [[nodiscard]] auto TypeStringForIndex() const noexcept -> std::string;
     [[nodiscard]] auto TypeString() const noexcept -> std::string;
+    [[nodiscard]] auto ComputeFingerprint() const noexcept -> Fingerprint;
+    /// \brief Compare the data of two expressions of equal fingerprint,
+    /// without computing their hashes. Parts are compared by operator==,
+    /// which rejects unequal parts by their fingerprints.
+    [[nodiscard]] auto HasEqualData(Expression const& other) const noexcept
+        -> bool;
     [[nodiscard]] auto ComputeHash() const noexcept -> std::string;
     [[nodiscard]] auto ComputeIsCacheable() const -> bool;
 };
@@ -357,10 +376,7 @@ template <>
 struct hash<Expression> {
     [[nodiscard]] auto operator()(Expression const& e) const noexcept
         -> std::size_t {
-        auto hash = std::size_t{};
-        auto bytes = e.ToHash();
-        std::memcpy(&hash, bytes.data(), std::min(sizeof(hash), bytes.size()));
-        return hash;
+        return std::hash<Fingerprint>{}(e.ToFingerprint());
     }
 };
 }  // namespace std
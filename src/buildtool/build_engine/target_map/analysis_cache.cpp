@@ -0,0 +1,492 @@
+// Copyright 2026 Huawei Cloud Computing Technology Co., Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef BOOTSTRAP_BUILD_TOOL
+
+#include "src/buildtool/build_engine/target_map/analysis_cache.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <exception>
+#include <iterator>
+#include <memory>
+#include <optional>
+#include <set>
+#include <string>
+#include <unordered_set>
+#include <utility>
+
+#include "nlohmann/json.hpp"
+#include "src/buildtool/build_engine/analysed_target/target_graph_information.hpp"
+#include "src/buildtool/build_engine/base_maps/entity_name_data.hpp"
+#include "src/buildtool/build_engine/expression/configuration.hpp"
+#include "src/buildtool/build_engine/expression/expression.hpp"
+#include "src/buildtool/build_engine/expression/expression_ptr.hpp"
+#include "src/buildtool/build_engine/expression/target_result.hpp"
+#include "src/buildtool/common/action_description.hpp"
+#include "src/buildtool/common/tree.hpp"
+#include "src/buildtool/common/tree_overlay.hpp"
+#include "src/buildtool/crypto/hash_function.hpp"
+#include "src/buildtool/logging/log_level.hpp"
+#include "src/buildtool/logging/logger.hpp"
+#include "src/buildtool/storage/storage.hpp"
+
+namespace {
+
+// Part of every key, to be bumped whenever the format of the entries changes.
+constexpr auto kFormatVersion = 1;
+
+using BuildMaps::Base::EntityName;
+using BuildMaps::Base::NamedTarget;
+using BuildMaps::Base::ReferenceType;
+using BuildMaps::Target::ConfiguredTarget;
+
+/// \brief A dependency as recorded in an analysis-cache entry.
+struct CachedDependency final {
+    ConfiguredTarget key;
+    std::string result;
+    std::set<std::string> implied_export;
+};
+
+[[nodiscard]] auto RepositoryKey(AnalyseContext const& context,
+                                 std::string const& repository) noexcept
+    -> std::optional<std::string> {
+    auto key = context.repo_config->RepositoryKey(*context.storage, repository);
+    if (not key) {
+        return std::nullopt;
+    }
+    return key->hash();
+}
+
+/// \brief Key of the list of sets of variables known to be relevant for a
+/// target.
+[[nodiscard]] auto VarsKey(AnalyseContext const& context,
+                           NamedTarget const& target,
+                           std::string const& repo_key) noexcept
+    -> std::optional<std::string> {
+    return context.storage->AnalysisCache().ComputeKey(
+        nlohmann::json{{"version", kFormatVersion},
+                       {"kind", "vars"},
+                       {"repo_key", repo_key},
+                       {"repository", target.repository},
+                       {"module", target.module},
+                       {"name", target.name}});
+}
+
+/// \brief Key of the analysis result of a target for a configuration that is
+/// pruned to the relevant variables.
+[[nodiscard]] auto EntryKey(AnalyseContext const& context,
+                            NamedTarget const& target,
+                            std::string const& repo_key,
+                            Configuration const& effective_config) noexcept
+    -> std::optional<std::string> {
+    try {
+        return context.storage->AnalysisCache().ComputeKey(
+            nlohmann::json{{"version", kFormatVersion},
+                           {"kind", "entry"},
+                           {"repo_key", repo_key},
+                           {"repository", target.repository},
+                           {"module", target.module},
+                           {"name", target.name},
+                           {"effective_config", effective_config.ToString()}});
+    } catch (...) {
+        return std::nullopt;
+    }
+}
+
+/// \brief Identifier of the result of a target, which determines the analysis
+/// of the targets depending on it. Computed from the hashes of its parts, as
+/// those are cached.
+[[nodiscard]] auto ResultId(AnalysedTarget const& target) noexcept
+    -> std::string {
+    HashFunction const hash_function{HashFunction::Type::PlainSHA256};
+    auto hasher = hash_function.MakeHasher();
+    hasher.Update(target.Artifacts()->ToHash());
+    hasher.Update(target.RunFiles()->ToHash());
+    hasher.Update(target.Provides()->ToHash());
+    return std::move(hasher).Finalize().HexString();
+}
+
+/// \brief Configurations have to survive the round trip through JSON.
+[[nodiscard]] auto IsJsonConfiguration(Configuration const& config) -> bool {
+    return Expression::FromJson(config.ToJson()) == config.Expr();
+}
+
+[[nodiscard]] auto SortedList(auto const& strings) -> nlohmann::json {
+    auto list = std::vector<std::string>{strings.begin(), strings.end()};
+    std::sort(list.begin(), list.end());
+    return list;
+}
+
+[[nodiscard]] auto SerializeDependency(
+    AnalyseContext const& context,
+    std::string const& repository,
+    ConfiguredTarget const& transition_key,
+    AnalysedTarget const& value) -> std::optional<nlohmann::json> {
+    if (not transition_key.target.IsNamedTarget()) {
+        return std::nullopt;
+    }
+    auto const& target = transition_key.target.GetNamedTarget();
+    auto config = transition_key.config.Prune(value.Vars());
+    if (not IsJsonConfiguration(config)) {
+        return std::nullopt;
+    }
+    auto dep = nlohmann::json{
+        {"target",
+         nlohmann::json::array({target.repository,
+                                target.module,
+                                target.name,
+                                static_cast<int>(target.reference_t)})},
+        {"config", config.ToJson()},
+        {"result", ResultId(value)},
+        {"implied_export", SortedList(value.ImpliedExport())}};
+    if (target.repository != repository) {
+        auto repo_key = RepositoryKey(context, target.repository);
+        if (not repo_key) {
+            return std::nullopt;
+        }
+        dep["repo_key"] = *std::move(repo_key);
+    }
+    return dep;
+}
+
+/// \brief Read the dependencies of an entry. Dependencies in other
+/// repositories are only valid if those repositories are still the same.
+[[nodiscard]] auto DeserializeDependencies(AnalyseContext const& context,
+                                           std::string const& repository,
+                                           nlohmann::json const& entry)
+    -> std::optional<std::vector<CachedDependency>> {
+    std::vector<CachedDependency> deps{};
+    auto const& deps_json = entry.at("deps");
+    deps.reserve(deps_json.size());
+    for (auto const& dep : deps_json) {
+        auto const& target = dep.at("target");
+        auto const dep_repository = target.at(0).get<std::string>();
+        auto const reference = target.at(3).get<int>();
+        if (reference < static_cast<int>(ReferenceType::kTarget) or
+            reference > static_cast<int>(ReferenceType::kSymlink)) {
+            return std::nullopt;
+        }
+        if (dep_repository != repository) {
+            auto repo_key = RepositoryKey(context, dep_repository);
+            if (not repo_key or
+                *repo_key != dep.at("repo_key").get<std::string>()) {
+                return std::nullopt;
+            }
+        }
+        auto config = Expression::FromJson(dep.at("config"));
+        if (not config or not config->IsMap()) {
+            return std::nullopt;
+        }
+        deps.emplace_back(CachedDependency{
+            .key = ConfiguredTarget{
+                .target = EntityName{dep_repository,
+                                     target.at(1).get<std::string>(),
+                                     target.at(2).get<std::string>(),
+                                     static_cast<ReferenceType>(reference)},
+                .config = Configuration{std::move(config)}},
+            .result = dep.at("result").get<std::string>(),
+            .implied_export =
+                dep.at("implied_export").get<std::set<std::string>>()});
+    }
+    return deps;
+}
+
+[[nodiscard]] auto SerializeEntry(
+    AnalyseContext const& context,
+    std::string const& repository,
+    std::vector<ConfiguredTarget> const& transition_keys,
+    std::vector<AnalysedTargetPtr const*> const& dependency_values,
+    std::size_t declared_count,
+    AnalysedTarget const& result) -> std::optional<nlohmann::json> {
+    auto deps = nlohmann::json::array();
+    for (std::size_t i = 0; i < transition_keys.size(); ++i) {
+        auto dep = SerializeDependency(
+            context, repository, transition_keys[i], **dependency_values[i]);
+        if (not dep) {
+            return std::nullopt;
+        }
+        deps.emplace_back(*std::move(dep));
+    }
+    auto actions = nlohmann::json::array();
+    for (auto const& action : result.Actions()) {
+        actions.push_back(nlohmann::json{{"id", action->Id()},
+                                         {"desc", action->ToJson()}});
+    }
+    auto trees = nlohmann::json::array();
+    for (auto const& tree : result.Trees()) {
+        trees.push_back(
+            nlohmann::json{{"id", tree->Id()}, {"desc", tree->ToJson()}});
+    }
+    auto tree_overlays = nlohmann::json::array();
+    for (auto const& overlay : result.TreeOverlays()) {
+        tree_overlays.push_back(
+            nlohmann::json{{"id", overlay->Id()}, {"desc", overlay->ToJson()}});
+    }
+    return nlohmann::json{{"result", result.Result().ToJson()},
+                          {"actions", std::move(actions)},
+                          {"blobs", result.Blobs()},
+                          {"trees", std::move(trees)},
+                          {"tree_overlays", std::move(tree_overlays)},
+                          {"vars", SortedList(result.Vars())},
+                          {"tainted", result.Tainted()},
+                          {"implied_export", result.ImpliedExport()},
+                          {"declared_deps", declared_count},
+                          {"deps", std::move(deps)}};
+}
+
+/// \brief Create the analysed target from an entry, given the analysed
+/// dependencies.
+[[nodiscard]] auto DeserializeEntry(
+    HashFunction::Type hash_type,
+    ConfiguredTarget const& node,
+    nlohmann::json const& entry,
+    std::vector<AnalysedTargetPtr const*> const& dependency_values)
+    -> AnalysedTargetPtr {
+    auto result = TargetResult::FromJson(hash_type, entry.at("result"));
+    if (not result) {
+        return nullptr;
+    }
+    std::vector<ActionDescription::Ptr> actions{};
+    for (auto const& action : entry.at("actions")) {
+        auto desc = ActionDescription::FromJson(
+            hash_type, action.at("id").get<std::string>(), action.at("desc"));
+        if (not desc) {
+            return nullptr;
+        }
+        actions.emplace_back(*std::move(desc));
+    }
+    std::vector<Tree::Ptr> trees{};
+    for (auto const& tree : entry.at("trees")) {
+        auto desc = Tree::FromJson(
+            hash_type, tree.at("id").get<std::string>(), tree.at("desc"));
+        if (not desc) {
+            return nullptr;
+        }
+        trees.emplace_back(*std::move(desc));
+    }
+    std::vector<TreeOverlay::Ptr> tree_overlays{};
+    for (auto const& overlay : entry.at("tree_overlays")) {
+        auto desc = TreeOverlay::FromJson(
+            hash_type, overlay.at("id").get<std::string>(), overlay.at("desc"));
+        if (not desc) {
+            return nullptr;
+        }
+        tree_overlays.emplace_back(*std::move(desc));
+    }
+
+    auto const declared_count = std::min(
+        entry.at("declared_deps").get<std::size_t>(), dependency_values.size());
+    std::vector<BuildMaps::Target::ConfiguredTargetPtr> declared_deps{};
+    std::vector<BuildMaps::Target::ConfiguredTargetPtr> implicit_deps{};
+    for (std::size_t i = 0; i < dependency_values.size(); ++i) {
+        auto dep_node = (*dependency_values[i])->GraphInformation().Node();
+        (i < declared_count ? declared_deps : implicit_deps)
+            .emplace_back(std::move(dep_node));
+    }
+
+    return std::make_shared<AnalysedTarget const>(
+        *std::move(result),
+        std::move(actions),
+        entry.at("blobs").get<std::vector<std::string>>(),
+        std::move(trees),
+        std::move(tree_overlays),
+        entry.at("vars").get<std::unordered_set<std::string>>(),
+        entry.at("tainted").get<std::set<std::string>>(),
+        entry.at("implied_export").get<std::set<std::string>>(),
+        TargetGraphInformation{std::make_shared<ConfiguredTarget>(node),
+                               std::move(declared_deps),
+                               std::move(implicit_deps),
+                               {}});
+}
+
+/// \brief Record the set of variables relevant for a target, if not known yet.
+void StoreVars(AnalyseContext const& context,
+               std::string const& key,
+               nlohmann::json const& vars) {
+    auto const& cache = context.storage->AnalysisCache();
+    auto var_sets = cache.Read(key).value_or(nlohmann::json::array());
+    if (not var_sets.is_array()) {
+        var_sets = nlohmann::json::array();
+    }
+    if (std::find(var_sets.begin(), var_sets.end(), vars) != var_sets.end()) {
+        return;
+    }
+    var_sets.push_back(vars);
+    if (not cache.Store(key, var_sets)) {
+        Logger::Log(LogLevel::Debug, "Failed to store analysis cache entry");
+    }
+}
+
+}  // namespace
+
+namespace BuildMaps::Target {
+
+void AnalyseFromCache(const gsl::not_null<AnalyseContext*>& context,
+                      const ConfiguredTarget& key,
+                      const TargetMap::SubCallerPtr& subcaller,
+                      const TargetMap::SetterPtr& setter,
+                      const TargetMap::LoggerPtr& logger,
+                      const gsl::not_null<ResultTargetMap*>& result_map,
+                      const std::function<void()>& analyse) {
+    auto const& target = key.target.GetNamedTarget();
+    auto const repo_key = RepositoryKey(*context, target.repository);
+    if (not repo_key) {
+        analyse();
+        return;
+    }
+    auto const& cache = context->storage->AnalysisCache();
+    auto const vars_key = VarsKey(*context, target, *repo_key);
+    auto const var_sets =
+        vars_key ? cache.Read(*vars_key) : std::optional<nlohmann::json>{};
+    if (not var_sets or not var_sets->is_array()) {
+        analyse();
+        return;
+    }
+    for (auto const& vars : *var_sets) {
+        try {
+            auto effective_config =
+                key.config.Prune(vars.get<std::vector<std::string>>());
+            auto const entry_key =
+                EntryKey(*context, target, *repo_key, effective_config);
+            auto entry = entry_key ? cache.Read(*entry_key)
+                                   : std::optional<nlohmann::json>{};
+            if (not entry) {
+                continue;
+            }
+            auto deps =
+                DeserializeDependencies(*context, target.repository, *entry);
+            if (not deps) {
+                continue;
+            }
+            std::vector<ConfiguredTarget> dep_keys{};
+            dep_keys.reserve(deps->size());
+            std::transform(deps->begin(),
+                           deps->end(),
+                           std::back_inserter(dep_keys),
+                           [](auto const& dep) { return dep.key; });
+            (*subcaller)(
+                dep_keys,
+                [context,
+                 node = ConfiguredTarget{.target = key.target,
+                                         .config = std::move(effective_config)},
+                 entry = *std::move(entry),
+                 deps = *std::move(deps),
+                 setter,
+                 result_map,
+                 analyse](auto const& values) {
+                    for (std::size_t i = 0; i < values.size(); ++i) {
+                        auto const& value = **values[i];
+                        if (ResultId(value) != deps[i].result or
+                            value.ImpliedExport() != deps[i].implied_export) {
+                            Logger::Log(LogLevel::Debug,
+                                        "Analysis cache entry for {} is "
+                                        "outdated, as {} changed",
+                                        node.target.ToString(),
+                                        deps[i].key.target.ToString());
+                            analyse();
+                            return;
+                        }
+                    }
+                    AnalysedTargetPtr analysis_result{};
+                    try {
+                        analysis_result = DeserializeEntry(
+                            context->storage->GetHashFunction().GetType(),
+                            node,
+                            entry,
+                            values);
+                    } catch (std::exception const& ex) {
+                        Logger::Log(LogLevel::Debug,
+                                    "Reading analysis cache entry for {} "
+                                    "failed with:\n{}",
+                                    node.target.ToString(),
+                                    ex.what());
+                    }
+                    if (not analysis_result) {
+                        analyse();
+                        return;
+                    }
+                    Logger::Log(LogLevel::Debug,
+                                "Target {} taken from analysis cache",
+                                node.ToString());
+                    analysis_result = result_map->Add(
+                        node.target, node.config, std::move(analysis_result));
+                    (*setter)(std::move(analysis_result));
+                },
+                logger);
+            return;
+        } catch (std::exception const& ex) {
+            Logger::Log(LogLevel::Debug,
+                        "Reading analysis cache entry for {} failed with:\n{}",
+                        key.target.ToString(),
+                        ex.what());
+        }
+    }
+    analyse();
+}
+
+void StoreInAnalysisCache(
+    const gsl::not_null<AnalyseContext*>& context,
+    const ConfiguredTarget& key,
+    const std::vector<ConfiguredTarget>& transition_keys,
+    const std::vector<AnalysedTargetPtr const*>& dependency_values,
+    std::size_t declared_count,
+    const AnalysedTarget& result) noexcept {
+    try {
+        if (not key.target.IsNamedTarget() or
+            transition_keys.size() != dependency_values.size() or
+            not result.Provides()->IsCacheable()) {
+            return;
+        }
+        auto const& target = key.target.GetNamedTarget();
+        auto const repo_key = RepositoryKey(*context, target.repository);
+        if (not repo_key) {
+            return;
+        }
+        auto const effective_config = key.config.Prune(result.Vars());
+        if (not IsJsonConfiguration(effective_config)) {
+            return;
+        }
+        auto const entry_key =
+            EntryKey(*context, target, *repo_key, effective_config);
+        auto const vars_key = VarsKey(*context, target, *repo_key);
+        if (not entry_key or not vars_key) {
+            return;
+        }
+        auto entry = SerializeEntry(*context,
+                                    target.repository,
+                                    transition_keys,
+                                    dependency_values,
+                                    declared_count,
+                                    result);
+        if (not entry) {
+            return;
+        }
+        // Store the entry before announcing its variables, so that readers
+        // never miss an entry because of the order.
+        if (not context->storage->AnalysisCache().Store(*entry_key, *entry)) {
+            return;
+        }
+        StoreVars(*context, *vars_key, entry->at("vars"));
+    } catch (std::exception const& ex) {
+        Logger::Log(LogLevel::Debug,
+                    "Storing analysis result of {} failed with:\n{}",
+                    key.target.ToString(),
+                    ex.what());
+    }
+}
+
+}  // namespace BuildMaps::Target
+
+#endif  // BOOTSTRAP_BUILD_TOOL
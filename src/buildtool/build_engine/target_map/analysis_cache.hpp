@@ -0,0 +1,73 @@
+// Copyright 2026 Huawei Cloud Computing Technology Co., Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef INCLUDED_SRC_BUILDTOOL_BUILD_ENGINE_TARGET_MAP_ANALYSIS_CACHE_HPP
+#define INCLUDED_SRC_BUILDTOOL_BUILD_ENGINE_TARGET_MAP_ANALYSIS_CACHE_HPP
+
+#include <cstddef>
+#include <functional>
+#include <vector>
+
+#include "gsl/gsl"
+#include "src/buildtool/build_engine/analysed_target/analysed_target.hpp"
+#include "src/buildtool/build_engine/target_map/configured_target.hpp"
+#include "src/buildtool/build_engine/target_map/result_map.hpp"
+#include "src/buildtool/build_engine/target_map/target_map.hpp"
+#include "src/buildtool/main/analyse_context.hpp"
+
+// The analysis cache persists the analysis results of targets defined by
+// user rules. An entry is keyed by the repository key of the target's
+// repository, which covers the content of all roots and the rule and
+// expression definitions of all repositories reachable from there, the target
+// name, and the target's effective configuration. Besides the analysed target
+// itself, an entry records the (pruned) configured targets of its
+// dependencies together with an identifier of their results. On a hit, only
+// the dependencies are analysed (typically from the analysis cache as well)
+// and the entry is used if their results are unchanged. This avoids reading
+// the targets files and evaluating the rules, but keeps the invariant that
+// every action of the build graph is defined by the target creating it.
+
+namespace BuildMaps::Target {
+
+/// \brief Analyse a named target from its analysis-cache entry. If there is no
+/// usable entry, fall back to the regular analysis.
+/// \param analyse  The regular analysis of the target.
+void AnalyseFromCache(const gsl::not_null<AnalyseContext*>& context,
+                      const ConfiguredTarget& key,
+                      const TargetMap::SubCallerPtr& subcaller,
+                      const TargetMap::SetterPtr& setter,
+                      const TargetMap::LoggerPtr& logger,
+                      const gsl::not_null<ResultTargetMap*>& result_map,
+                      const std::function<void()>& analyse);
+
+/// \brief Store the analysis result of a target defined by a user rule in the
+/// analysis cache, if it is eligible. Eligible are named targets of
+/// content-fixed repositories with cacheable provides data and only named
+/// dependencies. Failures to store are not an error.
+/// \param key              The configured target as requested.
+/// \param transition_keys  The configured targets of the dependencies.
+/// \param dependency_values    The analysed dependencies.
+/// \param declared_count   Number of declared (non-implicit) dependencies.
+/// \param result           The analysed target.
+void StoreInAnalysisCache(
+    const gsl::not_null<AnalyseContext*>& context,
+    const ConfiguredTarget& key,
+    const std::vector<ConfiguredTarget>& transition_keys,
+    const std::vector<AnalysedTargetPtr const*>& dependency_values,
+    std::size_t declared_count,
+    const AnalysedTarget& result) noexcept;
+
+}  // namespace BuildMaps::Target
+
+#endif  // INCLUDED_SRC_BUILDTOOL_BUILD_ENGINE_TARGET_MAP_ANALYSIS_CACHE_HPP
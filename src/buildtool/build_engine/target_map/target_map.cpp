@@ -73,6 +73,7 @@
 #include "src/utils/cpp/path.hpp"
 #include "src/utils/cpp/vector.hpp"
 #ifndef BOOTSTRAP_BUILD_TOOL
+#include "src/buildtool/build_engine/target_map/analysis_cache.hpp"
 #include "src/buildtool/serve_api/remote/serve_api.hpp"
 #endif  // BOOTSTRAP_BUILD_TOOL
 
@@ -1113,6 +1114,16 @@ void withDependencies(
                                                std::move(tainted),
                                                std::move(implied_export),
                                                deps_info);
+#ifndef BOOTSTRAP_BUILD_TOOL
+    if (declared_and_implicit_count == dependency_values.size()) {
+        StoreInAnalysisCache(context,
+                             key,
+                             transition_keys,
+                             dependency_values,
+                             declared_count,
+                             *analysis_result);
+    }
+#endif  // BOOTSTRAP_BUILD_TOOL
     analysis_result =
         result_map->Add(key.target, effective_conf, std::move(analysis_result));
     (*setter)(std::move(analysis_result));
@@ -2070,36 +2081,59 @@ auto CreateTargetMap(
         }
 #endif
         else {
-            targets_file_map->ConsumeAfterKeysReady(
-                ts,
-                {key.target.ToModule()},
-                [key,
-                 context,
-                 source_target_map,
-                 rule_map,
-                 ts,
-                 subcaller = std::move(subcaller),
-                 setter = std::move(setter),
-                 logger,
-                 result_map](auto values) {
-                    withTargetsFile(context,
-                                    key,
-                                    *values[0],
-                                    source_target_map,
-                                    rule_map,
-                                    ts,
-                                    subcaller,
-                                    setter,
-                                    logger,
-                                    result_map);
-                },
-                [logger, target = key.target](auto const& msg, auto fatal) {
-                    (*logger)(fmt::format("While searching targets "
-                                          "description for {}:\n{}",
-                                          target.ToString(),
-                                          msg),
-                              fatal);
-                });
+            auto analyse = [key,
+                            context,
+                            targets_file_map,
+                            source_target_map,
+                            rule_map,
+                            ts,
+                            subcaller,
+                            setter,
+                            logger,
+                            result_map]() {
+                targets_file_map->ConsumeAfterKeysReady(
+                    ts,
+                    {key.target.ToModule()},
+                    [key,
+                     context,
+                     source_target_map,
+                     rule_map,
+                     ts,
+                     subcaller,
+                     setter,
+                     logger,
+                     result_map](auto values) {
+                        withTargetsFile(context,
+                                        key,
+                                        *values[0],
+                                        source_target_map,
+                                        rule_map,
+                                        ts,
+                                        subcaller,
+                                        setter,
+                                        logger,
+                                        result_map);
+                    },
+                    [logger, target = key.target](auto const& msg,
+                                                  auto fatal) {
+                        (*logger)(fmt::format("While searching targets "
+                                              "description for {}:\n{}",
+                                              target.ToString(),
+                                              msg),
+                                  fatal);
+                    });
+            };
+#ifndef BOOTSTRAP_BUILD_TOOL
+            AnalyseFromCache(context,
+                             key,
+                             subcaller,
+                             setter,
+                             logger,
+                             result_map,
+                             analyse);
+#else
+            analyse();
+#endif  // BOOTSTRAP_BUILD_TOOL
         }
     };
     return AsyncMapConsumer<ConfiguredTarget, AnalysedTargetPtr>(target_reader,
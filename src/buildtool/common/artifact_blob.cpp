@@ -165,7 +165,20 @@ auto ArtifactBlob::ReadContent() const noexcept
         },
     };
     try {
-        return std::visit(kVisitor, content_);
+        auto content = std::visit(kVisitor, content_);
+        if (content != nullptr and IsVolatile()) {
+            HashFunction const hash_function{digest_.GetHashType()};
+            auto const digest =
+                digest_.IsTree()
+                    ? ArtifactDigestFactory::HashDataAs<ObjectType::Tree>(
+                          hash_function, *content)
+                    : ArtifactDigestFactory::HashDataAs<ObjectType::File>(
+                          hash_function, *content);
+            if (digest != digest_) {
+                return nullptr;
+            }
+        }
+        return content;
     } catch (...) {
         return nullptr;
     }
@@ -100,12 +100,20 @@ class ArtifactBlob final {
     }
 
     /// \brief Read the content from source. This operation may result in the
-    /// entire file being read into memory.
+    /// entire file being read into memory. Content of a volatile source is
+    /// verified against the digest; nullptr is returned if it differs.
     [[nodiscard]] auto ReadContent() const noexcept
         -> std::shared_ptr<std::string const>;
 
+    /// \brief Whether the content source may have changed since hashing, i.e.,
+    /// is a file not owned by this ArtifactBlob.
+    [[nodiscard]] auto IsVolatile() const noexcept -> bool {
+        return std::holds_alternative<InFile>(content_);
+    }
+
     /// \brief Create an IncrementalReader that uses this ArtifactBlob's content
-    /// source.
+    /// source. Content of a volatile source is not verified, this is up to the
+    /// caller.
     /// \param chunk_size   Size of chunk, must be greater than 0.
     /// \return Valid IncrementalReader on success or an error message on
     /// failure.
@@ -59,6 +59,7 @@ struct LogArguments {
     std::optional<LogLevel> restrict_stderr_log_limit;
     bool plain_log{false};
     bool log_append{false};
+    bool log_async{false};
 };
 
 /// \brief Arguments required for analysing targets.
@@ -79,6 +80,7 @@ struct AnalysisArguments {
     std::vector<std::filesystem::path> artifacts_to_build_files;
     std::optional<std::filesystem::path> serve_errors_file;
     std::optional<std::string> profile;
+    std::optional<std::filesystem::path> trace;
 };
 
 /// \brief Arguments required for describing targets/rules.
@@ -114,8 +116,10 @@ struct EndpointArguments {
 /// \brief Arguments required for building.
 struct BuildArguments {
     std::optional<std::vector<std::string>> local_launcher{std::nullopt};
+    bool local_cached_staging{false};
     std::chrono::milliseconds timeout{kDefaultTimeout};
     std::size_t build_jobs{};
+    std::optional<std::size_t> stream_window{std::nullopt};
     std::vector<std::filesystem::path> dump_artifacts{};
     std::optional<std::string> print_to_stdout{std::nullopt};
     bool print_unique{false};
@@ -182,6 +186,7 @@ struct ServiceArguments {
     std::optional<std::string> interface{std::nullopt};
     std::optional<std::string> pid_file{std::nullopt};
     std::optional<std::uint8_t> op_exponent;
+    std::size_t action_slots{};
 };
 
 struct ServeArguments {
@@ -196,6 +201,7 @@ struct ServeArguments {
 struct GcArguments {
     bool no_rotate = false;
     bool all = false;
+    std::optional<std::uintmax_t> max_cache_size;
 };
 
 struct ToAddArguments {
@@ -208,6 +214,10 @@ struct ProtocolArguments final {
     HashFunction::Type hash_type = HashFunction::Type::GitSHA1;
 };
 
+struct DaemonArguments {
+    std::optional<std::filesystem::path> socket;
+};
+
 static inline auto SetupCommonArguments(
     gsl::not_null<CLI::App*> const& app,
     gsl::not_null<CommonArguments*> const& clargs) {
@@ -281,6 +291,10 @@ static inline auto SetupLogArguments(
         "--log-append",
         clargs->log_append,
         "Append messages to log file instead of overwriting existing.");
+    app->add_flag("--log-async",
+                  clargs->log_async,
+                  "Write log files from a background thread. Errors are "
+                  "written immediately.");
 }
 
 static inline auto SetupAnalysisArguments(
@@ -352,6 +366,11 @@ static inline auto SetupAnalysisArguments(
     app->add_option(
            "--profile", clargs->profile, "Location to write the profile to.")
         ->type_name("PATH");
+    app->add_option("--trace",
+                    clargs->trace,
+                    "Location to write a timeline of the command to, in Chrome "
+                    "trace event format.")
+        ->type_name("PATH");
     if (with_graph) {
         app->add_option_function<std::string>(
                "--dump-graph",
@@ -522,6 +541,12 @@ static inline auto SetupCommonBuildArguments(
            "prepend actions' commands before being executed locally.")
         ->type_name("JSON")
         ->default_val(nlohmann::json(kDefaultLauncher).dump());
+    app->add_flag("--local-cached-staging",
+                  clargs->local_cached_staging,
+                  "Stage input trees of locally executed actions that are not "
+                  "written to from a pool of materialized trees. Actions may "
+                  "then only write into their working directory and the "
+                  "directories of their outputs.");
 }
 
 static inline auto SetupBuildArguments(
@@ -541,6 +566,13 @@ static inline auto SetupBuildArguments(
            clargs->build_jobs,
            "Number of jobs to run during build phase (Default: same as jobs).")
         ->type_name("NUM");
+
+    app->add_option("--stream-window",
+                    clargs->stream_window,
+                    "Size in bytes from which files in file-system roots are "
+                    "uploaded from disk instead of from memory. (Default: "
+                    "1048576).")
+        ->type_name("NUM");
 }
 
 static inline auto SetupExtendedBuildArguments(
@@ -834,6 +866,14 @@ static inline auto SetupServiceArguments(
         "given by the option --log-operations-threshold, at most 2^n "
         "operations will be removed, in a FIFO scheme. If unset, defaults to "
         "14. Must be in the range [0,63]");
+
+    app->add_option("--action-slots",
+                    service_args->action_slots,
+                    "Number of slots for running actions concurrently. Each "
+                    "action takes as many slots as given by its \"cpu\" "
+                    "platform property, but at least one. Further actions are "
+                    "queued, serving the clients in turn. If unset or 0, the "
+                    "number of cores is used.");
 }
 
 static inline auto SetupServeArguments(
@@ -845,6 +885,26 @@ static inline auto SetupServeArguments(
         ->required();
 }
 
+static inline auto SetupDaemonArguments(
+    gsl::not_null<CLI::App*> const& app,
+    gsl::not_null<DaemonArguments*> const& daemon_args) {
+    app->add_option("--socket",
+                    daemon_args->socket,
+                    "Path of the Unix domain socket to accept requests on.")
+        ->required();
+}
+
+static inline auto SetupDaemonClientArguments(
+    gsl::not_null<CLI::App*> const& app,
+    gsl::not_null<DaemonArguments*> const& daemon_args) {
+    app->add_option("--daemon-socket",
+                    daemon_args->socket,
+                    "Run the command by the daemon listening on this socket "
+                    "instead of in a new process. If no daemon is reachable, "
+                    "the command is run locally. Interrupting the client "
+                    "interrupts the command.");
+}
+
 static inline void SetupGcArguments(gsl::not_null<CLI::App*> const& app,
                                     gsl::not_null<GcArguments*> const& args) {
     auto* no_rotate =
@@ -856,8 +916,19 @@ static inline void SetupGcArguments(gsl::not_null<CLI::App*> const& app,
     auto* all = app->add_flag(
         "--all", args->all, "Remove all cache generations at once");
 
+    auto* max_cache_size =
+        app->add_option("--max-cache-size",
+                        args->max_cache_size,
+                        "Instead of rotating generations, evict least recently "
+                        "used entries until the cache fits the given size.")
+            ->type_name("BYTES");
+
     no_rotate->excludes(all);
     all->excludes(no_rotate);
+    max_cache_size->excludes(no_rotate);
+    max_cache_size->excludes(all);
+    no_rotate->excludes(max_cache_size);
+    all->excludes(max_cache_size);
 }
 
 #endif  // INCLUDED_SRC_BUILDTOOL_COMMON_CLI_HPP
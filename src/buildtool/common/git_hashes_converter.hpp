@@ -23,6 +23,7 @@
 #include <unordered_map>
 #include <utility>
 
+#include "src/buildtool/common/git_hashes_store.hpp"
 #include "src/buildtool/crypto/hash_function.hpp"
 #include "src/buildtool/logging/log_level.hpp"
 #include "src/buildtool/logging/logger.hpp"
@@ -41,9 +42,39 @@ class GitHashesConverter final {
         return instance;
     }
 
+    /// \brief Obtain the compatible hash of a git blob that was converted
+    /// before, without needing its content.
+    /// \param store    Optional store of blobs converted by earlier
+    /// invocations, consulted if the blob was not converted by this one.
+    /// \returns The compatible hash or nullopt if the blob is unknown.
+    [[nodiscard]] auto LookupGitEntry(std::string const& git_hash,
+                                      std::string const& repo,
+                                      IGitHashesStore* store)
+        -> std::optional<compat_hash> {
+        {
+            std::shared_lock lock{mutex_};
+            auto it = git_to_compatible_.find(git_hash);
+            if (it != git_to_compatible_.end()) {
+                return it->second;
+            }
+        }
+        if (store == nullptr) {
+            return std::nullopt;
+        }
+        auto compatible_hash = store->Lookup(git_hash);
+        if (compatible_hash) {
+            std::unique_lock lock{mutex_};
+            git_to_compatible_[git_hash] = *compatible_hash;
+            compatible_to_git_[*compatible_hash] = {git_hash, repo};
+        }
+        return compatible_hash;
+    }
+
+    /// \param store    Optional store to add newly converted blobs to.
     [[nodiscard]] auto RegisterGitEntry(std::string const& git_hash,
                                         std::string const& data,
-                                        std::string const& repo)
+                                        std::string const& repo,
+                                        IGitHashesStore* store = nullptr)
         -> compat_hash {
         {
             std::shared_lock lock{mutex_};
@@ -55,9 +86,14 @@ class GitHashesConverter final {
         // This is only used in compatible mode.
         HashFunction const hash_function{HashFunction::Type::PlainSHA256};
         auto compatible_hash = hash_function.PlainHashData(data).HexString();
-        std::unique_lock lock{mutex_};
-        git_to_compatible_[git_hash] = compatible_hash;
-        compatible_to_git_[compatible_hash] = {git_hash, repo};
+        {
+            std::unique_lock lock{mutex_};
+            git_to_compatible_[git_hash] = compatible_hash;
+            compatible_to_git_[compatible_hash] = {git_hash, repo};
+        }
+        if (store != nullptr) {
+            store->Store(git_hash, compatible_hash);
+        }
         return compatible_hash;
     }
 
@@ -0,0 +1,46 @@
+// Copyright 2026 Huawei Cloud Computing Technology Co., Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef INCLUDED_SRC_BUILDTOOL_COMMON_GIT_HASHES_STORE_HPP
+#define INCLUDED_SRC_BUILDTOOL_COMMON_GIT_HASHES_STORE_HPP
+
+#include <optional>
+#include <string>
+
+/// \brief Store of the compatible hashes of git blobs that were converted
+/// before, e.g., persisted to share conversions across invocations. It is
+/// passed explicitly to where blobs are converted, so that converting does
+/// not depend on any particular store. Implementations must be thread-safe.
+class IGitHashesStore {
+  public:
+    IGitHashesStore() noexcept = default;
+    IGitHashesStore(IGitHashesStore const&) = delete;
+    IGitHashesStore(IGitHashesStore&&) = delete;
+    auto operator=(IGitHashesStore const&) -> IGitHashesStore& = delete;
+    auto operator=(IGitHashesStore&&) -> IGitHashesStore& = delete;
+    virtual ~IGitHashesStore() noexcept = default;
+
+    /// \brief Look up the compatible hash of a git blob.
+    /// \param git_hash     Hex git identifier of the blob.
+    /// \returns The hex compatible hash of the blob's content, or nullopt if
+    /// the blob is unknown.
+    [[nodiscard]] virtual auto Lookup(std::string const& git_hash) noexcept
+        -> std::optional<std::string> = 0;
+
+    /// \brief Add the compatible hash of a git blob.
+    virtual void Store(std::string const& git_hash,
+                       std::string const& compat_hash) noexcept = 0;
+};
+
+#endif  // INCLUDED_SRC_BUILDTOOL_COMMON_GIT_HASHES_STORE_HPP
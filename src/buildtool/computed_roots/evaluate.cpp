@@ -206,7 +206,10 @@ void ComputeAndFill(
                                               context->remote_context,
                                               &statistics,
                                               &progress,
-                                              std::nullopt};
+                                              std::nullopt,
+                                              context->file_digests,
+                                              std::nullopt,
+                                              context->stream_window};
 
     auto cache_lookup =
         expected<std::optional<std::string>, std::monostate>(std::nullopt);
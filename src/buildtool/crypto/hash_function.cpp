@@ -14,22 +14,71 @@
 
 #include "src/buildtool/crypto/hash_function.hpp"
 
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
 #include <cstddef>
+#include <cstring>
 #include <exception>
 #include <string_view>
 
 #include "src/buildtool/logging/log_level.hpp"
 #include "src/buildtool/logging/logger.hpp"
 #include "src/utils/cpp/expected.hpp"
-#include "src/utils/cpp/incremental_reader.hpp"
 
 namespace {
+// Files of at least this size are read in larger windows, announcing the
+// sequential access to the kernel.
+constexpr std::size_t kLargeFileThreshold = 1UL << 20U;
+// Size of the windows in which large files are read.
+constexpr std::size_t kLargeFileWindow = 1UL << 20U;
+// Maximum size of the buffer used to read all other files.
+constexpr std::size_t kReadBufferSize = 64UL << 10U;
+
 [[nodiscard]] auto CreateGitTreeTag(std::size_t size) noexcept -> std::string {
     return std::string("tree ") + std::to_string(size) + '\0';
 }
 [[nodiscard]] auto CreateGitBlobTag(std::size_t size) noexcept -> std::string {
     return std::string("blob ") + std::to_string(size) + '\0';
 }
+
+/// \brief Hash the content of a file by reading it in windows until EOF.
+/// Reading, in contrast to mapping, cannot fault if the file is truncated
+/// concurrently; any change in size shows in the number of bytes hashed.
+/// \param window  Size of the read buffer, i.e., of the bytes read at once.
+/// \returns The number of bytes hashed or an error message.
+[[nodiscard]] auto HashRead(int fd,
+                            std::size_t window,
+                            gsl::not_null<Hasher*> const& hasher) noexcept
+    -> expected<std::size_t, std::string> {
+    try {
+        std::string buffer(window, '\0');
+        std::size_t total{};
+        while (true) {
+            auto const len = ::pread(
+                fd, buffer.data(), buffer.size(), static_cast<off_t>(total));
+            if (len == 0) {
+                return total;
+            }
+            if (len < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                return unexpected<std::string>{std::strerror(errno)};
+            }
+            auto const bytes = static_cast<std::size_t>(len);
+            if (not hasher->Update(std::string_view{buffer.data(), bytes})) {
+                return unexpected<std::string>{"updating the hash failed"};
+            }
+            total += bytes;
+        }
+    } catch (std::exception const& ex) {
+        return unexpected<std::string>{ex.what()};
+    }
+}
 }  // namespace
 
 auto HashFunction::HashBlobData(std::string const& data) const noexcept
@@ -58,6 +107,18 @@ auto HashFunction::HashTaggedLine(std::string const& data,
     return std::move(hasher).Finalize();
 }
 
+auto HashFunction::MakeTaggedHasher(std::size_t size,
+                                    bool is_tree) const noexcept
+    -> std::optional<Hasher> {
+    auto hasher = MakeHasher();
+    if (type_ == Type::GitSHA1 and
+        not hasher.Update(is_tree ? CreateGitTreeTag(size)
+                                  : CreateGitBlobTag(size))) {
+        return std::nullopt;
+    }
+    return hasher;
+}
+
 auto HashFunction::HashBlobFile(std::filesystem::path const& path) const
     noexcept -> std::optional<std::pair<Hasher::HashDigest, std::uintmax_t>> {
     return HashTaggedFile(path, CreateGitBlobTag);
@@ -71,39 +132,48 @@ auto HashFunction::HashTreeFile(std::filesystem::path const& path) const
 auto HashFunction::HashTaggedFile(std::filesystem::path const& path,
                                   TagCreator const& tag_creator) const noexcept
     -> std::optional<std::pair<Hasher::HashDigest, std::uintmax_t>> {
-    auto const size = std::filesystem::file_size(path);
-
-    static constexpr std::size_t kChunkSize{4048};
-    auto hasher = MakeHasher();
-    if (type_ == Type::GitSHA1) {
-        hasher.Update(std::invoke(tag_creator, size));
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-type-vararg,hicpp-vararg)
+    auto const fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        Logger::Log(LogLevel::Debug,
+                    "Failed to open {} for hashing: {}",
+                    path.string(),
+                    std::strerror(errno));
+        return std::nullopt;
     }
+    auto const closer = gsl::finally([fd] { ::close(fd); });
 
-    auto const to_read = IncrementalReader::FromFile(kChunkSize, path);
-    if (not to_read.has_value()) {
+    struct stat st{};
+    if (::fstat(fd, &st) != 0 or not S_ISREG(st.st_mode)) {
         Logger::Log(LogLevel::Debug,
-                    "Failed to create a reader for {}: {}",
-                    path.string(),
-                    to_read.error());
+                    "Failed to hash {}: not a regular file",
+                    path.string());
         return std::nullopt;
     }
+    auto const size = static_cast<std::size_t>(st.st_size);
 
-    try {
-        for (auto chunk : *to_read) {
-            if (not chunk.has_value()) {
-                Logger::Log(LogLevel::Debug,
-                            "Error while trying to hash {}: {}",
-                            path.string(),
-                            chunk.error());
-                return std::nullopt;
-            }
-            hasher.Update(std::string{*chunk});
-        }
-    } catch (std::exception const& e) {
+    auto hasher = MakeHasher();
+    if (type_ == Type::GitSHA1 and
+        not hasher.Update(std::invoke(tag_creator, size))) {
+        Logger::Log(
+            LogLevel::Debug, "Failed to hash the tag of {}", path.string());
+        return std::nullopt;
+    }
+
+    // The data is never copied into strings, but hashed from a single buffer.
+    // Small files are read into a buffer of their size (plus one byte, so it
+    // is never empty) instead of a full window.
+    auto window = std::min(size + 1, kReadBufferSize);
+    if (size >= kLargeFileThreshold) {
+        ::posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+        window = kLargeFileWindow;
+    }
+    auto result = HashRead(fd, window, &hasher);
+    if (not result.has_value() or *result != size) {
         Logger::Log(LogLevel::Debug,
                     "Error while trying to hash {}: {}",
                     path.string(),
-                    e.what());
+                    result.has_value() ? "file size changed" : result.error());
         return std::nullopt;
     }
     return std::make_pair(std::move(hasher).Finalize(), size);
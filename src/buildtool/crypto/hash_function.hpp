@@ -81,6 +81,12 @@ class HashFunction {
         return *std::move(hasher);
     }
 
+    /// \brief Obtain incremental hasher for computing the blob or tree hash of
+    /// content of the given size or std::nullopt on failure.
+    [[nodiscard]] auto MakeTaggedHasher(std::size_t size,
+                                        bool is_tree) const noexcept
+        -> std::optional<Hasher>;
+
   private:
     Type const type_;
 
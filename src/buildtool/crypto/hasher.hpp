@@ -20,6 +20,7 @@
 #include <memory>
 #include <optional>
 #include <string>
+#include <string_view>
 #include <utility>  // std::move
 
 #include "src/utils/cpp/hex_string.hpp"
@@ -79,7 +80,7 @@ class Hasher final {
     ~Hasher() noexcept;
 
     /// \brief Feed data to the hasher.
-    auto Update(std::string const& data) noexcept -> bool;
+    auto Update(std::string_view data) noexcept -> bool;
 
     /// \brief Finalize hash.
     [[nodiscard]] auto Finalize() && noexcept -> HashDigest;
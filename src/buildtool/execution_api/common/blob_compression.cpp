@@ -0,0 +1,236 @@
+// Copyright 2026 Huawei Cloud Computing Technology Co., Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "src/buildtool/execution_api/common/blob_compression.hpp"
+
+#include <array>
+#include <exception>
+#include <utility>
+
+#include <zlib.h>
+
+#include "fmt/core.h"
+
+namespace {
+
+// Favour throughput over ratio; transfers should not become CPU-bound.
+constexpr int kCompressionLevel = 1;
+// Negative window bits select a raw deflate stream without header or trailer.
+constexpr int kRawDeflateWindowBits = -15;
+constexpr int kMemoryLevel = 8;
+constexpr std::size_t kBufferSize = 64UL * 1024;
+
+[[nodiscard]] auto ErrorMessage(char const* operation,
+                                int code,
+                                z_stream const& stream) -> std::string {
+    return fmt::format("{} failed with code {}: {}",
+                       operation,
+                       code,
+                       stream.msg != nullptr ? stream.msg : "unknown error");
+}
+
+// zlib's interface takes non-const input pointers, but does not modify input.
+[[nodiscard]] auto ToInput(std::string_view data) noexcept -> Bytef* {
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-type-const-cast)
+    return reinterpret_cast<Bytef*>(const_cast<char*>(data.data()));
+}
+
+}  // namespace
+
+struct BlobCompression::Compressor::Stream {
+    z_stream z{};
+    bool initialized{false};
+    bool finished{false};
+
+    Stream() noexcept {
+        initialized = deflateInit2(&z,
+                                   kCompressionLevel,
+                                   Z_DEFLATED,
+                                   kRawDeflateWindowBits,
+                                   kMemoryLevel,
+                                   Z_DEFAULT_STRATEGY) == Z_OK;
+    }
+    Stream(Stream const&) = delete;
+    Stream(Stream&&) = delete;
+    auto operator=(Stream const&) -> Stream& = delete;
+    auto operator=(Stream&&) -> Stream& = delete;
+    ~Stream() noexcept {
+        if (initialized) {
+            deflateEnd(&z);
+        }
+    }
+};
+
+BlobCompression::Compressor::Compressor() noexcept {
+    try {
+        stream_ = std::make_unique<Stream>();
+    } catch (...) {
+        stream_.reset();
+    }
+}
+
+BlobCompression::Compressor::Compressor(Compressor&&) noexcept = default;
+auto BlobCompression::Compressor::operator=(Compressor&&) noexcept
+    -> Compressor& = default;
+BlobCompression::Compressor::~Compressor() noexcept = default;
+
+auto BlobCompression::Compressor::Update(std::string_view data,
+                                         bool finish) noexcept
+    -> expected<std::string, std::string> {
+    if (stream_ == nullptr or not stream_->initialized) {
+        return unexpected<std::string>{"compressor not initialized"};
+    }
+    if (stream_->finished) {
+        return unexpected<std::string>{"compressor already finished"};
+    }
+    try {
+        auto& z = stream_->z;
+        z.next_in = ToInput(data);
+        z.avail_in = static_cast<uInt>(data.size());
+        std::string result{};
+        std::array<Bytef, kBufferSize> buffer{};
+        int const flush = finish ? Z_FINISH : Z_NO_FLUSH;
+        int code = Z_OK;
+        do {  // NOLINT(cppcoreguidelines-avoid-do-while)
+            z.next_out = buffer.data();
+            z.avail_out = static_cast<uInt>(buffer.size());
+            code = deflate(&z, flush);
+            if (code == Z_STREAM_ERROR) {
+                return unexpected{ErrorMessage("deflate", code, z)};
+            }
+            result.append(reinterpret_cast<char const*>(buffer.data()),
+                          buffer.size() - z.avail_out);
+        } while (z.avail_out == 0 or (finish and code != Z_STREAM_END));
+        stream_->finished = finish;
+        return result;
+    } catch (std::exception const& ex) {
+        return unexpected{
+            fmt::format("compressing data failed with:\n{}", ex.what())};
+    }
+}
+
+struct BlobCompression::Decompressor::Stream {
+    z_stream z{};
+    bool initialized{false};
+    bool finished{false};
+    std::size_t remaining{};
+
+    explicit Stream(std::size_t max_size) noexcept : remaining{max_size} {
+        initialized = inflateInit2(&z, kRawDeflateWindowBits) == Z_OK;
+    }
+    Stream(Stream const&) = delete;
+    Stream(Stream&&) = delete;
+    auto operator=(Stream const&) -> Stream& = delete;
+    auto operator=(Stream&&) -> Stream& = delete;
+    ~Stream() noexcept {
+        if (initialized) {
+            inflateEnd(&z);
+        }
+    }
+};
+
+BlobCompression::Decompressor::Decompressor(std::size_t max_size) noexcept {
+    try {
+        stream_ = std::make_unique<Stream>(max_size);
+    } catch (...) {
+        stream_.reset();
+    }
+}
+
+BlobCompression::Decompressor::Decompressor(Decompressor&&) noexcept =
+    default;
+auto BlobCompression::Decompressor::operator=(Decompressor&&) noexcept
+    -> Decompressor& = default;
+BlobCompression::Decompressor::~Decompressor() noexcept = default;
+
+auto BlobCompression::Decompressor::Update(std::string_view data) noexcept
+    -> expected<std::string, std::string> {
+    if (stream_ == nullptr or not stream_->initialized) {
+        return unexpected<std::string>{"decompressor not initialized"};
+    }
+    if (stream_->finished) {
+        if (not data.empty()) {
+            return unexpected<std::string>{
+                "trailing data after end of compressed stream"};
+        }
+        return std::string{};
+    }
+    try {
+        auto& z = stream_->z;
+        z.next_in = ToInput(data);
+        z.avail_in = static_cast<uInt>(data.size());
+        std::string result{};
+        std::array<Bytef, kBufferSize> buffer{};
+        // Also continue on a full output buffer, as zlib might hold back
+        // further output even if all input was consumed.
+        do {  // NOLINT(cppcoreguidelines-avoid-do-while)
+            z.next_out = buffer.data();
+            z.avail_out = static_cast<uInt>(buffer.size());
+            int const code = inflate(&z, Z_NO_FLUSH);
+            if (code == Z_BUF_ERROR) {
+                // no progress possible without further input
+                break;
+            }
+            if (code != Z_OK and code != Z_STREAM_END) {
+                return unexpected{ErrorMessage("inflate", code, z)};
+            }
+            auto const produced = buffer.size() - z.avail_out;
+            if (produced > stream_->remaining) {
+                return unexpected<std::string>{
+                    "decompressed data exceeds expected size"};
+            }
+            stream_->remaining -= produced;
+            result.append(reinterpret_cast<char const*>(buffer.data()),
+                          produced);
+            stream_->finished = code == Z_STREAM_END;
+        } while (not stream_->finished and
+                 (z.avail_in > 0 or z.avail_out == 0));
+        if (stream_->finished and z.avail_in > 0) {
+            return unexpected<std::string>{
+                "trailing data after end of compressed stream"};
+        }
+        return result;
+    } catch (std::exception const& ex) {
+        return unexpected{
+            fmt::format("decompressing data failed with:\n{}", ex.what())};
+    }
+}
+
+auto BlobCompression::Decompressor::Finished() const noexcept -> bool {
+    return stream_ != nullptr and stream_->finished;
+}
+
+auto BlobCompression::Compress(std::string_view data) noexcept
+    -> expected<std::string, std::string> {
+    Compressor compressor{};
+    return compressor.Update(data, /*finish=*/true);
+}
+
+auto BlobCompression::Decompress(std::string_view data,
+                                 std::size_t size) noexcept
+    -> expected<std::string, std::string> {
+    Decompressor decompressor{size};
+    auto result = decompressor.Update(data);
+    if (not result) {
+        return result;
+    }
+    if (not decompressor.Finished() or result->size() != size) {
+        return unexpected<std::string>{
+            fmt::format("decompressed data has unexpected size {} instead of "
+                        "{}",
+                        result->size(),
+                        size)};
+    }
+    return result;
+}
@@ -0,0 +1,96 @@
+// Copyright 2026 Huawei Cloud Computing Technology Co., Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef INCLUDED_SRC_BUILDTOOL_EXECUTION_API_COMMON_BLOB_COMPRESSION_HPP
+#define INCLUDED_SRC_BUILDTOOL_EXECUTION_API_COMMON_BLOB_COMPRESSION_HPP
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <string_view>
+
+#include "src/utils/cpp/expected.hpp"
+
+/// \brief Compression of blobs for transfer between client and server, as
+/// negotiated via the remote-execution API's compressor values. The only
+/// supported encoding (besides identity) is DEFLATE, i.e., a raw deflate
+/// stream as specified in RFC 1951, without zlib or gzip headers.
+class BlobCompression final {
+  public:
+    /// \brief Blobs smaller than this are always transferred uncompressed, as
+    /// the savings would not outweigh the overhead.
+    static constexpr std::size_t kMinCompressSize = 1024;
+
+    /// \brief Incrementally compress a stream of data.
+    class Compressor final {
+      public:
+        Compressor() noexcept;
+        Compressor(Compressor const&) = delete;
+        Compressor(Compressor&&) noexcept;
+        auto operator=(Compressor const&) -> Compressor& = delete;
+        auto operator=(Compressor&&) noexcept -> Compressor&;
+        ~Compressor() noexcept;
+
+        /// \brief Compress the next chunk of data.
+        /// \param data     The uncompressed data.
+        /// \param finish   Whether this is the last chunk of the stream.
+        /// \returns The compressed data produced so far (possibly empty) or an
+        /// error message.
+        [[nodiscard]] auto Update(std::string_view data, bool finish) noexcept
+            -> expected<std::string, std::string>;
+
+      private:
+        struct Stream;
+        std::unique_ptr<Stream> stream_;
+    };
+
+    /// \brief Incrementally decompress a stream of data.
+    class Decompressor final {
+      public:
+        /// \param max_size Maximum size of the uncompressed data; producing
+        /// more is an error, which protects against decompression bombs.
+        explicit Decompressor(std::size_t max_size) noexcept;
+        Decompressor(Decompressor const&) = delete;
+        Decompressor(Decompressor&&) noexcept;
+        auto operator=(Decompressor const&) -> Decompressor& = delete;
+        auto operator=(Decompressor&&) noexcept -> Decompressor&;
+        ~Decompressor() noexcept;
+
+        /// \brief Decompress the next chunk of compressed data.
+        /// \returns The uncompressed data produced so far (possibly empty) or
+        /// an error message.
+        [[nodiscard]] auto Update(std::string_view data) noexcept
+            -> expected<std::string, std::string>;
+
+        /// \brief Whether the end of the compressed stream was reached.
+        [[nodiscard]] auto Finished() const noexcept -> bool;
+
+      private:
+        struct Stream;
+        std::unique_ptr<Stream> stream_;
+    };
+
+    /// \brief Compress data in one go.
+    [[nodiscard]] static auto Compress(std::string_view data) noexcept
+        -> expected<std::string, std::string>;
+
+    /// \brief Decompress a complete compressed stream in one go.
+    /// \param data     The compressed data.
+    /// \param size     The expected size of the uncompressed data.
+    [[nodiscard]] static auto Decompress(std::string_view data,
+                                         std::size_t size) noexcept
+        -> expected<std::string, std::string>;
+};
+
+#endif  // INCLUDED_SRC_BUILDTOOL_EXECUTION_API_COMMON_BLOB_COMPRESSION_HPP
@@ -68,18 +68,29 @@ const std::set<std::string> ByteStreamUtils::kOtherReservedFragments =
                           "capabilities",
                           "compressed-blobs"};
 
-auto ByteStreamUtils::ReadRequest::ToString(
-    std::string instance_name,
-    ArtifactDigest const& digest) noexcept -> std::string {
+auto ByteStreamUtils::BlobsFragment(bool compressed) noexcept
+    -> std::string {
+    if (compressed) {
+        return fmt::format("{}/{}",
+                           ByteStreamUtils::kCompressedBlobs,
+                           ByteStreamUtils::kDeflate);
+    }
+    return ByteStreamUtils::kBlobs;
+}
+
+auto ByteStreamUtils::ReadRequest::ToString(std::string instance_name,
+                                            ArtifactDigest const& digest,
+                                            bool compressed) noexcept
+    -> std::string {
     if (instance_name.empty()) {
         return fmt::format("{}/{}/{}",
-                           ByteStreamUtils::kBlobs,
+                           BlobsFragment(compressed),
                            ArtifactDigestFactory::ToBazel(digest).hash(),
                            digest.size());
     }
     return fmt::format("{}/{}/{}/{}",
                        std::move(instance_name),
-                       ByteStreamUtils::kBlobs,
+                       BlobsFragment(compressed),
                        ArtifactDigestFactory::ToBazel(digest).hash(),
                        digest.size());
 }
@@ -91,12 +102,26 @@ auto ByteStreamUtils::ReadRequest::FromString(
     static constexpr std::size_t kReadRequestPartsCountOffset = 3U;
 
     auto const parts = ::SplitRequest(request);
+    int instance_name_end = -1;
     int blobs_index = -1;
+    bool compressed = false;
     for (int i = 0; i < parts.size(); i++) {
         if (parts[i].compare(ByteStreamUtils::kBlobs) == 0) {
+            instance_name_end = i;
             blobs_index = i;
             break;
         }
+        if (parts[i].compare(ByteStreamUtils::kCompressedBlobs) == 0) {
+            // only deflate is supported as compressor
+            if (i + 1 >= parts.size() or
+                parts[i + 1].compare(ByteStreamUtils::kDeflate) != 0) {
+                return std::nullopt;
+            }
+            instance_name_end = i;
+            blobs_index = i + 1;
+            compressed = true;
+            break;
+        }
         if (parts[i].compare(ByteStreamUtils::kUploads) == 0) {
             // "uploads" not allowed in instance name
             return std::nullopt;
@@ -114,15 +139,16 @@ auto ByteStreamUtils::ReadRequest::FromString(
         return std::nullopt;
     }
     std::ostringstream instance_name{};
-    for (int i = 0; i < blobs_index; i++) {
+    for (int i = 0; i < instance_name_end; i++) {
         instance_name << parts[i];
-        if (i + 1 < blobs_index) {
+        if (i + 1 < instance_name_end) {
             instance_name << "/";
         }
     }
 
     ReadRequest result;
     result.instance_name_ = instance_name.str();
+    result.compressed_ = compressed;
     result.hash_ = std::string(parts[blobs_index + kHashIndexOffset]);
     try {
         result.size_ =
@@ -139,15 +165,16 @@ auto ByteStreamUtils::ReadRequest::GetDigest(HashFunction::Type hash_type)
     return ArtifactDigestFactory::FromBazel(hash_type, bazel_digest);
 }
 
-auto ByteStreamUtils::WriteRequest::ToString(
-    std::string instance_name,
-    std::string uuid,
-    ArtifactDigest const& digest) noexcept -> std::string {
+auto ByteStreamUtils::WriteRequest::ToString(std::string instance_name,
+                                             std::string uuid,
+                                             ArtifactDigest const& digest,
+                                             bool compressed) noexcept
+    -> std::string {
     if (instance_name.empty()) {
         return fmt::format("{}/{}/{}/{}/{}",
                            ByteStreamUtils::kUploads,
                            std::move(uuid),
-                           ByteStreamUtils::kBlobs,
+                           BlobsFragment(compressed),
                            ArtifactDigestFactory::ToBazel(digest).hash(),
                            digest.size());
     }
@@ -155,7 +182,7 @@ auto ByteStreamUtils::WriteRequest::ToString(
                        std::move(instance_name),
                        ByteStreamUtils::kUploads,
                        std::move(uuid),
-                       ByteStreamUtils::kBlobs,
+                       BlobsFragment(compressed),
                        ArtifactDigestFactory::ToBazel(digest).hash(),
                        digest.size());
 }
@@ -189,13 +216,29 @@ auto ByteStreamUtils::WriteRequest::FromString(
         return std::nullopt;
     }
 
-    if ((parts.size() != uploads_index + kWriteRequestPartsCountOffset) or
+    // a compressed blob has an additional fragment naming the compressor
+    bool const compressed =
+        parts.size() > uploads_index + kBlobsIndexOffset and
         parts[uploads_index + kBlobsIndexOffset].compare(
-            ByteStreamUtils::kBlobs) != 0) {
+            ByteStreamUtils::kCompressedBlobs) == 0;
+    std::size_t const shift = compressed ? 1U : 0U;
+    if (parts.size() != uploads_index + kWriteRequestPartsCountOffset + shift) {
+        return std::nullopt;
+    }
+    if (compressed) {
+        // only deflate is supported as compressor
+        if (parts[uploads_index + kBlobsIndexOffset + 1].compare(
+                ByteStreamUtils::kDeflate) != 0) {
+            return std::nullopt;
+        }
+    }
+    else if (parts[uploads_index + kBlobsIndexOffset].compare(
+                 ByteStreamUtils::kBlobs) != 0) {
         return std::nullopt;
     }
 
     WriteRequest result;
+    result.compressed_ = compressed;
     std::ostringstream instance_name{};
     for (int i = 0; i < uploads_index; i++) {
         instance_name << parts[i];
@@ -205,10 +248,11 @@ auto ByteStreamUtils::WriteRequest::FromString(
     }
     result.instance_name_ = instance_name.str();
     result.uuid_ = std::string(parts[uploads_index + kUUIDIndexOffset]);
-    result.hash_ = std::string(parts[uploads_index + kHashIndexOffset]);
+    result.hash_ =
+        std::string(parts[uploads_index + kHashIndexOffset + shift]);
     try {
-        result.size_ =
-            std::stoul(std::string(parts[uploads_index + kSizeIndexOffset]));
+        result.size_ = std::stoul(
+            std::string(parts[uploads_index + kSizeIndexOffset + shift]));
     } catch (...) {
         return std::nullopt;
     }
@@ -26,6 +26,8 @@
 
 class ByteStreamUtils final {
     static constexpr auto* kBlobs = "blobs";
+    static constexpr auto* kCompressedBlobs = "compressed-blobs";
+    static constexpr auto* kDeflate = "deflate";
     static constexpr auto* kUploads = "uploads";
     static const std::set<std::string> kOtherReservedFragments;
 
@@ -38,11 +40,15 @@ class ByteStreamUtils final {
     /// own. The pattern is:
     /// "{instance_name}/{kBlobs}/{digest.hash()}/{digest.size_bytes()}".
     /// "instance_name_example/blobs/62183d7a696acf7e69e218efc82c93135f8c85f895/4424712"
+    /// For compressed transfers, "{kBlobs}" is replaced by
+    /// "{kCompressedBlobs}/{kDeflate}"; the digest is that of the
+    /// uncompressed blob.
     class ReadRequest final {
       public:
-        [[nodiscard]] static auto ToString(
-            std::string instance_name,
-            ArtifactDigest const& digest) noexcept -> std::string;
+        [[nodiscard]] static auto ToString(std::string instance_name,
+                                           ArtifactDigest const& digest,
+                                           bool compressed = false) noexcept
+            -> std::string;
 
         [[nodiscard]] static auto FromString(
             std::string const& request) noexcept -> std::optional<ReadRequest>;
@@ -55,10 +61,16 @@ class ByteStreamUtils final {
         [[nodiscard]] auto GetDigest(HashFunction::Type hash_type)
             const noexcept -> expected<ArtifactDigest, std::string>;
 
+        /// \brief Whether the blob is transferred deflate-compressed.
+        [[nodiscard]] auto IsCompressed() const noexcept -> bool {
+            return compressed_;
+        }
+
       private:
         std::string instance_name_;
         std::string hash_;
         std::size_t size_ = 0;
+        bool compressed_ = false;
 
         explicit ReadRequest() = default;
     };
@@ -68,12 +80,14 @@ class ByteStreamUtils final {
     /// own. The pattern is:
     /// "{instance_name}/{kUploads}/{uuid}/{kBlobs}/{digest.hash()}/{digest.size_bytes()}".
     /// "instance_name_example/uploads/c4f03510-7d56-4490-8934-01bce1b1288e/blobs/62183d7a696acf7e69e218efc82c93135f8c85f895/4424712"
+    /// Compressed transfers are denoted as for \ref ReadRequest.
     class WriteRequest final {
       public:
-        [[nodiscard]] static auto ToString(
-            std::string instance_name,
-            std::string uuid,
-            ArtifactDigest const& digest) noexcept -> std::string;
+        [[nodiscard]] static auto ToString(std::string instance_name,
+                                           std::string uuid,
+                                           ArtifactDigest const& digest,
+                                           bool compressed = false) noexcept
+            -> std::string;
 
         [[nodiscard]] static auto FromString(
             std::string const& request) noexcept -> std::optional<WriteRequest>;
@@ -90,14 +104,25 @@ class ByteStreamUtils final {
         [[nodiscard]] auto GetDigest(HashFunction::Type hash_type)
             const noexcept -> expected<ArtifactDigest, std::string>;
 
+        /// \brief Whether the blob is transferred deflate-compressed.
+        [[nodiscard]] auto IsCompressed() const noexcept -> bool {
+            return compressed_;
+        }
+
       private:
         std::string instance_name_;
         std::string uuid_;
         std::string hash_;
         std::size_t size_ = 0;
+        bool compressed_ = false;
 
         explicit WriteRequest() = default;
     };
+
+  private:
+    /// \brief Resource name fragment denoting the blob's encoding.
+    [[nodiscard]] static auto BlobsFragment(bool compressed) noexcept
+        -> std::string;
 };
 
 #endif  // INCLUDED_SRC_BUILDTOOL_EXECUTION_API_COMMON_BYTESTREAM_UTILS_HPP
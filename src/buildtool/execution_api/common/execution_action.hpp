@@ -17,9 +17,12 @@
 
 #include <chrono>
 #include <cstdint>
+#include <exception>
+#include <functional>
 #include <memory>
 
 #include "src/buildtool/execution_api/common/execution_response.hpp"
+#include "src/buildtool/logging/log_level.hpp"
 #include "src/buildtool/logging/logger.hpp"
 
 /// \brief Abstract action.
@@ -29,6 +32,13 @@ class IExecutionAction {
   public:
     using Ptr = std::unique_ptr<IExecutionAction>;
 
+    /// \brief Completes an asynchronously started execution.
+    /// \returns Execution response, or nullptr if execution failed.
+    using Finisher = std::function<IExecutionResponse::Ptr()>;
+
+    /// \brief Receives the finisher of an asynchronously started execution.
+    using AsyncCallback = std::function<void(Finisher)>;
+
     enum class CacheFlag : std::uint8_t {
         CacheOutput,       ///< run and cache, or serve from cache
         DoNotCacheOutput,  ///< run and do not cache, never served from cached
@@ -62,6 +72,23 @@ class IExecutionAction {
     [[nodiscard]] virtual auto Execute(Logger const* logger = nullptr) noexcept
         -> IExecutionResponse::Ptr = 0;
 
+    /// \brief Start executing the action asynchronously.
+    /// The callback is called exactly once, possibly from a different thread,
+    /// as soon as the result is available; it must not block. The finisher
+    /// passed to it produces the response and may block; it must be called
+    /// while this action and the logger are still alive. The default
+    /// implementation defers the whole (blocking) execution to the finisher.
+    virtual void ExecuteAsync(Logger const* logger,
+                              AsyncCallback const& callback) noexcept {
+        try {
+            callback([this, logger]() { return Execute(logger); });
+        } catch (std::exception const& ex) {
+            Logger::Log(LogLevel::Error,
+                        "Unexpectedly failed to start execution with:\n{}",
+                        ex.what());
+        }
+    }
+
     virtual void SetCacheFlag(CacheFlag flag) noexcept = 0;
 
     virtual void SetTimeout(std::chrono::milliseconds timeout) noexcept = 0;
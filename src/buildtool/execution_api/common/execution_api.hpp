@@ -162,6 +162,13 @@ class IExecutionApi {
         -> HashFunction::Type = 0;
 
     [[nodiscard]] virtual auto GetTempSpace() const noexcept -> TmpDir::Ptr = 0;
+
+    /// \brief Whether uploading a file-backed blob may move its file into the
+    /// storage of the endpoint. If so, only files that can be given away may
+    /// be uploaded as file-backed blobs.
+    [[nodiscard]] virtual auto TakesOwnershipOfFiles() const noexcept -> bool {
+        return true;
+    }
 };
 
 #endif  // INCLUDED_SRC_BUILDTOOL_EXECUTION_API_COMMON_EXECUTION_APIHPP
@@ -0,0 +1,195 @@
+// Copyright 2026 Huawei Cloud Computing Technology Co., Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef INCLUDED_SRC_BUILDTOOL_EXECUTION_API_COMMON_REQUEST_BATCHER_HPP
+#define INCLUDED_SRC_BUILDTOOL_EXECUTION_API_COMMON_REQUEST_BATCHER_HPP
+
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <unordered_set>
+#include <utility>
+
+#include "src/buildtool/logging/log_level.hpp"
+#include "src/buildtool/logging/logger.hpp"
+
+/// \brief Coalesces requests on sets of items from concurrent callers into
+/// batched requests, e.g., lookups of missing blobs or uploads of small blobs.
+/// A caller finding no request in flight sends its items right away, so a lone
+/// caller is never delayed. Callers arriving while a request is in flight add
+/// their items to the next batch, which is sent by its first caller as soon as
+/// no request is in flight anymore (or the batch is full). Each caller obtains
+/// the items the request failed for out of the ones it passed.
+template <class TItem>
+class RequestBatcher final {
+  public:
+    /// \brief Request for a batch of items. Must be thread-safe.
+    /// \returns The items the request failed for, e.g., the digests of the
+    /// blobs missing or the blobs not uploaded.
+    using Request = std::function<std::unordered_set<TItem>(
+        std::unordered_set<TItem> const&)>;
+
+    /// \brief Share of an item in the capacity of a batch.
+    using Weight = std::function<std::size_t(TItem const&)>;
+
+    /// \param capacity  Total weight of the items of a batch. Each item counts
+    /// as one, unless a weight function is given.
+    explicit RequestBatcher(Request request,
+                            std::size_t capacity,
+                            Weight weight = {}) noexcept
+        : request_{std::move(request)},
+          capacity_{capacity},
+          weight_{std::move(weight)} {}
+
+    /// \brief Send the given items, batched with the ones of concurrent
+    /// callers. Items that fill a batch on their own are sent directly.
+    /// \returns The items the request failed for; if the request throws, all
+    /// items.
+    [[nodiscard]] auto Run(std::unordered_set<TItem> const& items) noexcept
+        -> std::unordered_set<TItem> {
+        if (items.empty()) {
+            return {};
+        }
+        try {
+            auto const weight = Weigh(items);
+            if (weight >= capacity_) {
+                return Send(items);
+            }
+            std::shared_ptr<Batch> batch;
+            {
+                std::unique_lock lock{mutex_};
+                if (open_ != nullptr and open_->weight + weight > capacity_) {
+                    CloseOpenBatch();
+                }
+                if (open_ == nullptr and in_flight_ == 0) {
+                    // nothing to wait for, so do not delay the caller
+                    return SendInFlight(&lock, items);
+                }
+                if (open_ == nullptr) {
+                    batch = std::make_shared<Batch>();
+                    batch->items = items;
+                    batch->weight = weight;
+                    open_ = batch;
+                    RunBatch(&lock, batch);
+                }
+                else {
+                    batch = open_;
+                    batch->items.insert(items.begin(), items.end());
+                    batch->weight += weight;
+                    if (batch->weight >= capacity_) {
+                        CloseOpenBatch();
+                    }
+                    cv_.wait(lock, [&batch]() { return batch->done; });
+                }
+            }
+            // The result of a finished batch is not modified anymore.
+            std::unordered_set<TItem> result;
+            for (auto const& item : items) {
+                if (batch->failed.contains(item)) {
+                    result.emplace(item);
+                }
+            }
+            return result;
+        } catch (std::exception const& ex) {
+            Logger::Log(LogLevel::Warning,
+                        "Batching request failed with:\n{}",
+                        ex.what());
+        }
+        return Send(items);
+    }
+
+  private:
+    struct Batch {
+        std::unordered_set<TItem> items;
+        std::unordered_set<TItem> failed;
+        std::size_t weight = 0;
+        bool full = false;
+        bool done = false;
+    };
+
+    Request request_;
+    std::size_t capacity_;
+    Weight weight_;
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::shared_ptr<Batch> open_;  // batch still accepting items
+    std::size_t in_flight_{};      // number of requests currently sent
+
+    [[nodiscard]] auto Weigh(std::unordered_set<TItem> const& items) const
+        -> std::size_t {
+        if (not weight_) {
+            return items.size();
+        }
+        std::size_t weight = 0;
+        for (auto const& item : items) {
+            weight += weight_(item);
+        }
+        return weight;
+    }
+
+    /// \brief Stop accepting items for the open batch. Caller must hold the
+    /// lock.
+    void CloseOpenBatch() noexcept {
+        open_->full = true;
+        open_ = nullptr;
+        cv_.notify_all();
+    }
+
+    /// \brief Send the given items while accounting them as in flight.
+    /// Caller must hold the lock, which is released during the request.
+    [[nodiscard]] auto SendInFlight(std::unique_lock<std::mutex>* lock,
+                                    std::unordered_set<TItem> const& items)
+        noexcept -> std::unordered_set<TItem> {
+        ++in_flight_;
+        lock->unlock();
+        auto failed = Send(items);
+        lock->lock();
+        --in_flight_;
+        // batches waiting for the request to finish can be sent now
+        cv_.notify_all();
+        return failed;
+    }
+
+    /// \brief Wait until no request is in flight or the batch is full, send
+    /// it, and publish the result.
+    void RunBatch(std::unique_lock<std::mutex>* lock,
+                  std::shared_ptr<Batch> const& batch) noexcept {
+        cv_.wait(*lock,
+                 [this, &batch]() { return batch->full or in_flight_ == 0; });
+        if (open_ == batch) {
+            open_ = nullptr;
+        }
+        // No other caller touches the items of a closed batch.
+        batch->failed = SendInFlight(lock, batch->items);
+        batch->done = true;
+        cv_.notify_all();
+    }
+
+    [[nodiscard]] auto Send(std::unordered_set<TItem> const& items)
+        const noexcept -> std::unordered_set<TItem> {
+        try {
+            return request_(items);
+        } catch (std::exception const& ex) {
+            Logger::Log(LogLevel::Warning,
+                        "Batched request failed with:\n{}",
+                        ex.what());
+        }
+        return items;
+    }
+};
+
+#endif  // INCLUDED_SRC_BUILDTOOL_EXECUTION_API_COMMON_REQUEST_BATCHER_HPP
@@ -76,6 +76,14 @@ class TreeReader final {
         return result;
     }
 
+    /// \brief Fetch a whole tree upfront, if supported by the reader, so that
+    /// reading its directories later does not take one round trip each.
+    void PrefetchTree(ArtifactDigest const& digest) const noexcept {
+        if constexpr (requires { impl_.PrefetchTree(digest); }) {
+            impl_.PrefetchTree(digest);
+        }
+    }
+
     /// \brief Traverses a tree recursively and retrieves object infos of all
     /// found blobs (leafs). Tree objects are by default not added to the result
     /// list, but converted to a path name.
@@ -98,6 +106,7 @@ class TreeReader final {
         };
 
         try {
+            PrefetchTree(digest);
             if (ReadObjectInfosRecursively(
                     store, parent, digest, include_trees)) {
                 return result;
@@ -14,6 +14,7 @@
 
 #include "src/buildtool/execution_api/common/tree_reader_utils.hpp"
 
+#include <algorithm>
 #include <exception>
 #include <unordered_map>
 #include <utility>
@@ -176,3 +177,121 @@ auto TreeReaderUtils::GitTreeToString(
         return std::nullopt;
     }
 }
+
+auto TreeReaderUtils::GitTreeToDirectory(
+    GitRepo::tree_entries_t const& entries,
+    SymlinkReadFunc const& read_symlink) noexcept
+    -> std::optional<bazel_re::Directory> {
+    try {
+        bazel_re::Directory dir{};
+        for (auto const& [raw_id, es] : entries) {
+            auto const hex_id = ToHexString(raw_id);
+            for (auto const& entry : es) {
+                auto digest =
+                    ArtifactDigestFactory::Create(HashFunction::Type::GitSHA1,
+                                                  hex_id,
+                                                  /*size is unknown*/ 0,
+                                                  IsTreeObject(entry.type));
+                if (not digest) {
+                    return std::nullopt;
+                }
+                switch (entry.type) {
+                    case ObjectType::File:
+                    case ObjectType::Executable: {
+                        auto* node = dir.add_files();
+                        node->set_name(entry.name);
+                        *node->mutable_digest() =
+                            ArtifactDigestFactory::ToBazel(*digest);
+                        node->set_is_executable(IsExecutableObject(entry.type));
+                    } break;
+                    case ObjectType::Tree: {
+                        auto* node = dir.add_directories();
+                        node->set_name(entry.name);
+                        *node->mutable_digest() =
+                            ArtifactDigestFactory::ToBazel(*digest);
+                    } break;
+                    case ObjectType::Symlink: {
+                        auto target = read_symlink(*digest);
+                        if (not target) {
+                            return std::nullopt;
+                        }
+                        auto* node = dir.add_symlinks();
+                        node->set_name(entry.name);
+                        node->set_target(*std::move(target));
+                    } break;
+                }
+            }
+        }
+        // Nodes of Directory messages are sorted by name.
+        auto by_name = [](auto const& lhs, auto const& rhs) {
+            return lhs.name() < rhs.name();
+        };
+        std::sort(dir.mutable_files()->begin(),
+                  dir.mutable_files()->end(),
+                  by_name);
+        std::sort(dir.mutable_directories()->begin(),
+                  dir.mutable_directories()->end(),
+                  by_name);
+        std::sort(dir.mutable_symlinks()->begin(),
+                  dir.mutable_symlinks()->end(),
+                  by_name);
+        return dir;
+    } catch (std::exception const& ex) {
+        Logger::Log(LogLevel::Error,
+                    "converting Git tree to Directory failed with:\n{}",
+                    ex.what());
+        return std::nullopt;
+    }
+}
+
+auto TreeReaderUtils::DirectoryToGitTree(
+    bazel_re::Directory const& dir) noexcept
+    -> std::optional<std::pair<std::string, std::string>> {
+    HashFunction const hash_function{HashFunction::Type::GitSHA1};
+    try {
+        GitRepo::tree_entries_t entries{};
+        auto add_entry = [&entries](bazel_re::Digest const& bazel_digest,
+                                    std::string const& name,
+                                    ObjectType type) -> bool {
+            auto digest = ArtifactDigestFactory::FromBazel(
+                HashFunction::Type::GitSHA1, bazel_digest);
+            if (not digest or digest->IsTree() != IsTreeObject(type)) {
+                return false;
+            }
+            auto raw_id = FromHexString(digest->hash());
+            if (not raw_id) {
+                return false;
+            }
+            entries[*std::move(raw_id)].emplace_back(name, type);
+            return true;
+        };
+        for (auto const& f : dir.files()) {
+            if (not add_entry(f.digest(),
+                              f.name(),
+                              f.is_executable() ? ObjectType::Executable
+                                                : ObjectType::File)) {
+                return std::nullopt;
+            }
+        }
+        for (auto const& d : dir.directories()) {
+            if (not add_entry(d.digest(), d.name(), ObjectType::Tree)) {
+                return std::nullopt;
+            }
+        }
+        for (auto const& l : dir.symlinks()) {
+            entries[hash_function.HashBlobData(l.target()).Bytes()]
+                .emplace_back(l.name(), ObjectType::Symlink);
+        }
+        auto tree = GitRepo::CreateShallowTree(entries);
+        if (not tree) {
+            return std::nullopt;
+        }
+        return std::make_pair(ToHexString(tree->first),
+                              std::move(tree->second));
+    } catch (std::exception const& ex) {
+        Logger::Log(LogLevel::Error,
+                    "converting Directory to Git tree failed with:\n{}",
+                    ex.what());
+        return std::nullopt;
+    }
+}
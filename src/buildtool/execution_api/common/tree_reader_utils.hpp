@@ -19,8 +19,10 @@
 #include <functional>
 #include <optional>
 #include <string>
+#include <utility>
 
 #include "src/buildtool/common/artifact.hpp"
+#include "src/buildtool/common/artifact_digest.hpp"
 #include "src/buildtool/common/bazel_types.hpp"
 #include "src/buildtool/file_system/git_repo.hpp"
 
@@ -28,6 +30,8 @@ class TreeReaderUtils final {
   public:
     using InfoStoreFunc = std::function<bool(std::filesystem::path const&,
                                              Artifact::ObjectInfo&&)>;
+    using SymlinkReadFunc =
+        std::function<std::optional<std::string>(ArtifactDigest const&)>;
 
     /// \brief Read object infos from directory.
     /// \returns true on success.
@@ -49,6 +53,24 @@ class TreeReaderUtils final {
     [[nodiscard]] static auto GitTreeToString(
         GitRepo::tree_entries_t const& entries) noexcept
         -> std::optional<std::string>;
+
+    /// \brief Represent a Git tree as Directory message, e.g., to transfer it
+    /// via the GetTree API. Digests of entries are the Git identifiers with
+    /// unknown size. The original tree can be recreated with
+    /// \ref DirectoryToGitTree.
+    /// \param entries       Entries of the Git tree.
+    /// \param read_symlink  Function to read the target of a symlink entry.
+    [[nodiscard]] static auto GitTreeToDirectory(
+        GitRepo::tree_entries_t const& entries,
+        SymlinkReadFunc const& read_symlink) noexcept
+        -> std::optional<bazel_re::Directory>;
+
+    /// \brief Recreate a Git tree from its representation as Directory
+    /// message created by \ref GitTreeToDirectory.
+    /// \returns Pair of hex identifier and content of the Git tree.
+    [[nodiscard]] static auto DirectoryToGitTree(
+        bazel_re::Directory const& dir) noexcept
+        -> std::optional<std::pair<std::string, std::string>>;
 };
 
 #endif  // INCLUDED_SRC_BUILDTOOL_EXECUTION_API_COMMON_TREE_READER_UTILS_HPP
@@ -23,12 +23,12 @@
 #include "src/buildtool/common/artifact_digest.hpp"
 #include "src/buildtool/common/artifact_digest_factory.hpp"
 #include "src/buildtool/crypto/hash_function.hpp"
+#include "src/buildtool/execution_api/execution_service/callback_reactors.hpp"
 #include "src/buildtool/logging/log_level.hpp"
 #include "src/buildtool/storage/garbage_collector.hpp"
 #include "src/utils/cpp/expected.hpp"
 
-auto ActionCacheServiceImpl::GetActionResult(
-    ::grpc::ServerContext* /*context*/,
+auto ActionCacheServiceImpl::GetActionResultImpl(
     const ::bazel_re::GetActionResultRequest* request,
     ::bazel_re::ActionResult* response) -> ::grpc::Status {
     auto action_digest = ArtifactDigestFactory::FromBazel(
@@ -61,12 +61,42 @@ auto ActionCacheServiceImpl::GetActionResult(
     return ::grpc::Status::OK;
 }
 
-auto ActionCacheServiceImpl::UpdateActionResult(
-    ::grpc::ServerContext* /*context*/,
-    const ::bazel_re::UpdateActionResultRequest*
-    /*request*/,
+auto ActionCacheServiceImpl::UpdateActionResultImpl(
+    const ::bazel_re::UpdateActionResultRequest* /*request*/,
     ::bazel_re::ActionResult* /*response*/) -> ::grpc::Status {
     static auto constexpr kStr = "UpdateActionResult not implemented";
     logger_.Emit(LogLevel::Error, kStr);
     return ::grpc::Status{grpc::StatusCode::UNIMPLEMENTED, kStr};
 }
+
+auto ActionCacheServiceImpl::GetActionResult(
+    ::grpc::ServerContext* /*context*/,
+    const ::bazel_re::GetActionResultRequest* request,
+    ::bazel_re::ActionResult* response) -> ::grpc::Status {
+    return GetActionResultImpl(request, response);
+}
+
+auto ActionCacheServiceImpl::UpdateActionResult(
+    ::grpc::ServerContext* /*context*/,
+    const ::bazel_re::UpdateActionResultRequest* request,
+    ::bazel_re::ActionResult* response) -> ::grpc::Status {
+    return UpdateActionResultImpl(request, response);
+}
+
+auto ActionCacheServiceImpl::GetActionResult(
+    ::grpc::CallbackServerContext* context,
+    const ::bazel_re::GetActionResultRequest* request,
+    ::bazel_re::ActionResult* response) -> ::grpc::ServerUnaryReactor* {
+    return ServeUnaryOn(&executor_, context, [this, request, response]() {
+        return GetActionResultImpl(request, response);
+    });
+}
+
+auto ActionCacheServiceImpl::UpdateActionResult(
+    ::grpc::CallbackServerContext* context,
+    const ::bazel_re::UpdateActionResultRequest* request,
+    ::bazel_re::ActionResult* response) -> ::grpc::ServerUnaryReactor* {
+    return ServeUnaryOn(&executor_, context, [this, request, response]() {
+        return UpdateActionResultImpl(request, response);
+    });
+}
@@ -22,10 +22,16 @@
 #include "src/buildtool/common/bazel_types.hpp"
 #include "src/buildtool/execution_api/local/context.hpp"
 #include "src/buildtool/logging/logger.hpp"
+#include "src/buildtool/multithreading/task_system.hpp"
 #include "src/buildtool/storage/config.hpp"
 #include "src/buildtool/storage/storage.hpp"
 
-class ActionCacheServiceImpl final : public bazel_re::ActionCache::Service {
+/// \brief Action-cache service. All calls are served via the callback API on
+/// the executor of this service, see \ref ServeUnaryOn.
+class ActionCacheServiceImpl final
+    : public bazel_re::ActionCache::WithCallbackMethod_GetActionResult<
+          bazel_re::ActionCache::WithCallbackMethod_UpdateActionResult<
+              bazel_re::ActionCache::Service>> {
   public:
     explicit ActionCacheServiceImpl(
         gsl::not_null<LocalContext const*> const& local_context) noexcept
@@ -69,10 +75,35 @@ class ActionCacheServiceImpl final : public bazel_re::ActionCache::Service {
         const ::bazel_re::UpdateActionResultRequest* request,
         ::bazel_re::ActionResult* response) -> ::grpc::Status override;
 
+    // Callback versions of the calls, serving them on the executor of this
+    // service.
+    auto GetActionResult(::grpc::CallbackServerContext* context,
+                         const ::bazel_re::GetActionResultRequest* request,
+                         ::bazel_re::ActionResult* response)
+        -> ::grpc::ServerUnaryReactor* override;
+    auto UpdateActionResult(
+        ::grpc::CallbackServerContext* context,
+        const ::bazel_re::UpdateActionResultRequest* request,
+        ::bazel_re::ActionResult* response)
+        -> ::grpc::ServerUnaryReactor* override;
+
   private:
+    // Implementations of the calls, shared by their synchronous and callback
+    // versions.
+    [[nodiscard]] auto GetActionResultImpl(
+        const ::bazel_re::GetActionResultRequest* request,
+        ::bazel_re::ActionResult* response) -> ::grpc::Status;
+    [[nodiscard]] auto UpdateActionResultImpl(
+        const ::bazel_re::UpdateActionResultRequest* request,
+        ::bazel_re::ActionResult* response) -> ::grpc::Status;
+
     StorageConfig const& storage_config_;
     Storage const& storage_;
     Logger logger_{"execution-service"};
+
+    // Declared last, so that pending calls are served before anything else
+    // is destroyed.
+    TaskSystem executor_;
 };
 
 #endif  // AC_SERVER_HPP
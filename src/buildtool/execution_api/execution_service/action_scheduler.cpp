@@ -0,0 +1,295 @@
+// Copyright 2026 Huawei Cloud Computing Technology Co., Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "src/buildtool/execution_api/execution_service/action_scheduler.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <iterator>
+#include <optional>
+#include <utility>
+
+#include "src/buildtool/logging/log_level.hpp"
+#include "src/buildtool/logging/logger.hpp"
+
+ActionScheduler::Reservation::Reservation(Reservation&& other) noexcept
+    : scheduler_{std::exchange(other.scheduler_, nullptr)},
+      slots_{other.slots_},
+      admitted_{other.admitted_} {}
+
+ActionScheduler::Reservation::~Reservation() noexcept {
+    if (scheduler_ != nullptr) {
+        scheduler_->Release(slots_,
+                            std::chrono::steady_clock::now() - admitted_);
+    }
+}
+
+ActionScheduler::ActionScheduler(std::size_t slots,
+                                 std::chrono::milliseconds interval) noexcept
+    : total_{slots > 0
+                 ? slots
+                 : std::max(std::size_t{1},
+                            std::size_t{std::thread::hardware_concurrency()})},
+      interval_{interval},
+      free_{total_},
+      ticker_{[this]() { Tick(); }} {}
+
+ActionScheduler::~ActionScheduler() noexcept {
+    {
+        std::unique_lock lock{mutex_};
+        shutdown_ = true;
+    }
+    tick_.notify_all();
+    ticker_.join();
+}
+
+void ActionScheduler::Submit(std::string const& client,
+                             std::size_t slots,
+                             AdmitCallback on_admitted,
+                             WaitCallback on_wait) noexcept {
+    slots = std::clamp(slots, std::size_t{1}, total_);
+    std::unique_lock lock{mutex_};
+    if (rotation_.empty() and free_ >= slots) {
+        free_ -= slots;
+        lock.unlock();
+        on_admitted(Reservation{this, slots});
+        return;
+    }
+
+    auto ticket = TicketPtr{};
+    try {
+        ticket = std::make_shared<Ticket>();
+        ticket->slots = slots;
+        auto& queue = queues_[client];
+        if (queue.empty()) {
+            rotation_.push_back(client);
+        }
+        queue.push_back(ticket);
+    } catch (std::exception const& ex) {
+        // Without a queue entry, the action cannot wait fairly; rather than
+        // failing it, admit it beyond the limit. The slots not free are
+        // accounted as overdrawn, so that they are repaid on release.
+        Logger::Log(LogLevel::Warning,
+                    "Failed to queue action of {}, running it right away:\n{}",
+                    client,
+                    ex.what());
+        auto const taken = std::min(free_, slots);
+        free_ -= taken;
+        overdrawn_ += slots - taken;
+        lock.unlock();
+        on_admitted(Reservation{this, slots});
+        return;
+    }
+    ticket->on_admitted = std::move(on_admitted);
+    ticket->on_wait = std::move(on_wait);
+    ++queued_;
+    // the action might overtake a blocked large request right away
+    auto const admitted = Dispatch();
+    std::optional<QueueState> state{};
+    if (ticket->on_wait) {
+        auto const queue = queues_.find(client);
+        if (queue != queues_.end() and queue->second.back() == ticket) {
+            auto const pos = std::find(rotation_.begin(),
+                                       rotation_.end(),
+                                       client) -
+                             rotation_.begin();
+            state = StateOf(static_cast<std::size_t>(pos),
+                            queue->second.size() - 1);
+        }
+    }
+    lock.unlock();
+    NotifyAdmitted(admitted);
+    if (state) {
+        NotifyWaiting(ticket.get(), *state);
+    }
+}
+
+auto ActionScheduler::Acquire(std::string const& client,
+                              std::size_t slots,
+                              WaitCallback on_wait) noexcept -> Reservation {
+    std::mutex mutex{};
+    std::condition_variable admitted{};
+    std::optional<Reservation> reservation{};
+    Submit(
+        client,
+        slots,
+        [&mutex, &admitted, &reservation](Reservation granted) {
+            // notify with the mutex held, as the waiter owns it
+            std::unique_lock lock{mutex};
+            reservation.emplace(std::move(granted));
+            admitted.notify_one();
+        },
+        std::move(on_wait));
+    std::unique_lock lock{mutex};
+    admitted.wait(lock, [&reservation]() { return reservation.has_value(); });
+    return *std::move(reservation);
+}
+
+auto ActionScheduler::FreeSlots() const noexcept -> std::size_t {
+    std::unique_lock lock{mutex_};
+    return free_;
+}
+
+auto ActionScheduler::QueueDepth() const noexcept -> std::size_t {
+    std::unique_lock lock{mutex_};
+    return queued_;
+}
+
+void ActionScheduler::Release(
+    std::size_t slots,
+    std::chrono::steady_clock::duration held) noexcept {
+    std::vector<TicketPtr> admitted{};
+    {
+        std::unique_lock lock{mutex_};
+        auto const repaid = std::min(overdrawn_, slots);
+        overdrawn_ -= repaid;
+        free_ = std::min(total_, free_ + slots - repaid);
+        auto const held_ms =
+            std::chrono::duration_cast<std::chrono::milliseconds>(held);
+        hold_time_ = hold_time_ ? (*hold_time_ * 7 + held_ms) / 8 : held_ms;
+        admitted = Dispatch();
+    }
+    NotifyAdmitted(admitted);
+}
+
+auto ActionScheduler::Dispatch() noexcept -> std::vector<TicketPtr> {
+    std::vector<TicketPtr> admitted{};
+    try {
+        while (not rotation_.empty()) {
+            auto const& head = queues_.find(rotation_.front())->second.front();
+            if (head->slots <= free_) {
+                admitted.emplace_back(Admit(0));
+                continue;
+            }
+            // The request of the client in front does not fit. Requests of
+            // other clients that fit may overtake it, but only a bounded
+            // number of times, so that it cannot starve.
+            if (head->overtaken >= total_) {
+                break;
+            }
+            std::size_t pos = 1;
+            while (pos < rotation_.size() and
+                   queues_.find(rotation_[pos])->second.front()->slots >
+                       free_) {
+                ++pos;
+            }
+            if (pos == rotation_.size()) {
+                break;
+            }
+            ++head->overtaken;
+            admitted.emplace_back(Admit(pos));
+        }
+    } catch (std::exception const& ex) {
+        // the tickets admitted so far are returned; the remaining ones are
+        // admitted on the next release
+        Logger::Log(LogLevel::Warning,
+                    "Failed to dispatch waiting actions:\n{}",
+                    ex.what());
+    }
+    return admitted;
+}
+
+auto ActionScheduler::Admit(std::size_t pos) noexcept -> TicketPtr {
+    auto const it = queues_.find(rotation_[pos]);
+    auto ticket = std::move(it->second.front());
+    free_ -= ticket->slots;
+    --queued_;
+    it->second.pop_front();
+    auto client = std::move(rotation_[pos]);
+    rotation_.erase(rotation_.begin() + static_cast<std::ptrdiff_t>(pos));
+    if (it->second.empty()) {
+        queues_.erase(it);
+    }
+    else {
+        // The client has more actions waiting, so it gets back in line.
+        rotation_.push_back(std::move(client));
+    }
+    return ticket;
+}
+
+void ActionScheduler::NotifyAdmitted(
+    std::vector<TicketPtr> const& admitted) noexcept {
+    for (auto const& ticket : admitted) {
+        std::unique_lock lock{ticket->callback_mutex};
+        ticket->admitted = true;
+        ticket->on_wait = nullptr;
+        auto const on_admitted = std::move(ticket->on_admitted);
+        on_admitted(Reservation{this, ticket->slots});
+    }
+}
+
+auto ActionScheduler::StateOf(std::size_t pos, std::size_t index) const
+    -> QueueState {
+    // Clients are served in turn: every client before the given one in the
+    // rotation gets one more action admitted first than every client after.
+    std::size_t before = index;
+    for (std::size_t i = 0; i < rotation_.size(); ++i) {
+        if (i != pos) {
+            auto const waiting = queues_.find(rotation_[i])->second.size();
+            before += std::min(waiting, i < pos ? index + 1 : index);
+        }
+    }
+    std::optional<std::chrono::milliseconds> eta{};
+    if (hold_time_) {
+        // all slots are taken, and one is released per hold time and slot
+        eta = *hold_time_ * static_cast<std::int64_t>(before + 1) /
+              static_cast<std::int64_t>(total_);
+    }
+    return QueueState{
+        .position = before + 1, .queue_depth = queued_, .eta = eta};
+}
+
+auto ActionScheduler::QueueStates() const
+    -> std::vector<std::pair<TicketPtr, QueueState>> {
+    std::vector<std::pair<TicketPtr, QueueState>> states{};
+    states.reserve(queued_);
+    for (std::size_t pos = 0; pos < rotation_.size(); ++pos) {
+        auto const& queue = queues_.find(rotation_[pos])->second;
+        for (std::size_t index = 0; index < queue.size(); ++index) {
+            states.emplace_back(queue[index], StateOf(pos, index));
+        }
+    }
+    return states;
+}
+
+void ActionScheduler::NotifyWaiting(Ticket* ticket,
+                                    QueueState const& state) noexcept {
+    std::unique_lock lock{ticket->callback_mutex};
+    if (not ticket->admitted and ticket->on_wait) {
+        ticket->on_wait(state);
+    }
+}
+
+void ActionScheduler::Tick() noexcept {
+    std::unique_lock lock{mutex_};
+    while (not tick_.wait_for(
+        lock, interval_, [this]() { return shutdown_; })) {
+        std::vector<std::pair<TicketPtr, QueueState>> states{};
+        try {
+            states = QueueStates();
+        } catch (std::exception const& ex) {
+            Logger::Log(LogLevel::Debug,
+                        "Failed to determine queue positions:\n{}",
+                        ex.what());
+            continue;
+        }
+        lock.unlock();
+        for (auto const& [ticket, state] : states) {
+            NotifyWaiting(ticket.get(), state);
+        }
+        lock.lock();
+    }
+}
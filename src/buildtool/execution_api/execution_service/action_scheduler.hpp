@@ -0,0 +1,206 @@
+// Copyright 2026 Huawei Cloud Computing Technology Co., Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef INCLUDED_SRC_BUILDTOOL_EXECUTION_API_EXECUTION_SERVICE_ACTION_SCHEDULER_HPP
+#define INCLUDED_SRC_BUILDTOOL_EXECUTION_API_EXECUTION_SERVICE_ACTION_SCHEDULER_HPP
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+/// \brief Admission control for the actions run by the execution service.
+/// Actions reserve slots of a fixed pool before they are run. If not enough
+/// slots are free, they wait in the queue of their client. Clients are served
+/// round robin, so that a client submitting many actions at once does not
+/// delay the actions of other clients; within the queue of a client, actions
+/// are admitted in order. If the action of the client in turn requests more
+/// slots than are free, actions of other clients fitting into the free slots
+/// may overtake it, up to as many times as the pool has slots; afterwards it
+/// is admitted next, so that large requests cannot starve. Waiting actions do
+/// not hold a thread: they are admitted by a callback, called by the thread
+/// releasing the slots they are admitted to.
+class ActionScheduler final {
+  public:
+    /// \brief Slots reserved for a running action, released on destruction.
+    class Reservation final {
+        friend class ActionScheduler;
+
+      public:
+        Reservation(Reservation const&) = delete;
+        Reservation(Reservation&& other) noexcept;
+        auto operator=(Reservation const&) -> Reservation& = delete;
+        auto operator=(Reservation&&) -> Reservation& = delete;
+        ~Reservation() noexcept;
+
+        [[nodiscard]] auto Slots() const noexcept -> std::size_t {
+            return slots_;
+        }
+
+      private:
+        ActionScheduler* scheduler_;
+        std::size_t slots_;
+        std::chrono::steady_clock::time_point admitted_;
+
+        explicit Reservation(ActionScheduler* scheduler,
+                             std::size_t slots) noexcept
+            : scheduler_{scheduler},
+              slots_{slots},
+              admitted_{std::chrono::steady_clock::now()} {}
+    };
+
+    /// \brief Position of a waiting action in the queue.
+    struct QueueState final {
+        /// \brief Estimated number of waiting actions admitted before this
+        /// one, plus one, assuming all of them fit into the free slots.
+        std::size_t position{};
+        /// \brief Number of actions waiting in total.
+        std::size_t queue_depth{};
+        /// \brief Estimated time until the action is admitted, based on how
+        /// long recent actions held their slots; unset while unknown.
+        std::optional<std::chrono::milliseconds> eta;
+    };
+
+    /// \brief Callback for actions that have to wait; it is called when the
+    /// action is queued and then periodically until the action is admitted.
+    using WaitCallback = std::function<void(QueueState const&)>;
+
+    /// \brief Callback for admitted actions, taking over their reservation.
+    using AdmitCallback = std::function<void(Reservation)>;
+
+    /// \brief Create a scheduler for the given number of slots. If 0 slots
+    /// are given, the number of cores is used.
+    /// \param interval    Interval in which waiting callbacks are called.
+    explicit ActionScheduler(
+        std::size_t slots,
+        std::chrono::milliseconds interval = kWaitInterval) noexcept;
+
+    ActionScheduler(ActionScheduler const&) = delete;
+    ActionScheduler(ActionScheduler&&) = delete;
+    auto operator=(ActionScheduler const&) -> ActionScheduler& = delete;
+    auto operator=(ActionScheduler&&) -> ActionScheduler& = delete;
+    ~ActionScheduler() noexcept;
+
+    /// \brief Reserve slots for an action without waiting for its admission.
+    /// The callbacks of an action are never called concurrently, and the
+    /// waiting callback is not called anymore once the action is admitted.
+    /// Actions still waiting when the scheduler is destroyed are dropped. The
+    /// callbacks must not throw.
+    /// \param client       Identifier of the client the action belongs to.
+    /// \param slots        Number of slots requested. Requests are limited to
+    /// the size of the pool and take at least one slot.
+    /// \param on_admitted  Callback taking over the reservation, called once
+    /// the action is admitted, either before this function returns or by the
+    /// thread releasing the slots.
+    /// \param on_wait      Callback informed while the action is waiting.
+    void Submit(std::string const& client,
+                std::size_t slots,
+                AdmitCallback on_admitted,
+                WaitCallback on_wait = {}) noexcept;
+
+    /// \brief Reserve slots for an action, waiting until it is admitted.
+    /// \see Submit
+    [[nodiscard]] auto Acquire(std::string const& client,
+                               std::size_t slots,
+                               WaitCallback on_wait = {}) noexcept
+        -> Reservation;
+
+    /// \brief Total number of slots of the pool.
+    [[nodiscard]] auto TotalSlots() const noexcept -> std::size_t {
+        return total_;
+    }
+
+    /// \brief Number of slots currently not reserved.
+    [[nodiscard]] auto FreeSlots() const noexcept -> std::size_t;
+
+    /// \brief Number of actions currently waiting to be admitted.
+    [[nodiscard]] auto QueueDepth() const noexcept -> std::size_t;
+
+  private:
+    static constexpr std::chrono::milliseconds kWaitInterval{10000};
+
+    struct Ticket final {
+        std::size_t slots;
+        AdmitCallback on_admitted;
+        WaitCallback on_wait;
+        std::size_t overtaken{};  // actions of other clients admitted first
+        // serializes the callbacks of the ticket
+        std::mutex callback_mutex;
+        bool admitted{false};  // guarded by the callback mutex
+    };
+    using TicketPtr = std::shared_ptr<Ticket>;
+
+    std::size_t const total_;
+    std::chrono::milliseconds const interval_;
+    mutable std::mutex mutex_;
+    std::size_t free_;
+    // slots of actions admitted beyond the limit, repaid before freeing slots
+    std::size_t overdrawn_{};
+    std::size_t queued_{};
+    // queues of the clients with waiting actions
+    std::unordered_map<std::string, std::deque<TicketPtr>> queues_;
+    // clients with waiting actions, in the order in which they are served
+    std::deque<std::string> rotation_;
+    // moving average of how long actions hold their slots
+    std::optional<std::chrono::milliseconds> hold_time_;
+    bool shutdown_{false};
+    std::condition_variable tick_;
+    // Calls the waiting callbacks periodically; declared last, so that it is
+    // started after all other members are initialized.
+    std::thread ticker_;
+
+    void Release(std::size_t slots,
+                 std::chrono::steady_clock::duration held) noexcept;
+
+    /// \brief Admit waiting actions as long as enough slots are free. Must be
+    /// called with the mutex held.
+    /// \returns The admitted tickets, to be notified without the mutex held.
+    [[nodiscard]] auto Dispatch() noexcept -> std::vector<TicketPtr>;
+
+    /// \brief Admit the next action of the client at the given position of
+    /// the rotation. Must be called with the mutex held.
+    [[nodiscard]] auto Admit(std::size_t pos) noexcept -> TicketPtr;
+
+    /// \brief Notify admitted tickets. Must be called without the mutex held.
+    void NotifyAdmitted(std::vector<TicketPtr> const& admitted) noexcept;
+
+    /// \brief Obtain the queue state of the ticket at the given index of the
+    /// queue of the client at the given position of the rotation. Must be
+    /// called with the mutex held.
+    [[nodiscard]] auto StateOf(std::size_t pos, std::size_t index) const
+        -> QueueState;
+
+    /// \brief Obtain the queue states of all waiting tickets. Must be called
+    /// with the mutex held.
+    [[nodiscard]] auto QueueStates() const
+        -> std::vector<std::pair<TicketPtr, QueueState>>;
+
+    /// \brief Call the waiting callback of a ticket, unless it is admitted.
+    static void NotifyWaiting(Ticket* ticket,
+                              QueueState const& state) noexcept;
+
+    void Tick() noexcept;
+};
+
+#endif  // INCLUDED_SRC_BUILDTOOL_EXECUTION_API_EXECUTION_SERVICE_ACTION_SCHEDULER_HPP
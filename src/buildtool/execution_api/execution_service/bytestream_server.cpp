@@ -14,6 +14,8 @@
 
 #include "src/buildtool/execution_api/execution_service/bytestream_server.hpp"
 
+#include <algorithm>
+#include <cstddef>
 #include <filesystem>
 #include <fstream>
 #include <memory>
@@ -26,7 +28,9 @@
 #include "nlohmann/json.hpp"
 #include "src/buildtool/common/artifact_digest.hpp"
 #include "src/buildtool/crypto/hash_function.hpp"
+#include "src/buildtool/execution_api/common/blob_compression.hpp"
 #include "src/buildtool/execution_api/common/bytestream_utils.hpp"
+#include "src/buildtool/execution_api/execution_service/callback_reactors.hpp"
 #include "src/buildtool/execution_api/execution_service/cas_utils.hpp"
 #include "src/buildtool/logging/log_level.hpp"
 #include "src/buildtool/storage/garbage_collector.hpp"
@@ -34,10 +38,9 @@
 #include "src/utils/cpp/incremental_reader.hpp"
 #include "src/utils/cpp/tmp_dir.hpp"
 
-auto BytestreamServiceImpl::Read(
-    ::grpc::ServerContext* /*context*/,
+auto BytestreamServiceImpl::ReadImpl(
     const ::google::bytestream::ReadRequest* request,
-    ::grpc::ServerWriter<::google::bytestream::ReadResponse>* writer)
+    ::grpc::ServerWriterInterface<::google::bytestream::ReadResponse>* writer)
     -> ::grpc::Status {
     logger_.Emit(
         LogLevel::Debug, "Read(resource_name={})", request->resource_name());
@@ -90,6 +93,11 @@ auto BytestreamServiceImpl::Read(
         return grpc::Status{grpc::StatusCode::INTERNAL, str};
     }
 
+    if (read_request->IsCompressed()) {
+        return ReadCompressed(
+            *read_digest, *to_read, request->read_offset(), writer);
+    }
+
     ::google::bytestream::ReadResponse response;
     for (auto it = to_read->make_iterator(request->read_offset());
          it != to_read->end();
@@ -103,14 +111,68 @@ auto BytestreamServiceImpl::Read(
             return grpc::Status{grpc::StatusCode::INTERNAL, str};
         }
         *response.mutable_data() = *chunk;
+        if (not writer->Write(response)) {
+            // no need to read any further, the client is gone
+            return ::grpc::Status{::grpc::StatusCode::CANCELLED,
+                                  "Stream closed by client"};
+        }
+    }
+    return ::grpc::Status::OK;
+}
+
+auto BytestreamServiceImpl::ReadCompressed(
+    ArtifactDigest const& digest,
+    IncrementalReader const& to_read,
+    std::int64_t read_offset,
+    ::grpc::ServerWriterInterface<::google::bytestream::ReadResponse>* writer)
+    -> ::grpc::Status {
+    // The read offset refers to the compressed stream, so compression always
+    // has to start from the beginning of the blob.
+    auto to_skip =
+        static_cast<std::size_t>(std::max<std::int64_t>(0, read_offset));
+    BlobCompression::Compressor compressor{};
+    ::google::bytestream::ReadResponse response;
+    auto const send = [&](std::string_view chunk, bool finish) -> bool {
+        auto data = compressor.Update(chunk, finish);
+        if (not data.has_value()) {
+            logger_.Emit(LogLevel::Error,
+                         "Failed to compress data for {}:\n{}",
+                         digest.hash(),
+                         data.error());
+            return false;
+        }
+        if (to_skip >= data->size()) {
+            to_skip -= data->size();
+            return true;
+        }
+        *response.mutable_data() = data->substr(to_skip);
+        to_skip = 0;
         writer->Write(response);
+        return true;
+    };
+    for (auto it = to_read.begin(); it != to_read.end(); ++it) {
+        auto const chunk = *it;
+        if (not chunk.has_value()) {
+            auto const str = fmt::format("Failed to read data for {}:\n{}",
+                                         digest.hash(),
+                                         chunk.error());
+            logger_.Emit(LogLevel::Error, str);
+            return grpc::Status{grpc::StatusCode::INTERNAL, str};
+        }
+        if (not send(*chunk, /*finish=*/false)) {
+            return grpc::Status{grpc::StatusCode::INTERNAL,
+                                "Failed to compress data"};
+        }
+    }
+    if (not send({}, /*finish=*/true)) {
+        return grpc::Status{grpc::StatusCode::INTERNAL,
+                            "Failed to compress data"};
     }
     return ::grpc::Status::OK;
 }
 
-auto BytestreamServiceImpl::Write(
-    ::grpc::ServerContext* /*context*/,
-    ::grpc::ServerReader<::google::bytestream::WriteRequest>* reader,
+auto BytestreamServiceImpl::WriteImpl(
+    ::grpc::ServerReaderInterface<::google::bytestream::WriteRequest>* reader,
     ::google::bytestream::WriteResponse* response) -> ::grpc::Status {
     ::google::bytestream::WriteRequest request;
     reader->Read(&request);
@@ -156,6 +218,12 @@ auto BytestreamServiceImpl::Write(
     }
 
     auto tmp = tmp_dir->GetPath() / write_digest->hash();
+    // For compressed uploads, the committed size refers to the compressed data.
+    std::optional<BlobCompression::Decompressor> decompressor;
+    if (write_request->IsCompressed()) {
+        decompressor.emplace(write_digest->size());
+    }
+    std::size_t received = 0;
     {
         std::ofstream stream{tmp, std::ios::binary};
         do {  // NOLINT(cppcoreguidelines-avoid-do-while)
@@ -165,10 +233,33 @@ auto BytestreamServiceImpl::Write(
                 logger_.Emit(LogLevel::Error, "{}", str);
                 return ::grpc::Status{::grpc::StatusCode::INTERNAL, str};
             }
-            stream.write(request.data().data(),
-                         static_cast<std::streamsize>(request.data().size()));
+            received += request.data().size();
+            if (not decompressor.has_value()) {
+                stream.write(
+                    request.data().data(),
+                    static_cast<std::streamsize>(request.data().size()));
+                continue;
+            }
+            auto const data = decompressor->Update(request.data());
+            if (not data.has_value()) {
+                auto const str = fmt::format("Failed to decompress data for "
+                                             "{}:\n{}",
+                                             write_digest->hash(),
+                                             data.error());
+                logger_.Emit(LogLevel::Error, "{}", str);
+                return ::grpc::Status{::grpc::StatusCode::INVALID_ARGUMENT,
+                                      str};
+            }
+            stream.write(data->data(),
+                         static_cast<std::streamsize>(data->size()));
         } while (not request.finish_write() and reader->Read(&request));
     }
+    if (decompressor.has_value() and not decompressor->Finished()) {
+        auto const str = fmt::format("Incomplete compressed data for {}",
+                                     write_digest->hash());
+        logger_.Emit(LogLevel::Error, "{}", str);
+        return ::grpc::Status{::grpc::StatusCode::INVALID_ARGUMENT, str};
+    }
 
     auto const status = CASUtils::AddFileToCAS(*write_digest, tmp, storage_);
     if (not status.ok()) {
@@ -177,12 +268,14 @@ auto BytestreamServiceImpl::Write(
         return ::grpc::Status{status.error_code(), str};
     }
     response->set_committed_size(
-        static_cast<google::protobuf::int64>(std::filesystem::file_size(tmp)));
+        decompressor.has_value()
+            ? static_cast<google::protobuf::int64>(received)
+            : static_cast<google::protobuf::int64>(
+                  std::filesystem::file_size(tmp)));
     return ::grpc::Status::OK;
 }
 
-auto BytestreamServiceImpl::QueryWriteStatus(
-    ::grpc::ServerContext* /*context*/,
+auto BytestreamServiceImpl::QueryWriteStatusImpl(
     const ::google::bytestream::QueryWriteStatusRequest* /*request*/,
     ::google::bytestream::QueryWriteStatusResponse* /*response*/)
     -> ::grpc::Status {
@@ -190,3 +283,56 @@ auto BytestreamServiceImpl::QueryWriteStatus(
     logger_.Emit(LogLevel::Error, "{}", kStr);
     return ::grpc::Status{grpc::StatusCode::UNIMPLEMENTED, kStr};
 }
+
+auto BytestreamServiceImpl::Read(
+    ::grpc::ServerContext* /*context*/,
+    const ::google::bytestream::ReadRequest* request,
+    ::grpc::ServerWriter<::google::bytestream::ReadResponse>* writer)
+    -> ::grpc::Status {
+    return ReadImpl(request, writer);
+}
+
+auto BytestreamServiceImpl::Write(
+    ::grpc::ServerContext* /*context*/,
+    ::grpc::ServerReader<::google::bytestream::WriteRequest>* reader,
+    ::google::bytestream::WriteResponse* response) -> ::grpc::Status {
+    return WriteImpl(reader, response);
+}
+
+auto BytestreamServiceImpl::QueryWriteStatus(
+    ::grpc::ServerContext* /*context*/,
+    const ::google::bytestream::QueryWriteStatusRequest* request,
+    ::google::bytestream::QueryWriteStatusResponse* response)
+    -> ::grpc::Status {
+    return QueryWriteStatusImpl(request, response);
+}
+
+auto BytestreamServiceImpl::Read(
+    ::grpc::CallbackServerContext* context,
+    const ::google::bytestream::ReadRequest* request)
+    -> ::grpc::ServerWriteReactor<::google::bytestream::ReadResponse>* {
+    return ServeServerStreamOn<::google::bytestream::ReadResponse>(
+        &executor_, context, [this, request](auto* writer) {
+            return ReadImpl(request, writer);
+        });
+}
+
+auto BytestreamServiceImpl::Write(
+    ::grpc::CallbackServerContext* context,
+    ::google::bytestream::WriteResponse* response)
+    -> ::grpc::ServerReadReactor<::google::bytestream::WriteRequest>* {
+    return ServeClientStreamOn<::google::bytestream::WriteRequest>(
+        &executor_, context, [this, response](auto* reader) {
+            return WriteImpl(reader, response);
+        });
+}
+
+auto BytestreamServiceImpl::QueryWriteStatus(
+    ::grpc::CallbackServerContext* context,
+    const ::google::bytestream::QueryWriteStatusRequest* request,
+    ::google::bytestream::QueryWriteStatusResponse* response)
+    -> ::grpc::ServerUnaryReactor* {
+    return ServeUnaryOn(&executor_, context, [this, request, response]() {
+        return QueryWriteStatusImpl(request, response);
+    });
+}
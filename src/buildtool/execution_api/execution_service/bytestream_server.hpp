@@ -15,17 +15,34 @@
 #ifndef BYTESTREAM_SERVER_HPP
 #define BYTESTREAM_SERVER_HPP
 
+#include <cstdint>
+
 #include <grpcpp/grpcpp.h>
 
 #include "google/bytestream/bytestream.grpc.pb.h"
 #include "google/bytestream/bytestream.pb.h"
 #include "gsl/gsl"
+#include "src/buildtool/common/artifact_digest.hpp"
 #include "src/buildtool/execution_api/local/context.hpp"
 #include "src/buildtool/logging/logger.hpp"
+#include "src/buildtool/multithreading/task_system.hpp"
 #include "src/buildtool/storage/config.hpp"
 #include "src/buildtool/storage/storage.hpp"
+#include "src/utils/cpp/incremental_reader.hpp"
+
+namespace bytestream_server {
+using ByteStream = ::google::bytestream::ByteStream;
 
-class BytestreamServiceImpl : public ::google::bytestream::ByteStream::Service {
+// All calls are served via the callback API.
+using CallbackService = ByteStream::WithCallbackMethod_Read<
+    ByteStream::WithCallbackMethod_Write<
+        ByteStream::WithCallbackMethod_QueryWriteStatus<ByteStream::Service>>>;
+}  // namespace bytestream_server
+
+/// \brief ByteStream service. All calls are served via the callback API on
+/// the executor of this service, so that long transfers only compete with
+/// each other for threads.
+class BytestreamServiceImpl : public bytestream_server::CallbackService {
   public:
     explicit BytestreamServiceImpl(
         gsl::not_null<LocalContext const*> const& local_context) noexcept
@@ -85,10 +102,54 @@ class BytestreamServiceImpl : public ::google::bytestream::ByteStream::Service {
         ::google::bytestream::QueryWriteStatusResponse* response)
         -> ::grpc::Status override;
 
+    // Callback versions of the calls, serving them on the executor of this
+    // service.
+    auto Read(::grpc::CallbackServerContext* context,
+              const ::google::bytestream::ReadRequest* request)
+        -> ::grpc::ServerWriteReactor<::google::bytestream::ReadResponse>*
+        override;
+    auto Write(::grpc::CallbackServerContext* context,
+               ::google::bytestream::WriteResponse* response)
+        -> ::grpc::ServerReadReactor<::google::bytestream::WriteRequest>*
+        override;
+    auto QueryWriteStatus(
+        ::grpc::CallbackServerContext* context,
+        const ::google::bytestream::QueryWriteStatusRequest* request,
+        ::google::bytestream::QueryWriteStatusResponse* response)
+        -> ::grpc::ServerUnaryReactor* override;
+
   private:
     StorageConfig const& storage_config_;
     Storage const& storage_;
     Logger logger_{"execution-service:bytestream"};
+
+    /// \brief Stream a blob deflate-compressed, starting at the given offset
+    /// of the compressed stream.
+    [[nodiscard]] auto ReadCompressed(
+        ArtifactDigest const& digest,
+        IncrementalReader const& to_read,
+        std::int64_t read_offset,
+        ::grpc::ServerWriterInterface<::google::bytestream::ReadResponse>*
+            writer) -> ::grpc::Status;
+
+    // Implementations of the calls, shared by their synchronous and callback
+    // versions.
+    [[nodiscard]] auto ReadImpl(
+        const ::google::bytestream::ReadRequest* request,
+        ::grpc::ServerWriterInterface<::google::bytestream::ReadResponse>*
+            writer) -> ::grpc::Status;
+    [[nodiscard]] auto WriteImpl(
+        ::grpc::ServerReaderInterface<::google::bytestream::WriteRequest>*
+            reader,
+        ::google::bytestream::WriteResponse* response) -> ::grpc::Status;
+    [[nodiscard]] auto QueryWriteStatusImpl(
+        const ::google::bytestream::QueryWriteStatusRequest* request,
+        ::google::bytestream::QueryWriteStatusResponse* response)
+        -> ::grpc::Status;
+
+    // Declared last, so that pending calls are served before anything else
+    // is destroyed.
+    TaskSystem executor_;
 };
 
 #endif  // BYTESTREAM_SERVER_HPP
@@ -0,0 +1,372 @@
+// Copyright 2026 Huawei Cloud Computing Technology Co., Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef INCLUDED_SRC_BUILDTOOL_EXECUTION_API_EXECUTION_SERVICE_CALLBACK_REACTORS_HPP
+#define INCLUDED_SRC_BUILDTOOL_EXECUTION_API_EXECUTION_SERVICE_CALLBACK_REACTORS_HPP
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <utility>  // std::move, std::exchange
+
+#include <grpcpp/grpcpp.h>
+
+#include "gsl/gsl"
+#include "src/buildtool/multithreading/task_system.hpp"
+
+// Calls of the callback API are served by running their implementation on the
+// executor of their service. So no gRPC thread is held while a call is served,
+// and calls of one service do not wait for threads held by calls of another.
+// Calls cancelled before their implementation is run are finished right away.
+// Calls waiting for other work to finish are served without any thread, by
+// writing to a \ref ResponseStream from the notifications of that work.
+
+/// \brief Serve a unary call of the callback API on the given executor.
+/// \param executor The executor of the service the call belongs to.
+/// \param context  The context of the call. Request and response of the call
+/// stay valid until it is finished.
+/// \param handler  Implementation of the call, returning its status.
+[[nodiscard]] inline auto ServeUnaryOn(
+    gsl::not_null<TaskSystem*> const& executor,
+    gsl::not_null<::grpc::CallbackServerContext*> const& context,
+    std::function<::grpc::Status()> handler) -> ::grpc::ServerUnaryReactor* {
+    auto* reactor = context->DefaultReactor();
+    executor->QueueTask(
+        [context = context.get(), reactor, handler = std::move(handler)]() {
+            reactor->Finish(context->IsCancelled() ? ::grpc::Status::CANCELLED
+                                                   : handler());
+        });
+    return reactor;
+}
+
+/// \brief Reactor of a server-streaming call, running the implementation of
+/// the call on an executor. The implementation writes to the reactor as to a
+/// synchronous stream: a write returns once the message is sent, and fails if
+/// the stream is broken, e.g., as the call was cancelled.
+template <typename TResponse>
+class ServerStreamReactor final
+    : public ::grpc::ServerWriteReactor<TResponse>,
+      public ::grpc::ServerWriterInterface<TResponse> {
+  public:
+    using Handler = std::function<::grpc::Status(
+        ::grpc::ServerWriterInterface<TResponse>*)>;
+
+    ServerStreamReactor(
+        gsl::not_null<TaskSystem*> const& executor,
+        gsl::not_null<::grpc::CallbackServerContext*> const& context,
+        Handler handler) noexcept {
+        executor->QueueTask(
+            [this, context = context.get(), handler = std::move(handler)]() {
+                this->Finish(context->IsCancelled()
+                                 ? ::grpc::Status::CANCELLED
+                                 : handler(this));
+            });
+    }
+
+    // initial metadata is sent along with the first message or the status
+    void SendInitialMetadata() override {}
+
+    using ::grpc::internal::WriterInterface<TResponse>::Write;
+    auto Write(TResponse const& msg, ::grpc::WriteOptions options)
+        -> bool override {
+        this->StartWrite(&msg, options);
+        std::unique_lock lock{mutex_};
+        done_.wait(lock, [this]() { return result_.has_value(); });
+        return *std::exchange(result_, std::nullopt);
+    }
+
+    void OnWriteDone(bool ok) override {
+        {
+            std::unique_lock lock{mutex_};
+            result_ = ok;
+        }
+        done_.notify_one();
+    }
+
+    // NOLINTNEXTLINE(cppcoreguidelines-owning-memory)
+    void OnDone() override { delete this; }
+
+  private:
+    std::mutex mutex_;
+    std::condition_variable done_;
+    std::optional<bool> result_;
+};
+
+/// \brief Reactor of a client-streaming call, running the implementation of
+/// the call on an executor. The implementation reads from the reactor as from
+/// a synchronous stream: a read returns once a message is received, and fails
+/// at the end of the stream or if the stream is broken.
+template <typename TRequest>
+class ClientStreamReactor final
+    : public ::grpc::ServerReadReactor<TRequest>,
+      public ::grpc::ServerReaderInterface<TRequest> {
+  public:
+    using Handler =
+        std::function<::grpc::Status(::grpc::ServerReaderInterface<TRequest>*)>;
+
+    ClientStreamReactor(
+        gsl::not_null<TaskSystem*> const& executor,
+        gsl::not_null<::grpc::CallbackServerContext*> const& context,
+        Handler handler) noexcept {
+        executor->QueueTask(
+            [this, context = context.get(), handler = std::move(handler)]() {
+                this->Finish(context->IsCancelled()
+                                 ? ::grpc::Status::CANCELLED
+                                 : handler(this));
+            });
+    }
+
+    // initial metadata is sent along with the status
+    void SendInitialMetadata() override {}
+
+    auto NextMessageSize(std::uint32_t* sz) -> bool override {
+        *sz = std::numeric_limits<std::uint32_t>::max();
+        return true;
+    }
+
+    auto Read(TRequest* msg) -> bool override {
+        this->StartRead(msg);
+        std::unique_lock lock{mutex_};
+        done_.wait(lock, [this]() { return result_.has_value(); });
+        return *std::exchange(result_, std::nullopt);
+    }
+
+    void OnReadDone(bool ok) override {
+        {
+            std::unique_lock lock{mutex_};
+            result_ = ok;
+        }
+        done_.notify_one();
+    }
+
+    // NOLINTNEXTLINE(cppcoreguidelines-owning-memory)
+    void OnDone() override { delete this; }
+
+  private:
+    std::mutex mutex_;
+    std::condition_variable done_;
+    std::optional<bool> result_;
+};
+
+/// \brief Serve a server-streaming call of the callback API on the given
+/// executor. The request of the call stays valid until it is finished.
+template <typename TResponse>
+[[nodiscard]] auto ServeServerStreamOn(
+    gsl::not_null<TaskSystem*> const& executor,
+    gsl::not_null<::grpc::CallbackServerContext*> const& context,
+    typename ServerStreamReactor<TResponse>::Handler handler)
+    -> ::grpc::ServerWriteReactor<TResponse>* {
+    // the reactor deletes itself once the call is done
+    // NOLINTNEXTLINE(cppcoreguidelines-owning-memory)
+    return new ServerStreamReactor<TResponse>{
+        executor, context, std::move(handler)};
+}
+
+/// \brief Serve a client-streaming call of the callback API on the given
+/// executor. The response of the call stays valid until it is finished.
+template <typename TRequest>
+[[nodiscard]] auto ServeClientStreamOn(
+    gsl::not_null<TaskSystem*> const& executor,
+    gsl::not_null<::grpc::CallbackServerContext*> const& context,
+    typename ClientStreamReactor<TRequest>::Handler handler)
+    -> ::grpc::ServerReadReactor<TRequest>* {
+    // the reactor deletes itself once the call is done
+    // NOLINTNEXTLINE(cppcoreguidelines-owning-memory)
+    return new ClientStreamReactor<TRequest>{
+        executor, context, std::move(handler)};
+}
+
+/// \brief Stream of the responses of a server-streaming call, written to
+/// without waiting for the messages to be sent. This allows serving calls
+/// from notifications, e.g., by the thread finishing the work the call waits
+/// for, instead of by a thread waiting on behalf of the call.
+template <typename TResponse>
+class ResponseStream {
+  public:
+    using Ptr = std::shared_ptr<ResponseStream>;
+
+    ResponseStream() noexcept = default;
+    ResponseStream(ResponseStream const&) = delete;
+    ResponseStream(ResponseStream&&) = delete;
+    auto operator=(ResponseStream const&) -> ResponseStream& = delete;
+    auto operator=(ResponseStream&&) -> ResponseStream& = delete;
+    virtual ~ResponseStream() noexcept = default;
+
+    /// \brief Send a message after all messages written before. Messages
+    /// written after the stream is closed are dropped.
+    virtual void Write(TResponse const& msg) noexcept = 0;
+
+    /// \brief Finish the call with the given status, once all messages
+    /// written before are sent. Only the first call has an effect.
+    virtual void Close(::grpc::Status const& status) noexcept = 0;
+};
+
+/// \brief Reactor of a server-streaming call of the callback API, serving
+/// the call as a \ref ResponseStream. Written messages are queued and sent in
+/// order; no thread is held while the call is served. The reactor stays alive
+/// until the call is done and as long as it is referenced, so that writing to
+/// it after the call is done is safe.
+template <typename TResponse>
+class ServerStreamWriter final : public ::grpc::ServerWriteReactor<TResponse>,
+                                 public ResponseStream<TResponse> {
+  public:
+    [[nodiscard]] static auto Create() -> std::shared_ptr<ServerStreamWriter> {
+        // NOLINTNEXTLINE(cppcoreguidelines-owning-memory)
+        auto writer =
+            std::shared_ptr<ServerStreamWriter>{new ServerStreamWriter};
+        writer->self_ = writer;
+        return writer;
+    }
+
+    void Write(TResponse const& msg) noexcept override {
+        try {
+            std::unique_lock lock{mutex_};
+            if (status_) {
+                return;
+            }
+            pending_.push_back(msg);
+        } catch (...) {
+            return;
+        }
+        Continue();
+    }
+
+    void Close(::grpc::Status const& status) noexcept override {
+        {
+            std::unique_lock lock{mutex_};
+            if (status_) {
+                return;
+            }
+            status_ = status;
+        }
+        Continue();
+    }
+
+    void OnWriteDone(bool ok) override {
+        {
+            std::unique_lock lock{mutex_};
+            writing_ = false;
+            if (not ok) {
+                // the stream is broken, nothing more can be sent
+                pending_.clear();
+                if (not status_) {
+                    status_ = ::grpc::Status::CANCELLED;
+                }
+            }
+        }
+        Continue();
+    }
+
+    void OnCancel() override {
+        {
+            std::unique_lock lock{mutex_};
+            pending_.clear();
+            if (not status_) {
+                status_ = ::grpc::Status::CANCELLED;
+            }
+        }
+        Continue();
+    }
+
+    void OnDone() override {
+        // drop the reference held on behalf of gRPC, last thing to do
+        auto const self = std::move(self_);
+    }
+
+  private:
+    std::mutex mutex_;
+    std::deque<TResponse> pending_;
+    TResponse current_;  // message being sent
+    bool writing_{false};
+    bool finished_{false};
+    std::optional<::grpc::Status> status_;
+    std::shared_ptr<ServerStreamWriter> self_;
+
+    ServerStreamWriter() noexcept = default;
+
+    /// \brief Send the next pending message, or, if none is left and the
+    /// stream is closed, finish the call. Operations of the reactor are not
+    /// started while holding the mutex, as their reactions may run inline.
+    void Continue() noexcept {
+        std::unique_lock lock{mutex_};
+        if (writing_ or finished_) {
+            return;
+        }
+        if (not pending_.empty()) {
+            current_ = std::move(pending_.front());
+            pending_.pop_front();
+            writing_ = true;
+            lock.unlock();
+            this->StartWrite(&current_);
+        }
+        else if (status_) {
+            finished_ = true;
+            auto const status = *status_;
+            lock.unlock();
+            this->Finish(status);
+        }
+    }
+};
+
+/// \brief Response stream of a call of the synchronous API. Messages are
+/// written to the stream of the call right away; the implementation of the
+/// call has to wait for the stream to be closed before returning.
+template <typename TResponse>
+class BlockingResponseStream final : public ResponseStream<TResponse> {
+  public:
+    explicit BlockingResponseStream(
+        gsl::not_null<::grpc::ServerWriterInterface<TResponse>*> const&
+            writer) noexcept
+        : writer_{writer} {}
+
+    void Write(TResponse const& msg) noexcept override {
+        std::unique_lock lock{mutex_};
+        if (not status_) {
+            writer_->Write(msg);
+        }
+    }
+
+    void Close(::grpc::Status const& status) noexcept override {
+        {
+            std::unique_lock lock{mutex_};
+            if (status_) {
+                return;
+            }
+            status_ = status;
+        }
+        closed_.notify_all();
+    }
+
+    /// \brief Wait until the stream is closed. Afterwards, the writer of the
+    /// call is not used anymore.
+    /// \returns The status the stream was closed with.
+    [[nodiscard]] auto Wait() noexcept -> ::grpc::Status {
+        std::unique_lock lock{mutex_};
+        closed_.wait(lock, [this]() { return status_.has_value(); });
+        return *status_;
+    }
+
+  private:
+    gsl::not_null<::grpc::ServerWriterInterface<TResponse>*> writer_;
+    std::mutex mutex_;
+    std::condition_variable closed_;
+    std::optional<::grpc::Status> status_;
+};
+
+#endif  // INCLUDED_SRC_BUILDTOOL_EXECUTION_API_EXECUTION_SERVICE_CALLBACK_REACTORS_HPP
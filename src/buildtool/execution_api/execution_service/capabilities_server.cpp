@@ -32,6 +32,9 @@ auto CapabilitiesServiceImpl::GetCapabilities(
             : ::bazel_re::DigestFunction_Value::DigestFunction_Value_SHA256);
     cache.mutable_action_cache_update_capabilities()->set_update_enabled(false);
     cache.set_max_batch_total_size_bytes(MessageLimits::kMaxGrpcLength);
+    cache.add_supported_compressors(::bazel_re::Compressor_Value_DEFLATE);
+    cache.add_supported_batch_update_compressors(
+        ::bazel_re::Compressor_Value_DEFLATE);
 
     *(response->mutable_cache_capabilities()) = cache;
 
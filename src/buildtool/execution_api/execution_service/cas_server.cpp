@@ -15,12 +15,16 @@
 #include "src/buildtool/execution_api/execution_service/cas_server.hpp"
 
 #include <algorithm>
+#include <cstddef>
 #include <filesystem>
 #include <fstream>
 #include <iterator>
+#include <limits>
 #include <optional>
 #include <sstream>
 #include <string>
+#include <tuple>  // std::ignore
+#include <unordered_set>
 #include <utility>  // std::move
 #include <vector>
 
@@ -30,16 +34,38 @@
 #include "nlohmann/json.hpp"
 #include "src/buildtool/common/artifact_digest.hpp"
 #include "src/buildtool/common/artifact_digest_factory.hpp"
+#include "src/buildtool/common/protocol_traits.hpp"
 #include "src/buildtool/crypto/hash_function.hpp"
+#include "src/buildtool/execution_api/bazel_msg/bazel_msg_factory.hpp"
+#include "src/buildtool/execution_api/common/blob_compression.hpp"
+#include "src/buildtool/execution_api/common/ids.hpp"
+#include "src/buildtool/execution_api/common/message_limits.hpp"
+#include "src/buildtool/execution_api/common/tree_reader_utils.hpp"
 #include "src/buildtool/execution_api/execution_service/cas_utils.hpp"
+#include "src/buildtool/execution_api/execution_service/callback_reactors.hpp"
+#include "src/buildtool/execution_api/local/local_cas_reader.hpp"
+#include "src/buildtool/file_system/file_system_manager.hpp"
 #include "src/buildtool/logging/log_level.hpp"
 #include "src/buildtool/storage/garbage_collector.hpp"
 #include "src/utils/cpp/expected.hpp"
 
 constexpr int kLogBlobLimit = 5;
 
-auto CASServiceImpl::FindMissingBlobs(
-    ::grpc::ServerContext* /*context*/,
+// Maximum number of unfinished GetTree traversals kept for continuation; the
+// oldest ones are dropped first.
+constexpr std::size_t kMaxPendingTraversals = 256;
+
+// Maximum number of digests kept by all unfinished GetTree traversals together.
+constexpr std::size_t kMaxPendingDigests = std::size_t{1} << 18U;
+
+// Number of most recently visited directories remembered by an unfinished
+// GetTree traversal to avoid sending them again.
+constexpr std::size_t kTraversalDedupWindow = 4096;
+
+// Encoding overhead of an element of a repeated message field (tag and length).
+constexpr std::size_t kRepeatedFieldOverhead = 6;
+
+auto CASServiceImpl::FindMissingBlobsImpl(
     const ::bazel_re::FindMissingBlobsRequest* request,
     ::bazel_re::FindMissingBlobsResponse* response) -> ::grpc::Status {
     auto const lock = GarbageCollector::SharedLock(storage_config_);
@@ -96,8 +122,7 @@ auto CASServiceImpl::FindMissingBlobs(
     return ::grpc::Status::OK;
 }
 
-auto CASServiceImpl::BatchUpdateBlobs(
-    ::grpc::ServerContext* /*context*/,
+auto CASServiceImpl::BatchUpdateBlobsImpl(
     const ::bazel_re::BatchUpdateBlobsRequest* request,
     ::bazel_re::BatchUpdateBlobsResponse* response) -> ::grpc::Status {
     auto const lock = GarbageCollector::SharedLock(storage_config_);
@@ -144,7 +169,30 @@ auto CASServiceImpl::BatchUpdateBlobs(
         auto* r = response->add_responses();
         r->mutable_digest()->CopyFrom(x.digest());
 
-        auto const status = CASUtils::AddDataToCAS(*digest, x.data(), storage_);
+        std::optional<std::string> decompressed;
+        if (x.compressor() == ::bazel_re::Compressor_Value_DEFLATE) {
+            auto data = BlobCompression::Decompress(x.data(), digest->size());
+            if (not data) {
+                auto const str = fmt::format(
+                    "BatchUpdateBlobs: failed to decompress {}:\n{}",
+                    hash,
+                    data.error());
+                logger_.Emit(LogLevel::Error, "{}", str);
+                return ::grpc::Status{grpc::StatusCode::INVALID_ARGUMENT, str};
+            }
+            decompressed = *std::move(data);
+        }
+        else if (x.compressor() != ::bazel_re::Compressor_Value_IDENTITY) {
+            auto const str = fmt::format(
+                "BatchUpdateBlobs: unsupported compressor {} for {}",
+                static_cast<int>(x.compressor()),
+                hash);
+            logger_.Emit(LogLevel::Error, "{}", str);
+            return ::grpc::Status{grpc::StatusCode::INVALID_ARGUMENT, str};
+        }
+
+        auto const status = CASUtils::AddDataToCAS(
+            *digest, decompressed ? *decompressed : x.data(), storage_);
         if (not status.ok()) {
             auto const str =
                 fmt::format("BatchUpdateBlobs: {}", status.error_message());
@@ -155,8 +203,7 @@ auto CASServiceImpl::BatchUpdateBlobs(
     return ::grpc::Status::OK;
 }
 
-auto CASServiceImpl::BatchReadBlobs(
-    ::grpc::ServerContext* /*context*/,
+auto CASServiceImpl::BatchReadBlobsImpl(
     const ::bazel_re::BatchReadBlobsRequest* request,
     ::bazel_re::BatchReadBlobsResponse* response) -> ::grpc::Status {
     static constexpr int kLogBlobLimit = 5;
@@ -188,6 +235,12 @@ auto CASServiceImpl::BatchReadBlobs(
         logger_.Emit(LogLevel::Error, "{}", kStr);
         return grpc::Status{grpc::StatusCode::INTERNAL, kStr};
     }
+    bool const deflate_acceptable = std::any_of(
+        request->acceptable_compressors().begin(),
+        request->acceptable_compressors().end(),
+        [](auto compressor) {
+            return compressor == ::bazel_re::Compressor_Value_DEFLATE;
+        });
     for (auto const& x : request->digests()) {
         auto* r = response->add_responses();
         r->mutable_digest()->CopyFrom(x);
@@ -214,6 +267,14 @@ auto CASServiceImpl::BatchReadBlobs(
         std::ifstream cert{*path};
         std::string tmp((std::istreambuf_iterator<char>(cert)),
                         std::istreambuf_iterator<char>());
+        if (deflate_acceptable and
+            tmp.size() >= BlobCompression::kMinCompressSize) {
+            auto compressed = BlobCompression::Compress(tmp);
+            if (compressed and compressed->size() < tmp.size()) {
+                tmp = *std::move(compressed);
+                r->set_compressor(::bazel_re::Compressor_Value_DEFLATE);
+            }
+        }
         *(r->mutable_data()) = std::move(tmp);
 
         r->mutable_status()->CopyFrom(google::rpc::Status{});
@@ -221,20 +282,226 @@ auto CASServiceImpl::BatchReadBlobs(
     return ::grpc::Status::OK;
 }
 
-auto CASServiceImpl::GetTree(
-    ::grpc::ServerContext* /*context*/,
-    const ::bazel_re::GetTreeRequest* /*request*/,
-    ::grpc::ServerWriter<::bazel_re::GetTreeResponse>* /*writer*/)
+auto CASServiceImpl::GetTreeImpl(
+    const ::bazel_re::GetTreeRequest* request,
+    ::grpc::ServerWriterInterface<::bazel_re::GetTreeResponse>* writer)
     -> ::grpc::Status {
-    static constexpr auto kStr = "GetTree not implemented";
-    logger_.Emit(LogLevel::Error, "{}", kStr);
-    return ::grpc::Status{grpc::StatusCode::UNIMPLEMENTED, kStr};
+    logger_.Emit(LogLevel::Debug, [request]() {
+        return fmt::format(
+            "GetTree(instance_name={}, root_digest={}, page_size={}, "
+            "page_token={})",
+            nlohmann::json(request->instance_name()).dump(),
+            request->root_digest().hash(),
+            request->page_size(),
+            nlohmann::json(request->page_token()).dump());
+    });
+    auto const lock = GarbageCollector::SharedLock(storage_config_);
+    if (not lock) {
+        static constexpr auto kStr = "GetTree: could not acquire SharedLock";
+        logger_.Emit(LogLevel::Error, "{}", kStr);
+        return grpc::Status{grpc::StatusCode::INTERNAL, kStr};
+    }
+    auto const hash_type = storage_config_.hash_function.GetType();
+    auto const root =
+        ArtifactDigestFactory::FromBazel(hash_type, request->root_digest());
+    if (not root) {
+        auto const str = fmt::format("GetTree: unsupported digest {}",
+                                     request->root_digest().hash());
+        logger_.Emit(LogLevel::Error, "{}", str);
+        return ::grpc::Status{grpc::StatusCode::INVALID_ARGUMENT, str};
+    }
+
+    TreeTraversal traversal{};
+    if (request->page_token().empty()) {
+        // In compatible mode, directories are stored as blobs.
+        auto const root_path =
+            ProtocolTraits::IsNative(hash_type)
+                ? storage_.CAS().TreePath(*root)
+                : storage_.CAS().BlobPath(*root, /*is_executable=*/false);
+        if (not root_path) {
+            auto const str =
+                fmt::format("GetTree: tree root {} not found", root->hash());
+            logger_.Emit(LogLevel::Error, "{}", str);
+            return ::grpc::Status{grpc::StatusCode::NOT_FOUND, str};
+        }
+        traversal.root = *root;
+        traversal.pending.push_back(*root);
+        traversal.recent.push_back(*root);
+    }
+    else {
+        auto resumed = TakeTraversal(request->page_token(), *root);
+        if (not resumed) {
+            auto const str =
+                fmt::format("GetTree: unknown page token {} for root {}",
+                            nlohmann::json(request->page_token()).dump(),
+                            root->hash());
+            logger_.Emit(LogLevel::Error, "{}", str);
+            return ::grpc::Status{grpc::StatusCode::INVALID_ARGUMENT, str};
+        }
+        traversal = *std::move(resumed);
+    }
+
+    // A page size of 0 lets the server choose, so send the whole tree.
+    auto const page_size =
+        request->page_size() > 0
+            ? static_cast<std::size_t>(request->page_size())
+            : std::numeric_limits<std::size_t>::max();
+
+    // A page may exceed the maximum message size, so it is split over
+    // multiple responses; only the last one carries the next page token.
+    // Directories visited while serving this page are all skipped; of those
+    // of earlier pages, only the ones remembered by the traversal.
+    std::unordered_set<ArtifactDigest> visited{traversal.recent.begin(),
+                                               traversal.recent.end()};
+    ::bazel_re::GetTreeResponse response{};
+    std::size_t response_size = 0;
+    std::size_t count = 0;
+    while (not traversal.pending.empty() and count < page_size) {
+        auto const current = traversal.pending.front();
+        traversal.pending.pop_front();
+        auto dir = ReadDirectory(current);
+        if (not dir) {
+            // parts of the tree missing in CAS are omitted
+            continue;
+        }
+        for (auto const& node : dir->directories()) {
+            auto digest =
+                ArtifactDigestFactory::FromBazel(hash_type, node.digest());
+            if (digest and visited.insert(*digest).second) {
+                traversal.recent.push_back(*digest);
+                if (traversal.recent.size() > kTraversalDedupWindow) {
+                    traversal.recent.pop_front();
+                }
+                traversal.pending.push_back(*std::move(digest));
+            }
+        }
+        auto const size = dir->ByteSizeLong() + kRepeatedFieldOverhead;
+        if (response.directories_size() > 0 and
+            response_size + size > MessageLimits::kMaxGrpcLength) {
+            if (not writer->Write(response)) {
+                // no need to traverse any further, the client is gone
+                return ::grpc::Status{::grpc::StatusCode::CANCELLED,
+                                      "Stream closed by client"};
+            }
+            response.Clear();
+            response_size = 0;
+        }
+        *response.add_directories() = *std::move(dir);
+        response_size += size;
+        ++count;
+    }
+    if (not traversal.pending.empty()) {
+        if (traversal.Size() > kMaxPendingDigests) {
+            auto const str = fmt::format(
+                "GetTree: {} directories pending after page of tree {}, "
+                "request larger pages",
+                traversal.pending.size(),
+                root->hash());
+            logger_.Emit(LogLevel::Error, "{}", str);
+            return ::grpc::Status{grpc::StatusCode::RESOURCE_EXHAUSTED, str};
+        }
+        auto token = StoreTraversal(std::move(traversal));
+        if (not token) {
+            static constexpr auto kStr =
+                "GetTree: could not store state of traversal";
+            logger_.Emit(LogLevel::Error, "{}", kStr);
+            return ::grpc::Status{grpc::StatusCode::INTERNAL, kStr};
+        }
+        response.set_next_page_token(*token);
+        if (not writer->Write(response)) {
+            // the next page is never requested
+            std::ignore = TakeTraversal(*token, *root);
+            return ::grpc::Status{::grpc::StatusCode::CANCELLED,
+                                  "Stream closed by client"};
+        }
+        return ::grpc::Status::OK;
+    }
+    if (not writer->Write(response)) {
+        return ::grpc::Status{::grpc::StatusCode::CANCELLED,
+                              "Stream closed by client"};
+    }
+    return ::grpc::Status::OK;
 }
 
-auto CASServiceImpl::SplitBlob(::grpc::ServerContext* /*context*/,
-                               const ::bazel_re::SplitBlobRequest* request,
-                               ::bazel_re::SplitBlobResponse* response)
-    -> ::grpc::Status {
+auto CASServiceImpl::ReadDirectory(ArtifactDigest const& digest)
+    const noexcept -> std::optional<bazel_re::Directory> {
+    auto const& cas = storage_.CAS();
+    if (not ProtocolTraits::IsNative(digest.GetHashType())) {
+        auto const path = cas.BlobPath(digest, /*is_executable=*/false);
+        if (not path) {
+            return std::nullopt;
+        }
+        auto const content = FileSystemManager::ReadFile(*path);
+        if (not content) {
+            return std::nullopt;
+        }
+        return BazelMsgFactory::MessageFromString<bazel_re::Directory>(
+            *content);
+    }
+    if (not cas.TreePath(digest)) {
+        return std::nullopt;
+    }
+    auto const entries = LocalCasReader{&cas}.ReadGitTree(digest);
+    if (not entries) {
+        return std::nullopt;
+    }
+    return TreeReaderUtils::GitTreeToDirectory(
+        *entries,
+        [&cas](ArtifactDigest const& link) -> std::optional<std::string> {
+            auto const path = cas.BlobPath(link, /*is_executable=*/false);
+            return path ? FileSystemManager::ReadFile(*path) : std::nullopt;
+        });
+}
+
+auto CASServiceImpl::StoreTraversal(TreeTraversal&& traversal) noexcept
+    -> std::optional<std::string> {
+    try {
+        std::unique_lock lock{traversals_mutex_};
+        // The random part makes tokens of earlier server instances unknown, so
+        // they are rejected instead of continuing a different traversal.
+        auto token =
+            fmt::format("{:08x}-{}", kRandomConstant, ++traversals_count_);
+        while (not traversals_order_.empty() and
+               (traversals_order_.size() >= kMaxPendingTraversals or
+                traversals_size_ + traversal.Size() > kMaxPendingDigests)) {
+            auto it = traversals_.find(traversals_order_.front());
+            if (it != traversals_.end()) {
+                traversals_size_ -= it->second.Size();
+                traversals_.erase(it);
+            }
+            traversals_order_.pop_front();
+        }
+        traversals_size_ += traversal.Size();
+        traversals_.emplace(token, std::move(traversal));
+        traversals_order_.push_back(token);
+        return token;
+    } catch (...) {
+        return std::nullopt;
+    }
+}
+
+auto CASServiceImpl::TakeTraversal(std::string const& page_token,
+                                   ArtifactDigest const& root) noexcept
+    -> std::optional<TreeTraversal> {
+    try {
+        std::unique_lock lock{traversals_mutex_};
+        auto it = traversals_.find(page_token);
+        if (it == traversals_.end() or it->second.root != root) {
+            return std::nullopt;
+        }
+        auto traversal = std::move(it->second);
+        traversals_size_ -= traversal.Size();
+        traversals_.erase(it);
+        std::erase(traversals_order_, page_token);
+        return traversal;
+    } catch (...) {
+        return std::nullopt;
+    }
+}
+
+auto CASServiceImpl::SplitBlobImpl(
+    const ::bazel_re::SplitBlobRequest* request,
+    ::bazel_re::SplitBlobResponse* response) -> ::grpc::Status {
     logger_.Emit(LogLevel::Debug, [request]() {
         return fmt::format("SplitBlob(instance_name={}, blob_digest={})",
                            nlohmann::json(request->instance_name()).dump(),
@@ -296,10 +563,9 @@ auto CASServiceImpl::SplitBlob(::grpc::ServerContext* /*context*/,
     return ::grpc::Status::OK;
 }
 
-auto CASServiceImpl::SpliceBlob(::grpc::ServerContext* /*context*/,
-                                const ::bazel_re::SpliceBlobRequest* request,
-                                ::bazel_re::SpliceBlobResponse* response)
-    -> ::grpc::Status {
+auto CASServiceImpl::SpliceBlobImpl(
+    const ::bazel_re::SpliceBlobRequest* request,
+    ::bazel_re::SpliceBlobResponse* response) -> ::grpc::Status {
     logger_.Emit(LogLevel::Debug, [request]() {
         return fmt::format("SplitBlob(instance_name={}, blob_digest={})",
                            nlohmann::json(request->instance_name()).dump(),
@@ -362,3 +628,103 @@ auto CASServiceImpl::SpliceBlob(::grpc::ServerContext* /*context*/,
         ArtifactDigestFactory::ToBazel(*splice_result);
     return ::grpc::Status::OK;
 }
+
+auto CASServiceImpl::FindMissingBlobs(
+    ::grpc::ServerContext* /*context*/,
+    const ::bazel_re::FindMissingBlobsRequest* request,
+    ::bazel_re::FindMissingBlobsResponse* response) -> ::grpc::Status {
+    return FindMissingBlobsImpl(request, response);
+}
+
+auto CASServiceImpl::BatchUpdateBlobs(
+    ::grpc::ServerContext* /*context*/,
+    const ::bazel_re::BatchUpdateBlobsRequest* request,
+    ::bazel_re::BatchUpdateBlobsResponse* response) -> ::grpc::Status {
+    return BatchUpdateBlobsImpl(request, response);
+}
+
+auto CASServiceImpl::BatchReadBlobs(
+    ::grpc::ServerContext* /*context*/,
+    const ::bazel_re::BatchReadBlobsRequest* request,
+    ::bazel_re::BatchReadBlobsResponse* response) -> ::grpc::Status {
+    return BatchReadBlobsImpl(request, response);
+}
+
+auto CASServiceImpl::GetTree(
+    ::grpc::ServerContext* /*context*/,
+    const ::bazel_re::GetTreeRequest* request,
+    ::grpc::ServerWriter<::bazel_re::GetTreeResponse>* writer)
+    -> ::grpc::Status {
+    return GetTreeImpl(request, writer);
+}
+
+auto CASServiceImpl::SplitBlob(::grpc::ServerContext* /*context*/,
+                               const ::bazel_re::SplitBlobRequest* request,
+                               ::bazel_re::SplitBlobResponse* response)
+    -> ::grpc::Status {
+    return SplitBlobImpl(request, response);
+}
+
+auto CASServiceImpl::SpliceBlob(::grpc::ServerContext* /*context*/,
+                                const ::bazel_re::SpliceBlobRequest* request,
+                                ::bazel_re::SpliceBlobResponse* response)
+    -> ::grpc::Status {
+    return SpliceBlobImpl(request, response);
+}
+
+auto CASServiceImpl::FindMissingBlobs(
+    ::grpc::CallbackServerContext* context,
+    const ::bazel_re::FindMissingBlobsRequest* request,
+    ::bazel_re::FindMissingBlobsResponse* response)
+    -> ::grpc::ServerUnaryReactor* {
+    return ServeUnaryOn(&executor_, context, [this, request, response]() {
+        return FindMissingBlobsImpl(request, response);
+    });
+}
+
+auto CASServiceImpl::BatchUpdateBlobs(
+    ::grpc::CallbackServerContext* context,
+    const ::bazel_re::BatchUpdateBlobsRequest* request,
+    ::bazel_re::BatchUpdateBlobsResponse* response)
+    -> ::grpc::ServerUnaryReactor* {
+    return ServeUnaryOn(&executor_, context, [this, request, response]() {
+        return BatchUpdateBlobsImpl(request, response);
+    });
+}
+
+auto CASServiceImpl::BatchReadBlobs(
+    ::grpc::CallbackServerContext* context,
+    const ::bazel_re::BatchReadBlobsRequest* request,
+    ::bazel_re::BatchReadBlobsResponse* response)
+    -> ::grpc::ServerUnaryReactor* {
+    return ServeUnaryOn(&executor_, context, [this, request, response]() {
+        return BatchReadBlobsImpl(request, response);
+    });
+}
+
+auto CASServiceImpl::GetTree(::grpc::CallbackServerContext* context,
+                             const ::bazel_re::GetTreeRequest* request)
+    -> ::grpc::ServerWriteReactor<::bazel_re::GetTreeResponse>* {
+    return ServeServerStreamOn<::bazel_re::GetTreeResponse>(
+        &tree_executor_, context, [this, request](auto* writer) {
+            return GetTreeImpl(request, writer);
+        });
+}
+
+auto CASServiceImpl::SplitBlob(::grpc::CallbackServerContext* context,
+                               const ::bazel_re::SplitBlobRequest* request,
+                               ::bazel_re::SplitBlobResponse* response)
+    -> ::grpc::ServerUnaryReactor* {
+    return ServeUnaryOn(&executor_, context, [this, request, response]() {
+        return SplitBlobImpl(request, response);
+    });
+}
+
+auto CASServiceImpl::SpliceBlob(::grpc::CallbackServerContext* context,
+                                const ::bazel_re::SpliceBlobRequest* request,
+                                ::bazel_re::SpliceBlobResponse* response)
+    -> ::grpc::ServerUnaryReactor* {
+    return ServeUnaryOn(&executor_, context, [this, request, response]() {
+        return SpliceBlobImpl(request, response);
+    });
+}
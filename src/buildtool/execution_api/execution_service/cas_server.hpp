@@ -15,18 +15,42 @@
 #ifndef CAS_SERVER_HPP
 #define CAS_SERVER_HPP
 
+#include <cstddef>
+#include <deque>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+
 #include <grpcpp/grpcpp.h>
 
 #include "build/bazel/remote/execution/v2/remote_execution.grpc.pb.h"
 #include "gsl/gsl"
+#include "src/buildtool/common/artifact_digest.hpp"
 #include "src/buildtool/common/bazel_types.hpp"
 #include "src/buildtool/execution_api/local/context.hpp"
 #include "src/buildtool/logging/logger.hpp"
+#include "src/buildtool/multithreading/task_system.hpp"
 #include "src/buildtool/storage/config.hpp"
 #include "src/buildtool/storage/storage.hpp"
 
-class CASServiceImpl final
-    : public bazel_re::ContentAddressableStorage::Service {
+namespace cas_server {
+using CAS = bazel_re::ContentAddressableStorage;
+
+// All calls are served via the callback API.
+using CallbackService = CAS::WithCallbackMethod_FindMissingBlobs<
+    CAS::WithCallbackMethod_BatchUpdateBlobs<
+        CAS::WithCallbackMethod_BatchReadBlobs<
+            CAS::WithCallbackMethod_GetTree<CAS::WithCallbackMethod_SplitBlob<
+                CAS::WithCallbackMethod_SpliceBlob<CAS::Service>>>>>>;
+}  // namespace cas_server
+
+/// \brief CAS service. All calls are served via the callback API on the
+/// executor of this service, see \ref ServeUnaryOn and \ref
+/// ServeServerStreamOn. GetTree calls, which may traverse large trees, are
+/// served on an executor of their own, so that they do not delay the short
+/// calls like FindMissingBlobs.
+class CASServiceImpl final : public cas_server::CallbackService {
   public:
     explicit CASServiceImpl(
         gsl::not_null<LocalContext const*> const& local_context) noexcept
@@ -216,9 +240,100 @@ class CASServiceImpl final
                     ::bazel_re::SpliceBlobResponse* response)
         -> ::grpc::Status override;
 
+    // Callback versions of the calls, serving them on the executor of this
+    // service.
+    auto FindMissingBlobs(::grpc::CallbackServerContext* context,
+                          const ::bazel_re::FindMissingBlobsRequest* request,
+                          ::bazel_re::FindMissingBlobsResponse* response)
+        -> ::grpc::ServerUnaryReactor* override;
+    auto BatchUpdateBlobs(::grpc::CallbackServerContext* context,
+                          const ::bazel_re::BatchUpdateBlobsRequest* request,
+                          ::bazel_re::BatchUpdateBlobsResponse* response)
+        -> ::grpc::ServerUnaryReactor* override;
+    auto BatchReadBlobs(::grpc::CallbackServerContext* context,
+                        const ::bazel_re::BatchReadBlobsRequest* request,
+                        ::bazel_re::BatchReadBlobsResponse* response)
+        -> ::grpc::ServerUnaryReactor* override;
+    auto GetTree(::grpc::CallbackServerContext* context,
+                 const ::bazel_re::GetTreeRequest* request)
+        -> ::grpc::ServerWriteReactor<::bazel_re::GetTreeResponse>* override;
+    auto SplitBlob(::grpc::CallbackServerContext* context,
+                   const ::bazel_re::SplitBlobRequest* request,
+                   ::bazel_re::SplitBlobResponse* response)
+        -> ::grpc::ServerUnaryReactor* override;
+    auto SpliceBlob(::grpc::CallbackServerContext* context,
+                    const ::bazel_re::SpliceBlobRequest* request,
+                    ::bazel_re::SpliceBlobResponse* response)
+        -> ::grpc::ServerUnaryReactor* override;
+
   private:
+    /// \brief State of a paged GetTree traversal, kept to serve the request
+    /// for the next page without enumerating the tree again. Only the most
+    /// recently visited directories are remembered, so a directory occurring
+    /// in distant parts of the tree might be sent again on a later page.
+    struct TreeTraversal final {
+        ArtifactDigest root;
+        std::deque<ArtifactDigest> pending;
+        std::deque<ArtifactDigest> recent;
+
+        /// \brief Number of digests kept by this traversal.
+        [[nodiscard]] auto Size() const noexcept -> std::size_t {
+            return pending.size() + recent.size();
+        }
+    };
+
     StorageConfig const& storage_config_;
     Storage const& storage_;
     Logger logger_{"execution-service"};
+
+    std::mutex traversals_mutex_;
+    std::unordered_map<std::string, TreeTraversal> traversals_;
+    std::deque<std::string> traversals_order_;
+    std::size_t traversals_count_{};
+    std::size_t traversals_size_{};  // digests kept by all traversals
+
+    // Implementations of the calls, shared by their synchronous and callback
+    // versions.
+    [[nodiscard]] auto FindMissingBlobsImpl(
+        const ::bazel_re::FindMissingBlobsRequest* request,
+        ::bazel_re::FindMissingBlobsResponse* response) -> ::grpc::Status;
+    [[nodiscard]] auto BatchUpdateBlobsImpl(
+        const ::bazel_re::BatchUpdateBlobsRequest* request,
+        ::bazel_re::BatchUpdateBlobsResponse* response) -> ::grpc::Status;
+    [[nodiscard]] auto BatchReadBlobsImpl(
+        const ::bazel_re::BatchReadBlobsRequest* request,
+        ::bazel_re::BatchReadBlobsResponse* response) -> ::grpc::Status;
+    [[nodiscard]] auto GetTreeImpl(
+        const ::bazel_re::GetTreeRequest* request,
+        ::grpc::ServerWriterInterface<::bazel_re::GetTreeResponse>* writer)
+        -> ::grpc::Status;
+    [[nodiscard]] auto SplitBlobImpl(
+        const ::bazel_re::SplitBlobRequest* request,
+        ::bazel_re::SplitBlobResponse* response) -> ::grpc::Status;
+    [[nodiscard]] auto SpliceBlobImpl(
+        const ::bazel_re::SpliceBlobRequest* request,
+        ::bazel_re::SpliceBlobResponse* response) -> ::grpc::Status;
+
+    /// \brief Read a directory from CAS. In native mode, the Git tree is
+    /// represented as Directory message, see
+    /// \ref TreeReaderUtils::GitTreeToDirectory.
+    [[nodiscard]] auto ReadDirectory(ArtifactDigest const& digest)
+        const noexcept -> std::optional<bazel_re::Directory>;
+
+    /// \brief Store an unfinished traversal and return its page token. The
+    /// oldest traversals are dropped to keep the total number of digests kept
+    /// bounded.
+    [[nodiscard]] auto StoreTraversal(TreeTraversal&& traversal) noexcept
+        -> std::optional<std::string>;
+
+    /// \brief Take the unfinished traversal of the given tree from storage.
+    [[nodiscard]] auto TakeTraversal(std::string const& page_token,
+                                     ArtifactDigest const& root) noexcept
+        -> std::optional<TreeTraversal>;
+
+    // Declared last, so that pending calls are served before anything else
+    // is destroyed.
+    TaskSystem executor_;
+    TaskSystem tree_executor_;
 };
 #endif  // CAS_SERVER_HPP
@@ -15,14 +15,15 @@
 #include "src/buildtool/execution_api/execution_service/execution_server.hpp"
 
 #include <chrono>
+#include <cstddef>
 #include <cstdint>
 #include <filesystem>
 #include <fstream>
 #include <functional>
 #include <map>
 #include <memory>
+#include <optional>
 #include <string>
-#include <thread>
 #include <unordered_map>
 #include <utility>
 #include <vector>
@@ -30,6 +31,7 @@
 #include "fmt/core.h"
 #include "google/protobuf/any.pb.h"
 #include "google/protobuf/repeated_ptr_field.h"
+#include "google/protobuf/struct.pb.h"
 #include "google/protobuf/timestamp.pb.h"
 #include "google/rpc/status.pb.h"
 #include "nlohmann/json.hpp"
@@ -46,6 +48,7 @@
 #include "src/buildtool/file_system/object_type.hpp"
 #include "src/buildtool/logging/log_level.hpp"
 #include "src/buildtool/storage/garbage_collector.hpp"
+#include "src/utils/cpp/file_locking.hpp"
 #include "src/utils/cpp/hex_string.hpp"
 
 namespace {
@@ -60,11 +63,57 @@ void SetTimeStamp(
     t->set_nanos(static_cast<int32_t>(nanos % k_nanoseconds_per_second));
 }
 
-void UpdateTimeStamp(
-    gsl::not_null<::google::longrunning::Operation*> const& op) {
-    ::google::protobuf::Timestamp t;
-    SetTimeStamp(&t, std::chrono::high_resolution_clock::now());
-    op->mutable_metadata()->PackFrom(t);
+void SetStage(gsl::not_null<::google::longrunning::Operation*> const& op,
+              ::bazel_re::ExecutionStage::Value stage) {
+    ::bazel_re::ExecuteOperationMetadata metadata;
+    op->metadata().UnpackTo(&metadata);
+    metadata.set_stage(stage);
+    op->mutable_metadata()->PackFrom(metadata);
+}
+
+/// \brief Report the state of a queued action in the partial execution
+/// metadata of its operation, as auxiliary metadata consisting of a struct with
+/// the position of the action in the queue, the number of queued actions, and,
+/// if known, the estimated number of seconds until the action is run.
+void SetQueueState(gsl::not_null<::google::longrunning::Operation*> const& op,
+                   ActionScheduler::QueueState const& state) {
+    ::bazel_re::ExecuteOperationMetadata metadata;
+    op->metadata().UnpackTo(&metadata);
+    ::google::protobuf::Struct queue{};
+    auto& fields = *queue.mutable_fields();
+    fields["queue_position"].set_number_value(
+        static_cast<double>(state.position));
+    fields["queue_depth"].set_number_value(
+        static_cast<double>(state.queue_depth));
+    if (state.eta) {
+        fields["estimated_wait_seconds"].set_number_value(
+            std::chrono::duration<double>(*state.eta).count());
+    }
+    auto* partial = metadata.mutable_partial_execution_metadata();
+    partial->clear_auxiliary_metadata();
+    partial->add_auxiliary_metadata()->PackFrom(queue);
+    op->mutable_metadata()->PackFrom(metadata);
+}
+
+/// \brief Number of slots an action reserves for running, as requested by its
+/// "cpu" platform property. Properties of the action take precedence over
+/// those of the command, which are deprecated as of RBEv2.2.
+[[nodiscard]] auto RequestedSlots(::bazel_re::Action const& action,
+                                  ::bazel_re::Command const& command) noexcept
+    -> std::size_t {
+    static constexpr auto kSlotsProperty = "cpu";
+    auto const& platform =
+        action.has_platform() ? action.platform() : command.platform();
+    for (auto const& property : platform.properties()) {
+        if (property.name() == kSlotsProperty) {
+            try {
+                return std::stoul(property.value());
+            } catch (...) {
+                return 1;
+            }
+        }
+    }
+    return 1;
 }
 
 [[nodiscard]] auto ToBazelActionResult(
@@ -74,6 +123,14 @@ void UpdateTimeStamp(
     bool legacy_client) noexcept
     -> expected<bazel_re::ActionResult, std::string>;
 
+/// \brief Obtain the digest of an output stream of a local action in the CAS
+/// of the given storage. The stream is read only if it is not there already.
+[[nodiscard]] auto StoreOutputStream(
+    Storage const& storage,
+    std::optional<ArtifactDigest> const& digest,
+    std::function<std::string()> const& read) noexcept
+    -> std::optional<ArtifactDigest>;
+
 [[nodiscard]] auto ToBazelAction(ArtifactDigest const& action_digest,
                                  Storage const& storage) noexcept
     -> expected<::bazel_re::Action, std::string>;
@@ -167,8 +224,11 @@ auto ExecutionServiceImpl::ToBazelExecuteResponse(
     action_result.set_exit_code(local_response->ExitCode());
     if (local_response->HasStdErr()) {
         auto const cas_digest =
-            storage_.CAS().StoreBlob(local_response->StdErr(),
-                                     /*is_executable=*/false);
+            StoreOutputStream(storage_,
+                              local_response->StdErrDigest(),
+                              [&local_response] {
+                                  return local_response->StdErr();
+                              });
         if (not cas_digest) {
             return unexpected{fmt::format("Could not store stderr of action {}",
                                           local_response->ActionDigest())};
@@ -179,8 +239,11 @@ auto ExecutionServiceImpl::ToBazelExecuteResponse(
 
     if (local_response->HasStdOut()) {
         auto const cas_digest =
-            storage_.CAS().StoreBlob(local_response->StdOut(),
-                                     /*is_executable=*/false);
+            StoreOutputStream(storage_,
+                              local_response->StdOutDigest(),
+                              [&local_response] {
+                                  return local_response->StdOut();
+                              });
         if (not cas_digest) {
             return unexpected{fmt::format("Could not store stdout of action {}",
                                           local_response->ActionDigest())};
@@ -200,35 +263,45 @@ auto ExecutionServiceImpl::ToBazelExecuteResponse(
 
 void ExecutionServiceImpl::WriteResponse(
     ::bazel_re::ExecuteResponse const& execute_response,
-    ::grpc::ServerWriter<::google::longrunning::Operation>* writer,
+    OperationStream* stream,
     ::google::longrunning::Operation&& op) noexcept {
     // send response to the client
     op.mutable_response()->PackFrom(execute_response);
     op.set_done(true);
-    UpdateTimeStamp(&op);
+    SetStage(&op, ::bazel_re::ExecutionStage::COMPLETED);
 
     op_cache_.Set(op.name(), op);
-    writer->Write(op);
+    stream->Write(op);
 }
 
-auto ExecutionServiceImpl::Execute(
-    ::grpc::ServerContext* /*context*/,
-    const ::bazel_re::ExecuteRequest* request,
-    ::grpc::ServerWriter<::google::longrunning::Operation>* writer)
-    -> ::grpc::Status {
-    auto const action_digest = ArtifactDigestFactory::FromBazel(
-        storage_config_.hash_function.GetType(), request->action_digest());
+struct ExecutionServiceImpl::PendingExecution final {
+    ArtifactDigest action_digest;
+    bool cacheable;
+    bool legacy_client;
+    IExecutionAction::Ptr action;
+    ::google::longrunning::Operation op;
+    OperationStream::Ptr stream;
+    // keeps the inputs of the action from being collected until it is run
+    LockFile lock;
+};
+
+auto ExecutionServiceImpl::ExecuteImpl(
+    std::string const& client,
+    ::bazel_re::ExecuteRequest const& request,
+    OperationStream::Ptr const& stream) -> ::grpc::Status {
+    auto action_digest = ArtifactDigestFactory::FromBazel(
+        storage_config_.hash_function.GetType(), request.action_digest());
     if (not action_digest) {
         logger_.Emit(LogLevel::Error, "{}", action_digest.error());
         return grpc::Status{grpc::StatusCode::INTERNAL, action_digest.error()};
     }
-    logger_.Emit(LogLevel::Debug, [request, &action_digest]() {
+    logger_.Emit(LogLevel::Debug, [&request, &action_digest]() {
         return fmt::format("Execute(instance_name={}, action_digest={})",
-                           nlohmann::json(request->instance_name()).dump(),
+                           nlohmann::json(request.instance_name()).dump(),
                            action_digest->hash());
     });
 
-    auto const lock = GarbageCollector::SharedLock(storage_config_);
+    auto lock = GarbageCollector::SharedLock(storage_config_);
     if (not lock) {
         static constexpr auto kStr = "Could not acquire SharedLock";
         logger_.Emit(LogLevel::Error, "{}", kStr);
@@ -265,22 +338,99 @@ auto ExecutionServiceImpl::Execute(
                            action_digest->hash(),
                            nlohmann::json(args).dump());
     });
-    logger_.Emit(LogLevel::Info, "Execute {}", action_digest->hash());
-    // send initial response to the client
     auto op = ::google::longrunning::Operation{};
-    auto const& op_name = request->action_digest().hash();
+    auto const& op_name = request.action_digest().hash();
     op.set_name(op_name);
     op.set_done(false);
-    UpdateTimeStamp(&op);
-    op_cache_.Set(op_name, op);
-    writer->Write(op);
+    ::bazel_re::ExecuteOperationMetadata metadata;
+    *metadata.mutable_action_digest() = request.action_digest();
+    metadata.set_stage(::bazel_re::ExecutionStage::QUEUED);
+    SetTimeStamp(metadata.mutable_partial_execution_metadata()
+                     ->mutable_queued_timestamp(),
+                 std::chrono::high_resolution_clock::now());
+    op.mutable_metadata()->PackFrom(metadata);
+
+    // Identical cacheable actions requested while one of them is executed are
+    // not run again, but attached to the running operation instead.
+    bool const cacheable = not action->do_not_cache();
+    if (cacheable) {
+        std::unique_lock lock{in_flight_mutex_};
+        if (not in_flight_.insert(op_name).second) {
+            lock.unlock();
+            logger_.Emit(LogLevel::Info,
+                         "Execute {}: attaching to running operation",
+                         action_digest->hash());
+            return FollowOperation(op_name, stream);
+        }
+        // publish the operation before others can attach to it
+        op_cache_.Set(op_name, op);
+    }
+    else {
+        op_cache_.Set(op_name, op);
+    }
+
+    logger_.Emit(LogLevel::Info, "Execute {}", action_digest->hash());
+    // send initial response to the client
+    stream->Write(op);
+
+    auto const slots = RequestedSlots(*action, *command);
+    auto execution = std::make_shared<PendingExecution>(PendingExecution{
+        .action_digest = std::move(*action_digest),
+        .cacheable = cacheable,
+        .legacy_client = legacy_client,
+        .action = std::move(*i_execution_action),
+        .op = std::move(op),
+        .stream = stream,
+        .lock = std::move(*lock)});
+
+    // Submit the action to the scheduler, which admits actions of different
+    // clients (connections) in turn. Until it is admitted, nothing waits for
+    // it: the client, and the requests attached to the operation, are kept
+    // informed about its position in the queue by the scheduler, and it is
+    // run once the scheduler admits it.
+    scheduler_.Submit(
+        client,
+        slots,
+        [this, execution](ActionScheduler::Reservation reservation) {
+            auto held = std::make_shared<ActionScheduler::Reservation>(
+                std::move(reservation));
+            executor_.QueueTask([this, execution, held]() mutable {
+                auto const op_name = execution->op.name();
+                auto const status = RunExecution(execution.get());
+                held.reset();
+                if (execution->cacheable) {
+                    FinishInFlight(op_name);
+                }
+                execution->stream->Close(status);
+            });
+        },
+        [this, execution](ActionScheduler::QueueState const& state) {
+            logger_.Emit(LogLevel::Debug,
+                         "Action {} is waiting at position {} of {}",
+                         execution->action_digest.hash(),
+                         state.position,
+                         state.queue_depth);
+            SetQueueState(&execution->op, state);
+            op_cache_.Set(execution->op.name(), execution->op);
+            execution->stream->Write(execution->op);
+        });
+    return ::grpc::Status::OK;
+}
+
+auto ExecutionServiceImpl::RunExecution(
+    gsl::not_null<PendingExecution*> const& execution) -> ::grpc::Status {
+    auto const& action_digest = execution->action_digest;
+    auto& op = execution->op;
+    SetStage(&op, ::bazel_re::ExecutionStage::EXECUTING);
+    op_cache_.Set(op.name(), op);
+    execution->stream->Write(op);
     auto t0 = std::chrono::high_resolution_clock::now();
-    auto i_execution_response = i_execution_action->get()->Execute(&logger_);
+    auto i_execution_response = execution->action->Execute(&logger_);
     auto t1 = std::chrono::high_resolution_clock::now();
     logger_.Emit(
         LogLevel::Trace,
         "Finished execution of {} in {} seconds",
-        action_digest->hash(),
+        action_digest.hash(),
         std::chrono::duration_cast<std::chrono::seconds>(t1 - t0).count());
 
     auto* local_response =
@@ -289,14 +439,14 @@ auto ExecutionServiceImpl::Execute(
         auto error_msg =
             (i_execution_response == nullptr)
                 ? fmt::format("Failed to execute action {}",
-                              action_digest->hash())
+                              action_digest.hash())
                 : std::string{"Local action did not produce a local response"};
         logger_.Emit(LogLevel::Error, "{}", error_msg);
         return ::grpc::Status{grpc::StatusCode::INTERNAL, error_msg};
     }
 
     auto execute_response =
-        ToBazelExecuteResponse(local_response, legacy_client);
+        ToBazelExecuteResponse(local_response, execution->legacy_client);
     if (not execute_response) {
         logger_.Emit(LogLevel::Error, "{}", execute_response.error());
         return ::grpc::Status{grpc::StatusCode::INTERNAL,
@@ -313,48 +463,126 @@ auto ExecutionServiceImpl::Execute(
                  t1);
 
     // Store the result in action cache
-    if (i_execution_response->ExitCode() == 0 and not action->do_not_cache()) {
-        if (not storage_.ActionCache().StoreResult(*action_digest,
+    if (i_execution_response->ExitCode() == 0 and execution->cacheable) {
+        if (not storage_.ActionCache().StoreResult(action_digest,
                                                    response.result())) {
             auto const str =
                 fmt::format("Could not store action result for action {}",
-                            action_digest->hash());
+                            action_digest.hash());
 
             logger_.Emit(LogLevel::Error, "{}", str);
             return ::grpc::Status{grpc::StatusCode::INTERNAL, str};
         }
     }
 
-    WriteResponse(response, writer, std::move(op));
+    WriteResponse(response, execution->stream.get(), std::move(op));
     return ::grpc::Status::OK;
 }
 
-auto ExecutionServiceImpl::WaitExecution(
-    ::grpc::ServerContext* /*context*/,
-    const ::bazel_re::WaitExecutionRequest* request,
-    ::grpc::ServerWriter<::google::longrunning::Operation>* writer)
+auto ExecutionServiceImpl::FollowOperation(std::string const& op_name,
+                                           OperationStream::Ptr const& stream)
     -> ::grpc::Status {
-    auto const& hash = request->name();
+    // forward the updates of the operation, as sent to its owner, and finish
+    // once it is done
+    auto const known =
+        op_cache_.Subscribe(op_name, [stream](auto const& current) {
+            stream->Write(current);
+            if (current.done()) {
+                stream->Close(::grpc::Status::OK);
+            }
+        });
+    if (not known) {
+        auto const str = fmt::format(
+            "Executing action {} not found in internal cache.", op_name);
+        logger_.Emit(LogLevel::Error, "{}", str);
+        return ::grpc::Status{grpc::StatusCode::INTERNAL, str};
+    }
+    return ::grpc::Status::OK;
+}
+
+void ExecutionServiceImpl::FinishInFlight(std::string const& op_name) noexcept {
+    // If the execution failed without finishing the operation, report the
+    // failure to the attached requests.
+    if (auto op = op_cache_.Query(op_name); op and not op->done()) {
+        op->set_done(true);
+        op->mutable_error()->set_code(grpc::StatusCode::INTERNAL);
+        op->mutable_error()->set_message(
+            fmt::format("Execution of action {} failed", op_name));
+        SetStage(&*op, ::bazel_re::ExecutionStage::COMPLETED);
+        op_cache_.Set(op_name, *op);
+    }
+    std::unique_lock lock{in_flight_mutex_};
+    in_flight_.erase(op_name);
+}
+
+auto ExecutionServiceImpl::WaitExecutionImpl(
+    ::bazel_re::WaitExecutionRequest const& request,
+    OperationStream::Ptr const& stream) -> ::grpc::Status {
+    auto const& hash = request.name();
     if (not IsHexString(hash)) {
         auto const str = fmt::format("Invalid hash {}", hash);
         logger_.Emit(LogLevel::Error, "{}", str);
         return ::grpc::Status{::grpc::StatusCode::INVALID_ARGUMENT, str};
     }
     logger_.Emit(LogLevel::Debug, "WaitExecution: {}", hash);
-    auto op = op_cache_.Query(hash);
-    while (op and not op->done()) {
-        std::this_thread::sleep_for(std::chrono::seconds(1));
-        op = op_cache_.Query(hash);
-    }
-    if (not op) {
-        auto const str = fmt::format(
-            "Executing action {} not found in internal cache.", hash);
-        logger_.Emit(LogLevel::Error, "{}", str);
-        return ::grpc::Status{grpc::StatusCode::INTERNAL, str};
+    return FollowOperation(hash, stream);
+}
+
+auto ExecutionServiceImpl::Execute(
+    ::grpc::ServerContext* context,
+    const ::bazel_re::ExecuteRequest* request,
+    ::grpc::ServerWriter<::google::longrunning::Operation>* writer)
+    -> ::grpc::Status {
+    auto stream = std::make_shared<
+        BlockingResponseStream<::google::longrunning::Operation>>(writer);
+    auto const client =
+        context == nullptr ? request->instance_name() : context->peer();
+    if (auto status = ExecuteImpl(client, *request, stream); not status.ok()) {
+        return status;
+    }
+    return stream->Wait();
+}
+
+auto ExecutionServiceImpl::WaitExecution(
+    ::grpc::ServerContext* /*context*/,
+    const ::bazel_re::WaitExecutionRequest* request,
+    ::grpc::ServerWriter<::google::longrunning::Operation>* writer)
+    -> ::grpc::Status {
+    auto stream = std::make_shared<
+        BlockingResponseStream<::google::longrunning::Operation>>(writer);
+    if (auto status = WaitExecutionImpl(*request, stream); not status.ok()) {
+        return status;
     }
-    writer->Write(*op);
-    logger_.Emit(LogLevel::Trace, "Finished WaitExecution {}", hash);
-    return ::grpc::Status::OK;
+    return stream->Wait();
+}
+
+auto ExecutionServiceImpl::Execute(::grpc::CallbackServerContext* context,
+                                   const ::bazel_re::ExecuteRequest* request)
+    -> ::grpc::ServerWriteReactor<::google::longrunning::Operation>* {
+    auto writer =
+        ServerStreamWriter<::google::longrunning::Operation>::Create();
+    // Prepare the request on the executor, as it reads from the storage. The
+    // request is copied, as the call may be cancelled meanwhile.
+    executor_.QueueTask(
+        [this, client = context->peer(), request = *request, writer]() {
+            if (auto status = ExecuteImpl(client, request, writer);
+                not status.ok()) {
+                writer->Close(status);
+            }
+        });
+    return writer.get();
+}
+
+auto ExecutionServiceImpl::WaitExecution(
+    ::grpc::CallbackServerContext* /*context*/,
+    const ::bazel_re::WaitExecutionRequest* request)
+    -> ::grpc::ServerWriteReactor<::google::longrunning::Operation>* {
+    auto writer =
+        ServerStreamWriter<::google::longrunning::Operation>::Create();
+    if (auto status = WaitExecutionImpl(*request, writer); not status.ok()) {
+        writer->Close(status);
+    }
+    return writer.get();
 }
 
 namespace {
@@ -551,4 +779,20 @@ namespace {
     }
     return c;
 }
+
+auto StoreOutputStream(Storage const& storage,
+                       std::optional<ArtifactDigest> const& digest,
+                       std::function<std::string()> const& read) noexcept
+    -> std::optional<ArtifactDigest> {
+    // The local action already stored its output streams in the CAS, so avoid
+    // reading (possibly large) outputs into memory to store them again.
+    if (digest and storage.CAS().BlobPath(*digest, /*is_executable=*/false)) {
+        return digest;
+    }
+    try {
+        return storage.CAS().StoreBlob(read(), /*is_executable=*/false);
+    } catch (...) {
+        return std::nullopt;
+    }
+}
 }  // namespace
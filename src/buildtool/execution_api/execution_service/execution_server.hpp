@@ -15,9 +15,13 @@
 #ifndef EXECUTION_SERVER_HPP
 #define EXECUTION_SERVER_HPP
 
+#include <cstddef>
 #include <cstdint>
+#include <memory>
+#include <mutex>
 #include <optional>
 #include <string>
+#include <unordered_set>
 
 #include <grpcpp/grpcpp.h>
 
@@ -26,25 +30,47 @@
 #include "gsl/gsl"
 #include "src/buildtool/common/bazel_types.hpp"
 #include "src/buildtool/execution_api/common/execution_action.hpp"
+#include "src/buildtool/execution_api/execution_service/action_scheduler.hpp"
+#include "src/buildtool/execution_api/execution_service/callback_reactors.hpp"
 #include "src/buildtool/execution_api/execution_service/operation_cache.hpp"
 #include "src/buildtool/execution_api/local/context.hpp"
 #include "src/buildtool/execution_api/local/local_api.hpp"
 #include "src/buildtool/logging/logger.hpp"
+#include "src/buildtool/multithreading/task_system.hpp"
 #include "src/buildtool/storage/config.hpp"
 #include "src/buildtool/storage/storage.hpp"
 #include "src/utils/cpp/expected.hpp"
 
 class LocalResponse;
 
-class ExecutionServiceImpl final : public bazel_re::Execution::Service {
+namespace execution_server {
+using Execution = bazel_re::Execution;
+
+// All calls are served via the callback API.
+using CallbackService = Execution::WithCallbackMethod_Execute<
+    Execution::WithCallbackMethod_WaitExecution<Execution::Service>>;
+}  // namespace execution_server
+
+/// \brief Execution service. All calls are served via the callback API. No
+/// thread is held while a call waits: calls waiting for their action to be
+/// admitted are resumed by the scheduler, and calls waiting for an operation
+/// to finish are resumed by the updates of the operation. Requests are
+/// prepared and admitted actions are run on the executor of this service.
+class ExecutionServiceImpl final : public execution_server::CallbackService {
   public:
+    /// \param op_exponent     Log2 threshold for the operation cache.
+    /// \param action_slots    Number of slots for running actions, see
+    /// \ref ActionScheduler; 0 for the number of cores.
     explicit ExecutionServiceImpl(
         gsl::not_null<LocalContext const*> const& local_context,
         gsl::not_null<LocalApi const*> const& local_api,
-        std::optional<std::uint8_t> op_exponent) noexcept
+        std::optional<std::uint8_t> op_exponent,
+        std::size_t action_slots) noexcept
         : storage_config_{*local_context->storage_config},
           storage_{*local_context->storage},
-          api_{*local_api} {
+          api_{*local_api},
+          scheduler_{action_slots},
+          executor_{scheduler_.TotalSlots() + kPreparingThreads} {
         if (op_exponent) {
             op_cache_.SetExponent(*op_exponent);
         }
@@ -135,12 +161,54 @@ class ExecutionServiceImpl final : public bazel_re::Execution::Service {
                        ::grpc::ServerWriter<::google::longrunning::Operation>*
                            writer) -> ::grpc::Status override;
 
+    // Callback versions of the calls.
+    auto Execute(::grpc::CallbackServerContext* context,
+                 const ::bazel_re::ExecuteRequest* request)
+        -> ::grpc::ServerWriteReactor<::google::longrunning::Operation>*
+        override;
+    auto WaitExecution(::grpc::CallbackServerContext* context,
+                       const ::bazel_re::WaitExecutionRequest* request)
+        -> ::grpc::ServerWriteReactor<::google::longrunning::Operation>*
+        override;
+
   private:
+    using OperationStream = ResponseStream<::google::longrunning::Operation>;
+
+    /// \brief State of an execution, from its request until it is finished.
+    struct PendingExecution;
+    using PendingExecutionPtr = std::shared_ptr<PendingExecution>;
+
+    // Threads of the executor besides those running admitted actions, for
+    // preparing incoming requests.
+    static constexpr std::size_t kPreparingThreads = 2;
+
     StorageConfig const& storage_config_;
     Storage const& storage_;
     LocalApi const& api_;
+    ActionScheduler scheduler_;
     OperationCache op_cache_;
     Logger logger_{"execution-service"};
+    // names of the operations currently executed for cacheable actions
+    std::mutex in_flight_mutex_;
+    std::unordered_set<std::string> in_flight_;
+    // Declared last, so that pending calls are served before anything else
+    // is destroyed.
+    TaskSystem executor_;
+
+    // Implementations of the calls, shared by their synchronous and callback
+    // versions. They do not wait: unless an error is returned, the call is
+    // accepted and the stream is closed once the operation is finished.
+    [[nodiscard]] auto ExecuteImpl(std::string const& client,
+                                   ::bazel_re::ExecuteRequest const& request,
+                                   OperationStream::Ptr const& stream)
+        -> ::grpc::Status;
+    [[nodiscard]] auto WaitExecutionImpl(
+        ::bazel_re::WaitExecutionRequest const& request,
+        OperationStream::Ptr const& stream) -> ::grpc::Status;
+
+    /// \brief Run an admitted action and send its result.
+    [[nodiscard]] auto RunExecution(
+        gsl::not_null<PendingExecution*> const& execution) -> ::grpc::Status;
 
     [[nodiscard]] auto ToIExecutionAction(::bazel_re::Action const& action,
                                           ::bazel_re::Command const& command,
@@ -152,10 +220,19 @@ class ExecutionServiceImpl final : public bazel_re::Execution::Service {
         bool legacy_client) const noexcept
         -> expected<::bazel_re::ExecuteResponse, std::string>;
 
-    void WriteResponse(
-        ::bazel_re::ExecuteResponse const& execute_response,
-        ::grpc::ServerWriter<::google::longrunning::Operation>* writer,
-        ::google::longrunning::Operation&& op) noexcept;
+    void WriteResponse(::bazel_re::ExecuteResponse const& execute_response,
+                       OperationStream* stream,
+                       ::google::longrunning::Operation&& op) noexcept;
+
+    /// \brief Serve a request by an operation already known, sending its
+    /// current state, every update of it, and, once done, its result.
+    [[nodiscard]] auto FollowOperation(std::string const& op_name,
+                                       OperationStream::Ptr const& stream)
+        -> ::grpc::Status;
+
+    /// \brief Unregister a running operation. If it did not finish, it is
+    /// marked as failed, so that attached requests do not wait forever.
+    void FinishInFlight(std::string const& op_name) noexcept;
 };
 
 #endif  // EXECUTION_SERVER_HPP
@@ -15,29 +15,28 @@
 #include "src/buildtool/execution_api/execution_service/operation_cache.hpp"
 
 #include <algorithm>
-#include <compare>   // for operator<
+#include <cstdint>
 #include <iterator>  // for back_insert_iterator
+#include <utility>   // for pair
 #include <vector>    // for vector
 
-#include "google/protobuf/timestamp.pb.h"
-
 void OperationCache::GarbageCollection() {
     if (cache_.size() > (threshold_ << 1U)) {
-        std::vector<std::pair<std::string, ::google::longrunning::Operation>>
-            tmp;
+        std::vector<std::pair<std::string, std::uint64_t>> tmp;
         tmp.reserve(cache_.size());
-        std::copy(cache_.begin(), cache_.end(), std::back_insert_iterator(tmp));
+        std::transform(cache_.begin(),
+                       cache_.end(),
+                       std::back_insert_iterator(tmp),
+                       [](auto const& entry) {
+                           return std::pair{entry.first, entry.second.update};
+                       });
         std::sort(tmp.begin(), tmp.end(), [](auto const& x, auto const& y) {
-            ::google::protobuf::Timestamp tx;
-            ::google::protobuf::Timestamp ty;
-            x.second.metadata().UnpackTo(&tx);
-            y.second.metadata().UnpackTo(&ty);
-            return tx.seconds() < ty.seconds();
+            return x.second < y.second;
         });
 
         std::size_t deleted = 0;
-        for (auto const& [key, op] : tmp) {
-            if (op.done()) {
+        for (auto const& [key, update] : tmp) {
+            if (cache_[key].op.done()) {
                 DropInternal(key);
                 ++deleted;
             }
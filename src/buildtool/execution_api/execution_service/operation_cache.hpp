@@ -18,12 +18,14 @@
 #include <cstddef>
 #include <cstdint>
 #include <functional>
+#include <memory>
 #include <mutex>
 #include <optional>
 #include <shared_mutex>
 #include <string>
 #include <unordered_map>
 #include <utility>
+#include <vector>
 
 #include "google/longrunning/operations.pb.h"
 
@@ -48,18 +50,95 @@ class OperationCache final {
         return QueryInternal(x);
     }
 
+    /// \brief Callback for the states of an operation.
+    using Listener = std::function<void(Operation const&)>;
+
+    /// \brief Follow the given operation without waiting for it. The listener
+    /// is called with the current state of the operation and then with every
+    /// state it is set to, until it is done. It is called by the thread
+    /// subscribing or setting the state, but without holding the lock of the
+    /// cache; states are reported in order, and states superseded before they
+    /// are reported may be skipped.
+    /// \returns False if the operation is not cached.
+    [[nodiscard]] auto Subscribe(std::string const& x, Listener listener)
+        -> bool {
+        auto subscriber = std::make_shared<Subscriber>();
+        subscriber->listener = std::move(listener);
+        Operation op{};
+        std::uint64_t update{};
+        {
+            std::unique_lock lock{mutex_};
+            auto it = cache_.find(x);
+            if (it == cache_.end()) {
+                return false;
+            }
+            op = it->second.op;
+            update = it->second.update;
+            if (not op.done()) {
+                it->second.subscribers.emplace_back(subscriber);
+            }
+        }
+        Notify(subscriber.get(), op, update);
+        return true;
+    }
+
     void SetExponent(std::uint8_t x) noexcept { threshold_ = 1U << x; }
 
   private:
+    /// \brief Listener of an operation, with the number of the last update
+    /// reported to it.
+    struct Subscriber final {
+        Listener listener;
+        std::mutex mutex;  // serializes the calls of the listener
+        std::uint64_t reported{};
+    };
+    using SubscriberPtr = std::shared_ptr<Subscriber>;
+
+    /// \brief Cached operation together with the number of its last update,
+    /// by which entries are dropped in FIFO order, and the listeners to
+    /// inform about its updates until it is done.
+    struct Entry final {
+        Operation op;
+        std::uint64_t update{};
+        std::vector<SubscriberPtr> subscribers;
+    };
+
     mutable std::shared_mutex mutex_;
-    std::unordered_map<std::string, ::google::longrunning::Operation> cache_;
+    std::unordered_map<std::string, Entry> cache_;
+    std::uint64_t updates_{};
     static constexpr std::uint8_t kDefaultExponent{14};
     std::size_t threshold_{1U << kDefaultExponent};
 
     void SetInternal(std::string const& action, Operation const& op) {
-        std::unique_lock lock{mutex_};
-        GarbageCollection();
-        cache_[action] = op;
+        std::vector<SubscriberPtr> subscribers{};
+        std::uint64_t update{};
+        {
+            std::unique_lock lock{mutex_};
+            GarbageCollection();
+            auto& entry = cache_[action];
+            entry.op = op;
+            entry.update = update = ++updates_;
+            if (op.done()) {
+                // done operations are not updated anymore
+                subscribers = std::exchange(entry.subscribers, {});
+            }
+            else {
+                subscribers = entry.subscribers;
+            }
+        }
+        for (auto const& subscriber : subscribers) {
+            Notify(subscriber.get(), op, update);
+        }
+    }
+
+    static void Notify(Subscriber* subscriber,
+                       Operation const& op,
+                       std::uint64_t update) {
+        std::unique_lock lock{subscriber->mutex};
+        if (update > subscriber->reported) {
+            subscriber->reported = update;
+            subscriber->listener(op);
+        }
     }
 
     [[nodiscard]] auto QueryInternal(std::string const& x) const noexcept
@@ -67,13 +146,13 @@ class OperationCache final {
         std::shared_lock lock{mutex_};
         auto it = cache_.find(x);
         if (it != cache_.end()) {
-            return it->second;
+            return it->second.op;
         }
         return std::nullopt;
     }
 
     void DropInternal(std::string const& x) noexcept {
-        cache_[x].Clear();
+        cache_[x].op.Clear();
         cache_.erase(x);
     }
 
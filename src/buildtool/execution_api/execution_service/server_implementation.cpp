@@ -77,10 +77,12 @@ auto ServerImpl::Create(std::optional<std::string> interface,
 auto ServerImpl::Run(gsl::not_null<LocalContext const*> const& local_context,
                      gsl::not_null<RemoteContext const*> const& remote_context,
                      gsl::not_null<LocalApi const*> const& local_api,
-                     std::optional<std::uint8_t> op_exponent) -> bool {
+                     std::optional<std::uint8_t> op_exponent,
+                     std::size_t action_slots) -> bool {
     auto const hash_type =
         local_context->storage_config->hash_function.GetType();
-    ExecutionServiceImpl es{local_context, local_api, op_exponent};
+    ExecutionServiceImpl es{
+        local_context, local_api, op_exponent, action_slots};
     ActionCacheServiceImpl ac{local_context};
     CASServiceImpl cas{local_context};
     BytestreamServiceImpl b{local_context};
@@ -15,6 +15,7 @@
 #ifndef SERVER_IMPLEMENATION_HPP
 #define SERVER_IMPLEMENATION_HPP
 
+#include <cstddef>
 #include <cstdint>
 #include <optional>
 #include <string>
@@ -47,10 +48,12 @@ class ServerImpl final {
     /// \param remote_context   The RemoteContext to be used.
     /// \param local_api        The LocalApi used.
     /// \param op_exponent      Log2 threshold for operation cache.
+    /// \param action_slots     Number of slots for running actions.
     auto Run(gsl::not_null<LocalContext const*> const& local_context,
              gsl::not_null<RemoteContext const*> const& remote_context,
              gsl::not_null<LocalApi const*> const& local_api,
-             std::optional<std::uint8_t> op_exponent) -> bool;
+             std::optional<std::uint8_t> op_exponent,
+             std::size_t action_slots) -> bool;
 
   private:
     ServerImpl() noexcept = default;
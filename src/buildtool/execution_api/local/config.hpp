@@ -31,6 +31,11 @@ struct LocalExecutionConfig final {
     // Launcher to be prepended to action's command before executed.
     // Default: ["env", "--"]
     std::vector<std::string> const launcher = {"env", "--"};
+
+    // Stage input trees not written to by an action from a pool of
+    // materialized trees, instead of creating them file by file.
+    // Default: false
+    bool const cached_staging = false;
 };
 
 class LocalExecutionConfig::Builder final {
@@ -40,6 +45,11 @@ class LocalExecutionConfig::Builder final {
         return *this;
     }
 
+    auto SetCachedStaging(bool cached_staging) noexcept -> Builder& {
+        cached_staging_ = cached_staging;
+        return *this;
+    }
+
     /// \brief Finalize building and create LocalExecutionConfig.
     /// \return LocalExecutionConfig on success, an error string on failure.
     [[nodiscard]] auto Build() const noexcept
@@ -57,11 +67,13 @@ class LocalExecutionConfig::Builder final {
             }
         }
 
-        return LocalExecutionConfig{.launcher = std::move(launcher)};
+        return LocalExecutionConfig{.launcher = std::move(launcher),
+                                    .cached_staging = cached_staging_};
     }
 
   private:
     std::optional<std::vector<std::string>> launcher_;
+    bool cached_staging_{false};
 };
 
 #endif  // INCLUDED_SRC_BUILDTOOL_EXECUTION_API_LOCAL_CONFIG_HPP
@@ -23,6 +23,7 @@
 #include <memory>
 #include <string>
 #include <system_error>
+#include <unordered_set>
 #include <utility>
 
 #include "google/protobuf/repeated_ptr_field.h"
@@ -193,7 +194,10 @@ auto LocalAction::Run(ArtifactDigest const& action_id) const noexcept
     auto anchor = BuildCleanupAnchor(*exec_path);
 
     auto const build_root = *exec_path / "build_root";
-    if (not CreateDirectoryStructure(build_root)) {
+
+    // trees staged from the staging cache, returned before the cleanup
+    auto staged = LocalStagingCache::StagedTrees{staging_cache_, build_root};
+    if (not CreateDirectoryStructure(build_root, &staged)) {
         return std::nullopt;
     }
 
@@ -327,15 +331,13 @@ auto LocalAction::StageInput(
     return true;
 }
 
-auto LocalAction::StageInputs(
-    std::filesystem::path const& exec_path,
+auto LocalAction::StageTree(
+    ArtifactDigest const& tree,
+    std::filesystem::path const& dir,
     gsl::not_null<LocalAction::FileCopies*> copies) const noexcept -> bool {
-    if (FileSystemManager::IsRelativePath(exec_path)) {
-        return false;
-    }
     auto reader = TreeReader<LocalCasReader>{&local_context_.storage->CAS()};
-    auto result = reader.RecursivelyReadTreeLeafs(
-        root_digest_, exec_path, /*include_trees=*/true);
+    auto result =
+        reader.RecursivelyReadTreeLeafs(tree, dir, /*include_trees=*/true);
     if (not result) {
         return false;
     }
@@ -347,8 +349,119 @@ auto LocalAction::StageInputs(
     return true;
 }
 
+auto LocalAction::StageTreeCached(
+    ArtifactDigest const& tree,
+    std::filesystem::path const& exec_path,
+    std::filesystem::path const& rel_path,
+    std::unordered_set<std::string> const& writable,
+    gsl::not_null<LocalAction::FileCopies*> copies,
+    gsl::not_null<LocalStagingCache::StagedTrees*> staged) const noexcept
+    -> bool {
+    if (not local_context_.storage->CAS().TreePath(tree)) {
+        logger_.Emit(LogLevel::Error,
+                     "tree with id {} is missing in CAS",
+                     tree.hash());
+        return false;
+    }
+    auto reader = TreeReader<LocalCasReader>{&local_context_.storage->CAS()};
+    auto const entries = reader.ReadDirectTreeEntries(tree, rel_path);
+    if (not entries) {
+        return false;
+    }
+    try {
+        if (not FileSystemManager::CreateDirectory(exec_path / rel_path)) {
+            return false;
+        }
+        for (std::size_t i{}; i < entries->paths.size(); ++i) {
+            auto const& path = entries->paths[i];
+            auto const& info = entries->infos[i];
+            if (not IsTreeObject(info.type)) {
+                if (not StageInput(exec_path / path, info, copies)) {
+                    return false;
+                }
+            }
+            else if (writable.contains(path.string())) {
+                if (not StageTreeCached(info.digest,
+                                        exec_path,
+                                        path,
+                                        writable,
+                                        copies,
+                                        staged)) {
+                    return false;
+                }
+            }
+            else if (not staged->Stage(
+                         info.digest,
+                         exec_path / path,
+                         [this, &info](std::filesystem::path const& dir) {
+                             FileCopies tree_copies{};
+                             return FileSystemManager::CreateDirectory(dir) and
+                                    StageTree(info.digest, dir, &tree_copies);
+                         })) {
+                return false;
+            }
+        }
+        return true;
+    } catch (std::exception const& ex) {
+        logger_.Emit(LogLevel::Error,
+                     "staging inputs from the staging cache failed with:\n{}",
+                     ex.what());
+    }
+    return false;
+}
+
+auto LocalAction::WritableDirectories() const
+    -> std::unordered_set<std::string> {
+    std::unordered_set<std::string> writable{};
+    auto const add = [&writable](std::filesystem::path const& path) {
+        for (auto dir = ToNormalPath(path); dir != "." and not dir.empty();
+             dir = dir.parent_path()) {
+            if (not writable.emplace(dir.string()).second) {
+                break;  // parents are already known
+            }
+        }
+    };
+    auto const cwd = std::filesystem::path{cwd_};
+    add(cwd);
+    for (auto const* outputs :
+         {&output_files_, &output_dirs_, &output_paths_}) {
+        for (auto const& output : *outputs) {
+            add(cwd / output);
+        }
+    }
+    return writable;
+}
+
+auto LocalAction::StageInputs(
+    std::filesystem::path const& exec_path,
+    gsl::not_null<LocalAction::FileCopies*> copies,
+    gsl::not_null<LocalStagingCache::StagedTrees*> staged) const noexcept
+    -> bool {
+    if (FileSystemManager::IsRelativePath(exec_path)) {
+        return false;
+    }
+    if (not staged->IsEnabled()) {
+        return StageTree(root_digest_, exec_path, copies);
+    }
+    try {
+        return StageTreeCached(root_digest_,
+                               exec_path,
+                               std::filesystem::path{},
+                               WritableDirectories(),
+                               copies,
+                               staged);
+    } catch (std::exception const& ex) {
+        logger_.Emit(LogLevel::Error,
+                     "determining writable directories failed with:\n{}",
+                     ex.what());
+    }
+    return false;
+}
+
 auto LocalAction::CreateDirectoryStructure(
-    std::filesystem::path const& exec_path) const noexcept -> bool {
+    std::filesystem::path const& exec_path,
+    gsl::not_null<LocalStagingCache::StagedTrees*> staged) const noexcept
+    -> bool {
     // clean execution directory
     if (not FileSystemManager::RemoveDirectory(exec_path)) {
         logger_.Emit(LogLevel::Error, "failed to clean exec_path");
@@ -364,7 +477,7 @@ auto LocalAction::CreateDirectoryStructure(
     // stage inputs (files, leaf trees) to execution directory
     {
         LocalAction::FileCopies copies{};
-        if (not StageInputs(exec_path, &copies)) {
+        if (not StageInputs(exec_path, &copies, staged)) {
             logger_.Emit(LogLevel::Error,
                          "failed to stage input files to exec_path");
             return false;
@@ -22,9 +22,11 @@
 #include <filesystem>
 #include <functional>  // IWYU pragma: keep
 #include <map>
+#include <memory>
 #include <optional>
 #include <string>
 #include <unordered_map>
+#include <unordered_set>
 #include <utility>  // std::move
 #include <variant>
 #include <vector>
@@ -38,6 +40,7 @@
 #include "src/buildtool/execution_api/common/execution_action.hpp"
 #include "src/buildtool/execution_api/common/execution_response.hpp"
 #include "src/buildtool/execution_api/local/context.hpp"
+#include "src/buildtool/execution_api/local/local_staging_cache.hpp"
 #include "src/buildtool/logging/logger.hpp"
 #include "src/buildtool/storage/config.hpp"
 #include "src/utils/cpp/tmp_dir.hpp"
@@ -81,6 +84,7 @@ class LocalAction final : public IExecutionAction {
   private:
     Logger logger_{"LocalExecution"};
     LocalContext const& local_context_;
+    std::shared_ptr<LocalStagingCache> const staging_cache_;
     ArtifactDigest const root_digest_;
     std::vector<std::string> const cmdline_;
     std::string const cwd_;
@@ -94,6 +98,7 @@ class LocalAction final : public IExecutionAction {
     RequestMode mode_{};
 
     explicit LocalAction(gsl::not_null<LocalContext const*> local_context,
+                         std::shared_ptr<LocalStagingCache> staging_cache,
                          ArtifactDigest root_digest,
                          std::vector<std::string> command,
                          std::string cwd,
@@ -103,6 +108,7 @@ class LocalAction final : public IExecutionAction {
                          std::map<std::string, std::string> const& properties,
                          bool best_effort) noexcept
         : local_context_{*local_context},
+          staging_cache_{std::move(staging_cache)},
           root_digest_{std::move(root_digest)},
           cmdline_{std::move(command)},
           cwd_{std::move(cwd)},
@@ -129,6 +135,7 @@ class LocalAction final : public IExecutionAction {
     // it is used by RBEv2.1 and above.
     explicit LocalAction(
         gsl::not_null<LocalContext const*> local_context,
+        std::shared_ptr<LocalStagingCache> staging_cache,
         ArtifactDigest root_digest,
         std::vector<std::string> command,
         std::string cwd,
@@ -136,6 +143,7 @@ class LocalAction final : public IExecutionAction {
         std::map<std::string, std::string> env_vars,
         std::map<std::string, std::string> const& properties) noexcept
         : local_context_{*local_context},
+          staging_cache_{std::move(staging_cache)},
           root_digest_{std::move(root_digest)},
           cmdline_{std::move(command)},
           cwd_{std::move(cwd)},
@@ -176,17 +184,49 @@ class LocalAction final : public IExecutionAction {
         Artifact::ObjectInfo const& info,
         gsl::not_null<FileCopies*> copies) const noexcept -> bool;
 
+    /// \brief Stage all artifacts and leaf trees of a tree to a directory.
+    /// The directory may not exist.
+    [[nodiscard]] auto StageTree(
+        ArtifactDigest const& tree,
+        std::filesystem::path const& dir,
+        gsl::not_null<FileCopies*> copies) const noexcept -> bool;
+
+    /// \brief Stage the entries of a tree, taking subtrees not written to by
+    /// the action from the staging cache.
+    /// \param[in] rel_path  Path of the tree relative to the execution
+    /// directory.
+    /// \param[in] writable  Paths of the directories written to by the
+    /// action, relative to the execution directory.
+    [[nodiscard]] auto StageTreeCached(
+        ArtifactDigest const& tree,
+        std::filesystem::path const& exec_path,
+        std::filesystem::path const& rel_path,
+        std::unordered_set<std::string> const& writable,
+        gsl::not_null<FileCopies*> copies,
+        gsl::not_null<LocalStagingCache::StagedTrees*> staged) const noexcept
+        -> bool;
+
+    /// \brief Paths of the directories the action writes to (its working
+    /// directory and the locations of outputs) and all their parents.
+    [[nodiscard]] auto WritableDirectories() const
+        -> std::unordered_set<std::string>;
+
     /// \brief Stage input artifacts and leaf trees to the execution directory.
     /// Stage artifacts and their parent directory structure from CAS to the
     /// specified execution directory. The execution directory may no exist.
     /// \param[in] exec_path Absolute path to the execution directory.
+    /// \param[in] staged    Trees staged from the staging cache.
     /// \returns Success indicator.
     [[nodiscard]] auto StageInputs(
         std::filesystem::path const& exec_path,
-        gsl::not_null<FileCopies*> copies) const noexcept -> bool;
+        gsl::not_null<FileCopies*> copies,
+        gsl::not_null<LocalStagingCache::StagedTrees*> staged) const noexcept
+        -> bool;
 
     [[nodiscard]] auto CreateDirectoryStructure(
-        std::filesystem::path const& exec_path) const noexcept -> bool;
+        std::filesystem::path const& exec_path,
+        gsl::not_null<LocalStagingCache::StagedTrees*> staged) const noexcept
+        -> bool;
 
     [[nodiscard]] auto CollectOutputFileOrSymlink(
         std::filesystem::path const& exec_path,
@@ -52,12 +52,22 @@ namespace {
     }
     return GitApi{repo_config};
 }
+
+[[nodiscard]] auto CreateStagingCache(
+    LocalContext const& local_context) noexcept
+    -> std::shared_ptr<LocalStagingCache> {
+    if (not local_context.exec_config->cached_staging) {
+        return nullptr;
+    }
+    return LocalStagingCache::Create(local_context.storage_config);
+}
 }  // namespace
 
 LocalApi::LocalApi(gsl::not_null<LocalContext const*> const& local_context,
                    RepositoryConfig const* repo_config) noexcept
     : local_context_{*local_context},
-      git_api_{CreateFallbackApi(*local_context->storage, repo_config)} {}
+      git_api_{CreateFallbackApi(*local_context->storage, repo_config)},
+      staging_cache_{CreateStagingCache(*local_context)} {}
 
 auto LocalApi::CreateAction(
     ArtifactDigest const& root_digest,
@@ -74,6 +84,7 @@ auto LocalApi::CreateAction(
     }
     bool best_effort = not force_legacy;
     return IExecutionAction::Ptr{new (std::nothrow) LocalAction{&local_context_,
+                                                                staging_cache_,
                                                                 root_digest,
                                                                 command,
                                                                 cwd,
@@ -93,6 +104,7 @@ auto LocalApi::CreateAction(
     std::map<std::string, std::string> const& properties) const noexcept
     -> IExecutionAction::Ptr {
     return IExecutionAction::Ptr{new (std::nothrow) LocalAction{&local_context_,
+                                                                staging_cache_,
                                                                 root_digest,
                                                                 command,
                                                                 cwd,
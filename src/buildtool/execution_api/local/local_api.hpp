@@ -17,6 +17,7 @@
 
 #include <filesystem>
 #include <map>
+#include <memory>
 #include <optional>
 #include <string>
 #include <unordered_set>
@@ -32,6 +33,7 @@
 #include "src/buildtool/execution_api/common/execution_api.hpp"
 #include "src/buildtool/execution_api/git/git_api.hpp"
 #include "src/buildtool/execution_api/local/context.hpp"
+#include "src/buildtool/execution_api/local/local_staging_cache.hpp"
 #include "src/buildtool/execution_engine/dag/dag.hpp"
 #include "src/utils/cpp/tmp_dir.hpp"
 
@@ -127,6 +129,7 @@ class LocalApi final : public IExecutionApi {
   private:
     LocalContext const& local_context_;
     std::optional<GitApi> const git_api_;
+    std::shared_ptr<LocalStagingCache> const staging_cache_;
 };
 
 #endif  // INCLUDED_SRC_BUILDTOOL_EXECUTION_API_LOCAL_LOCAL_API_HPP
@@ -0,0 +1,338 @@
+// Copyright 2026 Huawei Cloud Computing Technology Co., Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "src/buildtool/execution_api/local/local_staging_cache.hpp"
+
+#include <algorithm>
+#include <exception>
+#include <iterator>
+#include <string>
+#include <system_error>
+#include <tuple>  // std::ignore
+
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "src/buildtool/file_system/file_system_manager.hpp"
+#include "src/buildtool/logging/log_level.hpp"
+#include "src/buildtool/logging/logger.hpp"
+
+namespace {
+
+auto constexpr kWritePermissions = std::filesystem::perms::owner_write |
+                                   std::filesystem::perms::group_write |
+                                   std::filesystem::perms::others_write;
+
+[[nodiscard]] auto SetWritable(std::filesystem::path const& dir,
+                               bool writable) noexcept -> bool {
+    std::error_code ec{};
+    std::filesystem::permissions(
+        dir,
+        writable ? std::filesystem::perms::owner_write : kWritePermissions,
+        writable ? std::filesystem::perm_options::add
+                 : std::filesystem::perm_options::remove,
+        ec);
+    if (ec) {
+        Logger::Log(LogLevel::Debug,
+                    "Changing permissions of {} failed with:\n{}",
+                    dir.string(),
+                    ec.message());
+        return false;
+    }
+    return true;
+}
+
+/// \brief Make all directories strictly below the given one read-only.
+[[nodiscard]] auto MakeSubdirectoriesReadOnly(
+    std::filesystem::path const& dir) noexcept -> bool {
+    try {
+        for (auto const& entry :
+             std::filesystem::recursive_directory_iterator{dir}) {
+            if (entry.is_directory() and not entry.is_symlink() and
+                not SetWritable(entry.path(), false)) {
+                return false;
+            }
+        }
+        return true;
+    } catch (std::exception const& ex) {
+        Logger::Log(LogLevel::Debug,
+                    "Making {} read-only failed with:\n{}",
+                    dir.string(),
+                    ex.what());
+    }
+    return false;
+}
+
+[[nodiscard]] auto ToNanoseconds(struct timespec const& ts) noexcept
+    -> std::int64_t {
+    return static_cast<std::int64_t>(ts.tv_sec) * 1'000'000'000 +
+           static_cast<std::int64_t>(ts.tv_nsec);
+}
+
+}  // namespace
+
+auto LocalStagingCache::Create(
+    gsl::not_null<StorageConfig const*> const& storage_config) noexcept
+    -> std::shared_ptr<LocalStagingCache> {
+    if (::geteuid() == 0) {
+        Logger::Log(LogLevel::Warning,
+                    "Cached staging of inputs is not supported for the super "
+                    "user, staging inputs regularly.");
+        return nullptr;
+    }
+    auto pool = storage_config->CreateTypedTmpDir("staging");
+    if (pool == nullptr) {
+        Logger::Log(LogLevel::Warning,
+                    "Failed to create staging cache, staging inputs "
+                    "regularly.");
+        return nullptr;
+    }
+    try {
+        return std::make_shared<LocalStagingCache>(std::move(pool));
+    } catch (...) {
+        return nullptr;
+    }
+}
+
+LocalStagingCache::~LocalStagingCache() noexcept {
+    // Enable the removal of the pool by its temporary directory.
+    MakeWritable(pool_->GetPath());
+}
+
+void LocalStagingCache::MakeWritable(
+    std::filesystem::path const& dir) noexcept {
+    if (not SetWritable(dir, true)) {
+        return;
+    }
+    try {
+        // Directories are made writable before being descended into.
+        for (auto const& entry :
+             std::filesystem::recursive_directory_iterator{dir}) {
+            if (entry.is_directory() and not entry.is_symlink()) {
+                std::ignore = SetWritable(entry.path(), true);
+            }
+        }
+    } catch (std::exception const& ex) {
+        Logger::Log(LogLevel::Debug,
+                    "Making {} writable failed with:\n{}",
+                    dir.string(),
+                    ex.what());
+    }
+}
+
+auto LocalStagingCache::Claim(ArtifactDigest const& tree,
+                              std::filesystem::path const& target,
+                              Materializer const& materialize) noexcept
+    -> ListingPtr {
+    std::optional<IdleCopy> copy{};
+    try {
+        std::unique_lock lock{mutex_};
+        if (auto it = idle_by_tree_.find(tree); it != idle_by_tree_.end()) {
+            // take the most recently released copy
+            auto const pos = it->second.back();
+            copy = std::move(*pos);
+            idle_entries_ -= copy->listing->size();
+            idle_.erase(pos);
+            it->second.pop_back();
+            if (it->second.empty()) {
+                idle_by_tree_.erase(it);
+            }
+        }
+    } catch (...) {
+        return nullptr;
+    }
+
+    if (not copy) {
+        // Materialize a new copy; its root stays writable while in the pool,
+        // as moving a directory to another parent requires write permission.
+        copy = IdleCopy{.tree = tree, .path = NewPoolPath(), .listing = {}};
+        if (copy->path.empty() or not materialize(copy->path) or
+            not MakeSubdirectoriesReadOnly(copy->path)) {
+            Discard(copy->path);
+            return nullptr;
+        }
+    }
+
+    if (not FileSystemManager::CreateDirectory(target.parent_path()) or
+        not FileSystemManager::Rename(copy->path, target)) {
+        Discard(copy->path);
+        return nullptr;
+    }
+    if (copy->listing == nullptr) {
+        // list the copy as staged, i.e., with a read-only root
+        auto listing = SetWritable(target, false)
+                           ? List(target)
+                           : std::optional<Listing>{};
+        try {
+            if (listing) {
+                copy->listing =
+                    std::make_shared<Listing const>(*std::move(listing));
+            }
+        } catch (...) {
+            copy->listing = nullptr;
+        }
+    }
+    else if (not SetWritable(target, false)) {
+        copy->listing = nullptr;
+    }
+    if (copy->listing == nullptr) {
+        // not tracked as staged, so leave it removable with the build root
+        MakeWritable(target);
+    }
+    return copy->listing;
+}
+
+auto LocalStagingCache::Release(ArtifactDigest const& tree,
+                                std::filesystem::path const& staged,
+                                ListingPtr const& listing) noexcept -> bool {
+    // Only return copies unmodified by the action; all others are removed
+    // with the build root.
+    if (auto const current = List(staged); current != *listing) {
+        Logger::Log(LogLevel::Debug,
+                    "Staged tree {} was modified, not reusing it.",
+                    staged.string());
+        return false;
+    }
+    auto const copy = NewPoolPath();
+    if (copy.empty() or not SetWritable(staged, true) or
+        not FileSystemManager::Rename(staged, copy)) {
+        return false;
+    }
+    std::vector<std::filesystem::path> excess{};
+    try {
+        std::unique_lock lock{mutex_};
+        auto const pos = idle_.insert(
+            idle_.end(),
+            IdleCopy{.tree = tree, .path = copy, .listing = listing});
+        try {
+            idle_by_tree_[tree].emplace_back(pos);
+        } catch (...) {
+            idle_.erase(pos);
+            throw;
+        }
+        idle_entries_ += listing->size();
+        excess = TakeExcessCopies();
+    } catch (...) {
+        Discard(copy);
+        return true;
+    }
+    for (auto const& path : excess) {
+        Discard(path);
+    }
+    return true;
+}
+
+auto LocalStagingCache::TakeExcessCopies()
+    -> std::vector<std::filesystem::path> {
+    std::vector<std::filesystem::path> excess{};
+    while (idle_entries_ > max_idle_entries_ and not idle_.empty()) {
+        auto& least_recent = idle_.front();
+        auto it = idle_by_tree_.find(least_recent.tree);
+        if (it != idle_by_tree_.end()) {
+            // copies of a tree are ordered by release as well
+            it->second.erase(it->second.begin());
+            if (it->second.empty()) {
+                idle_by_tree_.erase(it);
+            }
+        }
+        idle_entries_ -= least_recent.listing->size();
+        excess.emplace_back(std::move(least_recent.path));
+        idle_.pop_front();
+    }
+    return excess;
+}
+
+auto LocalStagingCache::List(std::filesystem::path const& copy) noexcept
+    -> std::optional<Listing> {
+    try {
+        struct stat st{};
+        if (::lstat(copy.c_str(), &st) != 0 or not S_ISDIR(st.st_mode) or
+            (st.st_mode & (S_IWUSR | S_IWGRP | S_IWOTH)) != 0) {
+            return std::nullopt;
+        }
+        Listing listing{};
+        for (auto const& entry :
+             std::filesystem::recursive_directory_iterator{copy}) {
+            if (::lstat(entry.path().c_str(), &st) != 0) {
+                return std::nullopt;
+            }
+            bool const is_dir = S_ISDIR(st.st_mode);
+            listing.emplace_back(EntryStat{
+                .path = entry.path().lexically_relative(copy).string(),
+                .inode = static_cast<std::uint64_t>(st.st_ino),
+                .ctime_ns = is_dir ? ToNanoseconds(st.st_ctim) : 0,
+                .mode = static_cast<std::uint32_t>(st.st_mode)});
+        }
+        std::sort(listing.begin(),
+                  listing.end(),
+                  [](EntryStat const& lhs, EntryStat const& rhs) {
+                      return lhs.path < rhs.path;
+                  });
+        return listing;
+    } catch (std::exception const& ex) {
+        Logger::Log(LogLevel::Debug,
+                    "Inspecting {} failed with:\n{}",
+                    copy.string(),
+                    ex.what());
+    }
+    return std::nullopt;
+}
+
+void LocalStagingCache::Discard(std::filesystem::path const& copy) noexcept {
+    MakeWritable(copy);
+    std::ignore = FileSystemManager::RemoveDirectory(copy);
+}
+
+auto LocalStagingCache::NewPoolPath() noexcept -> std::filesystem::path {
+    try {
+        std::unique_lock lock{mutex_};
+        return pool_->GetPath() / std::to_string(next_id_++);
+    } catch (...) {
+        return {};
+    }
+}
+
+LocalStagingCache::StagedTrees::~StagedTrees() noexcept {
+    bool released = true;
+    for (auto const& copy : staged_) {
+        released = cache_->Release(copy.tree, copy.path, copy.listing) and
+                   released;
+    }
+    if (not released) {
+        // A staged tree was moved by the action, so its directories have to
+        // be found for the build root to be removable.
+        MakeWritable(root_);
+    }
+}
+
+auto LocalStagingCache::StagedTrees::Stage(
+    ArtifactDigest const& tree,
+    std::filesystem::path const& target,
+    Materializer const& materialize) noexcept -> bool {
+    if (cache_ == nullptr) {
+        return false;
+    }
+    try {
+        staged_.reserve(staged_.size() + 1);
+    } catch (...) {
+        return false;
+    }
+    auto listing = cache_->Claim(tree, target, materialize);
+    if (listing == nullptr) {
+        return false;
+    }
+    staged_.emplace_back(StagedCopy{
+        .tree = tree, .path = target, .listing = std::move(listing)});
+    return true;
+}
@@ -0,0 +1,183 @@
+// Copyright 2026 Huawei Cloud Computing Technology Co., Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef INCLUDED_SRC_BUILDTOOL_EXECUTION_API_LOCAL_LOCAL_STAGING_CACHE_HPP
+#define INCLUDED_SRC_BUILDTOOL_EXECUTION_API_LOCAL_LOCAL_STAGING_CACHE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "gsl/gsl"
+#include "src/buildtool/common/artifact_digest.hpp"
+#include "src/buildtool/storage/config.hpp"
+#include "src/utils/cpp/tmp_dir.hpp"
+
+/// \brief Pool of input trees materialized for local execution. An input tree
+/// not written to by an action is staged by moving a materialized copy of it
+/// into the action's build root, and moving it back to the pool afterwards.
+/// Hence, every input tree is materialized once per concurrent use instead of
+/// once per action. While staged, all directories of a copy are read-only, so
+/// that the copies in the pool remain identical to the tree they represent.
+/// Copies modified nevertheless are not returned to the pool. The number of
+/// directory entries of idle copies is bounded by removing the least recently
+/// returned copies.
+class LocalStagingCache final {
+  public:
+    class StagedTrees;
+
+    /// \brief Materialize a tree to the given, not yet existing, directory.
+    using Materializer = std::function<bool(std::filesystem::path const&)>;
+
+    /// \brief Create a staging cache in the ephemeral root of the storage.
+    /// \returns nullptr if no staging cache can be used. This is the case for
+    /// the super user, for whom read-only directories are still writable.
+    [[nodiscard]] static auto Create(
+        gsl::not_null<StorageConfig const*> const& storage_config) noexcept
+        -> std::shared_ptr<LocalStagingCache>;
+
+    /// \brief Default limit on the number of directory entries of all idle
+    /// copies in the pool.
+    static constexpr std::size_t kDefaultMaxIdleEntries = std::size_t{1}
+                                                          << 20U;
+
+    /// \param pool                Directory to materialize the copies in.
+    /// \param max_idle_entries    Limit on the number of directory entries of
+    ///                             all idle copies.
+    explicit LocalStagingCache(
+        TmpDir::Ptr pool,
+        std::size_t max_idle_entries = kDefaultMaxIdleEntries) noexcept
+        : pool_{std::move(pool)}, max_idle_entries_{max_idle_entries} {}
+
+    LocalStagingCache(LocalStagingCache const&) = delete;
+    LocalStagingCache(LocalStagingCache&&) = delete;
+    auto operator=(LocalStagingCache const&) -> LocalStagingCache& = delete;
+    auto operator=(LocalStagingCache&&) -> LocalStagingCache& = delete;
+    ~LocalStagingCache() noexcept;
+
+    /// \brief Make all directories below and including the given one writable
+    /// again, e.g., to be able to remove them.
+    static void MakeWritable(std::filesystem::path const& dir) noexcept;
+
+  private:
+    /// \brief Stat data of an entry strictly below the root of a copy. Any
+    /// modification of a directory changes its ctime, and replacing a file or
+    /// symlink changes its inode.
+    struct EntryStat {
+        std::string path;
+        std::uint64_t inode{};
+        std::int64_t ctime_ns{};  // directories only
+        std::uint32_t mode{};
+
+        [[nodiscard]] auto operator==(EntryStat const& other) const noexcept
+            -> bool = default;
+    };
+
+    /// \brief Stat data of all entries of a copy, sorted by path.
+    using Listing = std::vector<EntryStat>;
+    using ListingPtr = std::shared_ptr<Listing const>;
+
+    struct IdleCopy {
+        ArtifactDigest tree;
+        std::filesystem::path path;
+        ListingPtr listing;
+    };
+    using IdleList = std::list<IdleCopy>;
+
+    TmpDir::Ptr pool_;
+    std::size_t max_idle_entries_;
+    std::mutex mutex_;
+    std::size_t next_id_{};
+    IdleList idle_;  // least recently released first
+    std::unordered_map<ArtifactDigest, std::vector<IdleList::iterator>>
+        idle_by_tree_;
+    std::size_t idle_entries_{};
+
+    /// \brief Stage a copy of the tree at the given path, materializing a new
+    /// copy if no idle one is available.
+    /// \returns The listing of the staged copy or nullptr on failure.
+    [[nodiscard]] auto Claim(ArtifactDigest const& tree,
+                             std::filesystem::path const& target,
+                             Materializer const& materialize) noexcept
+        -> ListingPtr;
+
+    /// \brief Return a copy of the tree staged at the given path to the pool,
+    /// if it still matches the listing it was staged with. Copies beyond the
+    /// limit of idle entries are removed, least recently released first.
+    [[nodiscard]] auto Release(ArtifactDigest const& tree,
+                               std::filesystem::path const& staged,
+                               ListingPtr const& listing) noexcept -> bool;
+
+    /// \brief Remove the idle copies exceeding the limit of idle entries from
+    /// the bookkeeping. Must be called with the mutex held.
+    [[nodiscard]] auto TakeExcessCopies() -> std::vector<std::filesystem::path>;
+
+    /// \brief Obtain the listing of a copy, nullopt if it is not a read-only
+    /// directory or cannot be inspected.
+    [[nodiscard]] static auto List(std::filesystem::path const& copy) noexcept
+        -> std::optional<Listing>;
+
+    /// \brief Remove a copy that is not part of the pool anymore.
+    static void Discard(std::filesystem::path const& copy) noexcept;
+
+    [[nodiscard]] auto NewPoolPath() noexcept -> std::filesystem::path;
+};
+
+/// \brief The trees staged from a staging cache into one build root. All
+/// trees are returned to the cache on destruction.
+class LocalStagingCache::StagedTrees final {
+  public:
+    /// \param cache    The staging cache to use, may be nullptr.
+    /// \param root     The build root the trees are staged into.
+    StagedTrees(std::shared_ptr<LocalStagingCache> cache,
+                std::filesystem::path root) noexcept
+        : cache_{std::move(cache)}, root_{std::move(root)} {}
+
+    StagedTrees(StagedTrees const&) = delete;
+    StagedTrees(StagedTrees&&) = delete;
+    auto operator=(StagedTrees const&) -> StagedTrees& = delete;
+    auto operator=(StagedTrees&&) -> StagedTrees& = delete;
+    ~StagedTrees() noexcept;
+
+    [[nodiscard]] auto IsEnabled() const noexcept -> bool {
+        return cache_ != nullptr;
+    }
+
+    /// \brief Stage the tree at the given path inside the build root.
+    [[nodiscard]] auto Stage(ArtifactDigest const& tree,
+                             std::filesystem::path const& target,
+                             Materializer const& materialize) noexcept -> bool;
+
+  private:
+    struct StagedCopy {
+        ArtifactDigest tree;
+        std::filesystem::path path;
+        ListingPtr listing;
+    };
+
+    std::shared_ptr<LocalStagingCache> cache_;
+    std::filesystem::path root_;
+    std::vector<StagedCopy> staged_;
+};
+
+#endif  // INCLUDED_SRC_BUILDTOOL_EXECUTION_API_LOCAL_LOCAL_STAGING_CACHE_HPP
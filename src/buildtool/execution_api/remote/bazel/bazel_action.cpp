@@ -16,7 +16,10 @@
 
 #include <algorithm>
 #include <compare>
+#include <exception>
 #include <functional>
+#include <memory>
+#include <string>
 #include <utility>  // std::move
 
 #include "gsl/gsl"
@@ -59,8 +62,82 @@ BazelAction::BazelAction(std::shared_ptr<BazelNetwork> network,
     }
 }
 
+template <typename... Args>
+auto BazelAction::CreateResponse(Logger const* logger,
+                                 std::string const& action_hash,
+                                 Args&&... args) noexcept
+    -> IExecutionResponse::Ptr {
+    try {
+        return IExecutionResponse::Ptr{
+            new BazelResponse{action_hash, std::forward<Args>(args)...}};
+    } catch (...) {
+        if (logger != nullptr) {
+            logger->Emit(LogLevel::Error,
+                         "failed to create a response for {}",
+                         action_hash);
+        }
+    }
+    return nullptr;
+}
+
 auto BazelAction::Execute(Logger const* logger) noexcept
     -> IExecutionResponse::Ptr {
+    auto prepared = Prepare(logger);
+    if (auto* response = std::get_if<IExecutionResponse::Ptr>(&prepared)) {
+        return std::move(*response);
+    }
+    auto const& action = std::get<bazel_re::Digest>(prepared);
+    return CreateExecutedResponse(
+        logger, action, network_->ExecuteBazelActionSync(action));
+}
+
+void BazelAction::ExecuteAsync(Logger const* logger,
+                               AsyncCallback const& callback) noexcept {
+    // The callback is invoked exactly once, either by the completion of the
+    // remote execution or here, outside of the exception handler, so that an
+    // exception thrown by the callback itself is not mistaken for a failure to
+    // start the execution.
+    std::shared_ptr<IExecutionResponse::Ptr> result{};
+    try {
+        // Cache lookup and upload of inputs happen on the calling thread, only
+        // the remote execution itself is awaited asynchronously.
+        auto prepared = Prepare(logger);
+        if (auto* response = std::get_if<IExecutionResponse::Ptr>(&prepared)) {
+            result =
+                std::make_shared<IExecutionResponse::Ptr>(std::move(*response));
+        }
+        else {
+            auto action = std::get<bazel_re::Digest>(std::move(prepared));
+            auto on_done = [this, logger, action, callback](
+                               BazelExecutionClient::ExecutionResponse
+                                   response) {
+                callback([this, logger, action, response]() {
+                    return CreateExecutedResponse(
+                        logger,
+                        action,
+                        network_->FinishBazelActionAsync(action, response));
+                });
+            };
+            network_->ExecuteBazelActionAsync(action, std::move(on_done));
+            return;
+        }
+    } catch (std::exception const& ex) {
+        if (logger != nullptr) {
+            logger->Emit(LogLevel::Error,
+                         "failed to start execution for {}:\n{}",
+                         root_digest_.hash(),
+                         ex.what());
+        }
+    }
+    if (result != nullptr) {
+        callback([result]() { return std::move(*result); });
+        return;
+    }
+    callback([]() { return IExecutionResponse::Ptr{}; });
+}
+
+auto BazelAction::Prepare(Logger const* logger) const noexcept
+    -> std::variant<IExecutionResponse::Ptr, bazel_re::Digest> {
     std::unordered_set<ArtifactBlob> blobs{};
     auto do_cache = CacheEnabled(cache_flag_);
     auto action = CreateBundlesForAction(&blobs, root_digest_, not do_cache);
@@ -70,7 +147,7 @@ auto BazelAction::Execute(Logger const* logger) noexcept
                          "failed to create an action digest for {}",
                          root_digest_.hash());
         }
-        return nullptr;
+        return IExecutionResponse::Ptr{};
     }
 
     if (logger != nullptr) {
@@ -82,22 +159,6 @@ auto BazelAction::Execute(Logger const* logger) noexcept
                      action->hash());
     }
 
-    auto create_response = [](Logger const* logger,
-                              std::string const& action_hash,
-                              auto&&... args) -> IExecutionResponse::Ptr {
-        try {
-            return IExecutionResponse::Ptr{new BazelResponse{
-                action_hash, std::forward<decltype(args)>(args)...}};
-        } catch (...) {
-            if (logger != nullptr) {
-                logger->Emit(LogLevel::Error,
-                             "failed to create a response for {}",
-                             action_hash);
-            }
-        }
-        return nullptr;
-    };
-
     if (do_cache) {
         if (auto result = network_->GetCachedActionResult(
                 *action,
@@ -108,7 +169,7 @@ auto BazelAction::Execute(Logger const* logger) noexcept
                            *result, output_files_, output_dirs_)
                      : ActionResultContainsExpectedOutputs(*result,
                                                            output_paths_))) {
-                return create_response(
+                return CreateResponse(
                     logger,
                     action->hash(),
                     network_,
@@ -120,33 +181,37 @@ auto BazelAction::Execute(Logger const* logger) noexcept
 
     if (ExecutionEnabled(cache_flag_) and
         network_->UploadBlobs(std::move(blobs))) {
-        if (auto output = network_->ExecuteBazelActionSync(*action)) {
-            if (cache_flag_ == CacheFlag::PretendCached) {
-                // ensure the same id is created as if caching were enabled
-                auto action_cached =
-                    CreateBundlesForAction(nullptr, root_digest_, false);
-                if (not action_cached) {
-                    if (logger != nullptr) {
-                        logger->Emit(
-                            LogLevel::Error,
-                            "failed to create a cached action digest for {}",
-                            root_digest_.hash());
-                    }
-                    return nullptr;
-                }
+        return *std::move(action);
+    }
+    return IExecutionResponse::Ptr{};
+}
 
-                output->cached_result = true;
-                return create_response(logger,
-                                       action_cached->hash(),
-                                       network_,
-                                       *std::move(output));
+auto BazelAction::CreateExecutedResponse(
+    Logger const* logger,
+    bazel_re::Digest const& action,
+    std::optional<BazelExecutionClient::ExecutionOutput> output) const noexcept
+    -> IExecutionResponse::Ptr {
+    if (not output) {
+        return nullptr;
+    }
+    if (cache_flag_ == CacheFlag::PretendCached) {
+        // ensure the same id is created as if caching were enabled
+        auto action_cached =
+            CreateBundlesForAction(nullptr, root_digest_, false);
+        if (not action_cached) {
+            if (logger != nullptr) {
+                logger->Emit(LogLevel::Error,
+                             "failed to create a cached action digest for {}",
+                             root_digest_.hash());
             }
-            return create_response(
-                logger, action->hash(), network_, *std::move(output));
+            return nullptr;
         }
-    }
 
-    return nullptr;
+        output->cached_result = true;
+        return CreateResponse(
+            logger, action_cached->hash(), network_, *std::move(output));
+    }
+    return CreateResponse(logger, action.hash(), network_, *std::move(output));
 }
 
 auto BazelAction::CreateBundlesForAction(
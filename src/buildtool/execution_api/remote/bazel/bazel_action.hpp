@@ -22,6 +22,7 @@
 #include <optional>
 #include <string>
 #include <unordered_set>
+#include <variant>
 #include <vector>
 
 #include "src/buildtool/common/artifact_blob.hpp"
@@ -29,6 +30,7 @@
 #include "src/buildtool/common/bazel_types.hpp"
 #include "src/buildtool/execution_api/common/execution_action.hpp"
 #include "src/buildtool/execution_api/common/execution_response.hpp"
+#include "src/buildtool/execution_api/remote/bazel/bazel_execution_client.hpp"
 #include "src/buildtool/execution_api/remote/bazel/bazel_network.hpp"
 #include "src/buildtool/logging/logger.hpp"
 
@@ -45,6 +47,8 @@ class BazelAction final : public IExecutionAction {
   public:
     auto Execute(Logger const* logger) noexcept
         -> IExecutionResponse::Ptr final;
+    void ExecuteAsync(Logger const* logger,
+                      AsyncCallback const& callback) noexcept final;
     void SetCacheFlag(CacheFlag flag) noexcept final { cache_flag_ = flag; }
     void SetTimeout(std::chrono::milliseconds timeout) noexcept final {
         timeout_ = timeout;
@@ -74,6 +78,24 @@ class BazelAction final : public IExecutionAction {
                          std::map<std::string, std::string> const& properties,
                          bool best_effort) noexcept;
 
+    template <typename... Args>
+    [[nodiscard]] static auto CreateResponse(Logger const* logger,
+                                             std::string const& action_hash,
+                                             Args&&... args) noexcept
+        -> IExecutionResponse::Ptr;
+
+    /// \brief Look up the action cache and upload the inputs for execution.
+    /// \returns The response if served from cache, nullptr on failure, and
+    /// otherwise the digest of the action to execute.
+    [[nodiscard]] auto Prepare(Logger const* logger) const noexcept
+        -> std::variant<IExecutionResponse::Ptr, bazel_re::Digest>;
+
+    [[nodiscard]] auto CreateExecutedResponse(
+        Logger const* logger,
+        bazel_re::Digest const& action,
+        std::optional<BazelExecutionClient::ExecutionOutput> output)
+        const noexcept -> IExecutionResponse::Ptr;
+
     [[nodiscard]] auto CreateBundlesForAction(
         std::unordered_set<ArtifactBlob>* blobs,
         ArtifactDigest const& exec_dir,
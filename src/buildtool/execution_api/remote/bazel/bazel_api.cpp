@@ -23,6 +23,7 @@
 #include <iterator>
 #include <mutex>
 #include <new>
+#include <unordered_map>
 #include <unordered_set>
 #include <utility>  // std::move
 
@@ -35,6 +36,7 @@
 #include "src/buildtool/execution_api/bazel_msg/directory_tree.hpp"
 #include "src/buildtool/execution_api/bazel_msg/execution_config.hpp"
 #include "src/buildtool/execution_api/common/common_api.hpp"
+#include "src/buildtool/execution_api/common/message_limits.hpp"
 #include "src/buildtool/execution_api/common/stream_dumper.hpp"
 #include "src/buildtool/execution_api/common/tree_reader.hpp"
 #include "src/buildtool/execution_api/remote/bazel/bazel_action.hpp"
@@ -54,6 +56,11 @@ namespace {
 auto constexpr kVersion2dot1 =
     Capabilities::Version{.major = 2, .minor = 1, .patch = 0};
 
+// Upper bound on the size of objects retrieved to memory. Larger objects have
+// to be retrieved to a CAS or to the file system, which never hold them in
+// memory as a whole.
+auto constexpr kMaxRetrieveToMemorySize = std::size_t{1} << 30U;
+
 [[nodiscard]] auto RetrieveToCas(
     std::unordered_set<Artifact::ObjectInfo> const& infos,
     IExecutionApi const& api,
@@ -125,6 +132,276 @@ auto constexpr kVersion2dot1 =
     return true;
 }
 
+/// \brief Pipeline synchronizing objects, including the content of trees, from
+/// a remote CAS to another CAS. Discovering tree entries, checking which
+/// objects are missing in the other CAS, and transferring those objects happen
+/// concurrently on a single pool of workers. Checks and transfers are batched;
+/// a batch is dispatched once it is full, or as soon as nothing is running
+/// anymore that could add to it. A tree is only transferred after all of its
+/// entries are available in the other CAS. Trees to synchronize are fetched as
+/// a whole, so that reading their subtrees takes no further round trips.
+class RetrievalPipeline final {
+  public:
+    RetrievalPipeline(IExecutionApi const& this_api,
+                      IExecutionApi const& other_api,
+                      std::shared_ptr<BazelNetwork> network,
+                      bool use_blob_splitting) noexcept
+        : this_api_{this_api},
+          other_api_{other_api},
+          network_{std::move(network)},
+          reader_{network_->CreateReader()},
+          use_blob_splitting_{use_blob_splitting} {}
+
+    /// \brief Synchronize the given objects using the given number of jobs.
+    /// \returns Whether all objects are available in the other CAS.
+    [[nodiscard]] auto Run(std::vector<Artifact::ObjectInfo> const& infos,
+                           std::size_t jobs) noexcept -> bool {
+        try {
+            {
+                TaskSystem ts{jobs};
+                std::unique_lock lock{mutex_};
+                ts_ = &ts;
+                for (auto const& info : infos) {
+                    Add(info, nullptr);
+                }
+                Dispatch();
+            }
+            ts_ = nullptr;
+            if (failed_) {
+                return false;
+            }
+            auto const all_done = std::all_of(
+                nodes_.begin(), nodes_.end(), [](auto const& node) {
+                    return node.second.done;
+                });
+            if (not all_done) {
+                Logger::Log(LogLevel::Error,
+                            "BazelApi: Not all objects were synchronized");
+            }
+            return all_done;
+        } catch (std::exception const& ex) {
+            Logger::Log(LogLevel::Warning,
+                        "Artifact synchronization failed: {}",
+                        ex.what());
+        }
+        return false;
+    }
+
+  private:
+    // Upper estimate of the size of a digest in a request, used to size the
+    // batches of digests to check.
+    static constexpr std::size_t kDigestSizeEstimate = 128;
+    static constexpr std::size_t kMaxCheckBatch =
+        MessageLimits::kMaxGrpcLength / kDigestSizeEstimate;
+
+    using Batch = std::vector<Artifact::ObjectInfo>;
+
+    struct Node final {
+        // Number of tree entries not yet available in the other CAS.
+        std::size_t pending_entries{};
+        // Trees waiting for this object to become available.
+        std::vector<Artifact::ObjectInfo> waiting_trees{};
+        bool done{};
+        // Whether the object was requested, rather than found in a tree.
+        bool requested{};
+    };
+
+    IExecutionApi const& this_api_;
+    IExecutionApi const& other_api_;
+    std::shared_ptr<BazelNetwork> network_;
+    // Shared by all tasks, so that prefetched trees serve all of them.
+    TreeReader<BazelNetworkReader> const reader_;
+    bool use_blob_splitting_;
+
+    // Everything below is guarded by mutex_, only failed_ is read without it.
+    std::mutex mutex_;
+    TaskSystem* ts_{nullptr};
+    std::unordered_map<Artifact::ObjectInfo, Node> nodes_;
+    Batch to_check_;
+    Batch to_transfer_;
+    std::size_t to_transfer_size_{};
+    // Number of check and read tasks queued or running. These are the tasks
+    // discovering new objects, so partial batches have to wait for them.
+    std::size_t discovering_{};
+    std::atomic_bool failed_{false};
+
+    /// \brief Register an object, optionally as entry of the given tree.
+    void Add(Artifact::ObjectInfo const& info,
+             Artifact::ObjectInfo const* tree) {
+        auto [it, inserted] = nodes_.try_emplace(info);
+        if (it->second.done) {
+            return;
+        }
+        if (tree != nullptr) {
+            it->second.waiting_trees.emplace_back(*tree);
+            ++nodes_.at(*tree).pending_entries;
+        }
+        else {
+            it->second.requested = true;
+        }
+        if (inserted) {
+            to_check_.emplace_back(info);
+            if (to_check_.size() >= kMaxCheckBatch) {
+                QueueCheck(std::exchange(to_check_, {}));
+            }
+        }
+    }
+
+    /// \brief Schedule the transfer of an object missing in the other CAS.
+    void AddTransfer(Artifact::ObjectInfo const& info) {
+        auto const size = info.digest.size();
+        if (size > MessageLimits::kMaxGrpcLength) {
+            // Does not fit into a batch; transfer on its own.
+            QueueTransfer({info}, /*split=*/use_blob_splitting_);
+            return;
+        }
+        if (to_transfer_size_ + size > MessageLimits::kMaxGrpcLength) {
+            QueueTransfer(std::exchange(to_transfer_, {}), /*split=*/false);
+            to_transfer_size_ = 0;
+        }
+        to_transfer_.emplace_back(info);
+        to_transfer_size_ += size;
+    }
+
+    /// \brief Mark an object as available in the other CAS and schedule the
+    /// transfer of the trees that were only waiting for it.
+    void MarkDone(Artifact::ObjectInfo const& info) {
+        auto& node = nodes_.at(info);
+        node.done = true;
+        for (auto const& tree : std::exchange(node.waiting_trees, {})) {
+            if (--nodes_.at(tree).pending_entries == 0) {
+                AddTransfer(tree);
+            }
+        }
+    }
+
+    /// \brief Dispatch partial batches if no running task could extend them.
+    void Dispatch() {
+        if (discovering_ > 0) {
+            return;
+        }
+        if (not to_check_.empty()) {
+            QueueCheck(std::exchange(to_check_, {}));
+        }
+        if (not to_transfer_.empty()) {
+            QueueTransfer(std::exchange(to_transfer_, {}), /*split=*/false);
+            to_transfer_size_ = 0;
+        }
+    }
+
+    void QueueCheck(Batch batch) {
+        ++discovering_;
+        ts_->QueueTask([this, batch = std::move(batch)]() {
+            Finish(/*discovering=*/true, [this, &batch]() { Check(batch); });
+        });
+    }
+
+    void QueueRead(Artifact::ObjectInfo const& tree, bool prefetch) {
+        ++discovering_;
+        ts_->QueueTask([this, tree, prefetch]() {
+            Finish(/*discovering=*/true,
+                   [this, &tree, prefetch]() { Read(tree, prefetch); });
+        });
+    }
+
+    void QueueTransfer(Batch batch, bool split) {
+        ts_->QueueTask([this, batch = std::move(batch), split]() {
+            Finish(/*discovering=*/false, [this, &batch, split]() {
+                Transfer(batch, split);
+            });
+        });
+    }
+
+    /// \brief Run the stage of a task, and dispatch whatever became ready.
+    template <class TStage>
+    void Finish(bool discovering, TStage const& stage) noexcept {
+        try {
+            if (not failed_) {
+                stage();
+            }
+        } catch (std::exception const& ex) {
+            Logger::Log(LogLevel::Warning,
+                        "Artifact synchronization failed: {}",
+                        ex.what());
+            failed_ = true;
+        }
+        try {
+            std::unique_lock lock{mutex_};
+            if (discovering) {
+                --discovering_;
+            }
+            if (not failed_) {
+                Dispatch();
+            }
+        } catch (...) {
+            failed_ = true;
+        }
+    }
+
+    void Check(Batch const& batch) {
+        std::unordered_set<ArtifactDigest> digests;
+        digests.reserve(batch.size());
+        for (auto const& info : batch) {
+            digests.emplace(info.digest);
+        }
+        auto const missing = other_api_.GetMissingDigests(digests);
+
+        std::unique_lock lock{mutex_};
+        for (auto const& info : batch) {
+            if (not missing.contains(info.digest)) {
+                MarkDone(info);
+            }
+            else if (IsTreeObject(info.type)) {
+                // subtrees of requested trees are prefetched along with them
+                QueueRead(info, /*prefetch=*/nodes_.at(info).requested);
+            }
+            else {
+                AddTransfer(info);
+            }
+        }
+    }
+
+    void Read(Artifact::ObjectInfo const& tree, bool prefetch) {
+        if (prefetch) {
+            reader_.PrefetchTree(tree.digest);
+        }
+        auto const result =
+            reader_.ReadDirectTreeEntries(tree.digest, std::filesystem::path{});
+        if (not result) {
+            failed_ = true;
+            return;
+        }
+
+        std::unique_lock lock{mutex_};
+        for (auto const& entry : result->infos) {
+            Add(entry, &tree);
+        }
+        if (nodes_.at(tree).pending_entries == 0) {
+            AddTransfer(tree);
+        }
+    }
+
+    void Transfer(Batch const& batch, bool split) {
+        auto const transferred =
+            split ? ::RetrieveToCasSplitted(
+                        batch.front(), this_api_, other_api_, network_)
+                  : ::RetrieveToCas(
+                        std::unordered_set<Artifact::ObjectInfo>(batch.begin(),
+                                                                 batch.end()),
+                        other_api_,
+                        network_);
+        if (not transferred) {
+            failed_ = true;
+            return;
+        }
+
+        std::unique_lock lock{mutex_};
+        for (auto const& info : batch) {
+            MarkDone(info);
+        }
+    }
+};
+
 }  // namespace
 
 BazelApi::BazelApi(std::string const& instance_name,
@@ -364,138 +641,35 @@ auto BazelApi::CreateAction(
     if (this == &api) {
         return true;
     }
-    std::unordered_set<Artifact::ObjectInfo> done{};
-    return ParallelRetrieveToCasWithCache(
-        artifacts_info, api, jobs, use_blob_splitting, &done);
-}
-
-[[nodiscard]] auto BazelApi::ParallelRetrieveToCasWithCache(
-    std::vector<Artifact::ObjectInfo> const& all_artifacts_info,
-    IExecutionApi const& api,
-    std::size_t jobs,
-    bool use_blob_splitting,
-    gsl::not_null<std::unordered_set<Artifact::ObjectInfo>*> done)
-    const noexcept -> bool {
-    std::unordered_set<Artifact::ObjectInfo> artifacts_info;
-    try {
-        artifacts_info.reserve(all_artifacts_info.size());
-        for (auto const& info : all_artifacts_info) {
-            if (not done->contains(info)) {
-                artifacts_info.emplace(info);
-            }
-        }
-    } catch (std::exception const& ex) {
-        Logger::Log(
-            LogLevel::Error,
-            "BazelApi: Collecting the set of artifacts failed with:\n{}",
-            ex.what());
-        return false;
-    }
-    if (artifacts_info.empty()) {
-        return true;  // Nothing to do
-    }
-
-    // Determine missing artifacts in other CAS.
-    std::unordered_set<gsl::not_null<Artifact::ObjectInfo const*>> missing;
-    missing.reserve(artifacts_info.size());
-    {
-        auto back_map = BackMap<ArtifactDigest, Artifact::ObjectInfo>::Make(
-            &artifacts_info,
-            [](Artifact::ObjectInfo const& info) { return info.digest; });
-        if (back_map == nullptr) {
-            Logger::Log(LogLevel::Error, "BazelApi: Failed to create BackMap");
-            return false;
-        }
-        auto missing_digests = api.GetMissingDigests(back_map->GetKeys());
-        missing = back_map->GetReferences(missing_digests);
-    }
-
-    // Recursively process trees.
-    std::atomic_bool failure{false};
-    std::vector<Artifact::ObjectInfo> prerequisites{};
-    std::mutex prerequisites_lock{};
-    try {
-        auto ts = TaskSystem{jobs};
-        for (auto const& info : missing) {
-            if (not IsTreeObject(info->type)) {
-                continue;
-            }
-            ts.QueueTask(
-                [this, info, &failure, &prerequisites, &prerequisites_lock]() {
-                    auto reader = TreeReader<BazelNetworkReader>{
-                        network_->CreateReader()};
-                    auto const result = reader.ReadDirectTreeEntries(
-                        info->digest, std::filesystem::path{});
-                    if (not result) {
-                        failure = true;
-                        return;
-                    }
-                    std::unique_lock lock{prerequisites_lock};
-                    prerequisites.insert(prerequisites.end(),
-                                         result->infos.begin(),
-                                         result->infos.end());
-                });
-        }
-    } catch (std::exception const& ex) {
-        Logger::Log(LogLevel::Warning,
-                    "Artifact synchronization failed: {}",
-                    ex.what());
-        return false;
-    }
-
-    if (failure) {
-        return false;
-    }
-
-    if (not ParallelRetrieveToCasWithCache(
-            prerequisites, api, jobs, use_blob_splitting, done)) {
-        return false;
-    }
-
-    // In parallel process all the requested artifacts
-    try {
-        auto ts = TaskSystem{jobs};
-        for (auto const& info : missing) {
-            ts.QueueTask([this, info, &api, &failure, use_blob_splitting]() {
-                if (use_blob_splitting and network_->BlobSplitSupport() and
-                            api.BlobSpliceSupport()
-                        ? ::RetrieveToCasSplitted(*info, *this, api, network_)
-                        : ::RetrieveToCas({*info}, api, network_)) {
-                    return;
-                }
-                failure = true;
-            });
-        }
-    } catch (std::exception const& ex) {
-        Logger::Log(LogLevel::Warning,
-                    "Artifact synchronization failed: {}",
-                    ex.what());
-        return false;
-    }
-
-    if (failure) {
-        return false;
-    }
-
-    try {
-        for (auto const& info : artifacts_info) {
-            done->insert(info);
-        }
-    } catch (std::exception const& ex) {
-        Logger::Log(LogLevel::Warning,
-                    "Exception when updating set of synchronized objects "
-                    "(continuing anyway): {}",
-                    ex.what());
-    }
-
-    return true;
+    auto const split = use_blob_splitting and network_->BlobSplitSupport() and
+                       api.BlobSpliceSupport();
+    auto pipeline = RetrievalPipeline{*this, api, network_, split};
+    return pipeline.Run(artifacts_info, jobs);
 }
 
 [[nodiscard]] auto BazelApi::RetrieveToMemory(
     Artifact::ObjectInfo const& artifact_info) const noexcept
     -> std::optional<std::string> {
+    auto const too_large = [&artifact_info](std::size_t size) {
+        if (size <= kMaxRetrieveToMemorySize) {
+            return false;
+        }
+        Logger::Log(LogLevel::Error,
+                    "Object {} of size {} is too large to be retrieved to "
+                    "memory",
+                    artifact_info.digest.hash(),
+                    size);
+        return true;
+    };
+    if (too_large(artifact_info.digest.size())) {
+        return std::nullopt;
+    }
     auto reader = network_->CreateReader();
     if (auto blob = reader.ReadSingleBlob(artifact_info.digest)) {
+        // the size of the digest might have been unknown
+        if (too_large(blob->GetContentSize())) {
+            return std::nullopt;
+        }
         if (auto const content = blob->ReadContent()) {
             return *content;
         }
@@ -610,3 +784,8 @@ auto BazelApi::CreateAction(
 [[nodiscard]] auto BazelApi::GetTempSpace() const noexcept -> TmpDir::Ptr {
     return network_->GetTempSpace();
 }
+
+[[nodiscard]] auto BazelApi::TakesOwnershipOfFiles() const noexcept -> bool {
+    // blobs are only read for uploading
+    return false;
+}
@@ -104,6 +104,8 @@ class BazelApi final : public IExecutionApi {
         std::unordered_set<ArtifactDigest> const& digests) const noexcept
         -> std::unordered_set<ArtifactDigest> final;
 
+    /// \brief Retrieve one artifact to memory. Objects larger than 1 GiB are
+    /// refused; they have to be retrieved to a CAS or to the file system.
     [[nodiscard]] auto RetrieveToMemory(
         Artifact::ObjectInfo const& artifact_info) const noexcept
         -> std::optional<std::string> final;
@@ -124,16 +126,10 @@ class BazelApi final : public IExecutionApi {
 
     [[nodiscard]] auto GetTempSpace() const noexcept -> TmpDir::Ptr final;
 
+    [[nodiscard]] auto TakesOwnershipOfFiles() const noexcept -> bool final;
+
   private:
     std::shared_ptr<BazelNetwork> network_;
-
-    [[nodiscard]] auto ParallelRetrieveToCasWithCache(
-        std::vector<Artifact::ObjectInfo> const& all_artifacts_info,
-        IExecutionApi const& api,
-        std::size_t jobs,
-        bool use_blob_splitting,
-        gsl::not_null<std::unordered_set<Artifact::ObjectInfo>*> done)
-        const noexcept -> bool;
 };
 
 #endif  // INCLUDED_SRC_BUILDTOOL_EXECUTION_API_REMOTE_BAZEL_BAZEL_API_HPP
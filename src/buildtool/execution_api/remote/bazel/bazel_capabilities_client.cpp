@@ -37,6 +37,15 @@ namespace {
                                  .patch = version.patch()};
 }
 
+template <typename TCompressors>
+[[nodiscard]] auto SupportsDeflate(TCompressors const& compressors) noexcept
+    -> bool {
+    return std::any_of(
+        compressors.begin(), compressors.end(), [](auto compressor) {
+            return compressor == bazel_re::Compressor_Value_DEFLATE;
+        });
+}
+
 [[nodiscard]] auto Parse(std::optional<bazel_re::ServerCapabilities>
                              response) noexcept -> Capabilities {
     if (not response.has_value()) {
@@ -53,6 +62,9 @@ namespace {
     std::size_t max_batch = default_capabilities.MaxBatchTransferSize;
     bool split_support = default_capabilities.blob_split_support;
     bool splice_support = default_capabilities.blob_splice_support;
+    bool compression_support = default_capabilities.compression_support;
+    bool batch_compression_support =
+        default_capabilities.batch_compression_support;
     if (response->has_cache_capabilities()) {
         auto const& cache_capabilities = response->cache_capabilities();
         if (cache_capabilities.max_batch_total_size_bytes() != 0) {
@@ -63,11 +75,17 @@ namespace {
         }
         split_support = cache_capabilities.blob_split_support();
         splice_support = cache_capabilities.blob_splice_support();
+        compression_support =
+            SupportsDeflate(cache_capabilities.supported_compressors());
+        batch_compression_support = SupportsDeflate(
+            cache_capabilities.supported_batch_update_compressors());
     }
     return Capabilities{
         .MaxBatchTransferSize = max_batch,
         .blob_split_support = split_support,
         .blob_splice_support = splice_support,
+        .compression_support = compression_support,
+        .batch_compression_support = batch_compression_support,
         .low_api_version = response->has_deprecated_api_version()
                                ? ParseSemVer(response->deprecated_api_version())
                                : (response->has_low_api_version()  // NOLINT
@@ -144,11 +162,14 @@ auto BazelCapabilitiesClient::GetCapabilities(
     logger_.Emit(LogLevel::Debug,
                  "Obtained server capabilities for \"{}\":\n  - "
                  "max_batch_total_size_bytes: {}\n  - "
-                 "blob_split_support: {}\n  - blob_split_support: {}\n",
+                 "blob_split_support: {}\n  - blob_split_support: {}\n  - "
+                 "deflate_support: {}\n  - batch_deflate_support: {}\n",
                  instance_name,
                  result->MaxBatchTransferSize,
                  result->blob_split_support,
-                 result->blob_splice_support);
+                 result->blob_splice_support,
+                 result->compression_support,
+                 result->batch_compression_support);
 
     // Cache results only if they contain meaningful non-default capabilities or
     // there's no point in retrying:
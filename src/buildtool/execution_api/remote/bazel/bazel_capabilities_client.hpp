@@ -54,6 +54,8 @@ struct Capabilities final {
     std::size_t const MaxBatchTransferSize = MessageLimits::kMaxGrpcLength;
     bool const blob_split_support = false;
     bool const blob_splice_support = false;
+    bool const compression_support = false;
+    bool const batch_compression_support = false;
     Version const low_api_version = kMinVersion;
     Version const high_api_version = kMaxVersion;
 };
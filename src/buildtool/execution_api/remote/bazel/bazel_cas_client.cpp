@@ -15,6 +15,7 @@
 #include "src/buildtool/execution_api/remote/bazel/bazel_cas_client.hpp"
 
 #include <algorithm>
+#include <exception>
 #include <iterator>
 #include <sstream>
 #include <unordered_set>
@@ -29,6 +30,7 @@
 #include "src/buildtool/common/remote/retry.hpp"
 #include "src/buildtool/common/remote/retry_config.hpp"
 #include "src/buildtool/crypto/hash_function.hpp"
+#include "src/buildtool/execution_api/common/blob_compression.hpp"
 #include "src/buildtool/execution_api/common/message_limits.hpp"
 #include "src/buildtool/file_system/object_type.hpp"
 #include "src/buildtool/logging/log_level.hpp"
@@ -37,6 +39,13 @@
 
 namespace {
 
+// Number of directories requested per GetTree page.
+constexpr int kGetTreePageSize = 10000;
+
+// Upper bound on the size of directories fetched by a single GetTree call, to
+// bound the memory held by the caller; the remainder is read on demand.
+constexpr std::size_t kMaxGetTreeSize = 256UL * 1024 * 1024;
+
 [[nodiscard]] auto GetContentSize(bazel_re::Digest const& digest) noexcept
     -> std::size_t {
     return static_cast<std::size_t>(digest.size_bytes());
@@ -113,9 +122,15 @@ auto BazelCasClient::BatchReadBlobs(
         return result;
     }
 
-    auto request_creator = [&instance_name](bazel_re::Digest const& digest) {
+    bool const compression = BatchCompressionSupport(instance_name);
+    auto request_creator = [&instance_name,
+                            compression](bazel_re::Digest const& digest) {
         bazel_re::BatchReadBlobsRequest request;
         request.set_instance_name(instance_name);
+        if (compression) {
+            request.add_acceptable_compressors(
+                bazel_re::Compressor_Value_DEFLATE);
+        }
         *request.add_digests() = digest;
         return request;
     };
@@ -175,12 +190,16 @@ auto BazelCasClient::BatchReadBlobs(
                                 if (not ref.has_value()) {
                                     return;
                                 }
+                                auto data = DecompressBatchData(r, *ref.value());
+                                if (not data.has_value()) {
+                                    return;
+                                }
                                 auto blob = ArtifactBlob::FromTempFile(
                                     HashFunction{ref.value()->GetHashType()},
                                     ref.value()->IsTree() ? ObjectType::Tree
                                                           : ObjectType::File,
                                     temp_space_,
-                                    r.data());
+                                    *data);
                                 if (not blob.has_value()) {
                                     return;
                                 }
@@ -227,6 +246,14 @@ auto BazelCasClient::UpdateSingleBlob(std::string const& instance_name,
         return oss.str();
     });
 
+    if (UseCompression(instance_name, blob.GetContentSize())) {
+        if (stream_->Write(instance_name, blob, /*compressed=*/true)) {
+            return true;
+        }
+        logger_.Emit(LogLevel::Debug,
+                     "Compressed upload of {} failed, retrying uncompressed",
+                     blob.GetDigest().hash());
+    }
     if (not stream_->Write(instance_name, blob)) {
         logger_.Emit(LogLevel::Error,
                      "Failed to write {}:{}",
@@ -240,12 +267,22 @@ auto BazelCasClient::UpdateSingleBlob(std::string const& instance_name,
 auto BazelCasClient::IncrementalReadSingleBlob(std::string const& instance_name,
                                                ArtifactDigest const& digest)
     const noexcept -> ByteStreamClient::IncrementalReader {
-    return stream_->IncrementalRead(instance_name, digest);
+    return stream_->IncrementalRead(
+        instance_name, digest, UseCompression(instance_name, digest.size()));
 }
 
 auto BazelCasClient::ReadSingleBlob(std::string const& instance_name,
                                     ArtifactDigest const& digest) const noexcept
     -> std::optional<ArtifactBlob> {
+    if (UseCompression(instance_name, digest.size())) {
+        if (auto blob = stream_->Read(
+                instance_name, digest, temp_space_, /*compressed=*/true)) {
+            return blob;
+        }
+        logger_.Emit(LogLevel::Debug,
+                     "Compressed read of {} failed, retrying uncompressed",
+                     digest.hash());
+    }
     return stream_->Read(instance_name, digest, temp_space_);
 }
 
@@ -310,6 +347,60 @@ auto BazelCasClient::SpliceBlob(
     return response.blob_digest();
 }
 
+auto BazelCasClient::GetTree(std::string const& instance_name,
+                             ArtifactDigest const& root) const noexcept
+    -> std::vector<bazel_re::Directory> {
+    std::vector<bazel_re::Directory> result{};
+    if (not get_tree_support_.load()) {
+        return result;
+    }
+    try {
+        auto const root_digest = ArtifactDigestFactory::ToBazel(root);
+        std::size_t total_size = 0;
+        std::string page_token{};
+        do {  // NOLINT(cppcoreguidelines-avoid-do-while)
+            auto const request = CreateGetTreeRequest(
+                instance_name, root_digest, kGetTreePageSize, page_token);
+            std::vector<bazel_re::Directory> page{};
+            std::string next_page_token{};
+            auto [ok, status] = WithRetry(
+                [this, &request, &page, &next_page_token]() {
+                    page.clear();
+                    next_page_token.clear();
+                    grpc::ClientContext context;
+                    auto reader = stub_->GetTree(&context, request);
+                    bazel_re::GetTreeResponse response{};
+                    while (reader->Read(&response)) {
+                        std::move(response.mutable_directories()->begin(),
+                                  response.mutable_directories()->end(),
+                                  std::back_inserter(page));
+                        if (not response.next_page_token().empty()) {
+                            next_page_token = response.next_page_token();
+                        }
+                    }
+                    return reader->Finish();
+                },
+                retry_config_,
+                logger_);
+            if (not ok) {
+                if (status.error_code() == grpc::StatusCode::UNIMPLEMENTED) {
+                    get_tree_support_ = false;
+                }
+                LogStatus(&logger_, LogLevel::Debug, status, "GetTree");
+                return result;
+            }
+            for (auto& dir : page) {
+                total_size += dir.ByteSizeLong();
+                result.emplace_back(std::move(dir));
+            }
+            page_token = std::move(next_page_token);
+        } while (not page_token.empty() and total_size < kMaxGetTreeSize);
+    } catch (std::exception const& ex) {
+        logger_.Emit(LogLevel::Debug, "GetTree failed with:\n{}", ex.what());
+    }
+    return result;
+}
+
 auto BazelCasClient::BlobSplitSupport(
     std::string const& instance_name) const noexcept -> bool {
     return capabilities_.GetCapabilities(instance_name)->blob_split_support;
@@ -320,6 +411,43 @@ auto BazelCasClient::BlobSpliceSupport(
     return capabilities_.GetCapabilities(instance_name)->blob_splice_support;
 }
 
+auto BazelCasClient::UseCompression(std::string const& instance_name,
+                                    std::size_t size) const noexcept -> bool {
+    return size >= BlobCompression::kMinCompressSize and
+           capabilities_.GetCapabilities(instance_name)->compression_support;
+}
+
+auto BazelCasClient::BatchCompressionSupport(
+    std::string const& instance_name) const noexcept -> bool {
+    return capabilities_.GetCapabilities(instance_name)
+        ->batch_compression_support;
+}
+
+auto BazelCasClient::DecompressBatchData(
+    bazel_re::BatchReadBlobsResponse_Response const& response,
+    ArtifactDigest const& digest) const noexcept
+    -> std::optional<std::string> {
+    if (response.compressor() == bazel_re::Compressor_Value_IDENTITY) {
+        return response.data();
+    }
+    if (response.compressor() != bazel_re::Compressor_Value_DEFLATE) {
+        logger_.Emit(LogLevel::Warning,
+                     "Unsupported compressor {} for {}",
+                     static_cast<int>(response.compressor()),
+                     digest.hash());
+        return std::nullopt;
+    }
+    auto data = BlobCompression::Decompress(response.data(), digest.size());
+    if (not data.has_value()) {
+        logger_.Emit(LogLevel::Warning,
+                     "Failed to decompress {}:\n{}",
+                     digest.hash(),
+                     data.error());
+        return std::nullopt;
+    }
+    return *std::move(data);
+}
+
 auto BazelCasClient::FindMissingBlobs(
     std::string const& instance_name,
     std::unordered_set<ArtifactDigest> const& digests) const noexcept
@@ -425,7 +553,9 @@ auto BazelCasClient::BatchUpdateBlobs(std::string const& instance_name,
 
     auto const max_content_size = GetMaxBatchTransferSize(instance_name);
 
-    auto request_creator = [&instance_name](ArtifactBlob const& blob)
+    bool const compression = BatchCompressionSupport(instance_name);
+    auto request_creator = [&instance_name, compression](
+                               ArtifactBlob const& blob)
         -> std::optional<bazel_re::BatchUpdateBlobsRequest> {
         auto const content = blob.ReadContent();
         if (content == nullptr) {
@@ -438,6 +568,15 @@ auto BazelCasClient::BatchUpdateBlobs(std::string const& instance_name,
         auto& r = *request.add_requests();
         (*r.mutable_digest()) =
             ArtifactDigestFactory::ToBazel(blob.GetDigest());
+        if (compression and
+            content->size() >= BlobCompression::kMinCompressSize) {
+            auto compressed = BlobCompression::Compress(*content);
+            if (compressed and compressed->size() < content->size()) {
+                r.set_compressor(bazel_re::Compressor_Value_DEFLATE);
+                r.set_data(*std::move(compressed));
+                return request;
+            }
+        }
         r.set_data(*content);
         return request;
     };
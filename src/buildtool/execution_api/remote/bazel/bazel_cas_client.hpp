@@ -15,6 +15,7 @@
 #ifndef INCLUDED_SRC_BUILDTOOL_EXECUTION_API_REMOTE_BAZEL_BAZEL_CAS_CLIENT_HPP
 #define INCLUDED_SRC_BUILDTOOL_EXECUTION_API_REMOTE_BAZEL_BAZEL_CAS_CLIENT_HPP
 
+#include <atomic>
 #include <cstddef>
 #include <functional>
 #include <memory>
@@ -95,10 +96,11 @@ class BazelCasClient {
         ArtifactDigest const& digest) const noexcept
         -> ByteStreamClient::IncrementalReader;
 
-    /// \brief Read single blob via bytestream
+    /// \brief Read single blob via bytestream. The content is streamed to a
+    /// file in the temporary space, so blobs of any size can be read.
     /// \param[in] instance_name Name of the CAS instance
     /// \param[in] digest        Blob digest to read
-    /// \returns The blob successfully read
+    /// \returns The blob successfully read, backed by a temporary file
     [[nodiscard]] auto ReadSingleBlob(std::string const& instance_name,
                                       ArtifactDigest const& digest)
         const noexcept -> std::optional<ArtifactBlob>;
@@ -122,6 +124,17 @@ class BazelCasClient {
         std::vector<bazel_re::Digest> const& chunk_digests) const noexcept
         -> std::optional<bazel_re::Digest>;
 
+    /// \brief Read the directories of a tree via the GetTree API, in as many
+    /// round trips as there are pages instead of one per tree level.
+    /// \param[in] instance_name Name of the CAS instance
+    /// \param[in] root          Digest of the root directory
+    /// \returns The directories of the tree, including the root; these might
+    /// be incomplete, e.g., if the server does not support GetTree or the tree
+    /// is too large, so callers need to fall back to reading single directories
+    [[nodiscard]] auto GetTree(std::string const& instance_name,
+                               ArtifactDigest const& root) const noexcept
+        -> std::vector<bazel_re::Directory>;
+
     [[nodiscard]] auto BlobSplitSupport(
         std::string const& instance_name) const noexcept -> bool;
 
@@ -142,6 +155,22 @@ class BazelCasClient {
     TmpDir::Ptr temp_space_;
     std::unique_ptr<bazel_re::ContentAddressableStorage::Stub> stub_;
     Logger logger_{"RemoteCasClient"};
+    // Cleared once the server reported GetTree to be unimplemented.
+    mutable std::atomic<bool> get_tree_support_{true};
+
+    /// \brief Whether a blob of given size should be transferred compressed
+    /// via the bytestream API.
+    [[nodiscard]] auto UseCompression(std::string const& instance_name,
+                                      std::size_t size) const noexcept -> bool;
+
+    [[nodiscard]] auto BatchCompressionSupport(
+        std::string const& instance_name) const noexcept -> bool;
+
+    /// \brief Obtain the uncompressed data of a batch read response.
+    [[nodiscard]] auto DecompressBatchData(
+        bazel_re::BatchReadBlobsResponse_Response const& response,
+        ArtifactDigest const& digest) const noexcept
+        -> std::optional<std::string>;
 
     [[nodiscard]] static auto CreateGetTreeRequest(
         std::string const& instance_name,
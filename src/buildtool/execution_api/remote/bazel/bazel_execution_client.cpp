@@ -14,6 +14,10 @@
 
 #include "src/buildtool/execution_api/remote/bazel/bazel_execution_client.hpp"
 
+#include <exception>
+#include <memory>
+#include <optional>
+#include <string>
 #include <utility>  // std::move
 
 #include <grpcpp/grpcpp.h>
@@ -70,8 +74,149 @@ auto DebugString(grpc::Status const& status) -> std::string {
                        status.error_message());
 }
 
+[[nodiscard]] auto CreateExecuteRequest(std::string const& instance_name,
+                                        bazel_re::Digest const& action_digest,
+                                        ExecutionConfiguration const& config)
+    -> bazel_re::ExecuteRequest {
+    auto execution_policy = std::make_unique<bazel_re::ExecutionPolicy>();
+    execution_policy->set_priority(config.execution_priority);
+
+    auto results_cache_policy =
+        std::make_unique<bazel_re::ResultsCachePolicy>();
+    results_cache_policy->set_priority(config.results_cache_priority);
+
+    bazel_re::ExecuteRequest request;
+    request.set_instance_name(instance_name);
+    request.set_skip_cache_lookup(config.skip_cache_lookup);
+    (*request.mutable_action_digest()) = action_digest;
+    request.set_allocated_execution_policy(execution_policy.release());
+    request.set_allocated_results_cache_policy(results_cache_policy.release());
+    return request;
+}
+
 }  // namespace
 
+/// \brief Reader for the operation stream of a single asynchronous Execute or
+/// WaitExecution call. Keeps the last operation read and processes it once the
+/// call is done. Instances delete themselves after the call is done.
+class BazelExecutionClient::OperationReader final
+    : public grpc::ClientReadReactor<google::longrunning::Operation> {
+  public:
+    OperationReader(OperationReader const&) = delete;
+    OperationReader(OperationReader&&) = delete;
+    auto operator=(OperationReader const&) -> OperationReader& = delete;
+    auto operator=(OperationReader&&) -> OperationReader& = delete;
+    ~OperationReader() final = default;
+
+    static void Execute(gsl::not_null<BazelExecutionClient*> const& client,
+                        bazel_re::ExecuteRequest request,
+                        ExecutionCallback callback) {
+        auto* reader = new OperationReader{client, std::move(callback)};
+        reader->execute_request_ = std::move(request);
+        client->stub_->async()->Execute(
+            &reader->context_, &reader->execute_request_, reader);
+        reader->Start();
+    }
+
+    static void WaitExecution(
+        gsl::not_null<BazelExecutionClient*> const& client,
+        std::string const& execution_handle,
+        ExecutionCallback callback) {
+        auto* reader = new OperationReader{client, std::move(callback)};
+        reader->waiting_ = true;
+        reader->wait_request_.set_name(execution_handle);
+        client->stub_->async()->WaitExecution(
+            &reader->context_, &reader->wait_request_, reader);
+        reader->Start();
+    }
+
+    void OnReadDone(bool ok) final {
+        if (ok) {
+            operation_ = current_;
+            StartRead(&current_);
+        }
+        // otherwise, the stream has ended and OnDone will be called
+    }
+
+    void OnDone(grpc::Status const& status) final {
+        std::unique_ptr<OperationReader> self{this};
+        std::optional<ExecutionResponse> response{};
+        try {
+            response = Process(status);
+        } catch (std::exception const& ex) {
+            client_->logger_.Emit(
+                LogLevel::Error,
+                "Processing asynchronous execution failed with:\n{}",
+                ex.what());
+            response = ExecutionResponse::MakeEmptyFailed();
+        }
+        // invoked outside of the handler, so it is never called twice
+        if (response and callback_) {
+            callback_(*std::move(response));
+        }
+    }
+
+  private:
+    gsl::not_null<BazelExecutionClient*> client_;
+    ExecutionCallback callback_;
+    grpc::ClientContext context_;
+    bazel_re::ExecuteRequest execute_request_;
+    bazel_re::WaitExecutionRequest wait_request_;
+    bool waiting_{false};
+    google::longrunning::Operation current_;
+    std::optional<google::longrunning::Operation> operation_;
+
+    OperationReader(gsl::not_null<BazelExecutionClient*> const& client,
+                    ExecutionCallback callback) noexcept
+        : client_{client}, callback_{std::move(callback)} {}
+
+    void Start() {
+        StartRead(&current_);
+        StartCall();
+    }
+
+    /// \brief Compute the response to report, or nothing if the callback was
+    /// handed over to a WaitExecution call.
+    [[nodiscard]] auto Process(grpc::Status const& status)
+        -> std::optional<ExecutionResponse> {
+        auto& logger = client_->logger_;
+        if (not status.ok() or not operation_) {
+            // same classification as for the synchronous ReadExecution
+            auto const retry =
+                (status.error_code() == grpc::StatusCode::UNAVAILABLE) or
+                (status.error_code() == grpc::StatusCode::DEADLINE_EXCEEDED);
+            LogStatus(
+                &logger, retry ? LogLevel::Debug : LogLevel::Error, status);
+            auto response = ExecutionResponse::MakeEmptyFailed();
+            if (retry) {
+                response.state = ExecutionResponse::State::Retry;
+            }
+            return response;
+        }
+        auto contents = client_->ExtractContents(std::move(operation_));
+        auto& response = contents.response;
+        if (response.state == ExecutionResponse::State::Ongoing and
+            not waiting_) {
+            // the stream ended before the operation was done
+            logger.Emit(LogLevel::Trace,
+                        "Waiting for {}",
+                        response.execution_handle);
+            // keep our callback until the wait was started successfully
+            WaitExecution(client_, response.execution_handle, callback_);
+            callback_ = nullptr;
+            return std::nullopt;
+        }
+        if (response.state == ExecutionResponse::State::Failed) {
+            logger.Emit(LogLevel::Error,
+                        "Failed to execute action {}.",
+                        waiting_ ? wait_request_.name()
+                                 : execute_request_.action_digest()
+                                       .ShortDebugString());
+        }
+        return std::move(response);
+    }
+};
+
 BazelExecutionClient::BazelExecutionClient(
     std::string const& server,
     Port port,
@@ -87,19 +232,8 @@ auto BazelExecutionClient::Execute(std::string const& instance_name,
                                    ExecutionConfiguration const& config,
                                    bool wait)
     -> BazelExecutionClient::ExecutionResponse {
-    auto execution_policy = std::make_unique<bazel_re::ExecutionPolicy>();
-    execution_policy->set_priority(config.execution_priority);
-
-    auto results_cache_policy =
-        std::make_unique<bazel_re::ResultsCachePolicy>();
-    results_cache_policy->set_priority(config.results_cache_priority);
-
-    bazel_re::ExecuteRequest request;
-    request.set_instance_name(instance_name);
-    request.set_skip_cache_lookup(config.skip_cache_lookup);
-    (*request.mutable_action_digest()) = action_digest;
-    request.set_allocated_execution_policy(execution_policy.release());
-    request.set_allocated_results_cache_policy(results_cache_policy.release());
+    auto const request =
+        CreateExecuteRequest(instance_name, action_digest, config);
     BazelExecutionClient::ExecutionResponse response;
     auto execute = [this, &request, wait, &response]() -> RetryResponse {
         grpc::ClientContext context;
@@ -164,6 +298,24 @@ auto BazelExecutionClient::WaitExecution(std::string const& execution_handle)
     return response;
 }
 
+void BazelExecutionClient::ExecuteAsync(std::string const& instance_name,
+                                        bazel_re::Digest const& action_digest,
+                                        ExecutionConfiguration const& config,
+                                        ExecutionCallback callback) noexcept {
+    try {
+        OperationReader::Execute(
+            this,
+            CreateExecuteRequest(instance_name, action_digest, config),
+            callback);
+    } catch (std::exception const& ex) {
+        logger_.Emit(LogLevel::Error,
+                     "Failed to start execution of action {}:\n{}",
+                     action_digest.ShortDebugString(),
+                     ex.what());
+        callback(ExecutionResponse::MakeEmptyFailed());
+    }
+}
+
 auto BazelExecutionClient::ReadExecution(
     grpc::ClientReader<google::longrunning::Operation>* reader,
     bool wait) -> RetryReadOperation {
@@ -67,6 +67,9 @@ class BazelExecutionClient {
         }
     };
 
+    /// \brief Receives the response of an asynchronous execution.
+    using ExecutionCallback = std::function<void(ExecutionResponse)>;
+
     explicit BazelExecutionClient(
         std::string const& server,
         Port port,
@@ -81,7 +84,20 @@ class BazelExecutionClient {
     [[nodiscard]] auto WaitExecution(std::string const& execution_handle)
         -> ExecutionResponse;
 
+    /// \brief Execute an action without blocking the calling thread, waiting
+    /// for it to finish. If the operation stream ends before the operation is
+    /// done, execution is awaited via WaitExecution. No retries are performed;
+    /// a response in state Retry indicates that the caller may retry.
+    /// \param callback  Called exactly once with the final response, from a
+    /// thread owned by gRPC; must not block.
+    void ExecuteAsync(std::string const& instance_name,
+                      bazel_re::Digest const& action_digest,
+                      ExecutionConfiguration const& config,
+                      ExecutionCallback callback) noexcept;
+
   private:
+    class OperationReader;
+
     RetryConfig const& retry_config_;
     std::unique_ptr<bazel_re::Execution::Stub> stub_;
     Logger logger_{"RemoteExecutionClient"};
@@ -14,6 +14,7 @@
 
 #include "src/buildtool/execution_api/remote/bazel/bazel_network.hpp"
 
+#include <cstddef>
 #include <functional>
 #include <utility>
 
@@ -22,6 +23,14 @@
 #include "src/buildtool/logging/logger.hpp"
 #include "src/utils/cpp/back_map.hpp"
 
+namespace {
+
+// Upper estimate of the size of a digest in a request, used to size the
+// batches of digests to look up.
+constexpr std::size_t kDigestSizeEstimate = 128;
+
+}  // namespace
+
 BazelNetwork::BazelNetwork(
     std::string instance_name,
     std::string const& host,
@@ -47,18 +56,38 @@ BazelNetwork::BazelNetwork(
                                                    port,
                                                    auth,
                                                    retry_config)},
+      missing_blobs_{std::make_unique<RequestBatcher<ArtifactDigest>>(
+          [cas = cas_.get(), instance_name = instance_name_](
+              std::unordered_set<ArtifactDigest> const& digests) {
+              return cas->FindMissingBlobs(instance_name, digests);
+          },
+          MessageLimits::kMaxGrpcLength / kDigestSizeEstimate)},
+      batch_uploads_{std::make_unique<RequestBatcher<ArtifactBlob>>(
+          [cas = cas_.get(), instance_name = instance_name_](
+              std::unordered_set<ArtifactBlob> const& blobs)
+              -> std::unordered_set<ArtifactBlob> {
+              // the blobs actually stored are not known, so report them all
+              if (cas->BatchUpdateBlobs(instance_name, blobs) == blobs.size()) {
+                  return {};
+              }
+              return blobs;
+          },
+          MessageLimits::kMaxGrpcLength,
+          [](ArtifactBlob const& blob) {
+              return blob.GetContentSize() + kDigestSizeEstimate;
+          })},
       exec_config_{exec_config},
       hash_function_{hash_function} {}
 
 auto BazelNetwork::IsAvailable(ArtifactDigest const& digest) const noexcept
     -> bool {
-    return cas_->FindMissingBlobs(instance_name_, {digest}).empty();
+    return missing_blobs_->Run({digest}).empty();
 }
 
 auto BazelNetwork::FindMissingBlobs(
     std::unordered_set<ArtifactDigest> const& digests) const noexcept
     -> std::unordered_set<ArtifactDigest> {
-    return cas_->FindMissingBlobs(instance_name_, digests);
+    return missing_blobs_->Run(digests);
 }
 
 auto BazelNetwork::SplitBlob(bazel_re::Digest const& blob_digest) const noexcept
@@ -102,8 +131,12 @@ auto BazelNetwork::DoUploadBlobs(
         }
 
         // After uploading via stream api, only small blobs that may be uploaded
-        // using batch are in the container:
-        return cas_->BatchUpdateBlobs(instance_name_, blobs) == blobs.size();
+        // using batch are in the container. If a batch shared with other
+        // callers failed, the own blobs are uploaded again on their own, so
+        // that a failure caused by another caller's blob is not reported.
+        auto failed = batch_uploads_->Run(blobs);
+        return failed.empty() or
+               cas_->BatchUpdateBlobs(instance_name_, failed) == failed.size();
 
     } catch (...) {
         Logger::Log(LogLevel::Warning, "Unknown exception");
@@ -150,6 +183,35 @@ auto BazelNetwork::ExecuteBazelActionSync(
     return response.output;
 }
 
+void BazelNetwork::ExecuteBazelActionAsync(
+    bazel_re::Digest const& action,
+    BazelExecutionClient::ExecutionCallback callback) noexcept {
+    exec_->ExecuteAsync(
+        instance_name_, action, exec_config_, std::move(callback));
+}
+
+auto BazelNetwork::FinishBazelActionAsync(
+    bazel_re::Digest const& action,
+    BazelExecutionClient::ExecutionResponse response) noexcept
+    -> std::optional<BazelExecutionClient::ExecutionOutput> {
+    if (response.state ==
+        BazelExecutionClient::ExecutionResponse::State::Retry) {
+        Logger::Log(LogLevel::Debug,
+                    "Asynchronous execution of {} failed, retrying.",
+                    action.hash());
+        return ExecuteBazelActionSync(action);
+    }
+    if (response.state !=
+            BazelExecutionClient::ExecutionResponse::State::Finished or
+        not response.output) {
+        Logger::Log(LogLevel::Warning,
+                    "Failed to execute action with execution id {}.",
+                    action.hash());
+        return std::nullopt;
+    }
+    return std::move(response.output);
+}
+
 auto BazelNetwork::CreateReader() const noexcept -> BazelNetworkReader {
     return BazelNetworkReader{instance_name_, cas_.get(), hash_function_};
 }
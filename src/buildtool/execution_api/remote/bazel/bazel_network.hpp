@@ -30,6 +30,7 @@
 #include "src/buildtool/common/remote/retry_config.hpp"
 #include "src/buildtool/crypto/hash_function.hpp"
 #include "src/buildtool/execution_api/bazel_msg/execution_config.hpp"
+#include "src/buildtool/execution_api/common/request_batcher.hpp"
 #include "src/buildtool/execution_api/remote/bazel/bazel_ac_client.hpp"
 #include "src/buildtool/execution_api/remote/bazel/bazel_capabilities_client.hpp"
 #include "src/buildtool/execution_api/remote/bazel/bazel_cas_client.hpp"
@@ -55,6 +56,8 @@ class BazelNetwork {
     [[nodiscard]] auto IsAvailable(ArtifactDigest const& digest) const noexcept
         -> bool;
 
+    /// \brief Find the digests missing in CAS. Lookups of concurrent callers
+    /// are coalesced into batched requests.
     [[nodiscard]] auto FindMissingBlobs(
         std::unordered_set<ArtifactDigest> const& digests) const noexcept
         -> std::unordered_set<ArtifactDigest>;
@@ -71,7 +74,8 @@ class BazelNetwork {
 
     [[nodiscard]] auto BlobSpliceSupport() const noexcept -> bool;
 
-    /// \brief Uploads blobs to CAS
+    /// \brief Uploads blobs to CAS. Small blobs of concurrent callers are
+    /// coalesced into batched requests.
     /// \param blobs              The blobs to upload
     /// \param skip_find_missing  Skip finding missing blobs, just upload all
     /// \returns True if upload was successful, false otherwise
@@ -83,6 +87,22 @@ class BazelNetwork {
         bazel_re::Digest const& action) noexcept
         -> std::optional<BazelExecutionClient::ExecutionOutput>;
 
+    /// \brief Start executing an action without blocking the calling thread.
+    /// \param callback  Called with the response of the remote side, from a
+    /// thread owned by gRPC; must not block. The response should be passed to
+    /// FinishBazelActionAsync from a thread that may block.
+    void ExecuteBazelActionAsync(
+        bazel_re::Digest const& action,
+        BazelExecutionClient::ExecutionCallback callback) noexcept;
+
+    /// \brief Obtain the output of an asynchronously executed action. If the
+    /// response indicates a transient failure, the action is executed again
+    /// synchronously, with the configured retry strategy.
+    [[nodiscard]] auto FinishBazelActionAsync(
+        bazel_re::Digest const& action,
+        BazelExecutionClient::ExecutionResponse response) noexcept
+        -> std::optional<BazelExecutionClient::ExecutionOutput>;
+
     [[nodiscard]] auto CreateReader() const noexcept -> BazelNetworkReader;
     [[nodiscard]] auto GetHashFunction() const noexcept -> HashFunction {
         return hash_function_;
@@ -107,6 +127,8 @@ class BazelNetwork {
     std::unique_ptr<BazelCasClient> cas_;
     std::unique_ptr<BazelAcClient> ac_;
     std::unique_ptr<BazelExecutionClient> exec_;
+    std::unique_ptr<RequestBatcher<ArtifactDigest>> missing_blobs_;
+    std::unique_ptr<RequestBatcher<ArtifactBlob>> batch_uploads_;
     ExecutionConfiguration exec_config_{};
     HashFunction hash_function_;
 
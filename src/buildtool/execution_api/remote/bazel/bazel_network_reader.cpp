@@ -16,6 +16,7 @@
 
 #include <algorithm>
 #include <cstddef>
+#include <exception>
 #include <filesystem>
 #include <memory>
 #include <unordered_set>
@@ -24,6 +25,7 @@
 #include "google/protobuf/repeated_ptr_field.h"
 #include "src/buildtool/common/protocol_traits.hpp"
 #include "src/buildtool/execution_api/bazel_msg/bazel_msg_factory.hpp"
+#include "src/buildtool/execution_api/common/tree_reader_utils.hpp"
 #include "src/buildtool/file_system/object_type.hpp"
 #include "src/buildtool/logging/log_level.hpp"
 #include "src/buildtool/logging/logger.hpp"
@@ -40,18 +42,52 @@ BazelNetworkReader::BazelNetworkReader(
       cas_{*cas},
       hash_function_{hash_function} {}
 
-auto BazelNetworkReader::ReadDirectory(ArtifactDigest const& digest)
-    const noexcept -> std::optional<bazel_re::Directory> {
-    auto blob = ReadSingleBlob(digest);
-    if (not blob.has_value()) {
-        Logger::Log(
-            LogLevel::Debug,
-            "BazelNetworkReader::ReadDirectory: Directory {} not found in CAS",
-            digest.hash());
-        return std::nullopt;
+void BazelNetworkReader::PrefetchTree(
+    ArtifactDigest const& root) const noexcept {
+    try {
+        {
+            std::unique_lock lock{tree_cache_->mutex};
+            if (tree_cache_->content.contains(root.hash())) {
+                return;
+            }
+        }
+        auto directories = cas_.GetTree(instance_name_, root);
+        std::unordered_map<std::string, std::shared_ptr<std::string const>>
+            prefetched{};
+        prefetched.reserve(directories.size());
+        for (auto const& dir : directories) {
+            // The hash of each directory is computed locally, so the cache
+            // only serves content that matches the requested digest.
+            if (IsNativeProtocol()) {
+                auto tree = TreeReaderUtils::DirectoryToGitTree(dir);
+                if (tree) {
+                    prefetched.emplace(std::move(tree->first),
+                                       std::make_shared<std::string const>(
+                                           std::move(tree->second)));
+                }
+            }
+            else {
+                auto content = dir.SerializeAsString();
+                auto hash = hash_function_.HashBlobData(content).HexString();
+                prefetched.emplace(
+                    std::move(hash),
+                    std::make_shared<std::string const>(std::move(content)));
+            }
+        }
+        std::unique_lock lock{tree_cache_->mutex};
+        tree_cache_->content.merge(prefetched);
+    } catch (std::exception const& ex) {
+        Logger::Log(LogLevel::Debug,
+                    "BazelNetworkReader::PrefetchTree: Failed to prefetch tree "
+                    "{}:\n{}",
+                    root.hash(),
+                    ex.what());
     }
+}
 
-    auto const content = blob->ReadContent();
+auto BazelNetworkReader::ReadDirectory(ArtifactDigest const& digest)
+    const noexcept -> std::optional<bazel_re::Directory> {
+    auto const content = ReadTreeContent(digest);
     if (content == nullptr) {
         Logger::Log(
             LogLevel::Debug,
@@ -104,12 +140,7 @@ auto BazelNetworkReader::ReadGitTree(ArtifactDigest const& digest)
     const noexcept -> std::optional<GitRepo::tree_entries_t> {
     ExpectsAudit(IsNativeProtocol());
 
-    auto read_blob = ReadSingleBlob(digest);
-    if (not read_blob) {
-        Logger::Log(LogLevel::Debug, "Tree {} not found in CAS", digest.hash());
-        return std::nullopt;
-    }
-    auto const content = read_blob->ReadContent();
+    auto const content = ReadTreeContent(digest);
     if (content == nullptr) {
         return std::nullopt;
     }
@@ -175,6 +206,25 @@ auto BazelNetworkReader::IsNativeProtocol() const noexcept -> bool {
     return ProtocolTraits::IsNative(hash_function_.GetType());
 }
 
+auto BazelNetworkReader::ReadTreeContent(ArtifactDigest const& digest)
+    const noexcept -> std::shared_ptr<std::string const> {
+    try {
+        std::unique_lock lock{tree_cache_->mutex};
+        auto it = tree_cache_->content.find(digest.hash());
+        if (it != tree_cache_->content.end()) {
+            return it->second;
+        }
+    } catch (...) {
+        // fall back to reading the tree from the remote side
+    }
+    auto blob = ReadSingleBlob(digest);
+    if (not blob) {
+        Logger::Log(LogLevel::Debug, "Tree {} not found in CAS", digest.hash());
+        return nullptr;
+    }
+    return blob->ReadContent();
+}
+
 auto BazelNetworkReader::ReadSingleBlob(ArtifactDigest const& digest)
     const noexcept -> std::optional<ArtifactBlob> {
     return cas_.ReadSingleBlob(instance_name_, digest);
@@ -187,8 +237,10 @@ auto BazelNetworkReader::Read(std::unordered_set<ArtifactDigest> const& digests)
 
     std::unordered_set<ArtifactDigest> to_batch;
     to_batch.reserve(digests.size());
-    // Upload blobs that don't fit for batching: size is larger than limit or
-    // unknown
+    // Read blobs that don't fit for batching one by one: size is larger than
+    // limit or unknown. Their content is streamed to a temporary file, so
+    // they are never held in memory as a whole, also when uploaded to another
+    // CAS afterwards.
     std::size_t const limit = cas_.GetMaxBatchTransferSize(instance_name_);
     for (auto const& digest : digests) {
         if (digest.size() == 0 or digest.size() > limit) {
@@ -17,8 +17,11 @@
 
 #include <filesystem>
 #include <functional>
+#include <memory>
+#include <mutex>
 #include <optional>
 #include <string>
+#include <unordered_map>
 #include <unordered_set>
 #include <vector>
 
@@ -41,6 +44,11 @@ class BazelNetworkReader final {
                                 gsl::not_null<BazelCasClient const*> const& cas,
                                 HashFunction hash_function) noexcept;
 
+    /// \brief Fetch all directories of a tree via the GetTree API in advance,
+    /// to avoid one round trip per directory when traversing the tree later.
+    /// Directories not obtained this way are read on demand as usual.
+    void PrefetchTree(ArtifactDigest const& root) const noexcept;
+
     [[nodiscard]] auto ReadDirectory(ArtifactDigest const& digest)
         const noexcept -> std::optional<bazel_re::Directory>;
 
@@ -74,9 +82,23 @@ class BazelNetworkReader final {
         const noexcept -> std::vector<ArtifactBlob>;
 
   private:
+    // Content of prefetched trees by hash; held by pointer to keep the reader
+    // movable.
+    struct TreeCache final {
+        std::mutex mutex;
+        std::unordered_map<std::string, std::shared_ptr<std::string const>>
+            content;
+    };
+
     std::string const instance_name_;
     BazelCasClient const& cas_;
     HashFunction hash_function_;
+    std::unique_ptr<TreeCache> tree_cache_ = std::make_unique<TreeCache>();
+
+    /// \brief Read the content of a tree, from the prefetched trees if
+    /// possible.
+    [[nodiscard]] auto ReadTreeContent(ArtifactDigest const& digest)
+        const noexcept -> std::shared_ptr<std::string const>;
 };
 
 #endif  // INCLUDED_SRC_BUILDTOOL_EXECUTION_API_REMOTE_BAZEL_BAZEL_TREE_READER_HPP
@@ -35,6 +35,8 @@
 #include "src/buildtool/common/remote/client_common.hpp"
 #include "src/buildtool/common/remote/port.hpp"
 #include "src/buildtool/crypto/hash_function.hpp"
+#include "src/buildtool/crypto/hasher.hpp"
+#include "src/buildtool/execution_api/common/blob_compression.hpp"
 #include "src/buildtool/execution_api/common/bytestream_utils.hpp"
 #include "src/buildtool/execution_api/common/ids.hpp"
 #include "src/buildtool/file_system/object_type.hpp"
@@ -55,8 +57,21 @@ class ByteStreamClient {
         /// \returns empty string if stream finished and std::nullopt on error.
         [[nodiscard]] auto Next() -> std::optional<std::string> {
             google::bytestream::ReadResponse response{};
-            if (reader_->Read(&response)) {
-                return std::move(*response.mutable_data());
+            while (reader_->Read(&response)) {
+                if (not decompressor_.has_value()) {
+                    return std::move(*response.mutable_data());
+                }
+                auto data = decompressor_->Update(response.data());
+                if (not data.has_value()) {
+                    logger_->Emit(LogLevel::Debug,
+                                  "Decompressing read data failed: {}",
+                                  data.error());
+                    return std::nullopt;
+                }
+                // an empty chunk would indicate the end of the stream
+                if (not data->empty()) {
+                    return *std::move(data);
+                }
             }
 
             if (not finished_) {
@@ -68,6 +83,12 @@ class ByteStreamClient {
                                   status.error_message());
                     return std::nullopt;
                 }
+                if (decompressor_.has_value() and
+                    not decompressor_->Finished()) {
+                    logger_->Emit(LogLevel::Debug,
+                                  "Compressed stream ended prematurely");
+                    return std::nullopt;
+                }
                 finished_ = true;
             }
             return std::string{};
@@ -78,17 +99,22 @@ class ByteStreamClient {
         grpc::ClientContext ctx_;
         std::unique_ptr<grpc::ClientReader<google::bytestream::ReadResponse>>
             reader_;
+        std::optional<BlobCompression::Decompressor> decompressor_;
         bool finished_{false};
 
         IncrementalReader(
             gsl::not_null<google::bytestream::ByteStream::Stub*> const& stub,
             std::string const& instance_name,
             ArtifactDigest const& digest,
+            bool compressed,
             Logger const* logger)
             : logger_{logger} {
+            if (compressed) {
+                decompressor_.emplace(digest.size());
+            }
             google::bytestream::ReadRequest request{};
-            request.set_resource_name(
-                ByteStreamUtils::ReadRequest::ToString(instance_name, digest));
+            request.set_resource_name(ByteStreamUtils::ReadRequest::ToString(
+                instance_name, digest, compressed));
             reader_ = stub->Read(&ctx_, request);
         }
     };
@@ -100,22 +126,28 @@ class ByteStreamClient {
             CreateChannelWithCredentials(server, port, auth));
     }
 
-    [[nodiscard]] auto IncrementalRead(
-        std::string const& instance_name,
-        ArtifactDigest const& digest) const noexcept -> IncrementalReader {
-        return IncrementalReader{stub_.get(), instance_name, digest, &logger_};
+    /// \brief Read a blob incrementally.
+    /// \param compressed  Whether to transfer the blob deflate-compressed; the
+    /// reader always yields the uncompressed content.
+    [[nodiscard]] auto IncrementalRead(std::string const& instance_name,
+                                       ArtifactDigest const& digest,
+                                       bool compressed = false) const noexcept
+        -> IncrementalReader {
+        return IncrementalReader{
+            stub_.get(), instance_name, digest, compressed, &logger_};
     }
 
     [[nodiscard]] auto Read(std::string const& instance_name,
                             ArtifactDigest const& digest,
-                            TmpDir::Ptr const& temp_space) const noexcept
+                            TmpDir::Ptr const& temp_space,
+                            bool compressed = false) const noexcept
         -> std::optional<ArtifactBlob> {
         auto temp_file = TmpDir::CreateFile(temp_space, digest.hash());
         if (temp_file == nullptr) {
             return std::nullopt;
         }
 
-        auto reader = IncrementalRead(instance_name, digest);
+        auto reader = IncrementalRead(instance_name, digest, compressed);
         try {
             std::ofstream stream{temp_file->GetPath(), std::ios_base::binary};
 
@@ -141,17 +173,17 @@ class ByteStreamClient {
         return *std::move(blob);
     }
 
+    /// \brief Upload a blob.
+    /// \param compressed  Whether to transfer the blob deflate-compressed.
     [[nodiscard]] auto Write(std::string const& instance_name,
-                             ArtifactBlob const& blob) const noexcept -> bool {
-        thread_local static std::string uuid{};
-        if (uuid.empty()) {
-            auto id = CreateProcessUniqueId();
-            if (not id) {
-                logger_.Emit(LogLevel::Debug,
-                             "Failed creating process unique id.");
-                return false;
-            }
-            uuid = CreateUUIDVersion4(*id);
+                             ArtifactBlob const& blob,
+                             bool compressed = false) const noexcept -> bool {
+        auto const uuid = GetUploadId();
+        if (not uuid) {
+            return false;
+        }
+        if (compressed) {
+            return WriteCompressed(instance_name, *uuid, blob);
         }
 
         try {
@@ -160,7 +192,7 @@ class ByteStreamClient {
             auto writer = stub_->Write(&ctx, &response);
 
             auto const resource_name = ByteStreamUtils::WriteRequest::ToString(
-                instance_name, uuid, blob.GetDigest());
+                instance_name, *uuid, blob.GetDigest());
 
             google::bytestream::WriteRequest request{};
             request.set_resource_name(resource_name);
@@ -177,6 +209,7 @@ class ByteStreamClient {
                 return false;
             }
 
+            auto verifier = ContentVerifier::Create(blob);
             std::size_t pos = 0;
             for (auto it = to_read->begin(); it != to_read->end();) {
                 auto const chunk = *it;
@@ -190,9 +223,15 @@ class ByteStreamClient {
                 }
                 *request.mutable_data() = *chunk;
 
+                bool const finish =
+                    pos + chunk->size() >= blob.GetContentSize();
+                if (verifier and
+                    not verifier->Verify(pos, *chunk, finish, &logger_)) {
+                    ctx.TryCancel();
+                    return false;
+                }
                 request.set_write_offset(static_cast<int>(pos));
-                request.set_finish_write(pos + chunk->size() >=
-                                         blob.GetContentSize());
+                request.set_finish_write(finish);
                 if (writer->Write(request)) {
                     pos += chunk->size();
                     ++it;
@@ -248,6 +287,189 @@ class ByteStreamClient {
     std::unique_ptr<google::bytestream::ByteStream::Stub> stub_;
     Logger logger_{"ByteStreamClient"};
 
+    /// \brief Verifies the content of a volatile blob while it is uploaded,
+    /// so that the write is not finished if the content changed since the blob
+    /// was hashed. Chunks have to be passed in order; content passed again,
+    /// e.g., after resuming an upload, is skipped.
+    class ContentVerifier final {
+      public:
+        /// \brief Create a verifier for the given blob, or std::nullopt if its
+        /// content source is not volatile.
+        [[nodiscard]] static auto Create(ArtifactBlob const& blob)
+            -> std::optional<ContentVerifier> {
+            if (not blob.IsVolatile()) {
+                return std::nullopt;
+            }
+            auto const& digest = blob.GetDigest();
+            return ContentVerifier{
+                digest,
+                HashFunction{digest.GetHashType()}.MakeTaggedHasher(
+                    digest.size(), digest.IsTree())};
+        }
+
+        /// \brief Add the chunk at the given offset to the content read so far.
+        /// \param finish  Whether this is the last chunk of the content.
+        /// \returns false if the content is known to differ from the digest.
+        [[nodiscard]] auto Verify(std::size_t offset,
+                                  std::string_view chunk,
+                                  bool finish,
+                                  gsl::not_null<Logger const*> const& logger)
+            -> bool {
+            if (hasher_ and offset <= verified_ and
+                offset + chunk.size() > verified_) {
+                if (hasher_->Update(chunk.substr(verified_ - offset))) {
+                    verified_ = offset + chunk.size();
+                }
+                else {
+                    hasher_.reset();
+                }
+            }
+            if (not finish) {
+                return hasher_.has_value();
+            }
+            bool const matches =
+                hasher_ and verified_ == digest_.size() and
+                std::move(*hasher_).Finalize().HexString() == digest_.hash();
+            hasher_.reset();
+            if (not matches) {
+                logger->Emit(LogLevel::Warning,
+                             "Content of {} changed since it was hashed",
+                             digest_.hash());
+            }
+            return matches;
+        }
+
+      private:
+        ArtifactDigest digest_;
+        std::optional<Hasher> hasher_;
+        std::size_t verified_ = 0;
+
+        explicit ContentVerifier(ArtifactDigest digest,
+                                 std::optional<Hasher> hasher) noexcept
+            : digest_{std::move(digest)}, hasher_{std::move(hasher)} {}
+    };
+
+    [[nodiscard]] auto GetUploadId() const noexcept
+        -> std::optional<std::string> {
+        thread_local static std::string uuid{};
+        if (uuid.empty()) {
+            auto id = CreateProcessUniqueId();
+            if (not id) {
+                logger_.Emit(LogLevel::Debug,
+                             "Failed creating process unique id.");
+                return std::nullopt;
+            }
+            uuid = CreateUUIDVersion4(*id);
+        }
+        return uuid;
+    }
+
+    /// \brief Upload a blob deflate-compressed. Offsets refer to the
+    /// compressed stream, which cannot be resumed, so a broken stream fails
+    /// the upload.
+    [[nodiscard]] auto WriteCompressed(std::string const& instance_name,
+                                       std::string const& uuid,
+                                       ArtifactBlob const& blob) const noexcept
+        -> bool {
+        try {
+            grpc::ClientContext ctx;
+            google::bytestream::WriteResponse response{};
+            auto writer = stub_->Write(&ctx, &response);
+
+            google::bytestream::WriteRequest request{};
+            request.set_resource_name(ByteStreamUtils::WriteRequest::ToString(
+                instance_name, uuid, blob.GetDigest(), /*compressed=*/true));
+
+            auto const to_read =
+                blob.ReadIncrementally(ByteStreamUtils::kChunkSize);
+            if (not to_read.has_value()) {
+                logger_.Emit(
+                    LogLevel::Error,
+                    "ByteStreamClient: Failed to create a reader for {}:\n{}",
+                    request.resource_name(),
+                    to_read.error());
+                return false;
+            }
+
+            BlobCompression::Compressor compressor{};
+            auto verifier = ContentVerifier::Create(blob);
+            std::size_t read = 0;
+            std::size_t written = 0;
+            for (auto it = to_read->begin(); it != to_read->end(); ++it) {
+                auto const chunk = *it;
+                if (not chunk.has_value()) {
+                    logger_.Emit(
+                        LogLevel::Error,
+                        "ByteStreamClient: Failed to read data for {}:\n{}",
+                        request.resource_name(),
+                        chunk.error());
+                    return false;
+                }
+                bool const finish =
+                    read + chunk->size() >= blob.GetContentSize();
+                if (verifier and
+                    not verifier->Verify(read, *chunk, finish, &logger_)) {
+                    ctx.TryCancel();
+                    return false;
+                }
+                read += chunk->size();
+                auto data = compressor.Update(*chunk, finish);
+                if (not data.has_value()) {
+                    logger_.Emit(
+                        LogLevel::Error,
+                        "ByteStreamClient: Failed to compress data for {}:\n{}",
+                        request.resource_name(),
+                        data.error());
+                    return false;
+                }
+                if (data->empty() and not finish) {
+                    continue;
+                }
+                *request.mutable_data() = *std::move(data);
+                request.set_write_offset(static_cast<std::int64_t>(written));
+                request.set_finish_write(finish);
+                if (not writer->Write(request)) {
+                    logger_.Emit(
+                        LogLevel::Warning,
+                        "broken stream for upload to resource name {}",
+                        request.resource_name());
+                    return false;
+                }
+                written += request.data().size();
+            }
+            if (not writer->WritesDone()) {
+                logger_.Emit(LogLevel::Warning,
+                             "broken stream for upload to resource name {}",
+                             request.resource_name());
+                return false;
+            }
+
+            auto status = writer->Finish();
+            if (not status.ok()) {
+                LogStatus(&logger_, LogLevel::Debug, status);
+                return false;
+            }
+            // For compressed uploads, the committed size refers to the
+            // compressed data, or is -1 if the blob was already present.
+            if (response.committed_size() != -1 and
+                gsl::narrow<std::size_t>(response.committed_size()) !=
+                    written) {
+                logger_.Emit(
+                    LogLevel::Warning,
+                    "Committed size {} is different from the compressed one "
+                    "{}.",
+                    response.committed_size(),
+                    written);
+                return false;
+            }
+            return true;
+        } catch (...) {
+            logger_.Emit(LogLevel::Warning,
+                         "Caught exception in WriteCompressed");
+            return false;
+        }
+    }
+
     [[nodiscard]] auto QueryWriteStatus(
         std::string const& resource_name) const noexcept -> std::int64_t {
         grpc::ClientContext ctx;
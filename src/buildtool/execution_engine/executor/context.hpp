@@ -15,6 +15,7 @@
 #ifndef INCLUDED_SRC_BUILDTOOL_EXECUTION_ENGINE_EXECUTOR_CONTEXT_HPP
 #define INCLUDED_SRC_BUILDTOOL_EXECUTION_ENGINE_EXECUTOR_CONTEXT_HPP
 
+#include <cstddef>
 #include <optional>
 
 #include "gsl/gsl"
@@ -24,16 +25,27 @@
 #include "src/buildtool/execution_api/remote/context.hpp"
 #include "src/buildtool/profile/profile.hpp"
 #include "src/buildtool/progress_reporting/progress.hpp"
+#include "src/buildtool/storage/action_duration_history.hpp"
+#include "src/buildtool/storage/file_digest_cache.hpp"
 
 /// \brief Aggregate to be passed to graph traverser.
 /// \note No field is stored as const ref to avoid binding to temporaries.
 struct ExecutionContext final {
+    static constexpr std::size_t kDefaultStreamWindow = std::size_t{1} << 20U;
+
     gsl::not_null<RepositoryConfig const*> const repo_config;
     gsl::not_null<ApiBundle const*> const& apis;
     gsl::not_null<RemoteContext const*> const remote_context;
     gsl::not_null<Statistics*> const statistics;
     gsl::not_null<Progress*> const progress;
     std::optional<gsl::not_null<Profile*>> const profile;
+    std::optional<gsl::not_null<FileDigestCache*>> const file_digests =
+        std::nullopt;
+    std::optional<gsl::not_null<ActionDurationHistory*>> const durations =
+        std::nullopt;
+    /// \brief Files in file system roots of at least this size are uploaded
+    /// from disk instead of being read into memory.
+    std::size_t const stream_window = kDefaultStreamWindow;
 };
 
 #endif  // INCLUDED_SRC_BUILDTOOL_EXECUTION_ENGINE_EXECUTOR_CONTEXT_HPP
@@ -19,6 +19,7 @@
 #include <chrono>
 #include <cmath>
 #include <compare>
+#include <cstddef>
 #include <exception>
 #include <filesystem>
 #include <functional>
@@ -28,9 +29,11 @@
 #include <optional>
 #include <sstream>
 #include <string>
+#include <system_error>
 #include <unordered_map>
 #include <unordered_set>
 #include <utility>
+#include <variant>
 #include <vector>
 
 #include "fmt/core.h"
@@ -62,13 +65,18 @@
 #include "src/buildtool/execution_engine/executor/context.hpp"
 #include "src/buildtool/execution_engine/tree_operations/tree_operations_utils.hpp"
 #include "src/buildtool/file_system/file_root.hpp"
+#include "src/buildtool/file_system/file_system_manager.hpp"
 #include "src/buildtool/file_system/git_tree.hpp"
 #include "src/buildtool/file_system/object_type.hpp"
 #include "src/buildtool/logging/log_level.hpp"
 #include "src/buildtool/logging/logger.hpp"
+#include "src/buildtool/multithreading/task_system.hpp"
 #include "src/buildtool/profile/profile.hpp"
+#include "src/buildtool/profile/trace.hpp"
 #include "src/buildtool/progress_reporting/progress.hpp"
 #include "src/buildtool/progress_reporting/task_tracker.hpp"
+#include "src/buildtool/storage/action_duration_history.hpp"
+#include "src/buildtool/storage/file_digest_cache.hpp"
 #include "src/utils/cpp/back_map.hpp"
 #include "src/utils/cpp/expected.hpp"
 #include "src/utils/cpp/hex_string.hpp"
@@ -139,6 +147,12 @@ class ExecutorImpl {
         return std::nullopt;
     }
 
+    /// \brief Action prepared for execution, see PrepareAction.
+    struct PreparedAction {
+        IExecutionAction::Ptr remote_action;
+        std::unique_ptr<BazelApi> alternative_api;
+    };
+
     /// \brief Execute action and obtain response.
     /// \returns std::nullopt for actions without response (e.g., tree actions).
     /// \returns nullptr on error.
@@ -153,6 +167,48 @@ class ExecutorImpl {
         gsl::not_null<Statistics*> const& stats,
         gsl::not_null<Progress*> const& progress) noexcept
         -> std::optional<IExecutionResponse::Ptr> {
+        auto prepared = PrepareAction(logger,
+                                      action,
+                                      api,
+                                      merged_properties,
+                                      remote_context,
+                                      timeout,
+                                      cache_flag,
+                                      stats,
+                                      progress);
+        if (auto* response =
+                std::get_if<std::optional<IExecutionResponse::Ptr>>(
+                    &prepared)) {
+            return std::move(*response);
+        }
+        auto& [remote_action, alternative_api] =
+            std::get<PreparedAction>(prepared);
+        IExecutionResponse::Ptr result;
+        {
+            TraceSpan const span{"executor", "execute", action->Content().Id()};
+            result = remote_action->Execute(&logger);
+        }
+        return FinalizeAction(
+            logger, api, alternative_api.get(), std::move(result));
+    }
+
+    /// \brief Prepare an action for execution. Actions that do not need to be
+    /// executed remotely (e.g., tree actions) are computed right away.
+    /// \returns The response (see ExecuteAction) if the action is done
+    /// already or failed, otherwise the remote action ready to be executed.
+    [[nodiscard]] static auto PrepareAction(
+        Logger const& logger,
+        gsl::not_null<DependencyGraph::ActionNode const*> const& action,
+        IExecutionApi const& api,
+        ExecutionProperties const& merged_properties,
+        gsl::not_null<RemoteContext const*> const& remote_context,
+        std::chrono::milliseconds const& timeout,
+        IExecutionAction::CacheFlag cache_flag,
+        gsl::not_null<Statistics*> const& stats,
+        gsl::not_null<Progress*> const& progress) noexcept
+        -> std::variant<std::optional<IExecutionResponse::Ptr>,
+                        PreparedAction> {
+        TraceSpan const span{"executor", "prepare", action->Content().Id()};
         try {
             if (action->Content().IsTreeOverlayAction()) {
                 return ExecuteTreeOverlayAction(logger, action, api, progress);
@@ -180,7 +236,7 @@ class ExecutorImpl {
                 logger.Emit(
                     LogLevel::Error,
                     "failed to create root digest for input artifacts.");
-                return nullptr;
+                return IExecutionResponse::Ptr{};
             }
 
             if (tree_action) {
@@ -218,7 +274,7 @@ class ExecutorImpl {
                     logger.Emit(LogLevel::Error,
                                 "Failed to sync tree {} to dispatch endpoint",
                                 root_digest->hash());
-                    return nullptr;
+                    return IExecutionResponse::Ptr{};
                 }
             }
 
@@ -239,17 +295,34 @@ class ExecutorImpl {
             if (remote_action == nullptr) {
                 logger.Emit(LogLevel::Error,
                             "failed to create action for execution.");
-                return nullptr;
+                return IExecutionResponse::Ptr{};
             }
 
             // set action options
             remote_action->SetCacheFlag(cache_flag);
             remote_action->SetTimeout(timeout);
 
-            // execute action
-            auto result = remote_action->Execute(&logger);
+            return PreparedAction{.remote_action = std::move(remote_action),
+                                  .alternative_api =
+                                      std::move(alternative_api)};
+        } catch (std::exception const& ex) {
+            logger.Emit(LogLevel::Error,
+                        "Unexpectedly failed to execute action with:\n{}",
+                        ex.what());
+            return IExecutionResponse::Ptr{};
+        }
+    }
 
-            // process result
+    /// \brief Validate the result of an executed action and, if it was run on
+    /// an alternative endpoint, transfer its artifacts back.
+    /// \returns The result, or nullptr on error.
+    [[nodiscard]] static auto FinalizeAction(
+        Logger const& logger,
+        IExecutionApi const& api,
+        BazelApi const* alternative_api,
+        IExecutionResponse::Ptr result) noexcept -> IExecutionResponse::Ptr {
+        TraceSpan const span{"executor", "finalize"};
+        try {
             if (result) {
                 // in compatible mode, check that all artifacts are valid
                 if (not ProtocolTraits::IsNative(api.GetHashType())) {
@@ -268,7 +341,7 @@ class ExecutorImpl {
                     }
                 }
                 // if alternative endpoint used, transfer any missing blobs
-                if (alternative_api) {
+                if (alternative_api != nullptr) {
                     auto const artifacts = result->Artifacts();
                     if (not artifacts) {
                         logger.Emit(LogLevel::Error, artifacts.error());
@@ -300,13 +373,21 @@ class ExecutorImpl {
     /// available or by uploading it if there is no digest in the artifact. In
     /// the later case, the new digest is saved in the artifact
     /// \param[in] artifact The artifact to process.
+    /// \param[in] file_digests Optional cache of digests of local files.
+    /// \param[in] stream_window Size from which local files are uploaded from
+    /// disk instead of from memory.
     /// \returns True if artifact is available at the point of return, false
     /// otherwise
     [[nodiscard]] static auto VerifyOrUploadArtifact(
         Logger const& logger,
         gsl::not_null<DependencyGraph::ArtifactNode const*> const& artifact,
         gsl::not_null<const RepositoryConfig*> const& repo_config,
-        ApiBundle const& apis) noexcept -> bool {
+        ApiBundle const& apis,
+        std::optional<gsl::not_null<FileDigestCache*>> const& file_digests =
+            std::nullopt,
+        std::size_t stream_window =
+            ExecutionContext::kDefaultStreamWindow) noexcept -> bool {
+        TraceSpan const span{"executor", "upload"};
         auto const object_info_opt = artifact->Content().Info();
         auto const file_path_opt = artifact->Content().FilePath();
         // If there is no object info and no file path, the artifact can not be
@@ -366,8 +447,12 @@ class ExecutorImpl {
             return oss.str();
         });
         auto repo = artifact->Content().Repository();
-        auto new_info =
-            UploadFile(*apis.remote, repo, repo_config, *file_path_opt);
+        auto new_info = UploadFile(*apis.remote,
+                                   repo,
+                                   repo_config,
+                                   *file_path_opt,
+                                   file_digests,
+                                   stream_window);
         if (not new_info) {
             logger.Emit(LogLevel::Error,
                         "artifact in {} could not be uploaded to CAS.",
@@ -575,17 +660,104 @@ class ExecutorImpl {
             logger, api, repo, repo_config, info, info.digest.hash());
     }
 
+    /// \brief Create a file-backed blob of a file in a file system root. The
+    /// file itself is used, unless the endpoint takes ownership of file-backed
+    /// blobs, in which case a copy in its temporary space is used.
+    [[nodiscard]] static auto StreamWorkspaceFile(
+        IExecutionApi const& api,
+        std::filesystem::path const& fs_path,
+        ObjectType object_type) noexcept -> std::optional<ArtifactBlob> {
+        if (not api.TakesOwnershipOfFiles()) {
+            auto blob = ArtifactBlob::FromFile(
+                HashFunction{api.GetHashType()}, object_type, fs_path);
+            if (not blob.has_value()) {
+                Logger::Log(LogLevel::Debug, std::move(blob).error());
+                return std::nullopt;
+            }
+            return *std::move(blob);
+        }
+        return CopyWorkspaceFile(api, fs_path, object_type);
+    }
+
+    /// \brief Create a blob backed by a copy of a file in a file system root
+    /// in the temporary space of the endpoint.
+    [[nodiscard]] static auto CopyWorkspaceFile(
+        IExecutionApi const& api,
+        std::filesystem::path const& fs_path,
+        ObjectType object_type) noexcept -> std::optional<ArtifactBlob> {
+        auto tmp_file = TmpDir::CreateFile(api.GetTempSpace());
+        if (tmp_file == nullptr or
+            not FileSystemManager::CopyFile(fs_path, tmp_file->GetPath())) {
+            return std::nullopt;
+        }
+        auto blob = ArtifactBlob::FromTempFile(
+            HashFunction{api.GetHashType()}, object_type, std::move(tmp_file));
+        if (not blob.has_value()) {
+            Logger::Log(LogLevel::Debug, std::move(blob).error());
+            return std::nullopt;
+        }
+        return *std::move(blob);
+    }
+
+    /// \brief Create the blob of a file in a workspace root. Files in file
+    /// system roots of at least the given window size are not read into
+    /// memory, but uploaded from disk. If the endpoint takes ownership of
+    /// file-backed blobs, such files are copied to its temporary space first.
+    [[nodiscard]] static auto ReadWorkspaceBlob(
+        IExecutionApi const& api,
+        FileRoot const& ws_root,
+        std::filesystem::path const& file_path,
+        ObjectType object_type,
+        std::size_t stream_window) noexcept -> std::optional<ArtifactBlob> {
+        HashFunction const hash_function{api.GetHashType()};
+        auto const fs_path = IsFileObject(object_type)
+                                 ? ws_root.FileSystemPath(file_path)
+                                 : std::nullopt;
+        if (fs_path) {
+            std::error_code ec{};
+            auto const size = std::filesystem::file_size(*fs_path, ec);
+            if (not ec and size >= stream_window) {
+                auto blob = StreamWorkspaceFile(api, *fs_path, object_type);
+                if (blob.has_value()) {
+                    return blob;
+                }
+                Logger::Log(LogLevel::Debug,
+                            "Streaming {} failed, reading it into memory",
+                            fs_path->string());
+            }
+        }
+        auto content = ws_root.ReadContent(file_path);
+        if (not content.has_value()) {
+            return std::nullopt;
+        }
+        auto blob = ArtifactBlob::FromMemory(
+            hash_function, object_type, *std::move(content));
+        if (not blob.has_value()) {
+            return std::nullopt;
+        }
+        return *std::move(blob);
+    }
+
     /// \brief Lookup file via path in local workspace root and upload.
     /// \param api          The endpoint used for uploading
     /// \param repo         The global repository name, the artifact belongs to
     /// \param repo_config  Configuration specifying the workspace root
     /// \param file_path    The path of the file to be read
+    /// \param file_digests Optional cache of digests of files in file system
+    /// roots. Unchanged files already available to the endpoint are neither
+    /// read nor uploaded again.
+    /// \param stream_window Files in file system roots of at least this size
+    /// are uploaded from disk instead of from memory.
     /// \returns The computed object info on success
     [[nodiscard]] static auto UploadFile(
         IExecutionApi const& api,
         std::string const& repo,
         gsl::not_null<const RepositoryConfig*> const& repo_config,
-        std::filesystem::path const& file_path) noexcept
+        std::filesystem::path const& file_path,
+        std::optional<gsl::not_null<FileDigestCache*>> const& file_digests =
+            std::nullopt,
+        std::size_t stream_window =
+            ExecutionContext::kDefaultStreamWindow) noexcept
         -> std::optional<Artifact::ObjectInfo> {
         auto const* ws_root = repo_config->WorkspaceRoot(repo);
         if (ws_root == nullptr) {
@@ -595,22 +767,60 @@ class ExecutorImpl {
         if (not object_type) {
             return std::nullopt;
         }
-        auto content = ws_root->ReadContent(file_path);
-        if (not content.has_value()) {
-            return std::nullopt;
+
+        // For files in file system roots, consult the digest cache; the stat
+        // data has to be taken before reading the content, so that any
+        // concurrent modification invalidates the entry stored afterwards.
+        std::optional<std::filesystem::path> fs_path{};
+        std::optional<FileDigestCache::FileStat> stat{};
+        if (file_digests and
+            (*file_digests)->GetHashType() == api.GetHashType()) {
+            fs_path = ws_root->FileSystemPath(file_path);
+            if (fs_path) {
+                stat = FileDigestCache::Stat(*fs_path);
+            }
+            if (stat) {
+                auto cached = (*file_digests)->Lookup(*fs_path, *stat);
+                if (cached and cached->type == *object_type and
+                    api.IsAvailable(cached->digest)) {
+                    return cached;
+                }
+            }
         }
 
-        auto blob = ArtifactBlob::FromMemory(
-            HashFunction{api.GetHashType()}, *object_type, *std::move(content));
+        auto blob = ReadWorkspaceBlob(
+            api, *ws_root, file_path, *object_type, stream_window);
         if (not blob.has_value()) {
             return std::nullopt;
         }
         auto digest = blob->GetDigest();
+        auto const in_place =
+            blob->IsVolatile() ? blob->GetFilePath() : std::nullopt;
         if (not api.Upload({*std::move(blob)})) {
-            return std::nullopt;
+            // A file uploaded in place is verified while it is read, so the
+            // upload fails if the file changed since it was hashed; retry with
+            // a copy, whose content cannot change anymore.
+            if (not in_place) {
+                return std::nullopt;
+            }
+            Logger::Log(LogLevel::Debug,
+                        "Uploading {} in place failed, uploading a copy",
+                        in_place->string());
+            blob = CopyWorkspaceFile(api, *in_place, *object_type);
+            if (not blob.has_value()) {
+                return std::nullopt;
+            }
+            digest = blob->GetDigest();
+            if (not api.Upload({*std::move(blob)})) {
+                return std::nullopt;
+            }
+        }
+        auto info = Artifact::ObjectInfo{.digest = std::move(digest),
+                                         .type = *object_type};
+        if (stat) {
+            (*file_digests)->Store(*fs_path, *stat, info);
         }
-        return Artifact::ObjectInfo{.digest = std::move(digest),
-                                    .type = *object_type};
+        return info;
     }
 
     /// \brief Add digests and object type to artifact nodes for all outputs of
@@ -966,74 +1176,93 @@ class Executor {
             // non-copyable and non-movable object, we need some code
             // duplication
             if (logger_ != nullptr) {
-                auto const response = Impl::ExecuteAction(
-                    *logger_,
-                    action,
-                    *context_.apis->remote,
-                    Impl::MergeProperties(context_.remote_context->exec_config
-                                              ->platform_properties,
-                                          action->ExecutionProperties()),
-                    context_.remote_context,
-                    Impl::ScaleTime(timeout_, action->TimeoutScale()),
-                    action->NoCache() ? CF::DoNotCacheOutput : CF::CacheOutput,
-                    context_.statistics,
-                    context_.progress);
-                // check response and save digests of results
-                if (not response) {
-                    return true;
-                }
-                auto result = Impl::ParseResponse(*logger_,
-                                                  *response,
-                                                  action,
-                                                  context_.statistics,
-                                                  context_.progress);
-                if (context_.profile) {
-                    (*context_.profile)
-                        ->NoteActionCompleted(action->Content().Id(),
-                                              *response,
-                                              action->Content().Cwd());
-                }
-                return result;
+                auto const response = ExecuteAction(*logger_, action);
+                return ProcessResponse(*logger_, action, response);
             }
 
             Logger logger("action:" + action->Content().Id());
+            auto const response = ExecuteAction(logger, action);
+            return ProcessResponse(logger, action, response);
+        } catch (std::exception const& ex) {
+            Logger::Log(
+                LogLevel::Error,
+                "Executor: Unexpected failure processing action with:\n{}",
+                ex.what());
+            return false;
+        }
+    }
 
-            auto const response = Impl::ExecuteAction(
-                logger,
+    /// \brief Run an action without blocking while it is executed remotely.
+    /// Preparing the action (computing digests, uploading inputs) happens on
+    /// the calling thread. Processing the response is run as a task of the
+    /// given task system once the remote execution has finished, so that
+    /// waiting for remote actions does not occupy any thread.
+    /// This method must be thread-safe as it could be called in parallel
+    /// \param[in] action The action to execute.
+    /// \param[in] ts     The task system to process the response on.
+    /// \param[in] done   Called exactly once with the result of processing,
+    /// i.e., true if execution was successful, false otherwise.
+    void Process(
+        gsl::not_null<DependencyGraph::ActionNode const*> const& action,
+        gsl::not_null<TaskSystem*> const& ts,
+        std::function<void(bool)> const& done) const noexcept {
+        // unless handed over to the remote action, the result is reported
+        // outside of the handler, so done is never called twice
+        bool result = false;
+        try {
+            // the logger must stay alive until the response is processed
+            auto logger =
+                logger_ != nullptr
+                    ? std::shared_ptr<Logger const>{std::shared_ptr<void>{},
+                                                    logger_}
+                    : std::make_shared<Logger const>(
+                          "action:" + action->Content().Id());
+            auto prepared = Impl::PrepareAction(
+                *logger,
                 action,
                 *context_.apis->remote,
-                Impl::MergeProperties(
-                    context_.remote_context->exec_config->platform_properties,
-                    action->ExecutionProperties()),
+                MergedProperties(action),
                 context_.remote_context,
                 Impl::ScaleTime(timeout_, action->TimeoutScale()),
                 action->NoCache() ? CF::DoNotCacheOutput : CF::CacheOutput,
                 context_.statistics,
                 context_.progress);
-
-            // check response and save digests of results
-            if (not response) {
-                return true;
+            if (auto* response =
+                    std::get_if<std::optional<IExecutionResponse::Ptr>>(
+                        &prepared)) {
+                result = ProcessResponse(*logger, action, *response);
             }
-            auto result = Impl::ParseResponse(logger,
-                                              *response,
-                                              action,
-                                              context_.statistics,
-                                              context_.progress);
-            if (context_.profile) {
-                (*context_.profile)
-                    ->NoteActionCompleted(action->Content().Id(),
-                                          *response,
-                                          action->Content().Cwd());
+            else {
+                auto state = std::make_shared<Impl::PreparedAction>(
+                    std::get<Impl::PreparedAction>(std::move(prepared)));
+                auto deferred = std::make_shared<TaskSystem::DeferredTask>(
+                    ts->DeferTask());
+                // the execution overlaps other spans of the starting thread
+                auto span = std::make_shared<AsyncTraceSpan>(
+                    "executor", "execute", action->Content().Id());
+                state->remote_action->ExecuteAsync(
+                    logger.get(),
+                    [this, action, done, logger, state, deferred, span](
+                        IExecutionAction::Finisher const& finish) {
+                        span->Finish();
+                        deferred->Queue([this,
+                                         action,
+                                         done,
+                                         logger,
+                                         state,
+                                         finish]() {
+                            done(FinishAction(*logger, action, *state, finish));
+                        });
+                    });
+                return;
             }
-            return result;
         } catch (std::exception const& ex) {
             Logger::Log(
                 LogLevel::Error,
                 "Executor: Unexpected failure processing action with:\n{}",
                 ex.what());
-            return false;
         }
+        done(result);
     }
 
     /// \brief Check artifact is available to the CAS or upload it.
@@ -1048,13 +1277,21 @@ class Executor {
             // non-copyable and non-movable object, we need some code
             // duplication
             if (logger_ != nullptr) {
-                return Impl::VerifyOrUploadArtifact(
-                    *logger_, artifact, context_.repo_config, *context_.apis);
+                return Impl::VerifyOrUploadArtifact(*logger_,
+                                                    artifact,
+                                                    context_.repo_config,
+                                                    *context_.apis,
+                                                    context_.file_digests,
+                                                    context_.stream_window);
             }
 
             Logger logger("artifact:" + ToHexString(artifact->Content().Id()));
-            return Impl::VerifyOrUploadArtifact(
-                logger, artifact, context_.repo_config, *context_.apis);
+            return Impl::VerifyOrUploadArtifact(logger,
+                                                artifact,
+                                                context_.repo_config,
+                                                *context_.apis,
+                                                context_.file_digests,
+                                                context_.stream_window);
         } catch (std::exception const& ex) {
             Logger::Log(
                 LogLevel::Error,
@@ -1068,6 +1305,92 @@ class Executor {
     ExecutionContext const& context_;
     Logger const* logger_;
     std::chrono::milliseconds timeout_;
+
+    [[nodiscard]] auto MergedProperties(
+        gsl::not_null<DependencyGraph::ActionNode const*> const& action) const
+        -> ExecutionProperties {
+        return Impl::MergeProperties(
+            context_.remote_context->exec_config->platform_properties,
+            action->ExecutionProperties());
+    }
+
+    [[nodiscard]] auto ExecuteAction(
+        Logger const& logger,
+        gsl::not_null<DependencyGraph::ActionNode const*> const& action) const
+        -> std::optional<IExecutionResponse::Ptr> {
+        return Impl::ExecuteAction(
+            logger,
+            action,
+            *context_.apis->remote,
+            MergedProperties(action),
+            context_.remote_context,
+            Impl::ScaleTime(timeout_, action->TimeoutScale()),
+            action->NoCache() ? CF::DoNotCacheOutput : CF::CacheOutput,
+            context_.statistics,
+            context_.progress);
+    }
+
+    /// \brief Obtain the response of an asynchronously executed action and
+    /// process it.
+    [[nodiscard]] auto FinishAction(
+        Logger const& logger,
+        gsl::not_null<DependencyGraph::ActionNode const*> const& action,
+        Impl::PreparedAction const& prepared,
+        IExecutionAction::Finisher const& finish) const noexcept -> bool {
+        try {
+            auto const response = std::make_optional(
+                Impl::FinalizeAction(logger,
+                                     *context_.apis->remote,
+                                     prepared.alternative_api.get(),
+                                     finish()));
+            return ProcessResponse(logger, action, response);
+        } catch (std::exception const& ex) {
+            Logger::Log(
+                LogLevel::Error,
+                "Executor: Unexpected failure processing action with:\n{}",
+                ex.what());
+            return false;
+        }
+    }
+
+    /// \brief Check response and save digests of results.
+    [[nodiscard]] auto ProcessResponse(
+        Logger const& logger,
+        gsl::not_null<DependencyGraph::ActionNode const*> const& action,
+        std::optional<IExecutionResponse::Ptr> const& response) const -> bool {
+        if (not response) {
+            return true;
+        }
+        auto result = Impl::ParseResponse(logger,
+                                          *response,
+                                          action,
+                                          context_.statistics,
+                                          context_.progress);
+        if (context_.profile) {
+            (*context_.profile)
+                ->NoteActionCompleted(action->Content().Id(),
+                                      *response,
+                                      action->Content().Cwd());
+        }
+        if (context_.durations and *response) {
+            NoteDuration(action, **response);
+        }
+        return result;
+    }
+
+    /// \brief Record the duration of an executed action in the history and
+    /// account for its work in the progress.
+    void NoteDuration(
+        gsl::not_null<DependencyGraph::ActionNode const*> const& action,
+        IExecutionResponse& response) const {
+        auto const cached = response.IsCached();
+        context_.progress->FinishExpectedWork(action->Content().Id(),
+                                              /*executed=*/not cached);
+        if (not cached and response.ExitCode() == 0) {
+            (*context_.durations)
+                ->Record(action->Content(), response.ExecutionDuration());
+        }
+    }
 };
 
 /// \brief Rebuilder for running and comparing actions of two API endpoints.
@@ -1160,8 +1483,12 @@ class Rebuilder {
         const noexcept -> bool {
         try {
             Logger logger("artifact:" + ToHexString(artifact->Content().Id()));
-            return Impl::VerifyOrUploadArtifact(
-                logger, artifact, context_.repo_config, *context_.apis);
+            return Impl::VerifyOrUploadArtifact(logger,
+                                                artifact,
+                                                context_.repo_config,
+                                                *context_.apis,
+                                                context_.file_digests,
+                                                context_.stream_window);
         } catch (std::exception const& ex) {
             Logger::Log(
                 LogLevel::Error,
@@ -15,12 +15,18 @@
 #ifndef INCLUDED_SRC_BUILDTOOL_EXECUTION_ENGINE_TRAVERSER_TRAVERSER_HPP
 #define INCLUDED_SRC_BUILDTOOL_EXECUTION_ENGINE_TRAVERSER_TRAVERSER_HPP
 
+#include <algorithm>
 #include <atomic>
 #include <concepts>
 #include <cstddef>
 #include <functional>
+#include <mutex>
+#include <queue>
 #include <string>
+#include <type_traits>
+#include <unordered_map>
 #include <unordered_set>
+#include <utility>
 #include <vector>
 
 #include "gsl/gsl"
@@ -39,20 +45,47 @@ concept Runnable = requires(T const r,
     { r.Process(artifact) } -> std::same_as<bool>;
 };
 
+/// \brief Concept for Runners that can process actions asynchronously, i.e.,
+/// without blocking a thread of the given task system while an action is
+/// executed, and calling back with the result once done.
+template <class T>
+concept AsyncRunnable =
+    Runnable<T> and requires(T const r,
+                             DependencyGraph::ActionNode const* action,
+                             TaskSystem* ts,
+                             std::function<void(bool)> const& done) {
+        { r.Process(action, ts, done) } -> std::same_as<void>;
+    };
+
 /// \brief Class to traverse the dependency graph executing necessary actions
 /// \tparam Executor    Type of the executor
 //  Traversal of the graph and execution of actions are concurrent, using
 /// the //src/buildtool/execution_engine/task_system.
 /// Graph remains constant and the only parts of the nodes that are modified are
 /// their traversal state
+/// Actions ready to be executed are dispatched by decreasing length of their
+/// critical path, i.e., the longest chain of actions depending on them, so
+/// that long chains of dependent actions are started as early as possible.
 template <Runnable Executor>
 class Traverser {
   public:
+    /// \brief Estimated duration of an action, in arbitrary but consistent
+    /// units, used to weigh the critical paths.
+    using DurationEstimate =
+        std::function<double(DependencyGraph::ActionNode const&)>;
+
+    /// \param estimate Duration estimate for actions; if not given, every
+    /// action counts the same, so the critical path is the graph depth.
     explicit Traverser(Executor const& r,
                        DependencyGraph const& graph,
                        std::size_t jobs,
-                       gsl::not_null<std::atomic<bool>*> const& fail_flag)
-        : runner_{r}, graph_{graph}, failed_{fail_flag}, tasker_{jobs} {}
+                       gsl::not_null<std::atomic<bool>*> const& fail_flag,
+                       DurationEstimate estimate = {})
+        : runner_{r},
+          graph_{graph},
+          failed_{fail_flag},
+          estimate_{std::move(estimate)},
+          tasker_{jobs} {}
     Traverser() = delete;
     Traverser(Traverser const&) = delete;
     Traverser(Traverser&&) = delete;
@@ -73,9 +106,29 @@ class Traverser {
                                     target_ids) noexcept -> bool;
 
   private:
+    struct ReadyAction {
+        double critical_path{};
+        std::size_t sequence{};  // to dispatch equal paths in order
+        DependencyGraph::ActionNode const* node{};
+
+        [[nodiscard]] auto operator<(ReadyAction const& other) const noexcept
+            -> bool {
+            if (critical_path != other.critical_path) {
+                return critical_path < other.critical_path;
+            }
+            return sequence > other.sequence;
+        }
+    };
+
     Executor const& runner_{};
     DependencyGraph const& graph_;
     gsl::not_null<std::atomic<bool>*> failed_;
+    DurationEstimate estimate_;
+    std::mutex ready_mutex_;
+    std::priority_queue<ReadyAction> ready_;
+    std::size_t ready_sequence_{};
+    std::unordered_map<DependencyGraph::ActionNode const*, double>
+        critical_paths_;
     TaskSystem tasker_;  // THIS SHOULD BE THE LAST MEMBER VARIABLE
 
     // Visits discover nodes and queue visits to their children nodes.
@@ -113,20 +166,113 @@ class Traverser {
     // was successful
     template <typename NodeTypePtr>
     void QueueProcessing(NodeTypePtr node) noexcept {
-        if (failed_->load() or not node->TraversalState()->IsRequired() or
-            node->TraversalState()->GetAndMarkQueuedToBeProcessed()) {
+        if (not MarkQueuedToBeProcessed(node)) {
             return;
         }
 
-        auto process_node = [this, node]() {
-            if (runner_.Process(node)) {
-                NotifyAvailable(node);
+        if constexpr (std::is_convertible_v<
+                          NodeTypePtr,
+                          DependencyGraph::ActionNode const*>) {
+            QueueReadyActions({node});
+        }
+        else {
+            auto process_node = [this, node]() {
+                NotifyProcessed(node, runner_.Process(node));
+            };
+            tasker_.QueueTask(process_node);
+        }
+    }
+
+    // Check that the node is required and mark it as queued to be processed.
+    // Returns false if the node must not be queued (again).
+    template <typename NodeTypePtr>
+    [[nodiscard]] auto MarkQueuedToBeProcessed(NodeTypePtr node) noexcept
+        -> bool {
+        return not failed_->load() and node->TraversalState()->IsRequired() and
+               not node->TraversalState()->GetAndMarkQueuedToBeProcessed();
+    }
+
+    // Add actions that became ready at the same time to the ready queue and
+    // queue one task per action. Every queued task dispatches the ready action
+    // with the longest critical path at the time it runs.
+    void QueueReadyActions(
+        std::vector<DependencyGraph::ActionNode const*> const& nodes) noexcept {
+        {
+            std::unique_lock lock{ready_mutex_};
+            for (auto const* node : nodes) {
+                ready_.push(ReadyAction{.critical_path = CriticalPath(node),
+                                        .sequence = ready_sequence_++,
+                                        .node = node});
             }
-            else {
-                Abort();
+        }
+        for (std::size_t i = 0; i < nodes.size(); ++i) {
+            tasker_.QueueTask([this]() { ProcessNextReady(); });
+        }
+    }
+
+    void ProcessNextReady() noexcept {
+        DependencyGraph::ActionNode const* node = nullptr;
+        {
+            std::unique_lock lock{ready_mutex_};
+            node = ready_.top().node;
+            ready_.pop();
+        }
+        if constexpr (AsyncRunnable<Executor>) {
+            runner_.Process(node, &tasker_, [this, node](bool success) {
+                NotifyProcessed(node, success);
+            });
+        }
+        else {
+            NotifyProcessed(node, runner_.Process(node));
+        }
+    }
+
+    /// \brief Length of the critical path starting at the given action, i.e.,
+    /// its estimated duration plus the longest critical path of the actions
+    /// consuming its outputs. Caller must hold ready_mutex_.
+    [[nodiscard]] auto CriticalPath(
+        DependencyGraph::ActionNode const* action) noexcept -> double {
+        // Iterative post-order traversal over the consumers, as chains of
+        // dependent actions can be long.
+        std::vector<std::pair<DependencyGraph::ActionNode const*, bool>> stack{
+            {action, false}};
+        while (not stack.empty()) {
+            auto const [node, expanded] = stack.back();
+            stack.pop_back();
+            if (critical_paths_.contains(node)) {
+                continue;
+            }
+            if (not expanded) {
+                stack.emplace_back(node, true);
+                for (auto const& output : node->Parents()) {
+                    for (auto const& consumer : output->Parents()) {
+                        if (not critical_paths_.contains(consumer)) {
+                            stack.emplace_back(consumer, false);
+                        }
+                    }
+                }
+                continue;
             }
-        };
-        tasker_.QueueTask(process_node);
+            double longest = 0.0;
+            for (auto const& output : node->Parents()) {
+                for (auto const& consumer : output->Parents()) {
+                    longest = std::max(longest, critical_paths_[consumer]);
+                }
+            }
+            critical_paths_[node] =
+                longest + (estimate_ ? estimate_(*node) : 1.0);
+        }
+        return critical_paths_[action];
+    }
+
+    template <typename NodeTypePtr>
+    void NotifyProcessed(NodeTypePtr node, bool success) noexcept {
+        if (success) {
+            NotifyAvailable(node);
+        }
+        else {
+            Abort();
+        }
     }
 
     void Abort() noexcept {
@@ -197,11 +343,16 @@ void Traverser<Executor>::NotifyAvailable(
     gsl::not_null<DependencyGraph::ArtifactNode const*> const&
         artifact_node) noexcept {
     artifact_node->TraversalState()->MakeAvailable();
+    std::vector<DependencyGraph::ActionNode const*> ready{};
     for (auto const& action_node : artifact_node->Parents()) {
-        if (action_node->TraversalState()->NotifyAvailableDepAndCheckReady()) {
-            QueueProcessing(action_node);
+        if (action_node->TraversalState()->NotifyAvailableDepAndCheckReady() and
+            MarkQueuedToBeProcessed(action_node)) {
+            ready.push_back(action_node);
         }
     }
+    // queue all actions that became ready at once, so that they are
+    // dispatched by their critical paths
+    QueueReadyActions(ready);
 }
 
 template <Runnable Executor>
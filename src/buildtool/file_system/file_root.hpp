@@ -35,6 +35,7 @@
 #include "src/buildtool/common/artifact_digest.hpp"
 #include "src/buildtool/common/artifact_digest_factory.hpp"
 #include "src/buildtool/common/git_hashes_converter.hpp"
+#include "src/buildtool/common/git_hashes_store.hpp"
 #include "src/buildtool/common/protocol_traits.hpp"
 #include "src/buildtool/crypto/hash_function.hpp"
 #include "src/buildtool/file_system/file_system_manager.hpp"
@@ -373,7 +374,7 @@ class FileRoot {
         if (not raw_tree_id) {
             return std::nullopt;
         }
-        auto cas = GitCAS::Open(repo_path);
+        auto cas = GitCAS::OpenShared(repo_path);
         if (not cas) {
             return std::nullopt;
         }
@@ -448,6 +449,20 @@ class FileRoot {
         return std::nullopt;
     }
 
+    /// \brief Get the path in the local file system of an entry of a file
+    /// system root. Returns nullopt for all other kinds of roots.
+    [[nodiscard]] auto FileSystemPath(std::filesystem::path const& path)
+        const noexcept -> std::optional<std::filesystem::path> {
+        if (auto const* fs_root = std::get_if<fs_root_t>(&root_)) {
+            try {
+                return *fs_root / path;
+            } catch (...) {
+                return std::nullopt;
+            }
+        }
+        return std::nullopt;
+    }
+
     /// \brief Indicates that subsequent calls to `Exists()`, `IsFile()`,
     /// `IsDirectory()`, and `BlobType()` on valid contents of the same
     /// directory will be served without any additional file system lookups.
@@ -701,10 +716,13 @@ class FileRoot {
 
     /// \brief Create LOCAL or KNOWN artifact. Does not check existence or
     /// validity for LOCAL. `file_path` must reference a blob.
+    /// \param git_hashes   Optional store of compatible hashes of git blobs
+    /// converted before, to avoid reading them again in compatible mode.
     [[nodiscard]] auto ToArtifactDescription(
         HashFunction::Type hash_type,
         std::filesystem::path const& file_path,
-        std::string const& repository) const noexcept
+        std::string const& repository,
+        IGitHashesStore* git_hashes = nullptr) const noexcept
         -> std::optional<ArtifactDescription> {
         if (std::holds_alternative<RootGit>(root_)) {
             if (auto entry = std::get<RootGit>(root_).tree->LookupEntryByPath(
@@ -719,19 +737,27 @@ class FileRoot {
                 }
                 if (IsBlobObject(entry->Type())) {
                     if (not ProtocolTraits::IsNative(hash_type)) {
-                        // read blob content, if not read already
-                        if (not blob) {
-                            blob = entry->Blob();
+                        auto& converter = GitHashesConverter::Instance();
+                        // blobs converted before need not be read again
+                        auto compatible_hash = converter.LookupGitEntry(
+                            entry->Hash(), repository, git_hashes);
+                        if (not compatible_hash) {
+                            // read blob content, if not read already
                             if (not blob) {
-                                return std::nullopt;
+                                blob = entry->Blob();
+                                if (not blob) {
+                                    return std::nullopt;
+                                }
                             }
+                            compatible_hash =
+                                converter.RegisterGitEntry(entry->Hash(),
+                                                           *std::move(blob),
+                                                           repository,
+                                                           git_hashes);
                         }
-                        auto compatible_hash =
-                            GitHashesConverter::Instance().RegisterGitEntry(
-                                entry->Hash(), *std::move(blob), repository);
                         auto digest =
                             ArtifactDigestFactory::Create(hash_type,
-                                                          compatible_hash,
+                                                          *compatible_hash,
                                                           *entry->Size(),
                                                           /*is_tree=*/false);
                         if (not digest) {
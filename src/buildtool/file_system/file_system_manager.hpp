@@ -18,6 +18,11 @@
 #ifdef __unix__
 #include <fcntl.h>
 #include <pwd.h>
+#ifdef __linux__
+#include <linux/fs.h>  // FICLONE
+#include <sys/ioctl.h>
+#include <sys/sendfile.h>
+#endif
 #include <sys/stat.h>
 #include <sys/types.h>
 #include <sys/wait.h>
@@ -309,6 +314,8 @@ class FileSystemManager {
     }
 
     /// \brief Copy file
+    /// Where supported by the file system, the file is cloned (reflink) or
+    /// copied in the kernel instead of through a user-space buffer.
     /// If argument fd_less is given, the copy will be performed in a child
     /// process to prevent polluting the parent with open writable file
     /// descriptors (which might be inherited by other children that keep them
@@ -1076,7 +1083,23 @@ class FileSystemManager {
                     LogLevel::Error, "cannot remove file {}", dst.string());
                 return false;
             }
-            return std::filesystem::copy_file(src, dst, opt);
+            // Copy with the low-level operation, which clones or copies in
+            // the kernel if possible, and keep the permissions of the source.
+            auto const perms = std::filesystem::status(src).permissions();
+            if (auto const res = LowLevel::CopyFile(
+                    src.c_str(),
+                    dst.c_str(),
+                    opt == std::filesystem::copy_options::skip_existing);
+                res != 0) {
+                Logger::Log(LogLevel::Error,
+                            "copying file from {} to {}:\n{}",
+                            src.string(),
+                            dst.string(),
+                            LowLevel::ErrorToString(res));
+                return false;
+            }
+            std::filesystem::permissions(dst, perms);
+            return true;
         } catch (std::exception const& e) {
             Logger::Log(LogLevel::Error,
                         "copying file from {} to {}:\n{}",
@@ -1231,15 +1254,64 @@ class FileSystemManager {
             if (in.fd == -1) {
                 return PackError(ERROR_OPEN_INPUT, errno);
             }
+            return CopyContent<kChunkSize>(in.fd, out.fd);
+        }
+
+        /// \brief Copy the remaining content of one file descriptor to
+        /// another. Regular files are first tried to be cloned (reflink), then
+        /// copied in the kernel. If the file system does not support either,
+        /// the content is copied through a user-space buffer.
+        template <std::size_t kChunkSize = kDefaultChunkSize>
+        [[nodiscard]] static auto CopyContent(int in_fd,
+                                              int out_fd) noexcept -> int {
+#ifdef __linux__
+            // Only for regular files the size is known; others (e.g., in
+            // procfs) may report an empty size for non-empty content.
+            struct stat in_stat{};
+            if (fstat(in_fd, &in_stat) == 0 and S_ISREG(in_stat.st_mode) and
+                in_stat.st_size > 0) {
+#ifdef FICLONE
+                if (ioctl(out_fd, FICLONE, in_fd) == 0) {  // NOLINT
+                    return 0;
+                }
+#endif
+                // Both calls use and advance the file offsets, so falling back
+                // after a partial copy continues where the previous call
+                // stopped.
+                ssize_t len{};
+                while ((len = copy_file_range(in_fd,
+                                              nullptr,
+                                              out_fd,
+                                              nullptr,
+                                              kMaxKernelCopy,
+                                              0)) > 0) {
+                }
+                if (len == 0) {
+                    return 0;
+                }
+                if (not IsUnsupportedCopy(errno)) {
+                    return PackError(ERROR_WRITE_OUTPUT, errno);
+                }
+                while ((len = sendfile(
+                            out_fd, in_fd, nullptr, kMaxKernelCopy)) > 0) {
+                }
+                if (len == 0) {
+                    return 0;
+                }
+                if (not IsUnsupportedCopy(errno)) {
+                    return PackError(ERROR_WRITE_OUTPUT, errno);
+                }
+            }
+#endif
 
             ssize_t len{};
             std::array<std::uint8_t, kChunkSize> buf{};
-            while ((len = read(in.fd, buf.data(), buf.size())) > 0) {
+            while ((len = read(in_fd, buf.data(), buf.size())) > 0) {
                 ssize_t wlen{};
                 ssize_t written_len{};
                 while (written_len < len and
                        (wlen = write(
-                            out.fd,
+                            out_fd,
                             buf.data() + written_len,  // NOLINT
                             static_cast<std::size_t>(len - written_len))) > 0) {
                     written_len += wlen;
@@ -1305,6 +1377,17 @@ class FileSystemManager {
         }
 
       private:
+        // Maximum number of bytes to copy by a single in-kernel copy call.
+        static constexpr std::size_t kMaxKernelCopy = 1UL << 30U;
+
+        /// \brief Whether an in-kernel copy failed because it is not supported
+        /// for the given files, e.g., across file systems on older kernels.
+        [[nodiscard]] static auto IsUnsupportedCopy(int err) noexcept -> bool {
+            return err == ENOSYS or err == EXDEV or err == EINVAL or
+                   err == EOPNOTSUPP or err == ENOTSUP or err == EPERM or
+                   err == EBADF or err == ETXTBSY;
+        }
+
         enum ErrorCodes : std::uint8_t {
             ERROR_READ_INPUT,    // read() input file failed
             ERROR_OPEN_INPUT,    // open() input file failed
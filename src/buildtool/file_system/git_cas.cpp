@@ -16,9 +16,12 @@
 
 #include <exception>
 #include <mutex>
+#include <string>
+#include <unordered_map>
 
 #include "src/buildtool/file_system/git_context.hpp"
 #include "src/buildtool/logging/logger.hpp"
+#include "src/buildtool/profile/trace.hpp"
 #include "src/utils/cpp/hex_string.hpp"
 #include "src/utils/cpp/path.hpp"
 
@@ -49,6 +52,22 @@ namespace {
 
 #endif  // BOOTSTRAP_BUILD_TOOL
 
+namespace {
+
+/// \brief Repositories opened by GitCAS::OpenShared, if kept open.
+struct SharedRepositories {
+    std::mutex mutex;
+    bool keep_open{false};
+    std::unordered_map<std::string, GitCASPtr> repositories;
+};
+
+[[nodiscard]] auto Shared() noexcept -> SharedRepositories& {
+    static SharedRepositories shared{};
+    return shared;
+}
+
+}  // namespace
+
 GitCAS::GitCAS() noexcept {
     GitContext::Create();
 }
@@ -106,6 +125,40 @@ auto GitCAS::Open(std::filesystem::path const& repo_path,
 #endif
 }
 
+auto GitCAS::OpenShared(std::filesystem::path const& repo_path,
+                        LogLevel log_failure) noexcept -> GitCASPtr {
+    auto& shared = Shared();
+    try {
+        auto const key = ToNormalPath(std::filesystem::absolute(repo_path));
+        std::unique_lock lock{shared.mutex};
+        if (not shared.keep_open) {
+            lock.unlock();
+            return Open(repo_path, log_failure);
+        }
+        if (auto it = shared.repositories.find(key.string());
+            it != shared.repositories.end()) {
+            return it->second;
+        }
+        auto result = Open(repo_path, log_failure);
+        if (result != nullptr) {
+            shared.repositories.emplace(key.string(), result);
+        }
+        return result;
+    } catch (std::exception const& e) {
+        Logger::Log(log_failure,
+                    "Unexpected failure opening git object database {}:\n{}",
+                    repo_path.string(),
+                    e.what());
+        return nullptr;
+    }
+}
+
+void GitCAS::KeepOpen() noexcept {
+    auto& shared = Shared();
+    std::unique_lock lock{shared.mutex};
+    shared.keep_open = true;
+}
+
 auto GitCAS::CreateEmpty() noexcept -> GitCASPtr {
 #ifdef BOOTSTRAP_BUILD_TOOL
     return nullptr;
@@ -149,6 +202,7 @@ auto GitCAS::ReadObject(std::string const& id,
 #ifdef BOOTSTRAP_BUILD_TOOL
     return std::nullopt;
 #else
+    TraceSpan const span{"git", "read object"};
     try {
         if (not odb_) {
             return std::nullopt;
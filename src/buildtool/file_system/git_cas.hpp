@@ -37,6 +37,18 @@ class GitCAS {
         std::filesystem::path const& repo_path,
         LogLevel log_failure = LogLevel::Warning) noexcept -> GitCASPtr;
 
+    /// \brief Open a repository only to be read from, e.g., as a root. Once
+    /// \ref KeepOpen was called, the repository stays open and is shared with
+    /// all later calls for the same path.
+    [[nodiscard]] static auto OpenShared(
+        std::filesystem::path const& repo_path,
+        LogLevel log_failure = LogLevel::Warning) noexcept -> GitCASPtr;
+
+    /// \brief Keep repositories opened by \ref OpenShared open for the
+    /// lifetime of the process. Meant for long-running processes serving many
+    /// requests for the same roots.
+    static void KeepOpen() noexcept;
+
     [[nodiscard]] static auto CreateEmpty() noexcept -> GitCASPtr;
 
     GitCAS() noexcept;
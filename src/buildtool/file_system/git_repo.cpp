@@ -1499,6 +1499,75 @@ auto GitRepo::WriteBlob(std::string const& content,
 #endif  // BOOTSTRAP_BUILD_TOOL
 }
 
+auto GitRepo::WriteBlobStream(std::size_t size,
+                              BlobStreamFunc const& produce,
+                              anon_logger_ptr const& logger) noexcept
+    -> std::optional<std::string> {
+#ifdef BOOTSTRAP_BUILD_TOOL
+    return std::nullopt;
+#else
+    try {
+        // preferably with a "fake" repository!
+        if (not IsRepoFake()) {
+            Logger::Log(LogLevel::Debug,
+                        "Blob stream writer called on a real repository");
+        }
+
+        git_odb_stream* stream_ptr{nullptr};
+        if (git_odb_open_wstream(
+                &stream_ptr, git_cas_->GetODB(), size, GIT_OBJECT_BLOB) != 0) {
+            std::invoke(*logger,
+                        fmt::format("Opening blob stream into database failed "
+                                    "with:\n{}",
+                                    GitLastError()),
+                        /*fatal=*/true);
+            git_odb_stream_free(stream_ptr);
+            return std::nullopt;
+        }
+        auto stream =
+            std::unique_ptr<git_odb_stream, decltype(&odb_stream_closer)>(
+                stream_ptr, odb_stream_closer);
+
+        bool write_failed{false};
+        auto sink = [&stream, &write_failed](std::string_view chunk) -> bool {
+            if (git_odb_stream_write(
+                    stream.get(), chunk.data(), chunk.size()) != 0) {
+                write_failed = true;
+                return false;
+            }
+            return true;
+        };
+        if (not produce(sink)) {
+            std::invoke(*logger,
+                        write_failed
+                            ? fmt::format("Writing blob stream into database "
+                                          "failed with:\n{}",
+                                          GitLastError())
+                            : std::string{"Producing blob content failed"},
+                        /*fatal=*/true);
+            return std::nullopt;
+        }
+
+        // the stream checks that the announced size was written
+        git_oid blob_oid;
+        if (git_odb_stream_finalize_write(&blob_oid, stream.get()) != 0) {
+            std::invoke(*logger,
+                        fmt::format("Finalizing blob stream failed with:\n{}",
+                                    GitLastError()),
+                        /*fatal=*/true);
+            return std::nullopt;
+        }
+        return std::string{git_oid_tostr_s(&blob_oid)};
+    } catch (std::exception const& ex) {
+        std::invoke(*logger,
+                    fmt::format("Write blob stream failed with:\n{}",
+                                ex.what()),
+                    true /*fatal*/);
+        return std::nullopt;
+    }
+#endif  // BOOTSTRAP_BUILD_TOOL
+}
+
 auto GitRepo::GetObjectByPathFromTree(std::string const& tree_id,
                                       std::string const& rel_path) noexcept
     -> std::optional<TreeEntryInfo> {
@@ -15,12 +15,14 @@
 #ifndef INCLUDED_SRC_BUILDTOOL_FILE_SYSTEM_GIT_REPO_HPP
 #define INCLUDED_SRC_BUILDTOOL_FILE_SYSTEM_GIT_REPO_HPP
 
+#include <cstddef>
 #include <filesystem>
 #include <functional>
 #include <memory>
 #include <mutex>
 #include <optional>
 #include <string>
+#include <string_view>
 #include <unordered_map>
 #include <utility>  // std::move
 #include <vector>
@@ -305,6 +307,25 @@ class GitRepo {
                                  anon_logger_ptr const& logger) noexcept
         -> std::optional<std::string>;
 
+    /// \brief Sink for the content of a streamed blob. Returns false on
+    /// failure to write.
+    using BlobChunkSink = std::function<bool(std::string_view)>;
+    /// \brief Producer of the content of a streamed blob, passing it in
+    /// chunks to the given sink. Returns false on failure.
+    using BlobStreamFunc = std::function<bool(BlobChunkSink const&)>;
+
+    /// \brief Write a blob of given size into the underlying object database,
+    /// with the content produced in chunks. Unlike WriteBlob, the content is
+    /// never held in memory as a whole. Calling it from a fake repository
+    /// allows thread-safe use.
+    /// \returns Git ID of the written blob, or nullopt on errors, including
+    /// a mismatch between the given size and that of the produced content.
+    /// It guarantees the logger is called exactly once with fatal if failure.
+    [[nodiscard]] auto WriteBlobStream(std::size_t size,
+                                       BlobStreamFunc const& produce,
+                                       anon_logger_ptr const& logger) noexcept
+        -> std::optional<std::string>;
+
     /// \brief Get the object info related to a given path inside a Git tree.
     /// Unlike GetSubtreeFromTree, we here ignore errors and only return a value
     /// when all is successful.
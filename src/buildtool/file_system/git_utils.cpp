@@ -76,6 +76,12 @@ void odb_closer(gsl::owner<git_odb*> odb) {
 #endif
 }
 
+void odb_stream_closer(gsl::owner<git_odb_stream*> stream) {
+#ifndef BOOTSTRAP_BUILD_TOOL
+    git_odb_stream_free(stream);
+#endif
+}
+
 void repository_closer(gsl::owner<git_repository*> repository) {
 #ifndef BOOTSTRAP_BUILD_TOOL
     git_repository_free(repository);
@@ -24,6 +24,7 @@
 extern "C" {
 struct git_oid;
 struct git_odb;
+struct git_odb_stream;
 struct git_repository;
 struct git_tree;
 struct git_signature;
@@ -48,6 +49,8 @@ constexpr std::size_t kGitLockNumTries{10};
 
 void odb_closer(gsl::owner<git_odb*> odb);
 
+void odb_stream_closer(gsl::owner<git_odb_stream*> stream);
+
 void repository_closer(gsl::owner<git_repository*> repository);
 
 void tree_closer(gsl::owner<git_tree*> tree);
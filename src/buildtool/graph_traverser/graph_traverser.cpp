@@ -27,13 +27,18 @@
 #include <cstdint>
 #include <cstdio>
 #include <fstream>
+#include <functional>
 #include <iomanip>
 #include <iostream>
 #include <iterator>
 #include <memory>
 #include <sstream>
+#include <string>
 #include <thread>
+#include <unordered_map>
 #include <unordered_set>
+#include <utility>
+#include <vector>
 
 #include "fmt/core.h"
 #include "src/buildtool/common/artifact_blob.hpp"
@@ -50,10 +55,67 @@
 #include "src/buildtool/file_system/jsonfs.hpp"
 #include "src/buildtool/file_system/object_type.hpp"
 #include "src/buildtool/logging/log_level.hpp"
+#include "src/buildtool/profile/trace.hpp"
+#include "src/buildtool/storage/action_duration_history.hpp"
 #include "src/utils/cpp/expected.hpp"
 #include "src/utils/cpp/json.hpp"
 #include "src/utils/cpp/path.hpp"
 
+namespace {
+
+using DurationEstimate =
+    std::function<double(DependencyGraph::ActionNode const&)>;
+
+/// \brief Estimate the duration of actions from the history of action
+/// durations, if available.
+[[nodiscard]] auto EstimateFromHistory(ExecutionContext const& context)
+    -> DurationEstimate {
+    if (not context.durations) {
+        return {};
+    }
+    ActionDurationHistory const* durations = *context.durations;
+    return [durations](DependencyGraph::ActionNode const& action) {
+        return durations->Estimate(action.Content())
+            .value_or(ActionDurationHistory::kDefaultEstimate);
+    };
+}
+
+/// \brief Estimate the durations of all actions needed to build the given
+/// artifacts, by action identifier.
+[[nodiscard]] auto ExpectedWork(
+    DependencyGraph const& g,
+    std::vector<ArtifactIdentifier> const& artifact_ids,
+    DurationEstimate const& estimate)
+    -> std::unordered_map<std::string, double> {
+    std::unordered_set<DependencyGraph::ActionNode const*> seen{};
+    std::vector<DependencyGraph::ArtifactNode const*> to_visit{};
+    for (auto const& id : artifact_ids) {
+        if (auto const* node = g.ArtifactNodeWithId(id)) {
+            to_visit.push_back(node);
+        }
+    }
+    std::unordered_map<std::string, double> work{};
+    while (not to_visit.empty()) {
+        auto const* artifact = to_visit.back();
+        to_visit.pop_back();
+        if (not artifact->HasBuilderAction()) {
+            continue;
+        }
+        DependencyGraph::ActionNode const* action =
+            artifact->BuilderActionNode();
+        if (not seen.insert(action).second) {
+            continue;
+        }
+        work.emplace(action->Content().Id(), estimate(*action));
+        for (auto const& dep : action->Children()) {
+            to_visit.push_back(dep);
+        }
+    }
+    return work;
+}
+
+}  // namespace
+
 auto GraphTraverser::BuildAndStage(
     std::map<std::string, ArtifactDescription> const& artifact_descriptions,
     std::map<std::string, ArtifactDescription> const& runfile_descriptions,
@@ -340,6 +402,11 @@ auto GraphTraverser::Traverse(
     DependencyGraph const& g,
     std::vector<ArtifactIdentifier> const& artifact_ids) const -> bool {
     Executor executor{&context_, logger_, clargs_.build.timeout};
+    auto estimate = EstimateFromHistory(context_);
+    if (estimate) {
+        context_.progress->AddExpectedWork(
+            ExpectedWork(g, artifact_ids, estimate));
+    }
     bool traversing{};
     std::atomic<bool> done = false;
     std::atomic<bool> failed = false;
@@ -347,7 +414,7 @@ auto GraphTraverser::Traverse(
     auto observer =
         std::thread([this, &done, &cv]() { reporter_(&done, &cv); });
     {
-        Traverser t{executor, g, clargs_.jobs, &failed};
+        Traverser t{executor, g, clargs_.jobs, &failed, std::move(estimate)};
         traversing =
             t.Traverse({std::begin(artifact_ids), std::end(artifact_ids)});
     }
@@ -547,6 +614,7 @@ auto GraphTraverser::RetrieveOutputs(
     std::vector<std::filesystem::path> const& rel_paths,
     std::vector<Artifact::ObjectInfo> const& object_infos) const
     -> std::optional<std::vector<std::filesystem::path>> {
+    TraceSpan const span{"traverser", "retrieve outputs"};
     // Create output directory
     if (not FileSystemManager::CreateDirectory(clargs_.stage->output_dir)) {
         return std::nullopt;  // Message logged in the file system manager
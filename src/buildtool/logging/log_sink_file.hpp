@@ -16,8 +16,11 @@
 #define INCLUDED_SRC_BUILDTOOL_LOGGING_LOG_SINK_FILE_HPP
 
 #include <algorithm>
+#include <atomic>
+#include <condition_variable>
 #include <cstdint>
 #include <cstdio>
+#include <cstdlib>
 #include <ctime>
 #include <filesystem>
 #include <functional>
@@ -27,7 +30,14 @@
 #include <sstream>
 #include <string>
 #include <thread>
+#include <tuple>  // std::ignore
 #include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include <sys/types.h>
+#include <unistd.h>
 
 #include "fmt/chrono.h"
 #include "fmt/core.h"
@@ -50,14 +60,205 @@ class MutexMap {
         }
     }
     /// \brief Get mutex for key, creates mutex if key does not exist.
-    [[nodiscard]] auto Get(TKey const& key) noexcept -> std::mutex& {
+    /// The mutex is co-owned by the caller, so it outlives the map if needed.
+    [[nodiscard]] auto Get(TKey const& key) -> std::shared_ptr<std::mutex> {
         std::lock_guard lock(mutex_);
-        return map_[key];
+        auto& mutex = map_[key];
+        if (mutex == nullptr) {
+            mutex = std::make_shared<std::mutex>();
+        }
+        return mutex;
     }
 
   private:
     std::mutex mutex_;
-    std::unordered_map<TKey, std::mutex> map_;
+    std::unordered_map<TKey, std::shared_ptr<std::mutex>> map_;
+};
+
+/// \brief Background writer appending records to a log file. Records are
+/// queued by the emitting threads and written in batches by a single thread,
+/// which keeps the file open. Batches are written holding the mutex of the
+/// file, so they do not interleave with records written synchronously.
+/// The thread and its synchronization state are created on demand in the
+/// current process. A forked child creates its own and never touches the ones
+/// inherited from its parent, as their mutex might have been held by another
+/// thread of the parent at the time of the fork; the inherited ones are leaked
+/// and records queued but not yet written are left to the parent.
+/// All writers are stopped on process exit, before static objects are
+/// destroyed, so queued records do not depend on the destruction order of the
+/// sinks owning the writers.
+class AsyncLogFileWriter final {
+  public:
+    AsyncLogFileWriter(std::string file_path,
+                       std::shared_ptr<std::mutex> file_mutex)
+        : file_path_{std::move(file_path)}, file_mutex_{std::move(file_mutex)} {
+        static std::once_flag registered{};
+        std::call_once(registered, []() { std::atexit(&StopAll); });
+        auto& registry = Registry();
+        std::lock_guard lock{registry.mutex};
+        registry.writers.insert(this);
+    }
+
+    /// \brief Write all queued records before returning.
+    ~AsyncLogFileWriter() noexcept {
+        {
+            auto& registry = Registry();
+            std::lock_guard lock{registry.mutex};
+            registry.writers.erase(this);
+        }
+        auto* state = state_.load();
+        if (state == nullptr or state->owner != ::getpid()) {
+            // state of the parent process, whose thread does not exist here
+            return;
+        }
+        auto owned = std::unique_ptr<State>{state};
+        Stop(owned.get());
+    }
+
+    AsyncLogFileWriter(AsyncLogFileWriter const&) = delete;
+    AsyncLogFileWriter(AsyncLogFileWriter&&) = delete;
+    auto operator=(AsyncLogFileWriter const&) -> AsyncLogFileWriter& = delete;
+    auto operator=(AsyncLogFileWriter&&) -> AsyncLogFileWriter& = delete;
+
+    /// \brief Queue a record for writing.
+    /// \param wait  Block until the record is written.
+    /// \returns False if the record could not be queued, e.g., as the writer
+    /// thread could not be started; the caller has to write it then.
+    [[nodiscard]] auto Push(std::string&& record, bool wait) noexcept -> bool {
+        try {
+            auto* state = LocalState();
+            std::unique_lock lock{state->mutex};
+            if (state->stop) {
+                // the writer was already stopped on exit
+                return false;
+            }
+            state->queue.emplace_back(std::move(record));
+            auto const id = ++state->pushed;
+            state->queued.notify_one();
+            if (wait) {
+                state->flushed.wait(
+                    lock, [state, id]() { return state->written >= id; });
+            }
+            return true;
+        } catch (...) {
+            return false;
+        }
+    }
+
+  private:
+    // Synchronization state and thread of the process that created them.
+    struct State {
+        explicit State(pid_t pid) noexcept : owner{pid} {}
+        pid_t const owner;
+        std::mutex mutex;
+        std::condition_variable queued;
+        std::condition_variable flushed;
+        std::vector<std::string> queue;
+        std::uint64_t pushed{};
+        std::uint64_t written{};
+        bool stop{false};
+        std::thread thread;
+    };
+
+    // Writers alive in this process. Intentionally leaked, as it is used on
+    // exit and by writers destroyed after static objects.
+    struct WriterRegistry {
+        std::mutex mutex;
+        std::unordered_set<AsyncLogFileWriter*> writers;
+    };
+
+    std::string file_path_;
+    std::shared_ptr<std::mutex> file_mutex_;
+    std::atomic<State*> state_{nullptr};
+
+    [[nodiscard]] static auto Registry() noexcept -> WriterRegistry& {
+        // NOLINTNEXTLINE(cppcoreguidelines-owning-memory)
+        static auto* const instance = new WriterRegistry{};
+        return *instance;
+    }
+
+    /// \brief Write the queued records of all writers and stop their threads.
+    /// Records emitted afterwards are written synchronously.
+    static void StopAll() noexcept {
+        auto& registry = Registry();
+        std::lock_guard lock{registry.mutex};
+        auto const pid = ::getpid();
+        for (auto* writer : registry.writers) {
+            auto* state = writer->state_.load();
+            if (state != nullptr and state->owner == pid) {
+                Stop(state);
+            }
+        }
+    }
+
+    /// \brief Get the state of the current process, creating it and starting
+    /// the thread if needed.
+    /// \throws if the state could not be created.
+    [[nodiscard]] auto LocalState() -> State* {
+        auto const pid = ::getpid();
+        auto* state = state_.load();
+        while (state == nullptr or state->owner != pid) {
+            auto created = std::make_unique<State>(pid);
+            created->thread =
+                std::thread([this, raw = created.get()]() { Run(raw); });
+            if (state_.compare_exchange_strong(state, created.get())) {
+                return created.release();
+            }
+            // another thread of this process was faster, use its state
+            Stop(created.get());
+        }
+        return state;
+    }
+
+    /// \brief Write the queued records and stop the thread, if not already
+    /// stopped.
+    static void Stop(gsl::not_null<State*> const& state) noexcept {
+        {
+            std::unique_lock lock{state->mutex};
+            if (state->stop) {
+                return;
+            }
+            state->stop = true;
+            state->queued.notify_one();
+        }
+        state->thread.join();
+    }
+
+    void Run(gsl::not_null<State*> const& state) noexcept {
+        gsl::owner<FILE*> file = std::fopen(file_path_.c_str(), "a");
+        if (file != nullptr) {
+            // every batch is written by a single call
+            std::setvbuf(file, nullptr, _IONBF, 0);
+        }
+        std::string batch{};
+        std::unique_lock lock{state->mutex};
+        while (true) {
+            state->queued.wait(lock, [&state]() {
+                return state->stop or not state->queue.empty();
+            });
+            if (state->queue.empty()) {
+                break;
+            }
+            auto records = std::move(state->queue);
+            state->queue.clear();
+            auto const upto = state->pushed;
+            lock.unlock();
+            batch.clear();
+            for (auto const& record : records) {
+                batch.append(record);
+            }
+            if (file != nullptr) {
+                std::lock_guard file_lock{*file_mutex_};
+                std::fwrite(batch.data(), 1, batch.size(), file);
+            }
+            lock.lock();
+            state->written = upto;
+            state->flushed.notify_all();
+        }
+        if (file != nullptr) {
+            std::fclose(file);
+        }
+    }
 };
 
 class LogSinkFile final : public ILogSink {
@@ -67,13 +268,20 @@ class LogSinkFile final : public ILogSink {
         Overwrite  ///< Overwrite log file with each new program instantiation.
     };
 
+    /// \param async    Write messages from a background thread. Errors are
+    /// still written before Emit returns, and all messages are written before
+    /// the sink is destroyed.
     static auto CreateFactory(std::filesystem::path const& file_path,
-                              Mode file_mode = Mode::Append) -> LogSinkFactory {
-        return
-            [=] { return std::make_shared<LogSinkFile>(file_path, file_mode); };
+                              Mode file_mode = Mode::Append,
+                              bool async = false) -> LogSinkFactory {
+        return [=] {
+            return std::make_shared<LogSinkFile>(file_path, file_mode, async);
+        };
     }
 
-    LogSinkFile(std::filesystem::path const& file_path, Mode file_mode)
+    LogSinkFile(std::filesystem::path const& file_path,
+                Mode file_mode,
+                bool async = false)
         : file_path_{std::filesystem::weakly_canonical(file_path).string()} {
         // create file mutex for canonical path
         FileMutexes().Create(file_path_, [&] {
@@ -85,6 +293,10 @@ class LogSinkFile final : public ILogSink {
                 }
             }
         });
+        if (async) {
+            writer_ = std::make_unique<AsyncLogFileWriter>(
+                file_path_, FileMutexes().Get(file_path_));
+        }
     }
     ~LogSinkFile() noexcept final = default;
     LogSinkFile(LogSinkFile const&) noexcept = delete;
@@ -95,9 +307,43 @@ class LogSinkFile final : public ILogSink {
     /// \brief Thread-safe emitting of log messages to file.
     /// Race-conditions for file writes are resolved via a separate mutexes for
     /// every canonical file path shared across all instances of this class.
+    /// In asynchronous mode, messages are only queued for the writer thread.
     void Emit(Logger const* logger,
               LogLevel level,
               std::string const& msg) const noexcept final {
+        auto record = FormatRecord(logger, level, msg);
+        if (writer_ != nullptr and
+            writer_->Push(std::move(record), level == LogLevel::Error)) {
+            return;
+        }
+        {
+            auto const mutex = FileMutexes().Get(file_path_);
+            std::lock_guard lock{*mutex};
+            if (gsl::owner<FILE*> file = std::fopen(file_path_.c_str(), "a")) {
+                std::fwrite(record.data(), 1, record.size(), file);
+                std::fclose(file);
+            }
+        }
+    }
+
+  private:
+    std::string file_path_;
+    std::unique_ptr<AsyncLogFileWriter> writer_;
+
+    /// \brief Mutexes of all files. Intentionally leaked, as sinks might be
+    /// destroyed after static objects, e.g., as part of the logging config.
+    [[nodiscard]] static auto FileMutexes() noexcept -> MutexMap<std::string>& {
+        // NOLINTNEXTLINE(cppcoreguidelines-owning-memory)
+        static auto* const instance = new MutexMap<std::string>{};
+        return *instance;
+    }
+
+    /// \brief Format a message as it is written to file, one line per line of
+    /// the message.
+    [[nodiscard]] static auto FormatRecord(Logger const* logger,
+                                           LogLevel level,
+                                           std::string const& msg)
+        -> std::string {
 #ifdef __unix__  // support nanoseconds for timestamp
         timespec ts{};
         clock_gettime(CLOCK_REALTIME, &ts);
@@ -108,40 +354,32 @@ class LogSinkFile final : public ILogSink {
             "{:%Y-%m-%d %H:%M:%S} UTC", fmt::gmtime(std::time(nullptr));
 #endif
 
-        std::ostringstream id{};
-        id << "thread:" << std::this_thread::get_id();
-        auto thread = id.str();
+        thread_local std::string const kThread = [] {
+            std::ostringstream id{};
+            id << "thread:" << std::this_thread::get_id();
+            return id.str();
+        }();
 
         auto prefix = fmt::format(
-            "{}, [{}] {}", thread, timestamp, LogLevelToString(level));
-
+            "{}, [{}] {}", kThread, timestamp, LogLevelToString(level));
         if (logger != nullptr) {
             // append logger name
             prefix = fmt::format("{} ({})", prefix, logger->Name());
         }
-        prefix = fmt::format("{}:", prefix);
+        prefix.append(":");
         const auto* cont_prefix = "  ";
 
-        {
-            std::lock_guard lock{FileMutexes().Get(file_path_)};
-            if (gsl::owner<FILE*> file = std::fopen(file_path_.c_str(), "a")) {
-                using it = std::istream_iterator<ILogSink::Line>;
-                std::istringstream iss{msg};
-                for_each(it{iss}, it{}, [&](auto const& line) {
-                    fmt::print(file, "{} {}\n", prefix, line);
-                    prefix = cont_prefix;
-                });
-                std::fclose(file);
-            }
-        }
-    }
-
-  private:
-    std::string file_path_;
-
-    [[nodiscard]] static auto FileMutexes() noexcept -> MutexMap<std::string>& {
-        static MutexMap<std::string> instance{};
-        return instance;
+        std::string record{};
+        using it = std::istream_iterator<ILogSink::Line>;
+        std::istringstream iss{msg};
+        for_each(it{iss}, it{}, [&](auto const& line) {
+            record.append(prefix);
+            record.append(" ");
+            record.append(line);
+            record.append("\n");
+            prefix = cont_prefix;
+        });
+        return record;
     }
 };
 
@@ -144,7 +144,8 @@ namespace Target = BuildMaps::Target;
         &directory_entries,
         context->repo_config,
         context->storage->GetHashFunction().GetType(),
-        jobs);
+        jobs,
+        context->git_hashes);
     auto absent_target_variables_map =
         Target::CreateAbsentTargetVariablesMap(context, jobs);
 
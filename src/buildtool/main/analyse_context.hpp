@@ -16,6 +16,7 @@
 #define INCLUDED_SRC_BUILDOOL_MAIN_ANALYSE_CONTEXT_HPP
 
 #include "gsl/gsl"
+#include "src/buildtool/common/git_hashes_store.hpp"
 #include "src/buildtool/common/repository_config.hpp"
 #include "src/buildtool/common/statistics.hpp"
 #include "src/buildtool/progress_reporting/progress.hpp"
@@ -30,6 +31,7 @@ struct AnalyseContext final {
     gsl::not_null<Statistics*> const statistics;
     gsl::not_null<Progress*> const progress;
     ServeApi const* const serve = nullptr;
+    IGitHashesStore* const git_hashes = nullptr;
 };
 
 #endif  // INCLUDED_SRC_BUILDOOL_MAIN_ANALYSE_CONTEXT_HPP
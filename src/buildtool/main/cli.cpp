@@ -40,6 +40,7 @@ auto SetupDescribeCommandArguments(
     SetupProtocolArguments(app, &clargs->protocol);
     SetupDescribeArguments(app, &clargs->describe);
     SetupRetryArguments(app, &clargs->retry);
+    SetupDaemonClientArguments(app, &clargs->daemon);
 }
 
 /// \brief Setup arguments for sub command "just analyse".
@@ -60,6 +61,7 @@ auto SetupAnalyseCommandArguments(
     SetupDiagnosticArguments(app, &clargs->diagnose);
     SetupProtocolArguments(app, &clargs->protocol);
     SetupRetryArguments(app, &clargs->retry);
+    SetupDaemonClientArguments(app, &clargs->daemon);
 }
 
 /// \brief Setup arguments for sub command "just build".
@@ -81,6 +83,7 @@ auto SetupBuildCommandArguments(
     SetupTCArguments(app, &clargs->tc);
     SetupProtocolArguments(app, &clargs->protocol);
     SetupRetryArguments(app, &clargs->retry);
+    SetupDaemonClientArguments(app, &clargs->daemon);
 }
 
 /// \brief Setup arguments for sub command "just install".
@@ -111,6 +114,7 @@ auto SetupInstallCasCommandArguments(
     SetupFetchArguments(app, &clargs->fetch);
     SetupLogArguments(app, &clargs->log);
     SetupRetryArguments(app, &clargs->retry);
+    SetupDaemonClientArguments(app, &clargs->daemon);
 }
 
 /// \brief Setup arguments for sub command "just install-cas".
@@ -125,6 +129,7 @@ auto SetupAddToCasCommandArguments(
     SetupLogArguments(app, &clargs->log);
     SetupRetryArguments(app, &clargs->retry);
     SetupToAddArguments(app, &clargs->to_add);
+    SetupDaemonClientArguments(app, &clargs->daemon);
 }
 
 /// \brief Setup arguments for sub command "just traverse".
@@ -144,6 +149,7 @@ auto SetupTraverseCommandArguments(
     SetupExtendedBuildArguments(app, &clargs->build);
     SetupStageArguments(app, &clargs->stage);
     SetupProtocolArguments(app, &clargs->protocol);
+    SetupDaemonClientArguments(app, &clargs->daemon);
 }
 
 /// \brief Setup arguments for sub command "just gc".
@@ -168,6 +174,14 @@ auto SetupExecutionServiceCommandArguments(
     SetupServerAuthArguments(app, &clargs->sauth);
 }
 
+/// \brief Setup arguments for sub command "just daemon".
+auto SetupDaemonCommandArguments(
+    gsl::not_null<CLI::App*> const& app,
+    gsl::not_null<CommandLineArguments*> const& clargs) {
+    SetupLogArguments(app, &clargs->log);
+    SetupDaemonArguments(app, &clargs->daemon);
+}
+
 /// \brief Setup arguments for sub command "just serve".
 auto SetupServeServiceCommandArguments(
     gsl::not_null<CLI::App*> const& app,
@@ -204,6 +218,8 @@ auto ParseCommandLineArguments(int argc, char const* const* argv)
         "execute", "Start single node execution service on this machine.");
     auto* cmd_serve =
         app.add_subcommand("serve", "Provide target dependencies for a build.");
+    auto* cmd_daemon = app.add_subcommand(
+        "daemon", "Keep build state warm and run commands sent to a socket.");
     auto* cmd_traverse =
         app.group("")  // group for creating hidden options
             ->add_subcommand("traverse",
@@ -222,6 +238,7 @@ auto ParseCommandLineArguments(int argc, char const* const* argv)
     SetupGcCommandArguments(cmd_gc, &clargs);
     SetupExecutionServiceCommandArguments(cmd_execution, &clargs);
     SetupServeServiceCommandArguments(cmd_serve, &clargs);
+    SetupDaemonCommandArguments(cmd_daemon, &clargs);
     try {
         app.parse(argc, argv);
     } catch (CLI::Error& e) {
@@ -268,6 +285,9 @@ auto ParseCommandLineArguments(int argc, char const* const* argv)
     else if (*cmd_serve) {
         clargs.cmd = SubCommand::kServe;
     }
+    else if (*cmd_daemon) {
+        clargs.cmd = SubCommand::kDaemon;
+    }
 
     return clargs;
 }
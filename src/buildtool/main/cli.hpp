@@ -33,7 +33,8 @@ enum class SubCommand : std::uint8_t {
     kTraverse,
     kGc,
     kExecute,
-    kServe
+    kServe,
+    kDaemon
 };
 
 struct CommandLineArguments {
@@ -58,6 +59,7 @@ struct CommandLineArguments {
     GcArguments gc;
     ToAddArguments to_add;
     ProtocolArguments protocol;
+    DaemonArguments daemon;
     SubCommand cmd{SubCommand::kUnknown};
 };
 
@@ -0,0 +1,745 @@
+// Copyright 2026 Huawei Cloud Computing Technology Co., Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "src/buildtool/main/daemon.hpp"
+
+#ifndef BOOTSTRAP_BUILD_TOOL
+
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <array>
+#include <cerrno>
+#include <csignal>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <iostream>
+#include <span>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "gsl/gsl"
+#include "nlohmann/json.hpp"
+#include "src/buildtool/logging/log_level.hpp"
+#include "src/buildtool/logging/logger.hpp"
+#include "src/buildtool/main/exit_codes.hpp"
+
+extern char** environ;  // NOLINT
+
+// The protocol is line based: a client sends a single JSON object with the
+// command line ("argv"), the working directory ("cwd"), and the environment
+// ("env"), together with its standard streams as ancillary data. The daemon
+// answers with a JSON object containing the "exit_code" of the command. If
+// other commands are still to be served first, the daemon tells the client
+// beforehand with a JSON object containing the number of commands "queued"
+// before it. A client interrupted while waiting shuts down its sending side
+// of the connection, upon which the daemon interrupts the command.
+// Internally, the daemon process only accepts connections and hands them over
+// to a worker process, so that a command terminating the process (as command
+// line or configuration errors do) only costs the warm state of the worker.
+
+namespace {
+
+constexpr std::size_t kStdStreams = 3;
+constexpr std::size_t kChunkSize = 4096;
+
+volatile std::sig_atomic_t g_terminate = 0;
+volatile std::sig_atomic_t g_client_connection = -1;
+
+/// \brief Owned file descriptor, closed on destruction.
+class UniqueFd final {
+  public:
+    UniqueFd() noexcept = default;
+    explicit UniqueFd(int fd) noexcept : fd_{fd} {}
+    UniqueFd(UniqueFd const&) = delete;
+    UniqueFd(UniqueFd&& other) noexcept : fd_{std::exchange(other.fd_, -1)} {}
+    auto operator=(UniqueFd const&) -> UniqueFd& = delete;
+    auto operator=(UniqueFd&& other) noexcept -> UniqueFd& {
+        Reset(std::exchange(other.fd_, -1));
+        return *this;
+    }
+    ~UniqueFd() noexcept { Reset(); }
+
+    [[nodiscard]] auto Get() const noexcept -> int { return fd_; }
+    [[nodiscard]] auto IsValid() const noexcept -> bool { return fd_ >= 0; }
+
+    void Reset(int fd = -1) noexcept {
+        if (fd_ >= 0) {
+            ::close(fd_);
+        }
+        fd_ = fd;
+    }
+
+  private:
+    int fd_{-1};
+};
+
+[[nodiscard]] auto SocketAddress(
+    std::filesystem::path const& socket_path) noexcept
+    -> std::optional<sockaddr_un> {
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    auto const& path = socket_path.native();
+    if (path.empty() or path.size() >= sizeof(address.sun_path)) {
+        Logger::Log(LogLevel::Error,
+                    "Invalid socket path {}, must be non-empty and shorter "
+                    "than {} characters.",
+                    socket_path.string(),
+                    sizeof(address.sun_path));
+        return std::nullopt;
+    }
+    std::memcpy(
+        static_cast<char*>(address.sun_path), path.c_str(), path.size());
+    return address;
+}
+
+[[nodiscard]] auto Connect(sockaddr_un const& address) noexcept -> UniqueFd {
+    UniqueFd fd{::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0)};
+    if (fd.IsValid() and
+        ::connect(fd.Get(),
+                  reinterpret_cast<sockaddr const*>(&address),  // NOLINT
+                  sizeof(address)) == 0) {
+        return fd;
+    }
+    return UniqueFd{};
+}
+
+[[nodiscard]] auto WriteAll(int fd, std::string_view data) noexcept -> bool {
+    while (not data.empty()) {
+        auto const written =
+            ::send(fd, data.data(), data.size(), MSG_NOSIGNAL);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        data.remove_prefix(static_cast<std::size_t>(written));
+    }
+    return true;
+}
+
+/// \brief Send data, with the given file descriptors attached to its first
+/// byte.
+[[nodiscard]] auto SendWithFds(int fd,
+                               std::string_view data,
+                               std::vector<int> const& fds) noexcept -> bool {
+    if (data.empty()) {
+        return fds.empty();
+    }
+    std::vector<char> control(CMSG_SPACE(sizeof(int) * fds.size()));
+    auto first = data.front();
+    iovec iov{.iov_base = &first, .iov_len = 1};
+    msghdr msg{};
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    if (not fds.empty()) {
+        msg.msg_control = control.data();
+        msg.msg_controllen = control.size();
+        auto* cmsg = CMSG_FIRSTHDR(&msg);
+        cmsg->cmsg_level = SOL_SOCKET;
+        cmsg->cmsg_type = SCM_RIGHTS;
+        cmsg->cmsg_len = CMSG_LEN(sizeof(int) * fds.size());
+        std::memcpy(CMSG_DATA(cmsg), fds.data(), sizeof(int) * fds.size());
+    }
+    ssize_t sent{};
+    do {
+        sent = ::sendmsg(fd, &msg, MSG_NOSIGNAL);
+    } while (sent < 0 and errno == EINTR);
+    return sent == 1 and WriteAll(fd, data.substr(1));
+}
+
+/// \brief Receive up to the given number of bytes, collecting all attached
+/// file descriptors.
+/// \returns The number of bytes received, 0 on end of stream, or -1 on error.
+[[nodiscard]] auto Receive(int fd,
+                           std::span<char> buffer,
+                           std::vector<UniqueFd>* fds) noexcept -> ssize_t {
+    std::array<char, CMSG_SPACE(sizeof(int) * kStdStreams)> control{};
+    iovec iov{.iov_base = buffer.data(), .iov_len = buffer.size()};
+    msghdr msg{};
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control.data();
+    msg.msg_controllen = control.size();
+    ssize_t received{};
+    do {
+        received = ::recvmsg(fd, &msg, MSG_CMSG_CLOEXEC);
+    } while (received < 0 and errno == EINTR);
+    for (auto* cmsg = CMSG_FIRSTHDR(&msg); cmsg != nullptr;
+         cmsg = CMSG_NXTHDR(&msg, cmsg)) {
+        if (cmsg->cmsg_level != SOL_SOCKET or cmsg->cmsg_type != SCM_RIGHTS) {
+            continue;
+        }
+        auto const count = (cmsg->cmsg_len - CMSG_LEN(0)) / sizeof(int);
+        for (std::size_t i = 0; i < count; ++i) {
+            int received_fd{};
+            std::memcpy(&received_fd,
+                        CMSG_DATA(cmsg) + (i * sizeof(int)),  // NOLINT
+                        sizeof(int));
+            UniqueFd owned{received_fd};
+            if (fds != nullptr) {
+                fds->emplace_back(std::move(owned));
+            }
+        }
+    }
+    return received;
+}
+
+/// \brief Receive a single line, without the terminating newline.
+/// \param rest    If given, data received beyond the line is kept there and
+/// consumed first by the next call.
+[[nodiscard]] auto ReceiveLine(int fd,
+                               std::vector<UniqueFd>* fds,
+                               std::string* rest = nullptr) noexcept
+    -> std::optional<std::string> {
+    try {
+        std::string line =
+            rest != nullptr ? std::exchange(*rest, {}) : std::string{};
+        std::array<char, kChunkSize> buffer{};
+        while (true) {
+            if (auto pos = line.find('\n'); pos != std::string::npos) {
+                if (rest != nullptr) {
+                    *rest = line.substr(pos + 1);
+                }
+                line.resize(pos);
+                return line;
+            }
+            auto const received = Receive(fd, buffer, fds);
+            if (received <= 0) {
+                return std::nullopt;
+            }
+            line.append(buffer.data(), static_cast<std::size_t>(received));
+        }
+    } catch (...) {
+        return std::nullopt;
+    }
+}
+
+/// \brief Send a JSON object as a single line.
+[[nodiscard]] auto SendMessage(int fd, nlohmann::json const& message) noexcept
+    -> bool {
+    try {
+        return WriteAll(fd, message.dump() + "\n");
+    } catch (...) {
+        return false;
+    }
+}
+
+/// \brief Check whether the client shut down its side of the connection,
+/// without blocking.
+[[nodiscard]] auto HasHungUp(int connection) noexcept -> bool {
+    pollfd client{.fd = connection, .events = POLLRDHUP, .revents = 0};
+    return ::poll(&client, 1, 0) > 0 and
+           (client.revents & (POLLRDHUP | POLLHUP | POLLERR)) != 0;  // NOLINT
+}
+
+[[nodiscard]] auto IsFromSameUser(int connection) noexcept -> bool {
+    ucred credentials{};
+    socklen_t size = sizeof(credentials);
+    return ::getsockopt(connection,
+                        SOL_SOCKET,
+                        SO_PEERCRED,
+                        &credentials,
+                        &size) == 0 and
+           credentials.uid == ::getuid();
+}
+
+/// \brief Accept a connection, if it comes from the user owning the daemon.
+[[nodiscard]] auto AcceptClient(int listen_fd) noexcept
+    -> std::optional<UniqueFd> {
+    UniqueFd connection{::accept4(listen_fd, nullptr, nullptr, SOCK_CLOEXEC)};
+    if (not connection.IsValid()) {
+        if (errno != EINTR) {
+            Logger::Log(LogLevel::Warning,
+                        "Accepting connection failed with: {}",
+                        std::strerror(errno));
+        }
+        return std::nullopt;
+    }
+    if (not IsFromSameUser(connection.Get())) {
+        Logger::Log(LogLevel::Warning,
+                    "Rejected connection from another user.");
+        return std::nullopt;
+    }
+    return connection;
+}
+
+/// \brief Temporarily take over the client's standard streams.
+class RedirectedStreams final {
+  public:
+    explicit RedirectedStreams(std::vector<UniqueFd> const& streams) noexcept {
+        for (std::size_t i = 0; i < kStdStreams; ++i) {
+            auto const target = static_cast<int>(i);
+            saved_.at(i) = UniqueFd{::fcntl(target, F_DUPFD_CLOEXEC, 0)};
+            ::dup2(streams.at(i).Get(), target);
+        }
+    }
+    RedirectedStreams(RedirectedStreams const&) = delete;
+    RedirectedStreams(RedirectedStreams&&) = delete;
+    auto operator=(RedirectedStreams const&) -> RedirectedStreams& = delete;
+    auto operator=(RedirectedStreams&&) -> RedirectedStreams& = delete;
+    ~RedirectedStreams() noexcept {
+        std::cout.flush();
+        std::cerr.flush();
+        std::fflush(nullptr);
+        for (std::size_t i = 0; i < kStdStreams; ++i) {
+            if (saved_.at(i).IsValid()) {
+                ::dup2(saved_.at(i).Get(), static_cast<int>(i));
+            }
+        }
+    }
+
+  private:
+    std::array<UniqueFd, kStdStreams> saved_;
+};
+
+void SetEnvironment(std::vector<std::string> const& environment) {
+    ::clearenv();
+    for (auto const& entry : environment) {
+        auto const pos = entry.find('=');
+        if (pos != std::string::npos and pos > 0) {
+            ::setenv(entry.substr(0, pos).c_str(),
+                     entry.substr(pos + 1).c_str(),
+                     /*overwrite=*/1);
+        }
+    }
+}
+
+/// \brief Run the command requested on a connection in the current process.
+[[nodiscard]] auto ServeRequest(int connection,
+                                DaemonCommandRunner const& run) noexcept
+    -> int {
+    try {
+        std::vector<UniqueFd> streams{};
+        auto line = ReceiveLine(connection, &streams);
+        if (not line or streams.size() != kStdStreams) {
+            Logger::Log(LogLevel::Warning, "Ignoring malformed request.");
+            return kExitBuildEnvironment;
+        }
+        auto const request = nlohmann::json::parse(*line);
+        auto const args = request.at("argv").get<std::vector<std::string>>();
+        std::vector<char const*> argv{};
+        argv.reserve(args.size() + 1);
+        for (auto const& arg : args) {
+            argv.emplace_back(arg.c_str());
+        }
+        argv.emplace_back(nullptr);
+
+        std::filesystem::current_path(request.at("cwd").get<std::string>());
+        SetEnvironment(request.at("env").get<std::vector<std::string>>());
+        RedirectedStreams redirected{streams};
+        return run(static_cast<int>(args.size()), argv.data());
+    } catch (std::exception const& ex) {
+        Logger::Log(LogLevel::Error,
+                    "Running request failed with:\n{}",
+                    ex.what());
+    }
+    return kExitBuildEnvironment;
+}
+
+/// \brief Serve connections handed over by the daemon via the channel, until
+/// the daemon closes it.
+[[nodiscard]] auto WorkerLoop(int channel,
+                              DaemonCommandRunner const& run) noexcept -> int {
+    while (true) {
+        std::vector<UniqueFd> connection{};
+        std::array<char, 1> byte{};
+        if (Receive(channel, byte, &connection) <= 0) {
+            return kExitSuccess;
+        }
+        if (connection.size() != 1) {
+            return kExitFailure;
+        }
+        auto const exit_code = ServeRequest(connection.front().Get(), run);
+        connection.clear();
+        try {
+            if (not WriteAll(
+                    channel,
+                    nlohmann::json{{"exit_code", exit_code}}.dump() + "\n")) {
+                return kExitFailure;
+            }
+        } catch (...) {
+            return kExitFailure;
+        }
+    }
+}
+
+/// \brief The worker process running the commands, started on demand.
+class Worker final {
+  public:
+    explicit Worker(int listen_fd, DaemonCommandRunner run) noexcept
+        : listen_fd_{listen_fd}, run_{std::move(run)} {}
+    Worker(Worker const&) = delete;
+    Worker(Worker&&) = delete;
+    auto operator=(Worker const&) -> Worker& = delete;
+    auto operator=(Worker&&) -> Worker& = delete;
+    ~Worker() noexcept { Stop(); }
+
+    /// \brief Let the worker run the command requested on a connection. If
+    /// the client hangs up meanwhile, the command is interrupted.
+    /// \param on_pending  Called whenever a new connection is pending on the
+    /// listening socket while the command runs.
+    /// \returns The exit code of the command.
+    [[nodiscard]] auto Run(int connection,
+                           std::function<void()> const& on_pending) noexcept
+        -> int {
+        if (pid_ <= 0 and not Start(connection)) {
+            return kExitBuildEnvironment;
+        }
+        auto interrupted = false;
+        if (SendWithFds(channel_.Get(), "c", {connection}) and
+            WaitForReply(connection, on_pending, &interrupted)) {
+            if (auto reply = ReceiveLine(channel_.Get(), nullptr)) {
+                try {
+                    return nlohmann::json::parse(*reply)
+                        .at("exit_code")
+                        .get<int>();
+                } catch (std::exception const& ex) {
+                    Logger::Log(LogLevel::Warning,
+                                "Invalid reply from worker:\n{}",
+                                ex.what());
+                }
+            }
+        }
+        // The command terminated the worker, e.g., by exiting early.
+        auto const pid = pid_;
+        auto const status = Stop();
+        if (WIFEXITED(status)) {         // NOLINT
+            return WEXITSTATUS(status);  // NOLINT
+        }
+        if (interrupted) {
+            Logger::Log(LogLevel::Info,
+                        "Interrupted command of disconnected client.");
+            return kExitFailure;
+        }
+        Logger::Log(
+            LogLevel::Warning, "Worker process {} terminated abnormally.", pid);
+        return kExitFailure;
+    }
+
+  private:
+    int listen_fd_;
+    DaemonCommandRunner run_;
+    pid_t pid_{-1};
+    UniqueFd channel_;
+
+    /// \brief Start a new worker process.
+    /// \param connection  Connection currently served by the daemon, which the
+    /// worker receives through the channel instead.
+    [[nodiscard]] auto Start(int connection) noexcept -> bool {
+        std::array<int, 2> channel{};
+        if (::socketpair(
+                AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, channel.data()) != 0) {
+            Logger::Log(LogLevel::Error,
+                        "Creating worker channel failed with: {}",
+                        std::strerror(errno));
+            return false;
+        }
+        UniqueFd daemon_end{channel[0]};
+        UniqueFd worker_end{channel[1]};
+        auto const pid = ::fork();
+        if (pid < 0) {
+            Logger::Log(LogLevel::Error,
+                        "Starting worker process failed with: {}",
+                        std::strerror(errno));
+            return false;
+        }
+        // The worker leads its own process group, so that interrupting a
+        // command also reaches the actions it runs locally.
+        if (pid == 0) {
+            ::setpgid(0, 0);
+            std::signal(SIGINT, SIG_DFL);
+            std::signal(SIGTERM, SIG_DFL);
+            ::close(listen_fd_);
+            ::close(connection);
+            daemon_end.Reset();
+            std::exit(WorkerLoop(worker_end.Get(), run_));
+        }
+        ::setpgid(pid, pid);
+        Logger::Log(LogLevel::Debug, "Started worker process {}", pid);
+        pid_ = pid;
+        channel_ = std::move(daemon_end);
+        return true;
+    }
+
+    /// \brief Wait until the worker replies or terminates, meanwhile
+    /// watching the listening socket and the client.
+    /// \returns False if waiting failed.
+    [[nodiscard]] auto WaitForReply(int connection,
+                                    std::function<void()> const& on_pending,
+                                    gsl::not_null<bool*> const& interrupted)
+        const noexcept -> bool {
+        std::array<pollfd, 3> fds{
+            pollfd{.fd = channel_.Get(), .events = POLLIN, .revents = 0},
+            pollfd{.fd = listen_fd_, .events = POLLIN, .revents = 0},
+            pollfd{.fd = connection, .events = POLLRDHUP, .revents = 0}};
+        while (fds[0].revents == 0) {
+            if (::poll(fds.data(), fds.size(), -1) < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                Logger::Log(LogLevel::Warning,
+                            "Waiting for worker failed with: {}",
+                            std::strerror(errno));
+                return false;
+            }
+            if (fds[1].revents != 0) {
+                on_pending();
+            }
+            if (fds[2].revents != 0) {
+                Logger::Log(LogLevel::Debug,
+                            "Client disconnected, interrupting worker {}",
+                            pid_);
+                ::kill(-pid_, SIGINT);
+                *interrupted = true;
+                // negative descriptors are ignored by poll
+                fds[2].fd = -1;
+                fds[2].revents = 0;
+            }
+        }
+        return true;
+    }
+
+    /// \brief Stop the worker, if running.
+    /// \returns The wait status of the worker process.
+    auto Stop() noexcept -> int {
+        int status{};
+        if (pid_ > 0) {
+            channel_.Reset();
+            while (::waitpid(pid_, &status, 0) < 0 and errno == EINTR) {
+            }
+            pid_ = -1;
+        }
+        return status;
+    }
+};
+
+void RequestTermination(int /*signal*/) {
+    g_terminate = 1;
+}
+
+void ForwardInterrupt(int /*signal*/) {
+    // shutdown is async-signal-safe; the reply can still be received
+    ::shutdown(g_client_connection, SHUT_WR);
+}
+
+/// \brief While alive, forward SIGINT, SIGTERM, and SIGHUP to the daemon
+/// serving the given connection. A repeated signal takes its default action.
+class InterruptForwarding final {
+  public:
+    explicit InterruptForwarding(int connection) noexcept {
+        g_client_connection = connection;
+        struct sigaction action {};
+        action.sa_handler = ForwardInterrupt;
+        action.sa_flags = static_cast<int>(SA_RESETHAND);
+        ::sigemptyset(&action.sa_mask);
+        for (std::size_t i = 0; i < kSignals.size(); ++i) {
+            ::sigaction(kSignals.at(i), &action, &saved_.at(i));
+        }
+    }
+    InterruptForwarding(InterruptForwarding const&) = delete;
+    InterruptForwarding(InterruptForwarding&&) = delete;
+    auto operator=(InterruptForwarding const&)
+        -> InterruptForwarding& = delete;
+    auto operator=(InterruptForwarding&&) -> InterruptForwarding& = delete;
+    ~InterruptForwarding() noexcept {
+        for (std::size_t i = 0; i < kSignals.size(); ++i) {
+            ::sigaction(kSignals.at(i), &saved_.at(i), nullptr);
+        }
+        g_client_connection = -1;
+    }
+
+  private:
+    static constexpr std::array<int, 3> kSignals{SIGINT, SIGTERM, SIGHUP};
+    std::array<struct sigaction, kSignals.size()> saved_{};
+};
+
+}  // namespace
+
+auto RunDaemon(std::filesystem::path const& socket_path,
+               DaemonCommandRunner const& run) noexcept -> int {
+    try {
+        auto const address = SocketAddress(socket_path);
+        if (not address) {
+            return kExitSyntaxError;
+        }
+        if (std::filesystem::is_socket(socket_path)) {
+            if (Connect(*address).IsValid()) {
+                Logger::Log(LogLevel::Error,
+                            "A daemon is already listening on {}.",
+                            socket_path.string());
+                return kExitBuildEnvironment;
+            }
+            // left over by a daemon that did not terminate cleanly
+            std::filesystem::remove(socket_path);
+        }
+
+        UniqueFd listen_fd{::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0)};
+        // Only the owner may connect to the socket.
+        auto const mask = ::umask(S_IRWXG | S_IRWXO);
+        auto const bound =
+            listen_fd.IsValid() and
+            ::bind(listen_fd.Get(),
+                   reinterpret_cast<sockaddr const*>(&*address),  // NOLINT
+                   sizeof(*address)) == 0;
+        ::umask(mask);
+        if (not bound or ::listen(listen_fd.Get(), SOMAXCONN) != 0) {
+            Logger::Log(LogLevel::Error,
+                        "Listening on {} failed with: {}",
+                        socket_path.string(),
+                        std::strerror(errno));
+            return kExitBuildEnvironment;
+        }
+
+        // Interrupt accept on termination, to clean up the socket.
+        struct sigaction action {};
+        action.sa_handler = RequestTermination;
+        ::sigemptyset(&action.sa_mask);
+        ::sigaction(SIGINT, &action, nullptr);
+        ::sigaction(SIGTERM, &action, nullptr);
+
+        Logger::Log(
+            LogLevel::Info, "Daemon listening on {}", socket_path.string());
+        {
+            // Commands are served one after the other; clients connecting
+            // meanwhile are queued and told how many commands are ahead.
+            std::deque<UniqueFd> queue{};
+            auto const enqueue = [&queue, &listen_fd](bool busy) {
+                auto connection = AcceptClient(listen_fd.Get());
+                if (not connection) {
+                    return;
+                }
+                // ahead are the queued commands and the running one
+                if (busy and
+                    not SendMessage(connection->Get(),
+                                    nlohmann::json{
+                                        {"queued", queue.size() + 1}})) {
+                    Logger::Log(LogLevel::Debug,
+                                "Client disconnected before being queued.");
+                    return;
+                }
+                queue.emplace_back(*std::move(connection));
+            };
+            Worker worker{listen_fd.Get(), run};
+            while (g_terminate == 0) {
+                if (queue.empty()) {
+                    enqueue(/*busy=*/false);
+                    continue;
+                }
+                auto const connection = std::move(queue.front());
+                queue.pop_front();
+                int exit_code = kExitFailure;
+                if (HasHungUp(connection.Get())) {
+                    Logger::Log(LogLevel::Debug,
+                                "Skipping request of client disconnected "
+                                "while queued.");
+                }
+                else {
+                    exit_code = worker.Run(connection.Get(), [&enqueue]() {
+                        enqueue(/*busy=*/true);
+                    });
+                    Logger::Log(LogLevel::Debug,
+                                "Request finished with exit code {}",
+                                exit_code);
+                }
+                if (not SendMessage(connection.Get(),
+                                    nlohmann::json{{"exit_code", exit_code}})) {
+                    Logger::Log(LogLevel::Debug,
+                                "Client disconnected before receiving the "
+                                "result.");
+                }
+            }
+        }
+        std::filesystem::remove(socket_path);
+        Logger::Log(LogLevel::Info, "Daemon terminated.");
+        return kExitSuccess;
+    } catch (std::exception const& ex) {
+        Logger::Log(
+            LogLevel::Error, "Running daemon failed with:\n{}", ex.what());
+    }
+    return kExitBuildEnvironment;
+}
+
+auto ForwardToDaemon(std::filesystem::path const& socket_path,
+                     int argc,
+                     char const* const* argv) noexcept -> std::optional<int> {
+    try {
+        auto const address = SocketAddress(socket_path);
+        if (not address) {
+            return std::nullopt;
+        }
+        auto const connection = Connect(*address);
+        if (not connection.IsValid()) {
+            return std::nullopt;
+        }
+
+        std::vector<std::string> environment{};
+        for (char** entry = environ; *entry != nullptr; ++entry) {  // NOLINT
+            environment.emplace_back(*entry);
+        }
+        auto const request =
+            nlohmann::json{
+                {"argv", std::vector<std::string>(argv, argv + argc)},  // NOLINT
+                {"cwd", std::filesystem::current_path().string()},
+                {"env", environment}}
+                .dump() +
+            "\n";
+        if (not SendWithFds(connection.Get(),
+                            request,
+                            {STDIN_FILENO, STDOUT_FILENO, STDERR_FILENO})) {
+            return std::nullopt;
+        }
+
+        InterruptForwarding forwarding{connection.Get()};
+        std::string rest{};
+        while (auto reply = ReceiveLine(connection.Get(), nullptr, &rest)) {
+            auto const message = nlohmann::json::parse(*reply);
+            if (message.contains("queued")) {
+                Logger::Log(LogLevel::Info,
+                            "Daemon at {} is busy, waiting for {} earlier "
+                            "command(s).",
+                            socket_path.string(),
+                            message["queued"].get<std::size_t>());
+                continue;
+            }
+            return message.at("exit_code").get<int>();
+        }
+        Logger::Log(LogLevel::Error,
+                    "Lost connection to daemon at {}.",
+                    socket_path.string());
+        return kExitBuildEnvironment;
+    } catch (std::exception const& ex) {
+        Logger::Log(LogLevel::Error,
+                    "Communicating with daemon at {} failed with:\n{}",
+                    socket_path.string(),
+                    ex.what());
+    }
+    return kExitBuildEnvironment;
+}
+
+#endif  // BOOTSTRAP_BUILD_TOOL
@@ -0,0 +1,54 @@
+// Copyright 2026 Huawei Cloud Computing Technology Co., Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef INCLUDED_SRC_BUILDTOOL_MAIN_DAEMON_HPP
+#define INCLUDED_SRC_BUILDTOOL_MAIN_DAEMON_HPP
+
+#ifndef BOOTSTRAP_BUILD_TOOL
+
+#include <filesystem>
+#include <functional>
+#include <optional>
+
+/// \brief Run a single command in the current process, given its command line.
+/// \returns The exit code of the command.
+using DaemonCommandRunner =
+    std::function<int(int argc, char const* const* argv)>;
+
+/// \brief Serve commands sent to the given Unix domain socket until
+/// terminated. Commands are run one after the other by a long-lived worker
+/// process, so that state kept in memory (like open git repositories) is
+/// reused across commands. Each command runs in the working directory and
+/// environment of the client and writes to the client's standard streams.
+/// Clients connecting while a command runs are queued and told so. A command
+/// whose client disconnects is interrupted. If a command terminates the
+/// worker, the next command is run by a fresh one.
+/// \param socket_path  Path of the socket to create.
+/// \param run          Runner for the received commands.
+/// \returns The exit code of the daemon.
+[[nodiscard]] auto RunDaemon(std::filesystem::path const& socket_path,
+                             DaemonCommandRunner const& run) noexcept -> int;
+
+/// \brief Let the daemon listening on the given socket run a command, passing
+/// on the current working directory, environment, and standard streams.
+/// Meanwhile, SIGINT, SIGTERM, and SIGHUP interrupt the command on the daemon.
+/// \returns The exit code of the command, or nullopt if no daemon could be
+/// reached.
+[[nodiscard]] auto ForwardToDaemon(std::filesystem::path const& socket_path,
+                                   int argc,
+                                   char const* const* argv) noexcept
+    -> std::optional<int>;
+
+#endif  // BOOTSTRAP_BUILD_TOOL
+#endif  // INCLUDED_SRC_BUILDTOOL_MAIN_DAEMON_HPP
@@ -27,6 +27,7 @@
 #include <set>
 #include <string>
 #include <thread>
+#include <tuple>  // std::ignore
 #include <utility>
 #include <variant>
 #include <vector>
@@ -71,6 +72,7 @@
 #include "src/buildtool/main/version.hpp"
 #include "src/buildtool/multithreading/task_system.hpp"
 #include "src/buildtool/profile/profile.hpp"
+#include "src/buildtool/profile/trace.hpp"
 #include "src/buildtool/progress_reporting/progress.hpp"
 #include "src/buildtool/serve_api/remote/serve_api.hpp"
 #include "src/buildtool/storage/config.hpp"
@@ -91,16 +93,21 @@
 #include "src/buildtool/execution_api/remote/config.hpp"
 #include "src/buildtool/execution_api/remote/context.hpp"
 #include "src/buildtool/execution_engine/executor/context.hpp"
+#include "src/buildtool/file_system/git_cas.hpp"
 #include "src/buildtool/file_system/git_context.hpp"
 #include "src/buildtool/graph_traverser/graph_traverser.hpp"
+#include "src/buildtool/main/daemon.hpp"
 #include "src/buildtool/main/describe.hpp"
 #include "src/buildtool/main/retry.hpp"
 #include "src/buildtool/main/serve.hpp"
 #include "src/buildtool/progress_reporting/progress_reporter.hpp"
 #include "src/buildtool/serve_api/remote/config.hpp"
 #include "src/buildtool/serve_api/serve_service/serve_server_implementation.hpp"
+#include "src/buildtool/storage/action_duration_history.hpp"
 #include "src/buildtool/storage/backend_description.hpp"
+#include "src/buildtool/storage/file_digest_cache.hpp"
 #include "src/buildtool/storage/garbage_collector.hpp"
+#include "src/buildtool/storage/git_hashes_index.hpp"
 #endif  // BOOTSTRAP_BUILD_TOOL
 
 namespace {
@@ -121,7 +128,8 @@ void SetupLogging(LogArguments const& clargs) {
         LogConfig::AddSink(LogSinkFile::CreateFactory(
             log_file,
             clargs.log_append ? LogSinkFile::Mode::Append
-                              : LogSinkFile::Mode::Overwrite));
+                              : LogSinkFile::Mode::Overwrite,
+            clargs.log_async));
     }
 }
 
@@ -163,6 +171,7 @@ void SetupLogging(LogArguments const& clargs) {
     if (bargs.local_launcher.has_value()) {
         builder.SetLauncher(*bargs.local_launcher);
     }
+    builder.SetCachedStaging(bargs.local_cached_staging);
 
     auto config = builder.Build();
     if (config) {
@@ -724,14 +733,10 @@ void DumpArtifactsToBuild(
     os << dump_string << std::endl;
 }
 
-}  // namespace
-
-auto main(int argc, char* argv[]) -> int {
+/// \brief Run the subcommand given by the command-line arguments.
+[[nodiscard]] auto RunCommand(CommandLineArguments arguments) -> int {
     std::unique_ptr<Profile> profile;
-    SetupDefaultLogging();
     try {
-        auto arguments = ParseCommandLineArguments(argc, argv);
-
         if (arguments.cmd == SubCommand::kVersion) {
             std::cout << version() << std::endl;
             return kExitSuccess;
@@ -746,10 +751,10 @@ auto main(int argc, char* argv[]) -> int {
 #endif  // BOOTSTRAP_BUILD_TOOL
 
         SetupLogging(arguments.log);
-        if (arguments.analysis.expression_log_limit) {
-            Evaluator::SetExpressionLogLimit(
-                *arguments.analysis.expression_log_limit);
-        }
+        // Always set, as a daemon runs several commands in the same process.
+        Evaluator::SetExpressionLogLimit(
+            arguments.analysis.expression_log_limit.value_or(
+                Evaluator::kDefaultExpressionLogLimit));
 
         // global repository configuration
         RepositoryConfig repo_config{};
@@ -773,6 +778,13 @@ auto main(int argc, char* argv[]) -> int {
                 return kExitBuildEnvironment;
             }
 
+            if (arguments.gc.max_cache_size) {
+                if (GarbageCollector::TriggerQuotaCollection(
+                        *storage_config, *arguments.gc.max_cache_size)) {
+                    return kExitSuccess;
+                }
+                return kExitBuildEnvironment;
+            }
             if (GarbageCollector::TriggerGarbageCollection(
                     *storage_config,
                     arguments.gc.no_rotate,
@@ -844,7 +856,8 @@ auto main(int argc, char* argv[]) -> int {
                            &local_context,
                            &remote_context,
                            dynamic_cast<LocalApi const*>(&*exec_apis.local),
-                           arguments.service.op_exponent)
+                           arguments.service.op_exponent,
+                           arguments.service.action_slots)
                            ? kExitSuccess
                            : kExitFailure;
             }
@@ -924,6 +937,7 @@ auto main(int argc, char* argv[]) -> int {
                                          serve,
                                          serve_apis,
                                          op_exponent,
+                                         arguments.service.action_slots,
                                          with_execute)
                            ? kExitSuccess
                            : kExitFailure;
@@ -937,6 +951,17 @@ auto main(int argc, char* argv[]) -> int {
                                                 arguments);
         }
 
+        // Record a timeline, if requested
+        if (arguments.analysis.trace) {
+            Trace::Start();
+        }
+        auto const write_trace =
+            gsl::finally([trace_file = arguments.analysis.trace]() {
+                if (trace_file) {
+                    std::ignore = Trace::Stop(*trace_file);
+                }
+            });
+
         // If no execution endpoint was given, the client should default to the
         // serve endpoint, if given.
         if (not arguments.endpoint.remote_execution_address.has_value() and
@@ -1017,6 +1042,16 @@ auto main(int argc, char* argv[]) -> int {
 
         auto const main_apis =
             ApiBundle::Create(&local_context, &remote_context, &repo_config);
+        // digests of files in file system roots
+        FileDigestCache file_digests{&*storage_config};
+        // durations of executed actions
+        ActionDurationHistory durations{&*storage_config};
+        // compatible hashes of git blobs
+        std::optional<GitHashesIndex> git_hashes{};
+        if (not ProtocolTraits::IsNative(
+                storage_config->hash_function.GetType())) {
+            git_hashes.emplace(&*storage_config);
+        }
         ExecutionContext const exec_context{
             .repo_config = &repo_config,
             .apis = &main_apis,
@@ -1024,7 +1059,11 @@ auto main(int argc, char* argv[]) -> int {
             .statistics = &stats,
             .progress = &progress,
             .profile = profile != nullptr ? std::make_optional(profile.get())
-                                          : std::nullopt};
+                                          : std::nullopt,
+            .file_digests = &file_digests,
+            .durations = &durations,
+            .stream_window = arguments.build.stream_window.value_or(
+                ExecutionContext::kDefaultStreamWindow)};
         const GraphTraverser::CommandLineArguments traverse_args{
             jobs,
             std::move(arguments.build),
@@ -1090,6 +1129,23 @@ auto main(int argc, char* argv[]) -> int {
             }
             return kExitBuildEnvironment;
         }
+        // Write back the persistent caches before the lock is released, so
+        // that saving does not race with a rotation of the generations.
+        auto const save_caches =
+            gsl::finally([&file_digests, &durations, &git_hashes]() {
+                if (not file_digests.Save()) {
+                    Logger::Log(LogLevel::Debug,
+                                "Failed to save file digest cache");
+                }
+                if (not durations.Save()) {
+                    Logger::Log(LogLevel::Debug,
+                                "Failed to save action duration history");
+                }
+                if (git_hashes and not git_hashes->Save()) {
+                    Logger::Log(LogLevel::Debug,
+                                "Failed to save git hashes index");
+                }
+            });
 
         if (arguments.cmd == SubCommand::kTraverse) {
             if (arguments.graph.git_cas) {
@@ -1173,7 +1229,9 @@ auto main(int argc, char* argv[]) -> int {
                                    .storage = &storage,
                                    .statistics = &stats,
                                    .progress = &exports_progress,
-                                   .serve = serve ? &*serve : nullptr};
+                                   .serve = serve ? &*serve : nullptr,
+                                   .git_hashes = git_hashes ? &*git_hashes
+                                                            : nullptr};
 
         auto analyse_result =
             AnalyseTarget(&analyse_ctx,
@@ -1329,3 +1387,46 @@ auto main(int argc, char* argv[]) -> int {
     }
     return kExitBuildEnvironment;
 }
+
+}  // namespace
+
+auto main(int argc, char* argv[]) -> int {
+    SetupDefaultLogging();
+    try {
+        auto arguments = ParseCommandLineArguments(argc, argv);
+
+#ifndef BOOTSTRAP_BUILD_TOOL
+        if (arguments.cmd == SubCommand::kDaemon) {
+            SetupLogging(arguments.log);
+            // Git repositories stay open for later requests.
+            GitCAS::KeepOpen();
+            return RunDaemon(
+                *arguments.daemon.socket,
+                [log = arguments.log](int request_argc,
+                                      char const* const* request_argv) {
+                    SetupDefaultLogging();
+                    auto const result = RunCommand(ParseCommandLineArguments(
+                        request_argc, request_argv));
+                    SetupLogging(log);
+                    return result;
+                });
+        }
+
+        if (arguments.daemon.socket) {
+            if (auto result =
+                    ForwardToDaemon(*arguments.daemon.socket, argc, argv)) {
+                return *result;
+            }
+            Logger::Log(LogLevel::Warning,
+                        "No daemon reachable at {}, running locally.",
+                        arguments.daemon.socket->string());
+        }
+#endif  // BOOTSTRAP_BUILD_TOOL
+
+        return RunCommand(std::move(arguments));
+    } catch (std::exception const& ex) {
+        Logger::Log(
+            LogLevel::Error, "Caught exception with message: {}", ex.what());
+    }
+    return kExitBuildEnvironment;
+}
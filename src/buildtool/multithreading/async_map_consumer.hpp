@@ -31,6 +31,7 @@
 
 #include "gsl/gsl"
 #include "src/buildtool/multithreading/async_map.hpp"
+#include "src/buildtool/multithreading/task_span.hpp"
 #include "src/buildtool/multithreading/task_system.hpp"
 
 using AsyncMapConsumerLogger = std::function<void(std::string const&, bool)>;
@@ -238,6 +239,7 @@ class AsyncMapConsumer {
              setterptr = std::move(setterptr),
              wrapped_logger = std::move(wrapped_logger),
              subcallerptr = std::move(subcallerptr)]() {
+                TaskSpan const span{"async_map", "create value"};
                 (*vc)(ts, setterptr, wrapped_logger, subcallerptr, key);
             });
         return node;
@@ -0,0 +1,75 @@
+// Copyright 2026 Huawei Cloud Computing Technology Co., Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef INCLUDED_SRC_BUILDTOOL_MULTITHREADING_TASK_SPAN_HPP
+#define INCLUDED_SRC_BUILDTOOL_MULTITHREADING_TASK_SPAN_HPP
+
+#include <atomic>
+#include <cstdint>
+
+/// \brief Span of work of the task system, reported to an optional recorder,
+/// e.g., a timeline trace. The recorder is injected by the tool, so that the
+/// task system does not depend on any particular recorder. While no recorder
+/// is set, a span only costs an atomic load.
+class TaskSpan final {
+  public:
+    /// \brief Recorder of spans; both functions must be thread safe.
+    struct Recorder {
+        /// \brief Start a span; returns its start time, or a negative value if
+        /// the span is not to be recorded.
+        std::int64_t (*start)() noexcept;
+        /// \brief Finish a span started at the given time.
+        void (*finish)(char const* category,
+                       char const* name,
+                       std::int64_t start) noexcept;
+    };
+
+    /// \brief Set the recorder to report spans to, or nullptr for none. The
+    /// recorder must outlive all spans created while it is set.
+    static void SetRecorder(Recorder const* recorder) noexcept {
+        installed_.store(recorder);
+    }
+
+    /// \param category Category of the span; must be a string literal.
+    /// \param name     Name of the span; must be a string literal.
+    TaskSpan(char const* category, char const* name) noexcept
+        : category_{category},
+          name_{name},
+          recorder_{installed_.load(std::memory_order_relaxed)} {
+        if (recorder_ != nullptr) {
+            start_ = recorder_->start();
+        }
+    }
+
+    ~TaskSpan() noexcept {
+        if (recorder_ != nullptr and start_ >= 0) {
+            recorder_->finish(category_, name_, start_);
+        }
+    }
+
+    TaskSpan(TaskSpan const&) = delete;
+    TaskSpan(TaskSpan&&) = delete;
+    auto operator=(TaskSpan const&) -> TaskSpan& = delete;
+    auto operator=(TaskSpan&&) -> TaskSpan& = delete;
+
+  private:
+    static inline std::atomic<Recorder const*> installed_{nullptr};
+
+    char const* category_;
+    char const* name_;
+    Recorder const* recorder_;
+    std::int64_t start_{-1};
+};
+
+#endif  // INCLUDED_SRC_BUILDTOOL_MULTITHREADING_TASK_SPAN_HPP
@@ -14,19 +14,23 @@
 
 #include "src/buildtool/multithreading/task_system.hpp"
 
-#include <optional>
-
 #include "gsl/gsl"
-#include "src/buildtool/multithreading/task.hpp"
+#include "src/buildtool/multithreading/task_span.hpp"
+
+namespace {
+
+// Task system and queue index of the worker running on the current thread, if
+// any. Used to route tasks queued from within a task to the worker's own queue.
+thread_local TaskSystem const* current_system = nullptr;
+thread_local std::size_t current_index = 0;
+
+}  // namespace
 
 TaskSystem::TaskSystem() : TaskSystem(std::thread::hardware_concurrency()) {}
 
 TaskSystem::TaskSystem(std::size_t number_of_threads)
     : thread_count_{std::max(std::size_t{1}, number_of_threads)},
-      total_workload_{thread_count_} {
-    for (std::size_t index = 0; index < thread_count_; ++index) {
-        queues_.emplace_back(&total_workload_);
-    }
+      queues_(thread_count_) {
     for (std::size_t index = 0; index < thread_count_; ++index) {
         threads_.emplace_back([&, index]() { Run(index); });
     }
@@ -38,47 +42,150 @@ TaskSystem::~TaskSystem() {
     for (auto& t : threads_) {
         t.join();
     }
+    // After a shutdown, deferred tasks might still be outstanding; their
+    // handles must not outlive this system.
+    std::unique_lock lock{finish_mutex_};
+    finished_.wait(lock, [this]() { return deferred_ == 0; });
 }
 
 void TaskSystem::Shutdown() noexcept {
     shutdown_ = true;
-    // Abort the workload counter in case a system shut down was requested while
-    // the task queues (workload) are not yet empty and someone is still waiting
-    // on this counter to become zero.
-    total_workload_.Abort();
-    for (auto& q : queues_) {
-        q.done();
+    // Wake up all sleeping workers so they can terminate, as well as anyone
+    // waiting in Finish() in case a system shut down was requested while the
+    // workload is not yet zero.
+    {
+        std::unique_lock lock{sleep_mutex_};
+    }
+    wakeup_.notify_all();
+    {
+        std::unique_lock lock{finish_mutex_};
     }
+    finished_.notify_all();
 }
 
 void TaskSystem::Finish() noexcept {
-    // When starting a new task system all spawned threads will immediately go
-    // to sleep and wait for tasks. Even after adding some tasks, it can take a
-    // while until the first thread wakes up. Therefore, we need to wait for the
-    // total workload (number of active threads _and_ total number of queued
-    // tasks) to become zero.
-    total_workload_.WaitForZero();
+    // The workload counts all tasks that are queued or currently running. As
+    // running tasks may queue new tasks before they finish, the workload can
+    // only become zero once all work is done.
+    std::unique_lock lock{finish_mutex_};
+    finished_.wait(lock, [this]() { return workload_ == 0 or shutdown_; });
+}
+
+auto TaskSystem::DeferTask() noexcept -> DeferredTask {
+    ++workload_;
+    ++deferred_;
+    return DeferredTask{this};
+}
+
+void TaskSystem::Enqueue(std::unique_ptr<Task> task) noexcept {
+    ++workload_;
+    // Count the task as queued before it becomes visible, so that the counter
+    // can never underflow due to a worker taking it early.
+    ++queued_;
+    if (current_system == this) {
+        queues_[current_index].Push(std::move(task));
+    }
+    else {
+        std::unique_lock lock{injection_mutex_};
+        injection_queue_.emplace_back(std::move(task));
+        ++injected_;
+    }
+    WakeOne();
+}
+
+void TaskSystem::WakeOne() noexcept {
+    // Sleepers register themselves before checking for queued tasks, so either
+    // they see the new task or we see them (both counters are seq_cst).
+    if (sleepers_ > 0) {
+        {
+            std::unique_lock lock{sleep_mutex_};
+        }
+        wakeup_.notify_one();
+    }
+}
+
+void TaskSystem::DecrementWorkload() noexcept {
+    if (--workload_ == 0) {
+        {
+            std::unique_lock lock{finish_mutex_};
+        }
+        finished_.notify_all();
+    }
+}
+
+void TaskSystem::ReleaseDeferred() noexcept {
+    DecrementWorkload();
+    // Decrement under the lock, as the destructor may return as soon as it
+    // observes the counter dropping to zero.
+    std::unique_lock lock{finish_mutex_};
+    if (--deferred_ == 0) {
+        finished_.notify_all();
+    }
+}
+
+auto TaskSystem::TakeInjected() noexcept -> std::unique_ptr<Task> {
+    std::unique_lock lock{injection_mutex_};
+    if (injection_queue_.empty()) {
+        return nullptr;
+    }
+    auto task = std::move(injection_queue_.front());
+    injection_queue_.pop_front();
+    --injected_;
+    return task;
+}
+
+auto TaskSystem::TakeTask(std::size_t idx) noexcept -> std::unique_ptr<Task> {
+    if (auto task = queues_[idx].Pop()) {
+        --queued_;
+        return task;
+    }
+    for (std::size_t attempt = 0; attempt < kNumberOfAttempts; ++attempt) {
+        if (queued_ == 0) {
+            return nullptr;
+        }
+        if (injected_ > 0) {
+            if (auto task = TakeInjected()) {
+                --queued_;
+                return task;
+            }
+        }
+        for (std::size_t i = 1; i < thread_count_; ++i) {
+            if (auto task = queues_[(idx + i) % thread_count_].Steal()) {
+                --queued_;
+                return task;
+            }
+        }
+        std::this_thread::yield();
+    }
+    return nullptr;
 }
 
 void TaskSystem::Run(std::size_t idx) {
     Expects(thread_count_ > 0);
+    current_system = this;
+    current_index = idx;
 
     while (not shutdown_) {
-        std::optional<Task> t{};
-        for (std::size_t i = 0; i < thread_count_; ++i) {
-            t = queues_[(idx + i) % thread_count_].try_pop();
-            if (t) {
-                break;
-            }
+        auto task = TakeTask(idx);
+        if (not task) {
+            TaskSpan const idle{"task_system", "idle"};
+            std::unique_lock lock{sleep_mutex_};
+            ++sleepers_;
+            wakeup_.wait(lock, [this]() { return queued_ > 0 or shutdown_; });
+            --sleepers_;
+            continue;
         }
 
-        // NOLINTNEXTLINE(clang-analyzer-core.DivideZero)
-        t = t ? t : queues_[idx % thread_count_].pop();
-
-        if (not t or shutdown_) {
+        if (shutdown_) {
             break;
         }
 
-        (*t)();
+        {
+            TaskSpan const span{"task_system", "task"};
+            (*task)();
+            // Release captured state before the task counts as finished.
+            task.reset();
+        }
+        DecrementWorkload();
     }
 }
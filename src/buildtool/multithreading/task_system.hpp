@@ -17,15 +17,22 @@
 
 #include <algorithm>
 #include <atomic>
+#include <condition_variable>
 #include <cstddef>
+#include <deque>
+#include <memory>
+#include <mutex>
 #include <thread>
-#include <utility>  // std::forward
+#include <utility>  // std::forward, std::exchange
 #include <vector>
 
-#include "src/buildtool/multithreading/notification_queue.hpp"
+#include "src/buildtool/multithreading/task.hpp"
+#include "src/buildtool/multithreading/work_stealing_queue.hpp"
 
 class TaskSystem {
   public:
+    class DeferredTask;
+
     // Constructors create as many threads as specified (or
     // std::thread::hardware_concurrency() many if not specified) running
     // `TaskSystem::Run(index)` on them, where `index` is their position in
@@ -38,28 +45,28 @@ class TaskSystem {
     auto operator=(TaskSystem const&) -> TaskSystem& = delete;
     auto operator=(TaskSystem&&) -> TaskSystem& = delete;
 
-    // Destructor calls sets to "done" all notification queues and joins the
-    // threads. Note that joining the threads will wait until the Run method
-    // they are running is finished
+    // Destructor waits for all tasks to finish, shuts down the system, and
+    // joins the threads. Note that joining the threads will wait until the Run
+    // method they are running is finished
     ~TaskSystem();
 
-    // Queue a task. Task will be added to the first notification queue that is
-    // found to be unlocked or, if none is found (after kNumberOfAttemps
-    // iterations), to the one in `index+1` position waiting until it's
-    // unlocked.
+    // Queue a task. If called from one of this task system's worker threads,
+    // the task is pushed to that worker's own work-stealing queue (lock-free).
+    // Otherwise, it is pushed to the shared injection queue. Idle workers take
+    // from their own queue first, then from the injection queue, and finally
+    // steal from the queues of other workers.
     template <typename FunctionType>
     void QueueTask(FunctionType&& f) noexcept {
-        auto idx = index_++;
-
-        for (std::size_t i = 0; i < thread_count_ * kNumberOfAttempts; ++i) {
-            if (queues_[(idx + i) % thread_count_].try_push(
-                    std::forward<FunctionType>(f))) {
-                return;
-            }
-        }
-        queues_[idx % thread_count_].push(std::forward<FunctionType>(f));
+        Enqueue(std::make_unique<Task>(std::forward<FunctionType>(f)));
     }
 
+    // Reserve a task to be queued at a later point in time, possibly from a
+    // thread not belonging to this task system (e.g., the completion callback
+    // of an asynchronous operation). Until the returned handle is used or
+    // destroyed, the reserved task counts as pending workload, so Finish()
+    // waits for it and the destructor does not return before it was released.
+    [[nodiscard]] auto DeferTask() noexcept -> DeferredTask;
+
     [[nodiscard]] auto NumberOfThreads() const noexcept -> std::size_t {
         return thread_count_;
     }
@@ -74,14 +81,75 @@ class TaskSystem {
     std::size_t const thread_count_{
         std::max(1U, std::thread::hardware_concurrency())};
     std::vector<std::thread> threads_;
-    std::vector<NotificationQueue> queues_;
-    std::atomic<std::size_t> index_{0};
-    std::atomic<bool> shutdown_ = false;
-    WaitableZeroCounter total_workload_;
+    // One work-stealing queue per worker thread, owned by that worker.
+    std::vector<WorkStealingQueue> queues_;
+
+    // Queue for tasks submitted from threads not belonging to this system.
+    std::mutex injection_mutex_;
+    std::deque<std::unique_ptr<Task>> injection_queue_;
+    std::atomic<std::size_t> injected_{0};
 
+    // Number of queued tasks that have not yet been taken by a worker.
+    std::atomic<std::size_t> queued_{0};
+    // Number of tasks queued, running, or deferred; the system is finished at
+    // zero.
+    std::atomic<std::size_t> workload_{0};
+    // Number of deferred tasks not yet released.
+    std::atomic<std::size_t> deferred_{0};
+    std::atomic<bool> shutdown_{false};
+
+    // Idle workers sleep on this condition variable; producers only notify if
+    // there are sleepers, so the mutex is not touched in the busy case.
+    std::mutex sleep_mutex_;
+    std::condition_variable wakeup_;
+    std::atomic<std::size_t> sleepers_{0};
+
+    // Callers of Finish() wait here for the workload to become zero, the
+    // destructor waits here for all deferred tasks to be released.
+    std::mutex finish_mutex_;
+    std::condition_variable finished_;
+
+    // Number of stealing rounds over all queues before a worker goes to sleep.
     static constexpr std::size_t kNumberOfAttempts = 5;
 
+    void Enqueue(std::unique_ptr<Task> task) noexcept;
+    void WakeOne() noexcept;
+    void DecrementWorkload() noexcept;
+    void ReleaseDeferred() noexcept;
+    [[nodiscard]] auto TakeTask(std::size_t idx) noexcept
+        -> std::unique_ptr<Task>;
+    [[nodiscard]] auto TakeInjected() noexcept -> std::unique_ptr<Task>;
     void Run(std::size_t idx);
 };
 
+// Handle to a task reserved by TaskSystem::DeferTask(). Queueing a task through
+// the handle (at most once) or destroying it releases the reservation.
+class TaskSystem::DeferredTask {
+  public:
+    DeferredTask(DeferredTask const&) = delete;
+    DeferredTask(DeferredTask&& other) noexcept
+        : system_{std::exchange(other.system_, nullptr)} {}
+    auto operator=(DeferredTask const&) -> DeferredTask& = delete;
+    auto operator=(DeferredTask&&) -> DeferredTask& = delete;
+    ~DeferredTask() {
+        if (system_ != nullptr) {
+            system_->ReleaseDeferred();
+        }
+    }
+
+    template <typename FunctionType>
+    void Queue(FunctionType&& f) noexcept {
+        if (auto* system = std::exchange(system_, nullptr)) {
+            system->QueueTask(std::forward<FunctionType>(f));
+            system->ReleaseDeferred();
+        }
+    }
+
+  private:
+    friend class TaskSystem;
+    TaskSystem* system_;
+
+    explicit DeferredTask(TaskSystem* system) noexcept : system_{system} {}
+};
+
 #endif  // INCLUDED_SRC_BUILDTOOL_MULTITHREADING_TASK_SYSTEM_HPP
@@ -0,0 +1,179 @@
+// Copyright 2026 Huawei Cloud Computing Technology Co., Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef INCLUDED_SRC_BUILDTOOL_MULTITHREADING_WORK_STEALING_QUEUE_HPP
+#define INCLUDED_SRC_BUILDTOOL_MULTITHREADING_WORK_STEALING_QUEUE_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "src/buildtool/multithreading/task.hpp"
+
+/// \brief Lock-free single-producer multi-consumer deque of tasks.
+/// Implementation of the Chase-Lev work-stealing deque, following the C11
+/// formulation of "Correct and Efficient Work-Stealing for Weak Memory Models"
+/// (Lê, Pop, Cohen, Zappa Nardelli, PPoPP 2013). Only the owning thread may
+/// call Push and Pop, which operate LIFO on the bottom end; any thread may call
+/// Steal, which operates FIFO on the top end. The queue owns the tasks it
+/// contains and deletes remaining ones on destruction.
+class WorkStealingQueue {
+  public:
+    explicit WorkStealingQueue(
+        std::size_t initial_capacity = kInitialCapacity) {
+        array_.store(NewArray(RoundUpToPowerOfTwo(initial_capacity)),
+                     std::memory_order_relaxed);
+    }
+
+    WorkStealingQueue(WorkStealingQueue const&) = delete;
+    WorkStealingQueue(WorkStealingQueue&&) = delete;
+    auto operator=(WorkStealingQueue const&) -> WorkStealingQueue& = delete;
+    auto operator=(WorkStealingQueue&&) -> WorkStealingQueue& = delete;
+
+    ~WorkStealingQueue() noexcept {
+        auto* array = array_.load(std::memory_order_relaxed);
+        auto const top = top_.load(std::memory_order_relaxed);
+        auto const bottom = bottom_.load(std::memory_order_relaxed);
+        for (auto i = top; i < bottom; ++i) {
+            delete array->Get(i);  // NOLINT(cppcoreguidelines-owning-memory)
+        }
+    }
+
+    /// \brief Push task to the bottom end. Owner thread only.
+    void Push(std::unique_ptr<Task> task) {
+        auto const bottom = bottom_.load(std::memory_order_relaxed);
+        auto const top = top_.load(std::memory_order_acquire);
+        auto* array = array_.load(std::memory_order_relaxed);
+        if (bottom - top > static_cast<std::int64_t>(array->capacity) - 1) {
+            array = Grow(array, top, bottom);
+        }
+        array->Put(bottom, task.release());
+        std::atomic_thread_fence(std::memory_order_release);
+        bottom_.store(bottom + 1, std::memory_order_relaxed);
+    }
+
+    /// \brief Pop most recently pushed task from the bottom end. Owner thread
+    /// only. Returns nullptr if the queue is empty.
+    [[nodiscard]] auto Pop() noexcept -> std::unique_ptr<Task> {
+        auto const bottom = bottom_.load(std::memory_order_relaxed) - 1;
+        auto* array = array_.load(std::memory_order_relaxed);
+        bottom_.store(bottom, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        auto top = top_.load(std::memory_order_relaxed);
+        if (top > bottom) {
+            // queue was empty
+            bottom_.store(bottom + 1, std::memory_order_relaxed);
+            return nullptr;
+        }
+        auto* task = array->Get(bottom);
+        if (top == bottom) {
+            // last element, race against thieves
+            if (not top_.compare_exchange_strong(top,
+                                                 top + 1,
+                                                 std::memory_order_seq_cst,
+                                                 std::memory_order_relaxed)) {
+                task = nullptr;
+            }
+            bottom_.store(bottom + 1, std::memory_order_relaxed);
+        }
+        return std::unique_ptr<Task>{task};
+    }
+
+    /// \brief Steal least recently pushed task from the top end. Can be called
+    /// from any thread. Returns nullptr if the queue is empty or if the steal
+    /// lost a race against another thief or the owner.
+    [[nodiscard]] auto Steal() noexcept -> std::unique_ptr<Task> {
+        auto top = top_.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        auto const bottom = bottom_.load(std::memory_order_acquire);
+        if (top >= bottom) {
+            return nullptr;
+        }
+        auto* array = array_.load(std::memory_order_acquire);
+        auto* task = array->Get(top);
+        if (not top_.compare_exchange_strong(top,
+                                             top + 1,
+                                             std::memory_order_seq_cst,
+                                             std::memory_order_relaxed)) {
+            return nullptr;
+        }
+        return std::unique_ptr<Task>{task};
+    }
+
+    /// \brief Racy estimate whether the queue is empty.
+    [[nodiscard]] auto Empty() const noexcept -> bool {
+        return bottom_.load(std::memory_order_relaxed) <=
+               top_.load(std::memory_order_relaxed);
+    }
+
+  private:
+    static constexpr std::size_t kInitialCapacity = 256;
+    // Avoid false sharing between owner (bottom) and thieves (top).
+    static constexpr std::size_t kCacheLineSize = 64;
+
+    // Circular buffer of fixed capacity (power of two).
+    struct Array {
+        std::size_t capacity;
+        std::unique_ptr<std::atomic<Task*>[]> slots;
+
+        explicit Array(std::size_t cap)
+            : capacity{cap}, slots{new std::atomic<Task*>[cap]} {}
+
+        [[nodiscard]] auto Get(std::int64_t i) const noexcept -> Task* {
+            return slots[static_cast<std::size_t>(i) & (capacity - 1)].load(
+                std::memory_order_acquire);
+        }
+
+        void Put(std::int64_t i, Task* task) noexcept {
+            slots[static_cast<std::size_t>(i) & (capacity - 1)].store(
+                task, std::memory_order_release);
+        }
+    };
+
+    alignas(kCacheLineSize) std::atomic<std::int64_t> top_{0};
+    alignas(kCacheLineSize) std::atomic<std::int64_t> bottom_{0};
+    alignas(kCacheLineSize) std::atomic<Array*> array_{nullptr};
+    // All arrays ever allocated. Thieves might still read from an array that
+    // was replaced by a larger one, so arrays are only freed on destruction.
+    // Only accessed by the owner thread.
+    std::vector<std::unique_ptr<Array>> arrays_;
+
+    [[nodiscard]] auto NewArray(std::size_t capacity) -> Array* {
+        return arrays_.emplace_back(std::make_unique<Array>(capacity)).get();
+    }
+
+    [[nodiscard]] auto Grow(Array* old,
+                            std::int64_t top,
+                            std::int64_t bottom) -> Array* {
+        auto* array = NewArray(old->capacity * 2);
+        for (auto i = top; i < bottom; ++i) {
+            array->Put(i, old->Get(i));
+        }
+        array_.store(array, std::memory_order_release);
+        return array;
+    }
+
+    [[nodiscard]] static auto RoundUpToPowerOfTwo(std::size_t n) noexcept
+        -> std::size_t {
+        std::size_t result = 1;
+        while (result < n) {
+            result <<= 1U;
+        }
+        return result;
+    }
+};
+
+#endif  // INCLUDED_SRC_BUILDTOOL_MULTITHREADING_WORK_STEALING_QUEUE_HPP
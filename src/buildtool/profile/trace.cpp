@@ -0,0 +1,215 @@
+// Copyright 2026 Huawei Cloud Computing Technology Co., Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "src/buildtool/profile/trace.hpp"
+
+#include <chrono>
+#include <cstddef>
+#include <exception>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "nlohmann/json.hpp"
+#include "src/buildtool/logging/log_level.hpp"
+#include "src/buildtool/logging/logger.hpp"
+#include "src/buildtool/multithreading/task_span.hpp"
+
+namespace {
+
+struct Event {
+    char const* category;
+    char const* name;
+    std::string detail;
+    std::int64_t start;
+    std::int64_t end;
+    std::uint64_t async_id;
+};
+
+// Spans of a single thread. The mutex is only contended while the trace is
+// started or written.
+struct ThreadBuffer {
+    std::mutex mutex;
+    std::vector<Event> events;
+    std::size_t id{};
+};
+
+struct Registry {
+    std::mutex mutex;
+    std::vector<std::shared_ptr<ThreadBuffer>> buffers;
+    std::atomic<std::chrono::steady_clock::rep> epoch{};
+};
+
+[[nodiscard]] auto GetRegistry() noexcept -> Registry& {
+    static Registry instance{};
+    return instance;
+}
+
+[[nodiscard]] auto LocalBuffer() -> ThreadBuffer& {
+    thread_local std::shared_ptr<ThreadBuffer> const kBuffer = []() {
+        auto buffer = std::make_shared<ThreadBuffer>();
+        auto& registry = GetRegistry();
+        std::unique_lock lock{registry.mutex};
+        buffer->id = registry.buffers.size() + 1;
+        registry.buffers.emplace_back(buffer);
+        return buffer;
+    }();
+    return *kBuffer;
+}
+
+[[nodiscard]] auto ToJson(Event const& event,
+                          std::size_t tid,
+                          char const* phase,
+                          std::int64_t timestamp) -> nlohmann::json {
+    auto json = nlohmann::json{{"name", event.name},
+                               {"cat", event.category},
+                               {"ph", phase},
+                               {"ts", timestamp},
+                               {"pid", 1},
+                               {"tid", tid}};
+    if (not event.detail.empty()) {
+        json["args"] = nlohmann::json{{"detail", event.detail}};
+    }
+    return json;
+}
+
+// Writes an event as complete event, or as pair of async begin and end
+// events, which are shown on tracks of their own.
+void WriteEvent(std::ostream& os, Event const& event, std::size_t tid) {
+    if (event.async_id == 0) {
+        auto json = ToJson(event, tid, "X", event.start);
+        json["dur"] = event.end - event.start;
+        os << ",\n" << json.dump();
+        return;
+    }
+    auto begin = ToJson(event, tid, "b", event.start);
+    begin["id"] = event.async_id;
+    auto end = ToJson(event, tid, "e", event.end);
+    end["id"] = event.async_id;
+    os << ",\n" << begin.dump() << ",\n" << end.dump();
+}
+
+// Records the spans of the task system.
+[[nodiscard]] auto StartTaskSpan() noexcept -> std::int64_t {
+    return Trace::IsEnabled() ? Trace::Now() : -1;
+}
+
+void FinishTaskSpan(char const* category,
+                    char const* name,
+                    std::int64_t start) noexcept {
+    Trace::Record(category, name, std::string{}, start, Trace::Now());
+}
+
+constexpr TaskSpan::Recorder kTaskSpanRecorder{.start = StartTaskSpan,
+                                               .finish = FinishTaskSpan};
+
+}  // namespace
+
+void Trace::Start() noexcept {
+    try {
+        auto& registry = GetRegistry();
+        std::unique_lock lock{registry.mutex};
+        // Drop the buffers of terminated threads, keep the ones of running
+        // threads, as those keep using them.
+        std::erase_if(registry.buffers, [](auto const& buffer) {
+            return buffer.use_count() == 1;
+        });
+        for (auto const& buffer : registry.buffers) {
+            std::unique_lock buffer_lock{buffer->mutex};
+            buffer->events.clear();
+        }
+        registry.epoch =
+            std::chrono::steady_clock::now().time_since_epoch().count();
+        enabled_ = true;
+        TaskSpan::SetRecorder(&kTaskSpanRecorder);
+    } catch (std::exception const& ex) {
+        Logger::Log(
+            LogLevel::Warning, "Starting trace failed with:\n{}", ex.what());
+    }
+}
+
+auto Trace::Stop(std::filesystem::path const& file) noexcept -> bool {
+    TaskSpan::SetRecorder(nullptr);
+    enabled_ = false;
+    try {
+        std::ofstream os(file);
+        os << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+        os << nlohmann::json{{"name", "process_name"},
+                             {"ph", "M"},
+                             {"pid", 1},
+                             {"args", {{"name", "just"}}}}
+                  .dump();
+        auto& registry = GetRegistry();
+        std::unique_lock lock{registry.mutex};
+        for (auto const& buffer : registry.buffers) {
+            std::vector<Event> events{};
+            {
+                std::unique_lock buffer_lock{buffer->mutex};
+                events = std::move(buffer->events);
+                buffer->events.clear();
+            }
+            for (auto const& event : events) {
+                WriteEvent(os, event, buffer->id);
+            }
+        }
+        os << "\n]}" << std::endl;
+        if (not os.good()) {
+            Logger::Log(LogLevel::Warning,
+                        "Writing trace to {} failed",
+                        file.string());
+            return false;
+        }
+        return true;
+    } catch (std::exception const& ex) {
+        Logger::Log(LogLevel::Warning,
+                    "Writing trace to {} failed with:\n{}",
+                    file.string(),
+                    ex.what());
+    }
+    return false;
+}
+
+auto Trace::Now() noexcept -> std::int64_t {
+    auto const epoch = std::chrono::steady_clock::duration{
+        GetRegistry().epoch.load(std::memory_order_relaxed)};
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+               std::chrono::steady_clock::now().time_since_epoch() - epoch)
+        .count();
+}
+
+void Trace::Record(char const* category,
+                   char const* name,
+                   std::string&& detail,
+                   std::int64_t start,
+                   std::int64_t end,
+                   bool is_async) noexcept {
+    if (not IsEnabled()) {
+        return;
+    }
+    try {
+        auto& buffer = LocalBuffer();
+        std::unique_lock lock{buffer.mutex};
+        buffer.events.emplace_back(Event{.category = category,
+                                         .name = name,
+                                         .detail = std::move(detail),
+                                         .start = start,
+                                         .end = end,
+                                         .async_id = is_async
+                                                         ? next_async_id_++
+                                                         : 0});
+    } catch (...) {
+        // Spans that cannot be recorded are dropped.
+    }
+}
@@ -0,0 +1,147 @@
+// Copyright 2026 Huawei Cloud Computing Technology Co., Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef INCLUDED_SRC_BUILDTOOL_PROFILE_TRACE_HPP
+#define INCLUDED_SRC_BUILDTOOL_PROFILE_TRACE_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <string_view>
+#include <utility>
+
+/// \brief Process-wide recording of a timeline of spans, written in the Chrome
+/// trace event format (which Perfetto and chrome://tracing can open). Spans
+/// are recorded into thread-local buffers, so recording does not synchronize
+/// threads; while recording is disabled, a span only costs a flag check.
+class Trace final {
+  public:
+    /// \brief Discard all recorded spans and start recording.
+    static void Start() noexcept;
+
+    /// \brief Stop recording and write the recorded spans to the given file.
+    /// \returns True on success.
+    [[nodiscard]] static auto Stop(std::filesystem::path const& file) noexcept
+        -> bool;
+
+    [[nodiscard]] static auto IsEnabled() noexcept -> bool {
+        return enabled_.load(std::memory_order_relaxed);
+    }
+
+    /// \brief Microseconds since recording was started.
+    [[nodiscard]] static auto Now() noexcept -> std::int64_t;
+
+    /// \brief Record a span of the current thread.
+    /// \param is_async    Whether the span is not bound to the thread, e.g.,
+    /// as it was started on another one or overlaps other spans of it.
+    static void Record(char const* category,
+                       char const* name,
+                       std::string&& detail,
+                       std::int64_t start,
+                       std::int64_t end,
+                       bool is_async = false) noexcept;
+
+  private:
+    static inline std::atomic<bool> enabled_{false};
+    static inline std::atomic<std::uint64_t> next_async_id_{1};
+};
+
+/// \brief Span covering the lifetime of this object, recorded if tracing is
+/// enabled when it is created.
+/// \param category Category of the span; must be a string literal.
+/// \param name     Name of the span; must be a string literal.
+/// \param detail   Optional description, shown as argument of the span.
+class TraceSpan final {
+  public:
+    TraceSpan(char const* category,
+              char const* name,
+              std::string_view detail = {}) noexcept
+        : category_{category}, name_{name} {
+        if (Trace::IsEnabled()) {
+            try {
+                detail_ = detail;
+            } catch (...) {
+                return;
+            }
+            start_ = Trace::Now();
+        }
+    }
+
+    ~TraceSpan() noexcept {
+        if (start_ >= 0) {
+            Trace::Record(
+                category_, name_, std::move(detail_), start_, Trace::Now());
+        }
+    }
+
+    TraceSpan(TraceSpan const&) = delete;
+    TraceSpan(TraceSpan&&) = delete;
+    auto operator=(TraceSpan const&) -> TraceSpan& = delete;
+    auto operator=(TraceSpan&&) -> TraceSpan& = delete;
+
+  private:
+    char const* category_;
+    char const* name_;
+    std::string detail_;
+    std::int64_t start_{-1};
+};
+
+/// \brief Span of an asynchronous operation, which may finish on another
+/// thread than it started on and overlap other spans of these threads. It is
+/// recorded on a track of its own when finished, at the latest on destruction.
+class AsyncTraceSpan final {
+  public:
+    AsyncTraceSpan(char const* category,
+                   char const* name,
+                   std::string_view detail = {}) noexcept
+        : category_{category}, name_{name} {
+        if (Trace::IsEnabled()) {
+            try {
+                detail_ = detail;
+            } catch (...) {
+                return;
+            }
+            start_ = Trace::Now();
+        }
+    }
+
+    ~AsyncTraceSpan() noexcept { Finish(); }
+
+    AsyncTraceSpan(AsyncTraceSpan const&) = delete;
+    AsyncTraceSpan(AsyncTraceSpan&&) = delete;
+    auto operator=(AsyncTraceSpan const&) -> AsyncTraceSpan& = delete;
+    auto operator=(AsyncTraceSpan&&) -> AsyncTraceSpan& = delete;
+
+    /// \brief Finish the span now; later calls have no effect.
+    void Finish() noexcept {
+        if (start_ >= 0) {
+            Trace::Record(category_,
+                          name_,
+                          std::move(detail_),
+                          start_,
+                          Trace::Now(),
+                          /*is_async=*/true);
+            start_ = -1;
+        }
+    }
+
+  private:
+    char const* category_;
+    char const* name_;
+    std::string detail_;
+    std::int64_t start_{-1};
+};
+
+#endif  // INCLUDED_SRC_BUILDTOOL_PROFILE_TRACE_HPP
@@ -15,8 +15,13 @@
 #ifndef INCLUDED_SRC_BUILDTOOL_PROGRESS_REPORTING_PROGRESS_HPP
 #define INCLUDED_SRC_BUILDTOOL_PROGRESS_REPORTING_PROGRESS_HPP
 
+#include <atomic>
+#include <chrono>
 #include <cstddef>
+#include <cstdint>
 #include <functional>
+#include <mutex>
+#include <optional>
 #include <string>
 #include <unordered_map>
 #include <utility>
@@ -48,14 +53,96 @@ class Progress {
         return output_map_;
     }
 
+    /// \brief Add the estimated execution times, in seconds, of actions that
+    /// are about to be built, by action identifier. The estimates are kept, so
+    /// that each action is accounted with the same estimate when finished.
+    /// Actions already expected are not added again. If no work was
+    /// outstanding, this marks the start of a new build.
+    void AddExpectedWork(
+        std::unordered_map<std::string, double> const& work) noexcept {
+        try {
+            std::unique_lock lock{expected_mutex_};
+            if (expected_.empty()) {
+                expected_work_ = 0.0;
+                completed_work_ = 0.0;
+                start_ns_ = NowNanoseconds();
+            }
+            double added = 0.0;
+            for (auto const& [action_id, seconds] : work) {
+                if (expected_.emplace(action_id, seconds).second) {
+                    added += seconds;
+                }
+            }
+            expected_work_.fetch_add(added);
+        } catch (...) {
+            // the estimate is only informative
+        }
+    }
+
+    /// \brief Account for a finished action with the estimate it was expected
+    /// with. Executed actions count as completed work, the work of actions not
+    /// executed, e.g., as they were cached, is no longer expected.
+    void FinishExpectedWork(std::string const& action_id,
+                            bool executed) noexcept {
+        double seconds{};
+        {
+            std::unique_lock lock{expected_mutex_};
+            auto it = expected_.find(action_id);
+            if (it == expected_.end()) {
+                return;
+            }
+            seconds = it->second;
+            expected_.erase(it);
+        }
+        if (executed) {
+            completed_work_.fetch_add(seconds);
+        }
+        else {
+            expected_work_.fetch_sub(seconds);
+        }
+    }
+
+    /// \brief Estimate the remaining wall-clock time of the build from the
+    /// rate at which the expected work was completed so far.
+    [[nodiscard]] auto RemainingTime() const noexcept
+        -> std::optional<std::chrono::seconds> {
+        auto const start = start_ns_.load();
+        auto const completed = completed_work_.load();
+        auto const remaining = expected_work_.load() - completed;
+        if (start == 0 or completed <= 0.0 or remaining <= 0.0) {
+            return std::nullopt;
+        }
+        auto const elapsed =
+            static_cast<double>(NowNanoseconds() - start) / kNanosPerSecond;
+        if (elapsed < 1.0) {
+            return std::nullopt;
+        }
+        return std::chrono::seconds{
+            static_cast<std::int64_t>(remaining * elapsed / completed)};
+    }
+
   private:
+    static constexpr double kNanosPerSecond = 1e9;
+
     ::TaskTracker task_tracker_{};
+    std::atomic<std::int64_t> start_ns_{};
+    std::atomic<double> expected_work_{};
+    std::atomic<double> completed_work_{};
+    std::mutex expected_mutex_;
+    // estimates of the expected actions not yet finished
+    std::unordered_map<std::string, double> expected_;
     std::unordered_map<
         std::string,
         std::vector<
             std::pair<BuildMaps::Target::ConfiguredTarget, std::size_t>>>
         origin_map_;
     std::unordered_map<std::string, std::string> output_map_;
+
+    [[nodiscard]] static auto NowNanoseconds() noexcept -> std::int64_t {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                   std::chrono::steady_clock::now().time_since_epoch())
+            .count();
+    }
 };
 
 #endif  // INCLUDED_SRC_BUILDTOOL_PROGRESS_REPORTING_PROGRESS_HPP
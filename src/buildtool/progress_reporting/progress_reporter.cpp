@@ -14,6 +14,8 @@
 
 #include "src/buildtool/progress_reporting/progress_reporter.hpp"
 
+#include <chrono>
+#include <cstdint>
 #include <filesystem>
 #include <functional>
 #include <string>
@@ -28,6 +30,28 @@
 #include "src/buildtool/logging/log_level.hpp"
 #include "src/buildtool/progress_reporting/task_tracker.hpp"
 
+namespace {
+
+/// \brief Format an estimated remaining time for the progress line.
+[[nodiscard]] auto FormatEta(std::chrono::seconds eta) -> std::string {
+    constexpr std::int64_t kSecondsPerMinute{60};
+    constexpr std::int64_t kSecondsPerHour{3600};
+    auto const secs = eta.count();
+    if (secs >= kSecondsPerHour) {
+        return fmt::format(", ETA {}h{:02}m",
+                           secs / kSecondsPerHour,
+                           (secs % kSecondsPerHour) / kSecondsPerMinute);
+    }
+    if (secs >= kSecondsPerMinute) {
+        return fmt::format(", ETA {}m{:02}s",
+                           secs / kSecondsPerMinute,
+                           secs % kSecondsPerMinute);
+    }
+    return fmt::format(", ETA {}s", secs);
+}
+
+}  // namespace
+
 auto ProgressReporter::Reporter(gsl::not_null<Statistics*> const& stats,
                                 gsl::not_null<Progress*> const& progress,
                                 Logger const* logger) noexcept
@@ -71,6 +95,10 @@ auto ProgressReporter::Reporter(gsl::not_null<Statistics*> const& stats,
                                       active > 1 ? ", ..." : "");
             }
         }
+        std::string eta_msg{};
+        if (auto eta = progress->RemainingTime()) {
+            eta_msg = FormatEta(*eta);
+        }
         constexpr int kOneHundred{100};
         int total_work = total - cached;
         int progress = kOneHundred;  // default if no work has to be done
@@ -79,8 +107,9 @@ auto ProgressReporter::Reporter(gsl::not_null<Statistics*> const& stats,
         }
         Logger::Log(logger,
                     LogLevel::Progress,
-                    "[{:3}%] {} cached, {} run, {} processing{}.",
+                    "[{:3}%{}] {} cached, {} run, {} processing{}.",
                     progress,
+                    eta_msg,
                     cached,
                     run,
                     active,
@@ -94,6 +94,7 @@ auto ServeServerImpl::Run(
     std::optional<ServeApi> const& serve,
     ApiBundle const& apis,
     std::optional<std::uint8_t> op_exponent,
+    std::size_t action_slots,
     bool with_execute) -> bool {
     // make sure the git root directory is properly initialized
     if (not FileSystemManager::CreateDirectory(
@@ -186,7 +187,8 @@ auto ServeServerImpl::Run(
     [[maybe_unused]] ExecutionServiceImpl es{
         local_context,
         dynamic_cast<LocalApi const*>(&*apis.local),
-        op_exponent};
+        op_exponent,
+        action_slots};
     [[maybe_unused]] ActionCacheServiceImpl ac{local_context};
     [[maybe_unused]] CASServiceImpl cas{local_context};
     [[maybe_unused]] BytestreamServiceImpl b{local_context};
@@ -15,6 +15,7 @@
 #ifndef SERVE_SERVER_IMPLEMENTATION_HPP
 #define SERVE_SERVER_IMPLEMENTATION_HPP
 
+#include <cstddef>
 #include <cstdint>
 #include <mutex>
 #include <optional>
@@ -57,6 +58,7 @@ class ServeServerImpl final {
              std::optional<ServeApi> const& serve,
              ApiBundle const& apis,
              std::optional<std::uint8_t> op_exponent,
+             std::size_t action_slots,
              bool with_execute) -> bool;
 
   private:
@@ -613,6 +613,47 @@ auto SourceTreeService::ResolveContentTree(
     return SyncArchive(tree_id, repo_path, sync_tree, response);
 }
 
+auto SourceTreeService::StreamArchiveToGit(
+    std::filesystem::path const& archive,
+    std::string const& archive_type) -> expected<std::string, std::string> {
+    auto const& git_root = native_context_->storage_config->GitRoot();
+    auto just_git_cas = GitCAS::Open(git_root);
+    if (not just_git_cas) {
+        return unexpected{
+            fmt::format("Failed to open Git ODB at {}", git_root.string())};
+    }
+    auto tree_id = ArchiveOps::ImportArchiveToGit(
+        archive_type, archive, just_git_cas, serve_config_.jobs);
+    if (not tree_id) {
+        return tree_id;
+    }
+    // keep tree alive in Git cache
+    {
+        // this is a non-thread-safe Git operation, so it must be guarded!
+        std::unique_lock slock{*lock_};
+        auto git_repo = GitRepo::Open(git_root);
+        if (not git_repo) {
+            return unexpected{fmt::format(
+                "Failed to open Git CAS repository {}", git_root.string())};
+        }
+        std::string err;
+        auto logger = std::make_shared<GitRepo::anon_logger_t>(
+            [&err](auto const& msg, bool fatal) {
+                if (fatal) {
+                    err = msg;
+                }
+            });
+        // Important: message must be consistent with just-mr!
+        if (not git_repo->KeepTree(*tree_id,
+                                   /*message=*/"Keep referenced tree alive",
+                                   logger)) {
+            return unexpected{fmt::format(
+                "While keeping tree {} alive:\n{}", *tree_id, std::move(err))};
+        }
+    }
+    return tree_id;
+}
+
 auto SourceTreeService::ArchiveImportToGit(
     std::filesystem::path const& unpack_path,
     std::filesystem::path const& archive_tree_id_file,
@@ -635,7 +676,21 @@ auto SourceTreeService::ArchiveImportToGit(
         response->set_status(ServeArchiveTreeResponse::INTERNAL_ERROR);
         return ::grpc::Status::OK;
     }
-    auto const& tree_id = *res;
+    return ArchiveTreeToResponse(*res,
+                                 archive_tree_id_file,
+                                 subdir,
+                                 resolve_special,
+                                 sync_tree,
+                                 response);
+}
+
+auto SourceTreeService::ArchiveTreeToResponse(
+    std::string const& tree_id,
+    std::filesystem::path const& archive_tree_id_file,
+    std::string const& subdir,
+    std::optional<PragmaSpecial> const& resolve_special,
+    bool sync_tree,
+    ServeArchiveTreeResponse* response) -> ::grpc::Status {
     // write to tree id file
     if (not StorageUtils::WriteTreeIDFile(archive_tree_id_file, tree_id)) {
         logger_->Emit(LogLevel::Error,
@@ -864,6 +919,20 @@ auto SourceTreeService::ServeArchiveTree(
             return ::grpc::Status::OK;
         }
     }
+    // import archive content straight into the Git cache, if possible
+    auto tree_id = StreamArchiveToGit(*content_cas_path, archive_type);
+    if (tree_id) {
+        return ArchiveTreeToResponse(*tree_id,
+                                     archive_tree_id_file,
+                                     subdir,
+                                     resolve_special,
+                                     request->sync_tree(),
+                                     response);
+    }
+    logger_->Emit(LogLevel::Debug,
+                  "Could not import archive {} without extracting it:\n{}",
+                  content_cas_path->string(),
+                  tree_id.error());
     // extract archive
     auto tmp_dir =
         native_context_->storage_config->CreateTypedTmpDir(archive_type);
@@ -223,6 +223,23 @@ class SourceTreeService final
         bool sync_tree,
         ServeArchiveTreeResponse* response) -> ::grpc::Status;
 
+    /// \brief Imports an archive from the native CAS directly into the Git
+    /// cache, without extracting it, and keeps the resulting tree alive.
+    /// \returns The tree identifier, or an error message on failure.
+    [[nodiscard]] auto StreamArchiveToGit(std::filesystem::path const& archive,
+                                          std::string const& archive_type)
+        -> expected<std::string, std::string>;
+
+    /// \brief Responds with the tree of an archive that is in the Git cache,
+    /// after recording it in the archive tree id file.
+    [[nodiscard]] auto ArchiveTreeToResponse(
+        std::string const& tree_id,
+        std::filesystem::path const& archive_tree_id_file,
+        std::string const& subdir,
+        std::optional<PragmaSpecial> const& resolve_special,
+        bool sync_tree,
+        ServeArchiveTreeResponse* response) -> ::grpc::Status;
+
     [[nodiscard]] auto ArchiveImportToGit(
         std::filesystem::path const& unpack_path,
         std::filesystem::path const& archive_tree_id_file,
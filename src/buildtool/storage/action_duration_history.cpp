@@ -0,0 +1,326 @@
+// Copyright 2026 Huawei Cloud Computing Technology Co., Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "src/buildtool/storage/action_duration_history.hpp"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <chrono>
+#include <cstring>
+#include <exception>
+#include <set>
+#include <string_view>
+#include <utility>
+
+#include "src/buildtool/logging/log_level.hpp"
+#include "src/buildtool/logging/logger.hpp"
+#include "src/buildtool/storage/persistent_file.hpp"
+
+namespace {
+
+// Magic at the start of the history file; bump the version on format changes.
+// The byte-order mark rejects files written on machines of other endianness.
+constexpr std::string_view kMagic{"just-durations 1"};
+constexpr std::uint32_t kByteOrderMark = 0x01020304U;
+
+struct Header {
+    std::array<char, kMagic.size()> magic;
+    std::uint32_t byte_order;
+    std::uint32_t reserved;
+    std::uint64_t count;
+};
+static_assert(sizeof(Header) % alignof(std::uint64_t) == 0);
+
+// Weight of a new measurement in the smoothed duration of an entry.
+constexpr double kSmoothing = 0.3;
+
+// Upper bound on the number of entries; if exceeded, the entries updated
+// least recently are dropped when saving.
+constexpr std::size_t kMaxEntries = std::size_t{1} << 20U;
+
+// Extensions longer than this are not considered file types.
+constexpr std::size_t kMaxExtensionLength = 8;
+
+/// \brief Stable 64-bit FNV-1a hash; keys must not change between builds of
+/// the tool, so std::hash is not suitable.
+[[nodiscard]] auto StableHash(std::string_view prefix,
+                              std::string_view data) noexcept
+    -> std::uint64_t {
+    constexpr std::uint64_t kOffsetBasis = 0xcbf29ce484222325ULL;
+    constexpr std::uint64_t kPrime = 0x100000001b3ULL;
+    std::uint64_t hash = kOffsetBasis;
+    for (auto part : {prefix, data}) {
+        for (char c : part) {
+            hash ^= static_cast<unsigned char>(c);
+            hash *= kPrime;
+        }
+    }
+    return hash;
+}
+
+[[nodiscard]] auto ActionKey(Action const& action) noexcept -> std::uint64_t {
+    return StableHash("action:", action.Id());
+}
+
+[[nodiscard]] auto ShapeKey(Action const& action) -> std::uint64_t {
+    return StableHash("shape:",
+                      ActionDurationHistory::CommandShape(action.Command()));
+}
+
+[[nodiscard]] auto Today() noexcept -> std::uint32_t {
+    return static_cast<std::uint32_t>(
+        std::chrono::duration_cast<std::chrono::days>(
+            std::chrono::system_clock::now().time_since_epoch())
+            .count());
+}
+
+}  // namespace
+
+ActionDurationHistory::ActionDurationHistory(
+    gsl::not_null<StorageConfig const*> const& storage_config) noexcept
+    : history_file_{storage_config->CacheRoot() / "action-durations"} {
+    Map();
+}
+
+ActionDurationHistory::~ActionDurationHistory() noexcept { Unmap(); }
+
+auto ActionDurationHistory::CommandShape(
+    std::vector<std::string> const& command) -> std::string {
+    if (command.empty()) {
+        return std::string{};
+    }
+    std::set<std::string> extensions{};
+    for (std::size_t i = 1; i < command.size(); ++i) {
+        auto const& arg = command[i];
+        auto const pos = arg.find_last_of("./");
+        if (pos == std::string::npos or arg[pos] != '.' or pos == 0 or
+            arg[pos - 1] == '/' or arg.size() - pos > kMaxExtensionLength + 1) {
+            continue;
+        }
+        auto ext = arg.substr(pos);
+        if (ext.size() > 1 and
+            std::all_of(ext.begin() + 1, ext.end(), [](char c) {
+                return std::isalnum(static_cast<unsigned char>(c)) != 0;
+            })) {
+            extensions.emplace(std::move(ext));
+        }
+    }
+    auto shape = std::filesystem::path{command[0]}.filename().string();
+    for (auto const& ext : extensions) {
+        shape += ' ';
+        shape += ext;
+    }
+    return shape;
+}
+
+auto ActionDurationHistory::Estimate(Action const& action) const noexcept
+    -> std::optional<double> {
+    if (action.IsTreeAction() or action.IsTreeOverlayAction()) {
+        return 0.0;
+    }
+    try {
+        std::unique_lock lock{mutex_};
+        if (auto entry = Lookup(ActionKey(action))) {
+            return entry->seconds;
+        }
+        if (auto entry = Lookup(ShapeKey(action))) {
+            return entry->seconds;
+        }
+    } catch (...) {
+        // no estimate
+    }
+    return std::nullopt;
+}
+
+void ActionDurationHistory::Record(Action const& action,
+                                   double seconds) noexcept {
+    if (action.IsTreeAction() or action.IsTreeOverlayAction() or
+        not(seconds >= 0.0)) {
+        return;
+    }
+    try {
+        auto const day = Today();
+        Update(ActionKey(action), seconds, day);
+        Update(ShapeKey(action), seconds, day);
+    } catch (...) {
+        // the measurement is dropped
+    }
+}
+
+auto ActionDurationHistory::Save() noexcept -> bool {
+    try {
+        std::unique_lock lock{mutex_};
+        if (updates_.empty()) {
+            return true;
+        }
+        // Merge the updates of this process with the current table, which
+        // might have been written by another process since it was mapped. The
+        // file lock serializes the merges, so that no process drops the
+        // entries of another one.
+        auto const file_lock = PersistentFile::LockForUpdate(history_file_);
+        if (not file_lock) {
+            return false;
+        }
+        Unmap();
+        Map();
+        std::vector<Entry> entries{};
+        entries.reserve(mapped_count_ + updates_.size());
+        for (std::size_t i = 0; i < mapped_count_; ++i) {
+            auto entry = MappedEntry(i);
+            if (not updates_.contains(entry.key)) {
+                entries.push_back(entry);
+            }
+        }
+        for (auto const& [key, entry] : updates_) {
+            entries.push_back(entry);
+        }
+        if (entries.size() > kMaxEntries) {
+            std::nth_element(entries.begin(),
+                             entries.begin() + kMaxEntries,
+                             entries.end(),
+                             [](Entry const& lhs, Entry const& rhs) {
+                                 return lhs.day > rhs.day;
+                             });
+            entries.resize(kMaxEntries);
+        }
+        std::sort(entries.begin(),
+                  entries.end(),
+                  [](Entry const& lhs, Entry const& rhs) {
+                      return lhs.key < rhs.key;
+                  });
+
+        Header header{};
+        std::copy(kMagic.begin(), kMagic.end(), header.magic.begin());
+        header.byte_order = kByteOrderMark;
+        header.count = entries.size();
+        std::string content(sizeof(Header) + entries.size() * sizeof(Entry),
+                            '\0');
+        std::memcpy(content.data(), &header, sizeof(Header));
+        if (not entries.empty()) {
+            std::memcpy(content.data() + sizeof(Header),
+                        entries.data(),
+                        entries.size() * sizeof(Entry));
+        }
+        if (not PersistentFile::Replace(history_file_, content)) {
+            return false;
+        }
+        updates_.clear();
+        Unmap();
+        Map();
+        return true;
+    } catch (std::exception const& ex) {
+        Logger::Log(LogLevel::Debug,
+                    "Writing action duration history failed with:\n{}",
+                    ex.what());
+        return false;
+    }
+}
+
+void ActionDurationHistory::Map() noexcept {
+    auto const fd = ::open(history_file_.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return;
+    }
+    auto const closer = gsl::finally([fd] { ::close(fd); });
+    struct stat st{};
+    if (::fstat(fd, &st) != 0 or
+        static_cast<std::size_t>(st.st_size) < sizeof(Header)) {
+        return;
+    }
+    auto const size = static_cast<std::size_t>(st.st_size);
+    void* map = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (map == MAP_FAILED) {  // NOLINT(cppcoreguidelines-pro-type-cstyle-cast)
+        return;
+    }
+    Header header{};
+    std::memcpy(&header, map, sizeof(Header));
+    if (not std::equal(kMagic.begin(), kMagic.end(), header.magic.begin()) or
+        header.byte_order != kByteOrderMark or
+        header.count != (size - sizeof(Header)) / sizeof(Entry) or
+        (size - sizeof(Header)) % sizeof(Entry) != 0) {
+        Logger::Log(LogLevel::Debug,
+                    "Ignoring action duration history {} of unknown format",
+                    history_file_.string());
+        ::munmap(map, size);
+        return;
+    }
+    map_ = map;
+    map_size_ = size;
+    mapped_count_ = header.count;
+}
+
+void ActionDurationHistory::Unmap() noexcept {
+    if (map_ != nullptr) {
+        ::munmap(const_cast<void*>(map_), map_size_);
+    }
+    map_ = nullptr;
+    map_size_ = 0;
+    mapped_count_ = 0;
+}
+
+auto ActionDurationHistory::MappedEntry(std::size_t index) const noexcept
+    -> Entry {
+    Entry entry{};
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+    std::memcpy(&entry,
+                static_cast<char const*>(map_) + sizeof(Header) +
+                    index * sizeof(Entry),
+                sizeof(Entry));
+    return entry;
+}
+
+auto ActionDurationHistory::Lookup(std::uint64_t key) const noexcept
+    -> std::optional<Entry> {
+    if (auto it = updates_.find(key); it != updates_.end()) {
+        return it->second;
+    }
+    // binary search in the sorted table
+    std::size_t low = 0;
+    std::size_t high = mapped_count_;
+    while (low < high) {
+        auto const mid = low + (high - low) / 2;
+        auto const entry = MappedEntry(mid);
+        if (entry.key == key) {
+            return entry;
+        }
+        if (entry.key < key) {
+            low = mid + 1;
+        }
+        else {
+            high = mid;
+        }
+    }
+    return std::nullopt;
+}
+
+void ActionDurationHistory::Update(std::uint64_t key,
+                                   double seconds,
+                                   std::uint32_t day) {
+    std::unique_lock lock{mutex_};
+    auto const previous = Lookup(key);
+    auto smoothed = seconds;
+    if (previous) {
+        double const old = previous->seconds;
+        smoothed = old + kSmoothing * (seconds - old);
+    }
+    updates_.insert_or_assign(
+        key,
+        Entry{.key = key, .seconds = static_cast<float>(smoothed), .day = day});
+}
@@ -0,0 +1,102 @@
+// Copyright 2026 Huawei Cloud Computing Technology Co., Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef INCLUDED_SRC_BUILDTOOL_STORAGE_ACTION_DURATION_HISTORY_HPP
+#define INCLUDED_SRC_BUILDTOOL_STORAGE_ACTION_DURATION_HISTORY_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "gsl/gsl"
+#include "src/buildtool/common/action.hpp"
+#include "src/buildtool/storage/config.hpp"
+
+/// \brief Persistent history of the execution durations of actions.
+/// Durations are recorded per action identifier and per command shape, i.e.,
+/// the program run together with the kinds of files passed to it, so that
+/// actions never run before can be estimated from similar ones. Recorded
+/// durations are smoothed over the runs of an action.
+/// The history is stored as a sorted table of fixed-size entries that is
+/// memory mapped on construction, so loading is cheap even for large builds.
+/// Durations recorded by the current process are kept in memory and merged
+/// into the current table, as possibly written by other processes in the
+/// meantime, when it is written back by Save. Like the file digest
+/// cache, the history lives outside of the storage generations; it only
+/// serves as an estimate and is never needed for correctness.
+class ActionDurationHistory final {
+  public:
+    /// \brief Duration, in seconds, to assume for actions without estimate.
+    static constexpr double kDefaultEstimate = 1.0;
+
+    explicit ActionDurationHistory(
+        gsl::not_null<StorageConfig const*> const& storage_config) noexcept;
+
+    ActionDurationHistory(ActionDurationHistory const&) = delete;
+    ActionDurationHistory(ActionDurationHistory&&) = delete;
+    auto operator=(ActionDurationHistory const&)
+        -> ActionDurationHistory& = delete;
+    auto operator=(ActionDurationHistory&&) -> ActionDurationHistory& = delete;
+    ~ActionDurationHistory() noexcept;
+
+    /// \brief Shape of a command: the name of the program followed by the
+    /// sorted extensions of the file names among its arguments.
+    [[nodiscard]] static auto CommandShape(
+        std::vector<std::string> const& command) -> std::string;
+
+    /// \brief Estimate the execution duration of an action, in seconds.
+    /// Tree actions are not executed and estimated as zero.
+    /// \returns The duration recorded for the action, or else for its command
+    /// shape, or nullopt if neither is known.
+    [[nodiscard]] auto Estimate(Action const& action) const noexcept
+        -> std::optional<double>;
+
+    /// \brief Record the measured execution duration of an action, in seconds.
+    void Record(Action const& action, double seconds) noexcept;
+
+    /// \brief Write the history back to disk, if it was modified.
+    /// \returns true on success.
+    [[nodiscard]] auto Save() noexcept -> bool;
+
+  private:
+    // Layout of the entries of the table on disk, sorted by key.
+    struct Entry {
+        std::uint64_t key;
+        float seconds;
+        std::uint32_t day;  // day of the last update, to prune stale entries
+    };
+    static_assert(sizeof(Entry) == 16);
+
+    std::filesystem::path history_file_;
+    void const* map_{nullptr};
+    std::size_t map_size_{};
+    std::size_t mapped_count_{};
+    mutable std::mutex mutex_;
+    std::unordered_map<std::uint64_t, Entry> updates_;
+
+    void Map() noexcept;
+    void Unmap() noexcept;
+    [[nodiscard]] auto MappedEntry(std::size_t index) const noexcept -> Entry;
+    // Caller must hold mutex_.
+    [[nodiscard]] auto Lookup(std::uint64_t key) const noexcept
+        -> std::optional<Entry>;
+    void Update(std::uint64_t key, double seconds, std::uint32_t day);
+};
+
+#endif  // INCLUDED_SRC_BUILDTOOL_STORAGE_ACTION_DURATION_HISTORY_HPP
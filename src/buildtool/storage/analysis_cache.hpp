@@ -0,0 +1,111 @@
+// Copyright 2026 Huawei Cloud Computing Technology Co., Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef INCLUDED_SRC_BUILDTOOL_STORAGE_ANALYSIS_CACHE_HPP
+#define INCLUDED_SRC_BUILDTOOL_STORAGE_ANALYSIS_CACHE_HPP
+
+#include <memory>
+#include <optional>
+#include <string>
+
+#include "gsl/gsl"
+#include "nlohmann/json.hpp"
+#include "src/buildtool/crypto/hash_function.hpp"
+#include "src/buildtool/file_system/file_storage.hpp"
+#include "src/buildtool/file_system/object_type.hpp"
+#include "src/buildtool/logging/logger.hpp"
+#include "src/buildtool/storage/config.hpp"
+#include "src/buildtool/storage/uplinker.hpp"
+
+/// \brief The high-level cache for storing analysis results of targets.
+/// Entries are JSON values stored under the hash of a key description, which
+/// has to capture everything the value depends on. In contrast to the target
+/// cache, entries do not reference any CAS objects. Supports global uplinking
+/// across all generations. The uplink is automatically performed for every
+/// entry that is read and already exists in an older generation.
+/// \tparam kDoGlobalUplink     Enable global uplinking.
+template <bool kDoGlobalUplink>
+class AnalysisCache {
+  public:
+    /// Local analysis cache generation used by GC without global uplink.
+    using LocalGenerationANC = AnalysisCache</*kDoGlobalUplink=*/false>;
+
+    explicit AnalysisCache(
+        GenerationConfig const& config,
+        gsl::not_null<Uplinker<kDoGlobalUplink> const*> const& uplinker)
+        : hash_function_{config.storage_config->hash_function},
+          file_store_{config.analysis_cache},
+          uplinker_{*uplinker} {}
+
+    AnalysisCache(AnalysisCache const&) = default;
+    AnalysisCache(AnalysisCache&&) noexcept = default;
+    auto operator=(AnalysisCache const&) -> AnalysisCache& = delete;
+    auto operator=(AnalysisCache&&) noexcept -> AnalysisCache& = delete;
+    ~AnalysisCache() noexcept = default;
+
+    /// \brief Compute the key for a key description.
+    /// \returns The hex-encoded hash of the description or nullopt on error.
+    [[nodiscard]] auto ComputeKey(nlohmann::json const& key_desc) const noexcept
+        -> std::optional<std::string>;
+
+    /// \brief Store new key-value pair in the analysis cache.
+    /// \returns true on success.
+    [[nodiscard]] auto Store(std::string const& key,
+                             nlohmann::json const& value) const noexcept
+        -> bool;
+
+    /// \brief Read existing value from the analysis cache.
+    /// \returns The value on success or nullopt if not found or invalid.
+    [[nodiscard]] auto Read(std::string const& key) const noexcept
+        -> std::optional<nlohmann::json>;
+
+    /// \brief Uplink entry from this to latest analysis cache generation.
+    /// This function is only available for instances that are used as local GC
+    /// generations (i.e., disabled global uplink).
+    /// \tparam kIsLocalGeneration  True if this instance is a local generation.
+    /// \param latest   The latest analysis cache generation.
+    /// \param key      The key of the entry to uplink.
+    /// \returns True if entry was successfully uplinked.
+    template <bool kIsLocalGeneration = not kDoGlobalUplink>
+        requires(kIsLocalGeneration)
+    [[nodiscard]] auto LocalUplinkEntry(
+        LocalGenerationANC const& latest,
+        std::string const& key) const noexcept -> bool;
+
+  private:
+    // By default, overwrite existing entries. Unless this is a generation
+    // (disabled global uplink), then we never want to overwrite any entries.
+    static constexpr auto kStoreMode =
+        kDoGlobalUplink ? StoreMode::LastWins : StoreMode::FirstWins;
+
+    std::shared_ptr<Logger> logger_{std::make_shared<Logger>("AnalysisCache")};
+    HashFunction hash_function_;
+    FileStorage<ObjectType::File,
+                kStoreMode,
+                /*kSetEpochTime=*/false>
+        file_store_;
+    Uplinker<kDoGlobalUplink> const& uplinker_;
+};
+
+#ifdef BOOTSTRAP_BUILD_TOOL
+using ActiveAnalysisCache = AnalysisCache<false>;
+#else
+// AnalysisCache type aware of bootstrapping
+using ActiveAnalysisCache = AnalysisCache<true>;
+#endif  // BOOTSTRAP_BUILD_TOOL
+
+// NOLINTNEXTLINE(misc-header-include-cycle)
+#include "src/buildtool/storage/analysis_cache.tpp"  // IWYU pragma: export
+
+#endif  // INCLUDED_SRC_BUILDTOOL_STORAGE_ANALYSIS_CACHE_HPP
@@ -0,0 +1,101 @@
+// Copyright 2026 Huawei Cloud Computing Technology Co., Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef INCLUDED_SRC_BUILDTOOL_STORAGE_ANALYSIS_CACHE_TPP
+#define INCLUDED_SRC_BUILDTOOL_STORAGE_ANALYSIS_CACHE_TPP
+
+// IWYU pragma: private, include "src/buildtool/storage/analysis_cache.hpp"
+
+#include <exception>
+#include <tuple>  //std::ignore
+
+#include "src/buildtool/file_system/file_system_manager.hpp"
+#include "src/buildtool/logging/log_level.hpp"
+#include "src/buildtool/storage/analysis_cache.hpp"
+
+template <bool kDoGlobalUplink>
+auto AnalysisCache<kDoGlobalUplink>::ComputeKey(
+    nlohmann::json const& key_desc) const noexcept
+    -> std::optional<std::string> {
+    try {
+        return hash_function_.PlainHashData(key_desc.dump()).HexString();
+    } catch (std::exception const& ex) {
+        logger_->Emit(LogLevel::Error,
+                      "Creating analysis cache key failed with:\n{}",
+                      ex.what());
+    }
+    return std::nullopt;
+}
+
+template <bool kDoGlobalUplink>
+auto AnalysisCache<kDoGlobalUplink>::Store(
+    std::string const& key,
+    nlohmann::json const& value) const noexcept -> bool {
+    try {
+        logger_->Emit(LogLevel::Debug, "Adding entry for key {}", key);
+        return file_store_.AddFromBytes(key, value.dump());
+    } catch (std::exception const& ex) {
+        logger_->Emit(LogLevel::Warning,
+                      "Storing entry for key {} failed with:\n{}",
+                      key,
+                      ex.what());
+    }
+    return false;
+}
+
+template <bool kDoGlobalUplink>
+auto AnalysisCache<kDoGlobalUplink>::Read(
+    std::string const& key) const noexcept -> std::optional<nlohmann::json> {
+    if constexpr (kDoGlobalUplink) {
+        // Uplink any existing analysis cache entry in storage generations
+        std::ignore = uplinker_.UplinkAnalysisCacheEntry(key);
+    }
+
+    auto const entry_path = file_store_.GetPath(key);
+    auto const entry = FileSystemManager::ReadFile(entry_path, ObjectType::File);
+    if (not entry) {
+        logger_->Emit(LogLevel::Debug,
+                      "Cache miss, entry not found {}",
+                      entry_path.string());
+        return std::nullopt;
+    }
+    try {
+        return nlohmann::json::parse(*entry);
+    } catch (std::exception const& ex) {
+        logger_->Emit(LogLevel::Warning,
+                      "Parsing entry for key {} failed with:\n{}",
+                      key,
+                      ex.what());
+    }
+    return std::nullopt;
+}
+
+template <bool kDoGlobalUplink>
+template <bool kIsLocalGeneration>
+    requires(kIsLocalGeneration)
+auto AnalysisCache<kDoGlobalUplink>::LocalUplinkEntry(
+    LocalGenerationANC const& latest,
+    std::string const& key) const noexcept -> bool {
+    if (FileSystemManager::IsFile(latest.file_store_.GetPath(key))) {
+        return true;
+    }
+    auto const entry_path = file_store_.GetPath(key);
+    if (not FileSystemManager::IsFile(entry_path)) {
+        return false;
+    }
+    // Entries are self-contained, so only the entry itself is uplinked.
+    return latest.file_store_.AddFromFile(key, entry_path, /*is_owner=*/true);
+}
+
+#endif  // INCLUDED_SRC_BUILDTOOL_STORAGE_ANALYSIS_CACHE_TPP
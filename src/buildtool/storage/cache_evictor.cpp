@@ -0,0 +1,484 @@
+// Copyright 2026 Huawei Cloud Computing Technology Co., Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef BOOTSTRAP_BUILD_TOOL
+
+#include "src/buildtool/storage/cache_evictor.hpp"
+
+#include <sys/stat.h>
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <exception>
+#include <iterator>
+#include <numeric>
+#include <optional>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include "nlohmann/json.hpp"
+#include "src/buildtool/common/artifact.hpp"
+#include "src/buildtool/common/artifact_digest.hpp"
+#include "src/buildtool/common/artifact_digest_factory.hpp"
+#include "src/buildtool/common/bazel_types.hpp"
+#include "src/buildtool/common/protocol_traits.hpp"
+#include "src/buildtool/crypto/hash_function.hpp"
+#include "src/buildtool/file_system/file_system_manager.hpp"
+#include "src/buildtool/file_system/git_repo.hpp"
+#include "src/buildtool/file_system/object_type.hpp"
+#include "src/buildtool/logging/log_level.hpp"
+#include "src/buildtool/logging/logger.hpp"
+#include "src/buildtool/storage/target_cache_entry.hpp"
+#include "src/utils/cpp/hex_string.hpp"
+
+namespace {
+
+[[nodiscard]] auto ToNanoseconds(struct timespec const& ts) noexcept
+    -> std::int64_t {
+    return static_cast<std::int64_t>(ts.tv_sec) * 1'000'000'000 +
+           static_cast<std::int64_t>(ts.tv_nsec);
+}
+
+[[nodiscard]] auto CreateVictim(std::filesystem::path const& path) noexcept
+    -> std::optional<CacheEvictor::Victim> {
+    struct stat st{};
+    if (::lstat(path.c_str(), &st) != 0 or not S_ISREG(st.st_mode)) {
+        return std::nullopt;
+    }
+    return CacheEvictor::Victim{
+        .path = path,
+        .device = static_cast<std::uint64_t>(st.st_dev),
+        .inode = static_cast<std::uint64_t>(st.st_ino),
+        .ctime_ns = ToNanoseconds(st.st_ctim)};
+}
+
+/// \brief Kinds of files in a storage generation, determining the references
+/// they hold.
+enum class FileKind : std::uint8_t {
+    kActionCache,
+    kTargetCache,
+    kAnalysisCache,
+    kTree,
+    kLargeTree,
+    kLargeBlob,
+    kBlob
+};
+
+/// \brief A file of a storage generation, with the references it holds to
+/// other files of the same generation.
+struct GenerationFile final {
+    CacheEvictor::Victim victim;
+    FileKind kind{};
+    HashFunction::Type hash_type{};
+    std::vector<std::string> references;
+};
+
+/// \brief Collect all files below a storage directory.
+void CollectFiles(std::filesystem::path const& dir,
+                  FileKind kind,
+                  HashFunction::Type hash_type,
+                  std::vector<GenerationFile>* files) {
+    if (not FileSystemManager::IsDirectory(dir)) {
+        return;
+    }
+    for (auto const& entry :
+         std::filesystem::recursive_directory_iterator(dir)) {
+        if (auto victim = CreateVictim(entry.path())) {
+            files->emplace_back(GenerationFile{.victim = *std::move(victim),
+                                               .kind = kind,
+                                               .hash_type = hash_type,
+                                               .references = {}});
+        }
+    }
+}
+
+/// \brief Reference to a CAS object or target-cache entry. Hashes of the two
+/// protocols differ in length, so their references cannot clash.
+[[nodiscard]] auto CasReference(std::string const& hash) -> std::string {
+    return "c" + hash;
+}
+
+[[nodiscard]] auto TargetCacheReference(std::string const& hash)
+    -> std::string {
+    return "t" + hash;
+}
+
+/// \brief Object identifier of a file in a sharded object storage.
+[[nodiscard]] auto ObjectId(std::filesystem::path const& path) -> std::string {
+    return path.parent_path().filename().string() + path.filename().string();
+}
+
+/// \brief References to the direct parts of a Git tree.
+[[nodiscard]] auto ReadTreeReferences(std::string const& content,
+                                      std::string const& id)
+    -> std::vector<std::string> {
+    // Symlinks are irrelevant for the references between objects.
+    auto const skip_symlinks_check =
+        [](std::vector<ArtifactDigest> const& /*unused*/) { return true; };
+    auto const entries = GitRepo::ReadTreeData(
+        content, id, skip_symlinks_check, /*is_hex_id=*/true);
+    std::vector<std::string> references{};
+    if (entries) {
+        references.reserve(entries->size());
+        for (auto const& [raw_id, unused] : *entries) {
+            references.emplace_back(CasReference(ToHexString(raw_id)));
+        }
+    }
+    return references;
+}
+
+/// \brief Reads the content of the CAS objects of a generation.
+class ObjectReader final {
+  public:
+    explicit ObjectReader(std::vector<GenerationFile> const& files) {
+        for (auto const& file : files) {
+            if (file.kind == FileKind::kBlob) {
+                blobs_.emplace(ObjectId(file.victim.path), file.victim.path);
+            }
+        }
+    }
+
+    [[nodiscard]] auto ReadBlob(std::string const& hash) const
+        -> std::optional<std::string> {
+        auto const it = blobs_.find(hash);
+        if (it == blobs_.end()) {
+            return std::nullopt;
+        }
+        return FileSystemManager::ReadFile(it->second);
+    }
+
+  private:
+    std::unordered_map<std::string, std::filesystem::path> blobs_;
+};
+
+[[nodiscard]] auto ReadActionCacheReferences(GenerationFile const& file,
+                                             ObjectReader const& reader)
+    -> std::vector<std::string> {
+    auto const key = FileSystemManager::ReadFile(file.victim.path);
+    if (not key) {
+        return {};
+    }
+    auto const result_hash =
+        nlohmann::json::parse(*key).at(0).get<std::string>();
+    std::vector<std::string> references{CasReference(result_hash)};
+    bazel_re::ActionResult result{};
+    auto const content = reader.ReadBlob(result_hash);
+    if (not content or not result.ParseFromString(*content)) {
+        return references;
+    }
+    HashFunction const hash_function{file.hash_type};
+    for (auto const& output : result.output_files()) {
+        references.emplace_back(CasReference(output.digest().hash()));
+    }
+    for (auto const& output : result.output_directories()) {
+        references.emplace_back(CasReference(output.tree_digest().hash()));
+    }
+    for (auto const* links : {&result.output_file_symlinks(),
+                              &result.output_directory_symlinks()}) {
+        for (auto const& link : *links) {
+            references.emplace_back(CasReference(
+                ArtifactDigestFactory::HashDataAs<ObjectType::File>(
+                    hash_function, link.target())
+                    .hash()));
+        }
+    }
+    return references;
+}
+
+[[nodiscard]] auto ReadTargetCacheReferences(GenerationFile const& file,
+                                             ObjectReader const& reader)
+    -> std::vector<std::string> {
+    auto const key = FileSystemManager::ReadFile(file.victim.path);
+    auto const info = key ? Artifact::ObjectInfo::FromString(file.hash_type,
+                                                             *key)
+                          : std::nullopt;
+    if (not info) {
+        return {};
+    }
+    std::vector<std::string> references{CasReference(info->digest.hash())};
+    auto const content = reader.ReadBlob(info->digest.hash());
+    if (not content) {
+        return references;
+    }
+    auto const entry = TargetCacheEntry::FromJson(
+        file.hash_type, nlohmann::json::parse(*content));
+    std::vector<Artifact::ObjectInfo> artifacts{};
+    if (entry.ToArtifacts(&artifacts)) {
+        for (auto const& artifact : artifacts) {
+            references.emplace_back(CasReference(artifact.digest.hash()));
+        }
+    }
+    if (auto const implied = entry.ToImpliedIds(ObjectId(file.victim.path))) {
+        for (auto const& id : *implied) {
+            references.emplace_back(TargetCacheReference(id.digest.hash()));
+        }
+    }
+    return references;
+}
+
+/// \brief References of a large-object entry to its parts. A large tree also
+/// references the parts of the tree assembled from them.
+[[nodiscard]] auto ReadLargeObjectReferences(GenerationFile const& file,
+                                             ObjectReader const& reader)
+    -> std::vector<std::string> {
+    auto const entry = FileSystemManager::ReadFile(file.victim.path);
+    if (not entry) {
+        return {};
+    }
+    std::vector<std::string> references{};
+    std::optional<std::string> assembled{std::string{}};
+    for (auto const& part : nlohmann::json::parse(*entry)) {
+        auto const hash = part.at(0).get<std::string>();
+        references.emplace_back(CasReference(hash));
+        if (file.kind == FileKind::kLargeTree and assembled) {
+            auto const content = reader.ReadBlob(hash);
+            assembled = content ? std::make_optional(*assembled + *content)
+                                : std::nullopt;
+        }
+    }
+    if (file.kind == FileKind::kLargeTree and assembled) {
+        auto tree_references =
+            ReadTreeReferences(*assembled, ObjectId(file.victim.path));
+        references.insert(references.end(),
+                          std::make_move_iterator(tree_references.begin()),
+                          std::make_move_iterator(tree_references.end()));
+    }
+    return references;
+}
+
+/// \brief Determine the references of a file. Files that cannot be parsed
+/// are assumed to hold no references, as they cannot be used anyway.
+[[nodiscard]] auto ReadReferences(GenerationFile const& file,
+                                  ObjectReader const& reader) noexcept
+    -> std::vector<std::string> {
+    try {
+        switch (file.kind) {
+            case FileKind::kActionCache:
+                return ReadActionCacheReferences(file, reader);
+            case FileKind::kTargetCache:
+                return ReadTargetCacheReferences(file, reader);
+            case FileKind::kTree: {
+                auto const content =
+                    FileSystemManager::ReadFile(file.victim.path);
+                return content ? ReadTreeReferences(*content,
+                                                    ObjectId(file.victim.path))
+                               : std::vector<std::string>{};
+            }
+            case FileKind::kLargeTree:
+            case FileKind::kLargeBlob:
+                return ReadLargeObjectReferences(file, reader);
+            case FileKind::kAnalysisCache:
+            case FileKind::kBlob:
+                break;
+        }
+    } catch (std::exception const& ex) {
+        Logger::Log(LogLevel::Debug,
+                    "Reading references of {} failed with:\n{}",
+                    file.victim.path.string(),
+                    ex.what());
+    }
+    return {};
+}
+
+/// \brief Order the files of a generation from least to most recently used,
+/// such that the generation fulfills the invariants after evicting any prefix.
+/// A file is considered used as recently as the most recently used file of
+/// the generation referencing it, so it follows all of them.
+[[nodiscard]] auto OrderFiles(std::vector<GenerationFile> const& files)
+    -> std::vector<CacheEvictor::Victim> {
+    std::unordered_map<std::string, std::vector<std::size_t>> referenced{};
+    for (std::size_t i = 0; i < files.size(); ++i) {
+        auto const& file = files[i];
+        auto const id = ObjectId(file.victim.path);
+        switch (file.kind) {
+            case FileKind::kTargetCache:
+                referenced[TargetCacheReference(id)].emplace_back(i);
+                break;
+            case FileKind::kTree:
+            case FileKind::kLargeTree:
+            case FileKind::kLargeBlob:
+            case FileKind::kBlob:
+                referenced[CasReference(id)].emplace_back(i);
+                break;
+            case FileKind::kActionCache:
+            case FileKind::kAnalysisCache:
+                break;
+        }
+    }
+
+    std::vector<std::vector<std::size_t>> children(files.size());
+    std::vector<std::size_t> referrers(files.size(), 0);
+    for (std::size_t i = 0; i < files.size(); ++i) {
+        std::unordered_set<std::size_t> targets{};
+        for (auto const& reference : files[i].references) {
+            if (auto it = referenced.find(reference); it != referenced.end()) {
+                targets.insert(it->second.begin(), it->second.end());
+            }
+        }
+        targets.erase(i);
+        for (auto const target : targets) {
+            children[i].emplace_back(target);
+            ++referrers[target];
+        }
+    }
+
+    // Propagate the time of last use from the referrers to the referenced
+    // files, in topological order. The depth orders files of equal time.
+    std::vector<std::int64_t> last_use(files.size());
+    std::vector<std::size_t> depth(files.size(), 0);
+    std::vector<std::size_t> ready{};
+    for (std::size_t i = 0; i < files.size(); ++i) {
+        last_use[i] = files[i].victim.ctime_ns;
+        if (referrers[i] == 0) {
+            ready.emplace_back(i);
+        }
+    }
+    while (not ready.empty()) {
+        auto const i = ready.back();
+        ready.pop_back();
+        for (auto const child : children[i]) {
+            last_use[child] = std::max(last_use[child], last_use[i]);
+            depth[child] = std::max(depth[child], depth[i] + 1);
+            if (--referrers[child] == 0) {
+                ready.emplace_back(child);
+            }
+        }
+    }
+
+    std::vector<std::size_t> order(files.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(),
+              order.end(),
+              [&last_use, &depth](std::size_t lhs, std::size_t rhs) {
+                  return std::pair{last_use[lhs], depth[lhs]} <
+                         std::pair{last_use[rhs], depth[rhs]};
+              });
+    std::vector<CacheEvictor::Victim> result{};
+    result.reserve(order.size());
+    std::transform(order.begin(),
+                   order.end(),
+                   std::back_inserter(result),
+                   [&files](std::size_t i) { return files[i].victim; });
+    return result;
+}
+
+}  // namespace
+
+auto CacheEvictor::CacheSize(StorageConfig const& storage_config) noexcept
+    -> std::optional<std::uintmax_t> {
+    try {
+        std::uintmax_t size = 0;
+        std::set<std::pair<dev_t, ino_t>> linked{};
+        for (std::size_t i = 0; i < storage_config.num_generations; ++i) {
+            auto const root = storage_config.GenerationCacheRoot(i);
+            if (not FileSystemManager::IsDirectory(root)) {
+                continue;
+            }
+            for (auto const& entry :
+                 std::filesystem::recursive_directory_iterator(root)) {
+                struct stat st{};
+                if (::lstat(entry.path().c_str(), &st) != 0 or
+                    not S_ISREG(st.st_mode)) {
+                    continue;
+                }
+                if (st.st_nlink > 1 and
+                    not linked.emplace(st.st_dev, st.st_ino).second) {
+                    continue;
+                }
+                size += static_cast<std::uintmax_t>(st.st_size);
+            }
+        }
+        return size;
+    } catch (std::exception const& ex) {
+        Logger::Log(LogLevel::Error,
+                    "Determining the cache size failed with:\n{}",
+                    ex.what());
+        return std::nullopt;
+    }
+}
+
+auto CacheEvictor::Plan(StorageConfig const& storage_config,
+                        std::size_t generation) noexcept
+    -> std::optional<std::vector<Victim>> {
+    // Both native and compatible storages are part of a generation.
+    static constexpr std::array kHashes = {HashFunction::Type::GitSHA1,
+                                           HashFunction::Type::PlainSHA256};
+    try {
+        std::vector<GenerationFile> files{};
+        for (auto const hash_type : kHashes) {
+            auto const config = StorageConfig::Builder::Rebuild(storage_config)
+                                    .SetHashType(hash_type)
+                                    .Build();
+            if (not config) {
+                return std::nullopt;
+            }
+            auto const gen = config->CreateGenerationConfig(generation);
+            CollectFiles(
+                gen.action_cache, FileKind::kActionCache, hash_type, &files);
+            CollectFiles(
+                gen.target_cache, FileKind::kTargetCache, hash_type, &files);
+            CollectFiles(gen.analysis_cache,
+                         FileKind::kAnalysisCache,
+                         hash_type,
+                         &files);
+            CollectFiles(
+                gen.cas_large_f, FileKind::kLargeBlob, hash_type, &files);
+            CollectFiles(gen.cas_f, FileKind::kBlob, hash_type, &files);
+            CollectFiles(gen.cas_x, FileKind::kBlob, hash_type, &files);
+            // In compatible mode, trees are stored as blobs and their
+            // references are not checked.
+            if (ProtocolTraits::IsNative(hash_type)) {
+                CollectFiles(gen.cas_t, FileKind::kTree, hash_type, &files);
+                CollectFiles(
+                    gen.cas_large_t, FileKind::kLargeTree, hash_type, &files);
+            }
+        }
+        ObjectReader const reader{files};
+        for (auto& file : files) {
+            file.references = ReadReferences(file, reader);
+        }
+        return OrderFiles(files);
+    } catch (std::exception const& ex) {
+        Logger::Log(LogLevel::Error,
+                    "Planning eviction from generation {} failed with:\n{}",
+                    generation,
+                    ex.what());
+        return std::nullopt;
+    }
+}
+
+auto CacheEvictor::Evict(Victim const& victim) noexcept
+    -> std::optional<std::uintmax_t> {
+    struct stat st{};
+    if (::lstat(victim.path.c_str(), &st) != 0 or
+        static_cast<std::uint64_t>(st.st_dev) != victim.device or
+        static_cast<std::uint64_t>(st.st_ino) != victim.inode or
+        ToNanoseconds(st.st_ctim) != victim.ctime_ns) {
+        return std::nullopt;
+    }
+    if (not FileSystemManager::RemoveFile(victim.path)) {
+        Logger::Log(LogLevel::Warning,
+                    "Failed to evict {} from cache",
+                    victim.path.string());
+        return std::nullopt;
+    }
+    return st.st_nlink == 1 ? static_cast<std::uintmax_t>(st.st_size) : 0;
+}
+
+#endif  // BOOTSTRAP_BUILD_TOOL
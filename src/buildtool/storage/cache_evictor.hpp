@@ -0,0 +1,70 @@
+// Copyright 2026 Huawei Cloud Computing Technology Co., Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef INCLUDED_SRC_BUILDTOOL_STORAGE_CACHE_EVICTOR_HPP
+#define INCLUDED_SRC_BUILDTOOL_STORAGE_CACHE_EVICTOR_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <vector>
+
+#include "src/buildtool/storage/config.hpp"
+
+/// \brief Eviction of single entries from an older storage generation, to
+/// reduce the size of the cache to a given budget without rotating entire
+/// generations.
+class CacheEvictor final {
+  public:
+    /// \brief A file planned for eviction. The file is identified by its inode
+    /// and change time at the time of planning, and skipped if it changed
+    /// since, e.g., because it was uplinked in the meantime.
+    struct Victim final {
+        std::filesystem::path path;
+        std::uint64_t device{};
+        std::uint64_t inode{};
+        std::int64_t ctime_ns{};
+    };
+
+    /// \brief Total size of all storage generations of both protocols. Files
+    /// hard-linked between generations are counted once.
+    /// \param storage_config   Storage to inspect.
+    /// \return Size in bytes or nullopt on failure.
+    [[nodiscard]] static auto CacheSize(
+        StorageConfig const& storage_config) noexcept
+        -> std::optional<std::uintmax_t>;
+
+    /// \brief Plan the eviction of all entries of a storage generation of both
+    /// protocols, from least to most recently used. An entry is used when
+    /// added or uplinked, which sets its change time, as uplinking creates a
+    /// hard link. Entries referenced by other entries of the generation count
+    /// as used as recently as all of them, and are ordered after them; hence
+    /// the generation fulfills the invariants after evicting any prefix of the
+    /// plan.
+    /// \param storage_config   Storage to inspect.
+    /// \param generation       The generation to plan the eviction for.
+    /// \return The ordered list of files or nullopt on failure.
+    [[nodiscard]] static auto Plan(StorageConfig const& storage_config,
+                                   std::size_t generation) noexcept
+        -> std::optional<std::vector<Victim>>;
+
+    /// \brief Remove a planned file, unless it changed since planning.
+    /// \return Number of bytes freed on disk, where files still hard-linked to
+    /// another generation do not free any, or nullopt if the file was skipped.
+    [[nodiscard]] static auto Evict(Victim const& victim) noexcept
+        -> std::optional<std::uintmax_t>;
+};
+
+#endif  // INCLUDED_SRC_BUILDTOOL_STORAGE_CACHE_EVICTOR_HPP
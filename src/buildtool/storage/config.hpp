@@ -42,6 +42,7 @@ struct GenerationConfig final {
     std::filesystem::path const cas_large_t;
     std::filesystem::path const action_cache;
     std::filesystem::path const target_cache;
+    std::filesystem::path const analysis_cache;
 };
 
 struct StorageConfig final {
@@ -137,7 +138,8 @@ struct StorageConfig final {
             .cas_large_f = cache_dir / "cas-large-f",
             .cas_large_t = cache_dir / (native ? "cas-large-t" : "cas-large-f"),
             .action_cache = cache_dir / "ac",
-            .target_cache = cache_dir / "tc"};
+            .target_cache = cache_dir / "tc",
+            .analysis_cache = cache_dir / "anc"};
     };
 
   private:
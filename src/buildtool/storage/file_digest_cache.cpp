@@ -0,0 +1,243 @@
+// Copyright 2026 Huawei Cloud Computing Technology Co., Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "src/buildtool/storage/file_digest_cache.hpp"
+
+#include <sys/stat.h>
+
+#include <chrono>
+#include <exception>
+#include <sstream>
+#include <utility>
+
+#include "fmt/core.h"
+#include "src/buildtool/common/artifact_digest_factory.hpp"
+#include "src/buildtool/file_system/file_system_manager.hpp"
+#include "src/buildtool/file_system/object_type.hpp"
+#include "src/buildtool/logging/log_level.hpp"
+#include "src/buildtool/logging/logger.hpp"
+#include "src/buildtool/storage/persistent_file.hpp"
+
+namespace {
+
+// Header line of the cache file; bump the version on format changes.
+constexpr auto kFormatVersion = "just-file-digests 1";
+
+// Files modified less than this long ago are considered racy and not cached,
+// as a further modification within the timestamp granularity of the file
+// system (up to two seconds on some file systems) would not be reflected in
+// the stat data. Like git, only the mtime is considered; any later change to
+// the file, including resetting its mtime, also changes the ctime.
+constexpr auto kRacyWindow = std::chrono::seconds{2};
+
+// Upper bound on the number of entries; if exceeded, only entries used by the
+// current process are kept when saving.
+constexpr std::size_t kMaxEntries = std::size_t{1} << 20U;
+
+[[nodiscard]] auto ToNanoseconds(struct timespec const& ts) noexcept
+    -> std::int64_t {
+    return static_cast<std::int64_t>(ts.tv_sec) * 1'000'000'000 +
+           static_cast<std::int64_t>(ts.tv_nsec);
+}
+
+}  // namespace
+
+FileDigestCache::FileDigestCache(
+    gsl::not_null<StorageConfig const*> const& storage_config) noexcept
+    : hash_type_{storage_config->hash_function.GetType()},
+      cache_file_{storage_config->CacheRoot() / "file-digests" /
+                  ToString(hash_type_)} {
+    Load();
+}
+
+auto FileDigestCache::Stat(std::filesystem::path const& path) noexcept
+    -> std::optional<FileStat> {
+    struct stat st{};
+    if (::lstat(path.c_str(), &st) != 0) {
+        return std::nullopt;
+    }
+    return FileStat{.device = static_cast<std::uint64_t>(st.st_dev),
+                    .inode = static_cast<std::uint64_t>(st.st_ino),
+                    .size = static_cast<std::uint64_t>(st.st_size),
+                    .mtime_ns = ToNanoseconds(st.st_mtim),
+                    .ctime_ns = ToNanoseconds(st.st_ctim),
+                    .mode = static_cast<std::uint32_t>(st.st_mode)};
+}
+
+auto FileDigestCache::Lookup(std::filesystem::path const& path,
+                             FileStat const& stat) noexcept
+    -> std::optional<Artifact::ObjectInfo> {
+    try {
+        std::unique_lock lock{mutex_};
+        auto it = entries_.find(path.string());
+        if (it == entries_.end() or it->second.stat != stat) {
+            return std::nullopt;
+        }
+        auto digest = ArtifactDigestFactory::Create(hash_type_,
+                                                    it->second.hash,
+                                                    it->second.size,
+                                                    /*is_tree=*/false);
+        if (not digest) {
+            return std::nullopt;
+        }
+        it->second.used = true;
+        return Artifact::ObjectInfo{.digest = *std::move(digest),
+                                    .type = it->second.type};
+    } catch (...) {
+        return std::nullopt;
+    }
+}
+
+void FileDigestCache::Store(std::filesystem::path const& path,
+                            FileStat const& stat,
+                            Artifact::ObjectInfo const& info) noexcept {
+    if (info.digest.GetHashType() != hash_type_) {
+        return;
+    }
+    auto const racy_since =
+        std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::system_clock::now().time_since_epoch() - kRacyWindow)
+            .count();
+    if (stat.mtime_ns >= racy_since) {
+        return;
+    }
+    try {
+        auto key = path.string();
+        if (key.find('\n') != std::string::npos) {
+            // not representable in the line-based cache file
+            return;
+        }
+        std::unique_lock lock{mutex_};
+        entries_.insert_or_assign(std::move(key),
+                                  Entry{.stat = stat,
+                                        .hash = info.digest.hash(),
+                                        .size = info.digest.size(),
+                                        .type = info.type,
+                                        .used = true,
+                                        .stored = true});
+        modified_ = true;
+    } catch (...) {
+        // the entry is dropped
+    }
+}
+
+auto FileDigestCache::Save() noexcept -> bool {
+    try {
+        std::unique_lock lock{mutex_};
+        if (not modified_) {
+            return true;
+        }
+        // Merge with the current cache file, which might have been written by
+        // another process since it was loaded. The file lock serializes the
+        // merges, so that no process drops the entries of another one.
+        auto const file_lock = PersistentFile::LockForUpdate(cache_file_);
+        if (not file_lock) {
+            return false;
+        }
+        auto entries = ReadEntries();
+        for (auto const& [path, entry] : entries_) {
+            if (entry.stored) {
+                entries.insert_or_assign(path, entry);
+            }
+            else if (entry.used) {
+                if (auto it = entries.find(path); it != entries.end()) {
+                    it->second.used = true;
+                }
+            }
+        }
+        if (entries.size() > kMaxEntries) {
+            std::erase_if(entries, [](auto const& item) {
+                return not item.second.used;
+            });
+        }
+        std::ostringstream out{};
+        out << kFormatVersion << '\n';
+        for (auto const& [path, entry] : entries) {
+            out << fmt::format("{} {} {} {} {} {} {} {} {} {}\n",
+                               entry.stat.device,
+                               entry.stat.inode,
+                               entry.stat.size,
+                               entry.stat.mtime_ns,
+                               entry.stat.ctime_ns,
+                               entry.stat.mode,
+                               ToChar(entry.type),
+                               entry.hash,
+                               entry.size,
+                               path);
+        }
+        if (not PersistentFile::Replace(cache_file_, out.str())) {
+            return false;
+        }
+        for (auto& [path, entry] : entries) {
+            entry.stored = false;
+        }
+        entries_ = std::move(entries);
+        modified_ = false;
+        return true;
+    } catch (std::exception const& ex) {
+        Logger::Log(LogLevel::Debug,
+                    "Writing file digest cache failed with:\n{}",
+                    ex.what());
+        return false;
+    }
+}
+
+void FileDigestCache::Load() noexcept {
+    try {
+        entries_ = ReadEntries();
+    } catch (std::exception const& ex) {
+        Logger::Log(LogLevel::Debug,
+                    "Reading file digest cache {} failed with:\n{}",
+                    cache_file_.string(),
+                    ex.what());
+        entries_.clear();
+    }
+}
+
+auto FileDigestCache::ReadEntries() const
+    -> std::unordered_map<std::string, Entry> {
+    std::unordered_map<std::string, Entry> entries{};
+    if (not FileSystemManager::IsFile(cache_file_)) {
+        return entries;
+    }
+    auto content = FileSystemManager::ReadFile(cache_file_);
+    if (not content) {
+        return entries;
+    }
+    std::istringstream in{*content};
+    std::string line{};
+    if (not std::getline(in, line) or line != kFormatVersion) {
+        Logger::Log(LogLevel::Debug,
+                    "Ignoring file digest cache {} of unknown format",
+                    cache_file_.string());
+        return entries;
+    }
+    while (std::getline(in, line)) {
+        std::istringstream fields{line};
+        Entry entry{};
+        char type{};
+        std::string path{};
+        if (not(fields >> entry.stat.device >> entry.stat.inode >>
+                entry.stat.size >> entry.stat.mtime_ns >> entry.stat.ctime_ns >>
+                entry.stat.mode >> type >> entry.hash >> entry.size) or
+            fields.get() != ' ' or not std::getline(fields, path) or
+            path.empty()) {
+            // skip malformed entries, e.g., from a truncated file
+            continue;
+        }
+        entry.type = FromChar(type);
+        entries.insert_or_assign(std::move(path), std::move(entry));
+    }
+    return entries;
+}
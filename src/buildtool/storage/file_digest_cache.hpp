@@ -0,0 +1,118 @@
+// Copyright 2026 Huawei Cloud Computing Technology Co., Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef INCLUDED_SRC_BUILDTOOL_STORAGE_FILE_DIGEST_CACHE_HPP
+#define INCLUDED_SRC_BUILDTOOL_STORAGE_FILE_DIGEST_CACHE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+
+#include "gsl/gsl"
+#include "src/buildtool/common/artifact.hpp"
+#include "src/buildtool/crypto/hash_function.hpp"
+#include "src/buildtool/storage/config.hpp"
+
+/// \brief Persistent cache of digests of files in the local file system.
+/// Maps absolute file paths to the object info computed for them, keyed by
+/// the file's stat data (device, inode, size, mtime, ctime, and mode). An entry
+/// is only valid as long as the stat data of the file is unchanged.
+/// To avoid caching a digest for a file that is modified within the timestamp
+/// granularity of the file system after it was read ("racily clean" entries,
+/// as in git's index), files modified too recently are never stored.
+/// The cache is loaded on construction and written back by Save, merged with
+/// the entries other processes wrote in the meantime. As it lives outside
+/// of the storage generations, consumers must verify that a cached digest is
+/// still available in the CAS before relying on it.
+class FileDigestCache final {
+  public:
+    /// \brief Stat data of a file used to detect modifications.
+    struct FileStat {
+        std::uint64_t device{};
+        std::uint64_t inode{};
+        std::uint64_t size{};
+        std::int64_t mtime_ns{};
+        std::int64_t ctime_ns{};
+        std::uint32_t mode{};
+
+        [[nodiscard]] auto operator==(FileStat const& other) const noexcept
+            -> bool = default;
+    };
+
+    explicit FileDigestCache(
+        gsl::not_null<StorageConfig const*> const& storage_config) noexcept;
+
+    FileDigestCache(FileDigestCache const&) = delete;
+    FileDigestCache(FileDigestCache&&) = delete;
+    auto operator=(FileDigestCache const&) -> FileDigestCache& = delete;
+    auto operator=(FileDigestCache&&) -> FileDigestCache& = delete;
+    ~FileDigestCache() noexcept = default;
+
+    /// \brief Obtain stat data of a file, not following symlinks.
+    [[nodiscard]] static auto Stat(std::filesystem::path const& path) noexcept
+        -> std::optional<FileStat>;
+
+    /// \brief Type of the hash function digests in this cache are created by.
+    [[nodiscard]] auto GetHashType() const noexcept -> HashFunction::Type {
+        return hash_type_;
+    }
+
+    /// \brief Look up cached object info for file with given stat data.
+    /// \returns The cached object info or nullopt if there is no entry or the
+    /// stat data does not match.
+    [[nodiscard]] auto Lookup(std::filesystem::path const& path,
+                              FileStat const& stat) noexcept
+        -> std::optional<Artifact::ObjectInfo>;
+
+    /// \brief Store object info for a file. The stat data must have been
+    /// obtained before the file was read; entries for racily modified files are
+    /// silently dropped.
+    void Store(std::filesystem::path const& path,
+               FileStat const& stat,
+               Artifact::ObjectInfo const& info) noexcept;
+
+    /// \brief Write the cache back to disk, if it was modified. Entries stored
+    /// by this process are merged into the cache file as currently on disk.
+    /// \returns true on success.
+    [[nodiscard]] auto Save() noexcept -> bool;
+
+  private:
+    struct Entry {
+        FileStat stat;
+        std::string hash;
+        std::size_t size{};
+        ObjectType type{};
+        bool used{};    // looked up or stored by this process
+        bool stored{};  // stored by this process and not yet saved
+    };
+
+    HashFunction::Type hash_type_;
+    std::filesystem::path cache_file_;
+    std::mutex mutex_;
+    std::unordered_map<std::string, Entry> entries_;
+    bool modified_{false};
+
+    void Load() noexcept;
+
+    /// \brief Read the entries of the cache file.
+    /// \throws on errors other than a missing or malformed file.
+    [[nodiscard]] auto ReadEntries() const
+        -> std::unordered_map<std::string, Entry>;
+};
+
+#endif  // INCLUDED_SRC_BUILDTOOL_STORAGE_FILE_DIGEST_CACHE_HPP
@@ -18,6 +18,7 @@
 
 #include <algorithm>
 #include <array>
+#include <cstdint>
 #include <filesystem>
 #include <string>
 #include <vector>
@@ -29,6 +30,7 @@
 #include "src/buildtool/file_system/file_system_manager.hpp"
 #include "src/buildtool/logging/log_level.hpp"
 #include "src/buildtool/logging/logger.hpp"
+#include "src/buildtool/storage/cache_evictor.hpp"
 #include "src/buildtool/storage/compactifier.hpp"
 #include "src/buildtool/storage/storage.hpp"
 #include "src/utils/cpp/expected.hpp"
@@ -244,6 +246,115 @@ auto GarbageCollector::TriggerGarbageCollection(
     return success;
 }
 
+auto GarbageCollector::TriggerQuotaCollection(
+    StorageConfig const& storage_config,
+    std::uintmax_t max_cache_size) noexcept -> bool {
+    if (storage_config.num_generations < 2) {
+        Logger::Log(LogLevel::Error,
+                    "Reducing the cache to a given size requires at least two "
+                    "cache generations");
+        return false;
+    }
+
+    // Concurrent evictions following different plans could together violate
+    // the invariants of a generation, so only one may run at a time.
+    auto evict_lock = LockFile::Acquire(
+        storage_config.CacheRoot() / "gc-evict.lock", /*is_shared=*/false);
+    if (not evict_lock) {
+        Logger::Log(LogLevel::Error, "Failed to lock the cache for eviction");
+        return false;
+    }
+
+    // Clean up without losing cache; rotation only happens if evicting from
+    // the older generations does not suffice.
+    if (not TriggerGarbageCollection(storage_config, /*no_rotation=*/true)) {
+        return false;
+    }
+    for (bool rotated = false;; rotated = true) {
+        auto const fits =
+            EvictFromOlderGenerations(storage_config, max_cache_size);
+        if (not fits) {
+            return false;
+        }
+        if (*fits) {
+            return true;
+        }
+        if (rotated) {
+            Logger::Log(LogLevel::Warning,
+                        "Cache could not be reduced to {} bytes, as the "
+                        "remaining entries were added since the rotation",
+                        max_cache_size);
+            return true;
+        }
+        // Make the youngest generation subject to eviction; entries used in
+        // the meantime are uplinked again and thus evicted last.
+        Logger::Log(LogLevel::Info,
+                    "Rotating generations to evict from the youngest one");
+        if (not TriggerGarbageCollection(storage_config)) {
+            return false;
+        }
+    }
+}
+
+auto GarbageCollector::EvictFromOlderGenerations(
+    StorageConfig const& storage_config,
+    std::uintmax_t max_cache_size) noexcept -> std::optional<bool> {
+    // Only the youngest generation is modified by builds, and entries of older
+    // generations are only read for uplinking, where a missing entry results
+    // in a cache miss. Hence, evicting from older generations in an order that
+    // keeps their invariants only needs a shared lock, which in particular
+    // prevents rotation.
+    auto lock = SharedLock(storage_config);
+    if (not lock) {
+        Logger::Log(LogLevel::Error,
+                    "Failed to get a shared lock the local build root");
+        return std::nullopt;
+    }
+
+    std::size_t evicted = 0;
+    do {  // NOLINT(cppcoreguidelines-avoid-do-while)
+        auto size = CacheEvictor::CacheSize(storage_config);
+        if (not size) {
+            return std::nullopt;
+        }
+        Logger::Log(LogLevel::Performance,
+                    "Cache size is {} bytes, quota is {} bytes",
+                    *size,
+                    max_cache_size);
+        evicted = 0;
+        for (std::size_t i = storage_config.num_generations - 1;
+             i > 0 and *size > max_cache_size;
+             --i) {
+            auto const plan = CacheEvictor::Plan(storage_config, i);
+            if (not plan) {
+                return std::nullopt;
+            }
+            std::size_t evicted_from_generation = 0;
+            for (auto const& victim : *plan) {
+                if (*size <= max_cache_size) {
+                    break;
+                }
+                if (auto const freed = CacheEvictor::Evict(victim)) {
+                    *size -= std::min(*size, *freed);
+                    ++evicted_from_generation;
+                }
+            }
+            Logger::Log(LogLevel::Performance,
+                        "Evicted {} of {} files from generation {}",
+                        evicted_from_generation,
+                        plan->size(),
+                        i);
+            evicted += evicted_from_generation;
+        }
+        if (*size <= max_cache_size) {
+            return true;
+        }
+        // Entries skipped as they were uplinked during eviction can be evicted
+        // from the older generations in another pass.
+    } while (evicted > 0);
+    return false;
+}
+
 auto GarbageCollector::Compactify(StorageConfig const& storage_config,
                                   size_t threshold) noexcept -> bool {
     Logger::Log(LogLevel::Performance, "Compactification has been started");
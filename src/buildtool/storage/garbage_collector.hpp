@@ -16,6 +16,7 @@
 #define INCLUDED_SRC_BUILDTOOL_STORAGE_GARBAGE_COLLECTOR_HPP
 
 #include <cstddef>
+#include <cstdint>
 #include <filesystem>
 #include <optional>
 
@@ -39,6 +40,19 @@ class GarbageCollector {
         bool no_rotation = false,
         bool gc_all = false) noexcept -> bool;
 
+    /// \brief Trigger garbage collection that reduces the cache to a given
+    /// size. Instead of rotating generations, single entries are evicted from
+    /// the older generations in the order they were last added or uplinked,
+    /// while holding only a shared lock, so that builds can continue. Only if
+    /// this does not suffice, generations are rotated and the eviction is
+    /// repeated once.
+    /// \param storage_config Storage to collect garbage in
+    /// \param max_cache_size Size in bytes the cache should be reduced to.
+    /// \return true on success.
+    [[nodiscard]] auto static TriggerQuotaCollection(
+        StorageConfig const& storage_config,
+        std::uintmax_t max_cache_size) noexcept -> bool;
+
     /// \brief Acquire shared lock to prevent garbage collection from running.
     /// \param storage_config   Storage to be locked.
     /// \returns The acquired lock file on success or nullopt otherwise.
@@ -54,6 +68,14 @@ class GarbageCollector {
     [[nodiscard]] auto static LockFilePath(
         StorageConfig const& storage_config) noexcept -> std::filesystem::path;
 
+    /// \brief Evict entries from all but the youngest generation, oldest
+    /// generation first, until the cache fits the given size.
+    /// \return Whether the cache fits the given size afterwards, or nullopt
+    /// on failure.
+    [[nodiscard]] auto static EvictFromOlderGenerations(
+        StorageConfig const& storage_config,
+        std::uintmax_t max_cache_size) noexcept -> std::optional<bool>;
+
     /// \brief Remove spliced objects from the youngest generation and split
     /// objects that are larger than the threshold.
     /// \param threshold    Compactification threshold.
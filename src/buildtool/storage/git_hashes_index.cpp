@@ -0,0 +1,420 @@
+// Copyright 2026 Huawei Cloud Computing Technology Co., Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "src/buildtool/storage/git_hashes_index.hpp"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <exception>
+#include <string_view>
+#include <utility>
+
+#include "src/buildtool/file_system/file_system_manager.hpp"
+#include "src/buildtool/logging/log_level.hpp"
+#include "src/buildtool/logging/logger.hpp"
+#include "src/buildtool/storage/persistent_file.hpp"
+#include "src/utils/cpp/hex_string.hpp"
+
+namespace {
+
+// Name of the index file in a generation's cache root.
+constexpr auto kIndexFileName = "git-sha256-index";
+
+// Name of the log of entries not yet merged into the index file.
+constexpr auto kLogFileName = "git-sha256-index.log";
+
+// Number of entries in the log above which it is merged into the index file.
+constexpr std::size_t kMaxLogEntries = std::size_t{1} << 16U;
+
+// Magic at the start of an index file; bump the version on format changes.
+constexpr std::string_view kMagic{"just-git-sha256 "};
+constexpr std::uint32_t kVersion = 1;
+
+struct Header {
+    std::array<char, kMagic.size()> magic;
+    std::uint32_t version;
+    std::uint32_t reserved;
+    std::uint64_t count;
+};
+static_assert(sizeof(Header) % alignof(std::uint64_t) == 0);
+
+template <typename TEntry>
+[[nodiscard]] auto LessByGitHash(TEntry const& lhs, TEntry const& rhs) noexcept
+    -> bool {
+    return lhs.git_hash < rhs.git_hash;
+}
+
+template <typename TEntry>
+[[nodiscard]] auto EqualGitHash(TEntry const& lhs, TEntry const& rhs) noexcept
+    -> bool {
+    return lhs.git_hash == rhs.git_hash;
+}
+
+/// \brief Convert a hex hash of the given size to raw bytes.
+[[nodiscard]] auto ToRaw(std::string const& hex_hash, std::size_t size)
+    -> std::optional<std::string> {
+    if (hex_hash.size() != 2 * size or not IsHexString(hex_hash)) {
+        return std::nullopt;
+    }
+    return FromHexString(hex_hash);
+}
+
+/// \brief Append records of the given size to a file, creating it if needed.
+/// A truncated last record of an earlier interrupted append is dropped first,
+/// so that the records stay aligned.
+[[nodiscard]] auto AppendRecords(std::string const& content,
+                                 std::size_t record_size,
+                                 std::filesystem::path const& file) noexcept
+    -> bool {
+    if (not FileSystemManager::CreateDirectory(file.parent_path())) {
+        return false;
+    }
+    auto const fd =
+        ::open(file.c_str(), O_WRONLY | O_APPEND | O_CREAT | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        return false;
+    }
+    auto const closer = gsl::finally([fd] { ::close(fd); });
+    struct stat st{};
+    if (::fstat(fd, &st) != 0) {
+        return false;
+    }
+    auto const size = static_cast<std::size_t>(st.st_size);
+    if (size % record_size != 0 and
+        ::ftruncate(fd, static_cast<off_t>(size - (size % record_size))) !=
+            0) {
+        return false;
+    }
+    std::size_t written = 0;
+    while (written < content.size()) {
+        auto const n = ::write(
+            fd, content.data() + written, content.size() - written);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        written += static_cast<std::size_t>(n);
+    }
+    return true;
+}
+
+}  // namespace
+
+/// \brief Read-only mapping of the sorted table of an index file.
+class GitHashesIndex::MappedTable final {
+  public:
+    MappedTable() noexcept = default;
+    MappedTable(MappedTable const&) = delete;
+    MappedTable(MappedTable&& other) noexcept
+        : map_{std::exchange(other.map_, nullptr)},
+          size_{std::exchange(other.size_, 0)},
+          count_{std::exchange(other.count_, 0)} {}
+    auto operator=(MappedTable const&) -> MappedTable& = delete;
+    auto operator=(MappedTable&& other) noexcept -> MappedTable& {
+        std::swap(map_, other.map_);
+        std::swap(size_, other.size_);
+        std::swap(count_, other.count_);
+        return *this;
+    }
+    ~MappedTable() noexcept {
+        if (map_ != nullptr) {
+            ::munmap(map_, size_);
+        }
+    }
+
+    /// \brief Map the table of an index file. Missing or malformed files
+    /// result in an empty table.
+    [[nodiscard]] static auto Open(std::filesystem::path const& file) noexcept
+        -> MappedTable {
+        MappedTable table{};
+        auto const fd = ::open(file.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) {
+            return table;
+        }
+        auto const closer = gsl::finally([fd] { ::close(fd); });
+        struct stat st{};
+        if (::fstat(fd, &st) != 0 or
+            static_cast<std::size_t>(st.st_size) < sizeof(Header)) {
+            return table;
+        }
+        auto const size = static_cast<std::size_t>(st.st_size);
+        void* map = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        // NOLINTNEXTLINE(cppcoreguidelines-pro-type-cstyle-cast)
+        if (map == MAP_FAILED) {
+            return table;
+        }
+        table.map_ = map;
+        table.size_ = size;
+        Header header{};
+        std::memcpy(&header, map, sizeof(Header));
+        auto const payload = size - sizeof(Header);
+        bool const magic_ok =
+            std::equal(kMagic.begin(), kMagic.end(), header.magic.begin());
+        if (not magic_ok or header.version != kVersion or
+            payload % sizeof(Entry) != 0 or
+            header.count != payload / sizeof(Entry)) {
+            Logger::Log(LogLevel::Debug,
+                        "Ignoring git hashes index {} of unknown format",
+                        file.string());
+            return table;
+        }
+        table.count_ = header.count;
+        return table;
+    }
+
+    [[nodiscard]] auto Count() const noexcept -> std::size_t { return count_; }
+
+    [[nodiscard]] auto At(std::size_t index) const noexcept -> Entry {
+        Entry entry{};
+        // NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+        std::memcpy(&entry,
+                    static_cast<char const*>(map_) + sizeof(Header) +
+                        index * sizeof(Entry),
+                    sizeof(Entry));
+        return entry;
+    }
+
+    /// \brief Binary search for the entry of a raw git hash.
+    [[nodiscard]] auto Find(std::string const& raw_git_hash) const noexcept
+        -> std::optional<Entry> {
+        std::size_t low = 0;
+        std::size_t high = count_;
+        while (low < high) {
+            auto const mid = low + (high - low) / 2;
+            auto const entry = At(mid);
+            auto const cmp = std::memcmp(
+                entry.git_hash.data(), raw_git_hash.data(), kGitHashSize);
+            if (cmp == 0) {
+                return entry;
+            }
+            if (cmp < 0) {
+                low = mid + 1;
+            }
+            else {
+                high = mid;
+            }
+        }
+        return std::nullopt;
+    }
+
+  private:
+    void* map_{nullptr};
+    std::size_t size_{};
+    std::size_t count_{};
+};
+
+GitHashesIndex::GitHashesIndex(
+    gsl::not_null<StorageConfig const*> const& storage_config) noexcept
+    : storage_config_{*storage_config} {
+    try {
+        tables_.reserve(storage_config_.num_generations);
+        logs_.reserve(storage_config_.num_generations);
+        for (std::size_t i = 0; i < storage_config_.num_generations; ++i) {
+            tables_.emplace_back(MappedTable::Open(IndexFile(i)));
+            logs_.emplace_back(ReadLog(LogFile(i)));
+        }
+    } catch (...) {
+        tables_.clear();
+        logs_.clear();
+    }
+}
+
+GitHashesIndex::~GitHashesIndex() noexcept = default;
+
+auto GitHashesIndex::Lookup(std::string const& git_hash) noexcept
+    -> std::optional<std::string> {
+    try {
+        auto raw = ToRaw(git_hash, kGitHashSize);
+        if (not raw) {
+            return std::nullopt;
+        }
+        auto to_hex = [](Entry const& entry) {
+            return ToHexString(std::string(entry.compat_hash.begin(),
+                                           entry.compat_hash.end()));
+        };
+        std::unique_lock lock{mutex_};
+        if (auto it = updates_.find(*raw); it != updates_.end()) {
+            return to_hex(it->second);
+        }
+        for (std::size_t i = 0; i < tables_.size(); ++i) {
+            if (auto entry = Find(i, *raw)) {
+                if (i > 0) {
+                    // uplink to the youngest generation
+                    updates_.emplace(*std::move(raw), *entry);
+                }
+                return to_hex(*entry);
+            }
+        }
+    } catch (...) {
+        // not found
+    }
+    return std::nullopt;
+}
+
+void GitHashesIndex::Store(std::string const& git_hash,
+                           std::string const& compat_hash) noexcept {
+    try {
+        auto raw_git = ToRaw(git_hash, kGitHashSize);
+        auto raw_compat = ToRaw(compat_hash, kCompatHashSize);
+        if (not raw_git or not raw_compat) {
+            return;
+        }
+        Entry entry{};
+        std::memcpy(entry.git_hash.data(), raw_git->data(), kGitHashSize);
+        std::memcpy(
+            entry.compat_hash.data(), raw_compat->data(), kCompatHashSize);
+        std::unique_lock lock{mutex_};
+        if (not tables_.empty() and Find(0, *raw_git)) {
+            return;
+        }
+        updates_.insert_or_assign(*std::move(raw_git), entry);
+    } catch (...) {
+        // the entry is dropped
+    }
+}
+
+auto GitHashesIndex::Save() noexcept -> bool {
+    try {
+        std::unique_lock lock{mutex_};
+        if (updates_.empty()) {
+            return true;
+        }
+        // The lock of the table also serializes the updates of its log.
+        auto const file_lock = PersistentFile::LockForUpdate(IndexFile(0));
+        if (not file_lock) {
+            return false;
+        }
+        // Only append the new entries, so saving does not depend on the size
+        // of the table. The log might have been extended or merged by another
+        // process in the meantime, so it is read again.
+        auto const log_file = LogFile(0);
+        auto log = ReadLog(log_file);
+        std::string content(updates_.size() * sizeof(Entry), '\0');
+        std::size_t offset = 0;
+        for (auto const& [raw, entry] : updates_) {
+            std::memcpy(content.data() + offset, &entry, sizeof(Entry));
+            offset += sizeof(Entry);
+            log.push_back(entry);
+        }
+        if (log.size() > kMaxLogEntries) {
+            if (not MergeLog(std::move(log))) {
+                return false;
+            }
+        }
+        else {
+            if (not AppendRecords(content, sizeof(Entry), log_file)) {
+                return false;
+            }
+            std::sort(log.begin(), log.end(), LessByGitHash<Entry>);
+            if (not logs_.empty()) {
+                logs_[0] = std::move(log);
+            }
+        }
+        updates_.clear();
+        return true;
+    } catch (std::exception const& ex) {
+        Logger::Log(LogLevel::Debug,
+                    "Writing git hashes index failed with:\n{}",
+                    ex.what());
+        return false;
+    }
+}
+
+auto GitHashesIndex::MergeLog(std::vector<Entry> log) -> bool {
+    auto const index_file = IndexFile(0);
+    auto const current = MappedTable::Open(index_file);
+    std::vector<Entry> entries = std::move(log);
+    entries.reserve(entries.size() + current.Count());
+    for (std::size_t i = 0; i < current.Count(); ++i) {
+        entries.push_back(current.At(i));
+    }
+    std::stable_sort(entries.begin(), entries.end(), LessByGitHash<Entry>);
+    entries.erase(
+        std::unique(entries.begin(), entries.end(), EqualGitHash<Entry>),
+        entries.end());
+
+    Header header{};
+    std::copy(kMagic.begin(), kMagic.end(), header.magic.begin());
+    header.version = kVersion;
+    header.count = entries.size();
+    std::string content(sizeof(Header) + entries.size() * sizeof(Entry), '\0');
+    std::memcpy(content.data(), &header, sizeof(Header));
+    std::memcpy(content.data() + sizeof(Header),
+                entries.data(),
+                entries.size() * sizeof(Entry));
+
+    // Readers seeing the new table together with the old log only see
+    // duplicates.
+    if (not PersistentFile::Replace(index_file, content) or
+        not FileSystemManager::RemoveFile(LogFile(0))) {
+        return false;
+    }
+    if (not tables_.empty()) {
+        tables_[0] = MappedTable::Open(index_file);
+        logs_[0].clear();
+    }
+    return true;
+}
+
+auto GitHashesIndex::Find(std::size_t generation,
+                          std::string const& raw_git_hash) const noexcept
+    -> std::optional<Entry> {
+    if (auto entry = tables_[generation].Find(raw_git_hash)) {
+        return entry;
+    }
+    auto const& log = logs_[generation];
+    Entry key{};
+    std::memcpy(key.git_hash.data(), raw_git_hash.data(), kGitHashSize);
+    auto it = std::lower_bound(
+        log.begin(), log.end(), key, LessByGitHash<Entry>);
+    if (it != log.end() and it->git_hash == key.git_hash) {
+        return *it;
+    }
+    return std::nullopt;
+}
+
+auto GitHashesIndex::ReadLog(std::filesystem::path const& file)
+    -> std::vector<Entry> {
+    std::vector<Entry> entries{};
+    if (not FileSystemManager::IsFile(file)) {
+        return entries;
+    }
+    auto content = FileSystemManager::ReadFile(file);
+    if (not content) {
+        return entries;
+    }
+    auto const count = content->size() / sizeof(Entry);
+    entries.resize(count);
+    std::memcpy(entries.data(), content->data(), count * sizeof(Entry));
+    std::sort(entries.begin(), entries.end(), LessByGitHash<Entry>);
+    return entries;
+}
+
+auto GitHashesIndex::IndexFile(std::size_t generation) const
+    -> std::filesystem::path {
+    return storage_config_.GenerationCacheRoot(generation) / kIndexFileName;
+}
+
+auto GitHashesIndex::LogFile(std::size_t generation) const
+    -> std::filesystem::path {
+    return storage_config_.GenerationCacheRoot(generation) / kLogFileName;
+}
@@ -0,0 +1,114 @@
+// Copyright 2026 Huawei Cloud Computing Technology Co., Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef INCLUDED_SRC_BUILDTOOL_STORAGE_GIT_HASHES_INDEX_HPP
+#define INCLUDED_SRC_BUILDTOOL_STORAGE_GIT_HASHES_INDEX_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "gsl/gsl"
+#include "src/buildtool/common/git_hashes_store.hpp"
+#include "src/buildtool/storage/config.hpp"
+
+/// \brief Persistent index mapping git blob identifiers to the SHA256 hashes
+/// of the blobs' content, as needed in compatible mode.
+/// Every storage generation holds a sorted table of fixed-size entries that is
+/// memory mapped on construction. Entries are looked up in the generations
+/// from youngest to oldest; entries found in an older generation are uplinked
+/// to the youngest one. As the tables are rotated together with the
+/// generations, entries not used for a full rotation are garbage collected.
+/// New entries and uplinked ones are kept in memory and appended to a log next
+/// to the table of the youngest generation when saving; only once the log
+/// grows too large, it is merged into the table. Appending and merging are
+/// serialized between processes by a lock file. Entries only depend on the
+/// content of the blobs, so they never become invalid.
+class GitHashesIndex final : public IGitHashesStore {
+  public:
+    explicit GitHashesIndex(
+        gsl::not_null<StorageConfig const*> const& storage_config) noexcept;
+
+    GitHashesIndex(GitHashesIndex const&) = delete;
+    GitHashesIndex(GitHashesIndex&&) = delete;
+    auto operator=(GitHashesIndex const&) -> GitHashesIndex& = delete;
+    auto operator=(GitHashesIndex&&) -> GitHashesIndex& = delete;
+    ~GitHashesIndex() noexcept final;
+
+    /// \brief Look up the SHA256 hash of a git blob.
+    /// \param git_hash     Hex git identifier of the blob.
+    /// \returns The hex SHA256 hash of the blob's content, or nullopt if the
+    /// blob is not in the index.
+    [[nodiscard]] auto Lookup(std::string const& git_hash) noexcept
+        -> std::optional<std::string> final;
+
+    /// \brief Add the SHA256 hash of a git blob to the index. Malformed
+    /// hashes are silently ignored.
+    void Store(std::string const& git_hash,
+               std::string const& compat_hash) noexcept final;
+
+    /// \brief Append new entries to the log of the youngest generation, merging
+    /// the log into its table if it grew too large. Must be called holding the
+    /// shared lock of the garbage collector, as the generations are rotated
+    /// under its exclusive lock.
+    /// \returns true on success.
+    [[nodiscard]] auto Save() noexcept -> bool;
+
+  private:
+    static constexpr std::size_t kGitHashSize = 20;
+    static constexpr std::size_t kCompatHashSize = 32;
+
+    // Layout of the entries of the tables on disk, sorted by git hash.
+    struct Entry {
+        std::array<std::uint8_t, kGitHashSize> git_hash;
+        std::array<std::uint8_t, kCompatHashSize> compat_hash;
+    };
+    static_assert(sizeof(Entry) == kGitHashSize + kCompatHashSize);
+
+    class MappedTable;
+
+    StorageConfig const& storage_config_;
+    std::mutex mutex_;
+    std::vector<MappedTable> tables_;  // indexed by generation
+    // entries of the logs, indexed by generation and sorted by git hash
+    std::vector<std::vector<Entry>> logs_;
+    std::unordered_map<std::string, Entry> updates_;  // keyed by raw git hash
+
+    [[nodiscard]] auto IndexFile(std::size_t generation) const
+        -> std::filesystem::path;
+    [[nodiscard]] auto LogFile(std::size_t generation) const
+        -> std::filesystem::path;
+
+    /// \brief Find the entry of a raw git hash in a generation.
+    [[nodiscard]] auto Find(std::size_t generation,
+                            std::string const& raw_git_hash) const noexcept
+        -> std::optional<Entry>;
+
+    /// \brief Read the entries of a log file, sorted by git hash. A truncated
+    /// last entry, e.g., of an interrupted append, is ignored.
+    [[nodiscard]] static auto ReadLog(std::filesystem::path const& file)
+        -> std::vector<Entry>;
+
+    /// \brief Merge the log of the youngest generation into its table and
+    /// remove the log. Must be called holding the lock file.
+    [[nodiscard]] auto MergeLog(std::vector<Entry> log) -> bool;
+};
+
+#endif  // INCLUDED_SRC_BUILDTOOL_STORAGE_GIT_HASHES_INDEX_HPP
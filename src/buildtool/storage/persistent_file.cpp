@@ -0,0 +1,42 @@
+// Copyright 2026 Huawei Cloud Computing Technology Co., Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "src/buildtool/storage/persistent_file.hpp"
+
+#include "src/buildtool/execution_api/common/ids.hpp"
+#include "src/buildtool/file_system/file_system_manager.hpp"
+
+namespace PersistentFile {
+
+auto LockForUpdate(std::filesystem::path const& file) noexcept
+    -> std::optional<LockFile> {
+    try {
+        return LockFile::Acquire(file.string() + ".lock", /*is_shared=*/false);
+    } catch (...) {
+        return std::nullopt;
+    }
+}
+
+auto Replace(std::filesystem::path const& file,
+             std::string const& content) noexcept -> bool {
+    // Write to a process-unique file and rename it, so that concurrent readers
+    // never observe a partially written file. As the rename replaces the
+    // directory entry only, existing memory mappings of the old file stay
+    // valid as well.
+    auto tmp_file = CreateUniquePath(file);
+    return tmp_file and FileSystemManager::WriteFile(content, *tmp_file) and
+           FileSystemManager::Rename(*tmp_file, file);
+}
+
+}  // namespace PersistentFile
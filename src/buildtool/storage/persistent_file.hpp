@@ -0,0 +1,45 @@
+// Copyright 2026 Huawei Cloud Computing Technology Co., Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef INCLUDED_SRC_BUILDTOOL_STORAGE_PERSISTENT_FILE_HPP
+#define INCLUDED_SRC_BUILDTOOL_STORAGE_PERSISTENT_FILE_HPP
+
+#include <filesystem>
+#include <optional>
+#include <string>
+
+#include "src/utils/cpp/file_locking.hpp"
+
+/* Utilities for the files the persistent caches and indices of the storage
+ * are saved to, i.e., the file digest cache, the action duration history, and
+ * the git hashes index. Such a file is loaded on construction of its store and
+ * written back by an explicit save. Saving happens under the storage's shared
+ * garbage collection lock, so that it does not race with generation rotation.
+ */
+
+namespace PersistentFile {
+
+/// \brief Acquire the exclusive lock serializing updates of a file between
+/// processes. The lock file is placed next to the file.
+[[nodiscard]] auto LockForUpdate(std::filesystem::path const& file) noexcept
+    -> std::optional<LockFile>;
+
+/// \brief Atomically replace the content of a file, creating it if needed.
+/// \returns true on success.
+[[nodiscard]] auto Replace(std::filesystem::path const& file,
+                           std::string const& content) noexcept -> bool;
+
+}  // namespace PersistentFile
+
+#endif  // INCLUDED_SRC_BUILDTOOL_STORAGE_PERSISTENT_FILE_HPP
@@ -20,6 +20,7 @@
 
 #include "gsl/gsl"
 #include "src/buildtool/crypto/hash_function.hpp"
+#include "src/buildtool/storage/analysis_cache.hpp"
 #include "src/buildtool/storage/config.hpp"
 #include "src/buildtool/storage/local_ac.hpp"
 #include "src/buildtool/storage/local_cas.hpp"
@@ -28,9 +29,10 @@
 #include "src/utils/cpp/gsl.hpp"
 
 /// \brief The local storage for accessing CAS and caches.
-/// Maintains an instance of LocalCAS, LocalAC, TargetCache. Supports global
-/// uplinking across all generations. The uplink is automatically performed by
-/// the affected storage instance (CAS, action cache, target cache).
+/// Maintains an instance of LocalCAS, LocalAC, TargetCache, AnalysisCache.
+/// Supports global uplinking across all generations. The uplink is
+/// automatically performed by the affected storage instance (CAS, action
+/// cache, target cache, analysis cache).
 /// \tparam kDoGlobalUplink     Enable global uplinking.
 template <bool kDoGlobalUplink>
 class LocalStorage final {
@@ -41,6 +43,7 @@ class LocalStorage final {
     using CAS_t = LocalCAS<kDoGlobalUplink>;
     using AC_t = LocalAC<kDoGlobalUplink>;
     using TC_t = ::TargetCache<kDoGlobalUplink>;
+    using ANC_t = ::AnalysisCache<kDoGlobalUplink>;
 
     [[nodiscard]] static auto Create(
         gsl::not_null<StorageConfig const*> const& storage_config,
@@ -70,17 +73,24 @@ class LocalStorage final {
         return *tc_;
     }
 
+    /// \brief Get the analysis cache instance.
+    [[nodiscard]] auto AnalysisCache() const noexcept -> ANC_t const& {
+        return *anc_;
+    }
+
   private:
     std::unique_ptr<Uplinker_t const> uplinker_;
     std::unique_ptr<CAS_t const> cas_;
     std::unique_ptr<AC_t const> ac_;
     std::unique_ptr<TC_t const> tc_;
+    std::unique_ptr<ANC_t const> anc_;
 
     explicit LocalStorage(GenerationConfig const& config)
         : uplinker_{std::make_unique<Uplinker_t>(config.storage_config)},
           cas_{std::make_unique<CAS_t>(config, &*uplinker_)},
           ac_{std::make_unique<AC_t>(&*cas_, config, &*uplinker_)},
-          tc_{std::make_unique<TC_t>(&*cas_, config, &*uplinker_)} {}
+          tc_{std::make_unique<TC_t>(&*cas_, config, &*uplinker_)},
+          anc_{std::make_unique<ANC_t>(config, &*uplinker_)} {}
 };
 
 #ifdef BOOTSTRAP_BUILD_TOOL
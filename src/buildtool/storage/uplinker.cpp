@@ -18,6 +18,7 @@
 
 #include <algorithm>
 #include <cstddef>
+#include <string>
 
 #include "src/buildtool/file_system/object_type.hpp"
 #include "src/buildtool/storage/storage.hpp"
@@ -115,4 +116,16 @@ auto GlobalUplinker::UplinkTargetCacheEntry(
         });
 }
 
+auto GlobalUplinker::UplinkAnalysisCacheEntry(
+    std::string const& key) const noexcept -> bool {
+    // Try to find analysis-cache entry in all generations.
+    auto const& latest = generations_[Generation::kYoungest].AnalysisCache();
+    return std::any_of(generations_.begin(),
+                       generations_.end(),
+                       [&latest, &key](Generation const& generation) {
+                           return generation.AnalysisCache().LocalUplinkEntry(
+                               latest, key);
+                       });
+}
+
 #endif  // BOOTSTRAP_BUILD_TOOL
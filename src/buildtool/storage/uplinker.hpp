@@ -15,6 +15,7 @@
 #ifndef INCLUDED_SRC_BUILDTOOL_STORAGE_UPLINKER_HPP
 #define INCLUDED_SRC_BUILDTOOL_STORAGE_UPLINKER_HPP
 
+#include <string>
 #include <type_traits>
 #include <vector>
 
@@ -79,6 +80,13 @@ class GlobalUplinker final {
         TargetCacheKey const& key,
         BackendDescription const& backend_description) const noexcept -> bool;
 
+    /// \brief Uplink entry from analysis cache across all generations to
+    /// latest.
+    /// \param key  Analysis cache key to uplink entry for.
+    /// \returns true if cache entry was found and successfully uplinked.
+    [[nodiscard]] auto UplinkAnalysisCacheEntry(
+        std::string const& key) const noexcept -> bool;
+
   private:
     StorageConfig const& storage_config_;
     std::vector<LocalStorage<false>> const generations_;
@@ -14,6 +14,7 @@
 
 #include "src/other_tools/root_maps/content_git_map.hpp"
 
+#include <cstddef>
 #include <filesystem>
 #include <functional>
 #include <memory>
@@ -390,10 +391,10 @@ void WriteIdFileAndSetWSRoot(
                        logger);
 }
 
-/// \brief Called when archive is in local CAS. Performs the import-to-git
-/// and follow-up processing. It guarantees the logger is called exactly
-/// once with fatal on failure, and the setter on success.
-void ExtractAndImportToGit(
+/// \brief Extracts the archive and imports the extracted directory to Git.
+/// Performs the follow-up processing. It guarantees the logger is called
+/// exactly once with fatal on failure, and the setter on success.
+void ExtractAndCommitToGit(
     ArchiveRepoInfo const& key,
     std::filesystem::path const& content_cas_path,
     std::filesystem::path const& archive_tree_id_file,
@@ -473,6 +474,145 @@ void ExtractAndImportToGit(
         });
 }
 
+/// \brief Called when archive is in local CAS. Imports the archive content
+/// directly into the Git cache, falling back to extracting it if it can not
+/// be imported that way, and performs the follow-up processing. It guarantees
+/// the logger is called exactly once with fatal on failure, and the setter on
+/// success.
+void ExtractAndImportToGit(
+    ArchiveRepoInfo const& key,
+    std::filesystem::path const& content_cas_path,
+    std::filesystem::path const& archive_tree_id_file,
+    bool is_absent,
+    ServeApi const* serve,
+    gsl::not_null<StorageConfig const*> const& native_storage_config,
+    gsl::not_null<CriticalGitOpMap*> const& critical_git_op_map,
+    gsl::not_null<ImportToGitMap*> const& import_to_git_map,
+    gsl::not_null<ResolveSymlinksMap*> const& resolve_symlinks_map,
+    gsl::not_null<TaskSystem*> const& ts,
+    ContentGitMap::SetterPtr const& setter,
+    ContentGitMap::LoggerPtr const& logger) {
+    // ensure Git cache
+    GitOpKey op_key = {.params =
+                           {
+                               native_storage_config->GitRoot(),  // target_path
+                               "",                                // git_hash
+                               std::nullopt,                      // message
+                               std::nullopt,                      // source_path
+                               true                               // init_bare
+                           },
+                       .op_type = GitOpType::ENSURE_INIT};
+    critical_git_op_map->ConsumeAfterKeysReady(
+        ts,
+        {std::move(op_key)},
+        [key,
+         content_cas_path,
+         archive_tree_id_file,
+         is_absent,
+         serve,
+         native_storage_config,
+         critical_git_op_map,
+         import_to_git_map,
+         resolve_symlinks_map,
+         ts,
+         setter,
+         logger](auto const& values) {
+            GitOpValue op_result = *values[0];
+            // check flag
+            if (not op_result.result) {
+                (*logger)("Git init failed",
+                          /*fatal=*/true);
+                return;
+            }
+            auto tree_id =
+                ArchiveOps::ImportArchiveToGit(key.repo_type,
+                                               content_cas_path,
+                                               op_result.git_cas,
+                                               ts->NumberOfThreads());
+            if (not tree_id) {
+                (*logger)(fmt::format("Could not import archive {} without "
+                                      "extracting it:\n{}",
+                                      content_cas_path.string(),
+                                      tree_id.error()),
+                          /*fatal=*/false);
+                ExtractAndCommitToGit(key,
+                                      content_cas_path,
+                                      archive_tree_id_file,
+                                      is_absent,
+                                      serve,
+                                      native_storage_config,
+                                      critical_git_op_map,
+                                      import_to_git_map,
+                                      resolve_symlinks_map,
+                                      ts,
+                                      setter,
+                                      logger);
+                return;
+            }
+            // keep tree alive in Git cache via a tag
+            GitOpKey op_key = {
+                .params =
+                    {
+                        native_storage_config->GitRoot(),  // target_path
+                        *tree_id,                          // git_hash
+                        "Keep referenced tree alive"       // message
+                    },
+                .op_type = GitOpType::KEEP_TREE};
+            critical_git_op_map->ConsumeAfterKeysReady(
+                ts,
+                {std::move(op_key)},
+                [archive_tree_id = *tree_id,
+                 just_git_cas = op_result.git_cas,
+                 key,
+                 archive_tree_id_file,
+                 is_absent,
+                 serve,
+                 native_storage_config,
+                 critical_git_op_map,
+                 resolve_symlinks_map,
+                 ts,
+                 setter,
+                 logger](auto const& values) {
+                    GitOpValue op_result = *values[0];
+                    // check flag
+                    if (not op_result.result) {
+                        (*logger)("Keep tree failed",
+                                  /*fatal=*/true);
+                        return;
+                    }
+                    // write to id file and process subdir tree
+                    WriteIdFileAndSetWSRoot(key,
+                                            archive_tree_id,
+                                            just_git_cas,
+                                            archive_tree_id_file,
+                                            is_absent,
+                                            serve,
+                                            native_storage_config,
+                                            critical_git_op_map,
+                                            resolve_symlinks_map,
+                                            ts,
+                                            setter,
+                                            logger);
+                },
+                [logger, target_path = native_storage_config->GitRoot()](
+                    auto const& msg, bool fatal) {
+                    (*logger)(fmt::format("While running critical Git op "
+                                          "KEEP_TREE for target {}:\n{}",
+                                          target_path.string(),
+                                          msg),
+                              fatal);
+                });
+        },
+        [logger, target_path = native_storage_config->GitRoot()](
+            auto const& msg, bool fatal) {
+            (*logger)(fmt::format("While running critical Git op ENSURE_INIT "
+                                  "for target {}:\n{}",
+                                  target_path.string(),
+                                  msg),
+                      fatal);
+        });
+}
+
 auto IdFileExistsInOlderGeneration(
     gsl::not_null<StorageConfig const*> const& native_storage_config,
     ArchiveRepoInfo const& key) -> std::optional<std::size_t> {
@@ -14,13 +14,27 @@
 
 #include "src/utils/archive/archive_ops.hpp"
 
+#include <algorithm>
+#include <array>
+#include <condition_variable>
 #include <cstddef>
 #include <exception>
 #include <memory>
+#include <mutex>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
 
+#include "fmt/core.h"
+#include "gsl/gsl"
 #include "src/buildtool/file_system/file_system_manager.hpp"
+#include "src/buildtool/file_system/git_repo.hpp"
+#include "src/buildtool/file_system/object_type.hpp"
 #include "src/buildtool/logging/log_level.hpp"
 #include "src/buildtool/logging/logger.hpp"
+#include "src/buildtool/multithreading/task_system.hpp"
+#include "src/utils/cpp/hex_string.hpp"
 
 extern "C" {
 #include <archive.h>
@@ -96,6 +110,386 @@ auto enable_read_filter(archive* ar, ArchiveType type) -> bool {
     }
 }
 
+/// \brief Blobs of at least this size are streamed into the object database
+/// while reading the archive, instead of being buffered for a parallel write.
+constexpr std::size_t kStreamBlobThreshold = 16UL * 1024 * 1024;
+
+/// \brief Maximal total size of buffered blobs awaiting their parallel write.
+constexpr std::size_t kMaxBufferedBlobBytes = 256UL * 1024 * 1024;
+
+/// \brief Node of the directory structure of an archive imported to Git.
+struct ImportNode {
+    ObjectType type{ObjectType::Tree};
+    // raw id of a non-tree object, set once written; shared by hardlinks
+    std::shared_ptr<std::optional<std::string>> raw_id;
+    std::unordered_map<std::string, std::unique_ptr<ImportNode>> children;
+};
+
+/// \brief Split the path of an archive entry into its components relative to
+/// the destination directory. Returns nullopt for paths leaving it.
+[[nodiscard]] auto SplitEntryPath(char const* path)
+    -> std::optional<std::vector<std::string>> {
+    if (path == nullptr or *path == '/') {
+        return std::nullopt;
+    }
+    std::vector<std::string> components{};
+    std::string_view rest{path};
+    while (not rest.empty()) {
+        auto const pos = rest.find('/');
+        auto const component = rest.substr(0, pos);
+        rest = pos == std::string_view::npos ? std::string_view{}
+                                             : rest.substr(pos + 1);
+        if (component == "..") {
+            return std::nullopt;
+        }
+        if (not component.empty() and component != ".") {
+            components.emplace_back(component);
+        }
+    }
+    return components;
+}
+
+/// \brief Read the data of the current archive entry in chunks, the same way
+/// extraction to disk does: blocks are placed at their offset, holes of sparse
+/// entries are zero-filled, and the content is cut or padded to the size of
+/// the entry. Returns nullopt on success, or an error string if failure.
+[[nodiscard]] auto ReadEntryData(archive* a_in,
+                                 std::size_t size,
+                                 GitRepo::BlobChunkSink const& sink)
+    -> std::optional<std::string> {
+    static constexpr std::array<char, kArchiveBlockSize> kZeros{};
+    std::size_t written{};
+    auto fill_zeros = [&written, &sink](std::size_t end) -> bool {
+        while (written < end) {
+            auto const count = std::min(end - written, kZeros.size());
+            if (not sink(std::string_view{kZeros.data(), count})) {
+                return false;
+            }
+            written += count;
+        }
+        return true;
+    };
+    while (true) {
+        void const* buff{nullptr};
+        std::size_t len{};
+        la_int64_t offset{};
+        int const r = archive_read_data_block(a_in, &buff, &len, &offset);
+        if (r == ARCHIVE_EOF) {
+            break;
+        }
+        if (r != ARCHIVE_OK) {
+            return std::string("ArchiveOps: ") +
+                   std::string(archive_error_string(a_in));
+        }
+        auto const start = static_cast<std::size_t>(offset);
+        if (offset < 0 or start < written) {
+            return std::string("ArchiveOps: unordered data blocks");
+        }
+        if (start >= size) {
+            continue;
+        }
+        if (not fill_zeros(start) or
+            not sink(std::string_view{static_cast<char const*>(buff),
+                                      std::min(len, size - start)})) {
+            return std::string("ArchiveOps: failed to store entry data");
+        }
+        written = start + std::min(len, size - start);
+    }
+    if (not fill_zeros(size)) {
+        return std::string("ArchiveOps: failed to store entry data");
+    }
+    return std::nullopt;
+}
+
+/// \brief Imports the entries of an archive into a Git object database. Blobs
+/// are buffered and written by the workers of a task system, except for large
+/// ones, which are streamed by the reading thread. Trees are written once all
+/// entries are known.
+class ArchiveGitImporter {
+  public:
+    explicit ArchiveGitImporter(GitRepo repo) noexcept
+        : repo_{std::move(repo)} {}
+
+    /// \brief Add all entries of the archive, writing their blobs.
+    /// Returns nullopt on success, or an error string if failure.
+    [[nodiscard]] auto AddEntries(archive* a_in,
+                                  gsl::not_null<TaskSystem*> const& ts)
+        -> std::optional<std::string> {
+        archive_entry* entry{nullptr};
+        while (true) {
+            int const r = archive_read_next_header(a_in, &entry);
+            if (r == ARCHIVE_EOF) {
+                return std::nullopt;
+            }
+            if (r != ARCHIVE_OK) {
+                return std::string("ArchiveOps: ") +
+                       std::string(archive_error_string(a_in));
+            }
+            if (auto error = AddEntry(a_in, entry, ts)) {
+                return error;
+            }
+            std::unique_lock lock{mutex_};
+            if (write_error_) {
+                return write_error_;
+            }
+        }
+    }
+
+    /// \brief Write the trees of the archive content. To be called only once
+    /// all blobs are written.
+    /// Returns the raw id of the root tree, or an error string if failure.
+    [[nodiscard]] auto WriteTrees() -> expected<std::string, std::string> {
+        if (write_error_) {
+            return unexpected{*write_error_};
+        }
+        return WriteTree(root_);
+    }
+
+  private:
+    GitRepo repo_;
+    ImportNode root_;
+    std::mutex mutex_;
+    std::condition_variable buffer_freed_;
+    std::size_t buffered_bytes_{};
+    std::optional<std::string> write_error_;
+
+    [[nodiscard]] auto AddEntry(archive* a_in,
+                                archive_entry* entry,
+                                gsl::not_null<TaskSystem*> const& ts)
+        -> std::optional<std::string> {
+        auto const* pathname = archive_entry_pathname(entry);
+        auto components = SplitEntryPath(pathname);
+        if (not components) {
+            return fmt::format("ArchiveOps: entry {} leaves the destination",
+                               pathname == nullptr ? "" : pathname);
+        }
+        bool const is_dir = archive_entry_filetype(entry) == AE_IFDIR and
+                            archive_entry_hardlink(entry) == nullptr;
+        if (components->empty()) {
+            if (is_dir) {
+                return std::nullopt;  // the destination itself
+            }
+            return fmt::format("ArchiveOps: non-directory entry {}", pathname);
+        }
+        auto* parent = FindDirectory(*components, /*create=*/true);
+        if (parent == nullptr) {
+            return fmt::format(
+                "ArchiveOps: entry {} is below a non-directory", pathname);
+        }
+        auto const& name = components->back();
+        auto const it = parent->children.find(name);
+        auto const* existing =
+            it == parent->children.end() ? nullptr : it->second.get();
+        if (is_dir) {
+            // extraction merges directories and replaces other entries
+            if (existing == nullptr or existing->type != ObjectType::Tree) {
+                parent->children[name] = std::make_unique<ImportNode>();
+            }
+            return std::nullopt;
+        }
+        if (existing != nullptr and existing->type == ObjectType::Tree and
+            not existing->children.empty()) {
+            return fmt::format(
+                "ArchiveOps: entry {} replaces a non-empty directory",
+                pathname);
+        }
+        auto node = std::make_unique<ImportNode>();
+        if (auto const* hardlink = archive_entry_hardlink(entry)) {
+            // extraction writes the data of hardlinks to the shared file
+            if (archive_entry_size(entry) > 0) {
+                return fmt::format(
+                    "ArchiveOps: hardlink {} carries data", pathname);
+            }
+            auto const* target = FindEntry(hardlink);
+            if (target == nullptr or target == existing or
+                target->type == ObjectType::Tree) {
+                return fmt::format(
+                    "ArchiveOps: hardlink {} has no file target {}",
+                    pathname,
+                    hardlink);
+            }
+            node->type = target->type;
+            node->raw_id = target->raw_id;
+        }
+        else if (archive_entry_filetype(entry) == AE_IFREG) {
+            static constexpr auto kExecPerms = 0111U;
+            node->type = (archive_entry_perm(entry) & kExecPerms) != 0
+                             ? ObjectType::Executable
+                             : ObjectType::File;
+            node->raw_id = std::make_shared<std::optional<std::string>>();
+            // as for extraction, only entries of positive size carry data
+            auto const size = archive_entry_size(entry);
+            if (size <= 0) {
+                WriteBuffered(std::string{}, node->raw_id, ts);
+            }
+            else if (auto error = ReadBlob(a_in,
+                                           static_cast<std::size_t>(size),
+                                           node->raw_id,
+                                           ts)) {
+                return error;
+            }
+        }
+        else if (archive_entry_filetype(entry) == AE_IFLNK and
+                 archive_entry_symlink(entry) != nullptr) {
+            node->type = ObjectType::Symlink;
+            node->raw_id = std::make_shared<std::optional<std::string>>();
+            WriteBuffered(
+                std::string{archive_entry_symlink(entry)}, node->raw_id, ts);
+        }
+        else {
+            return fmt::format("ArchiveOps: unsupported type of entry {}",
+                               pathname);
+        }
+        parent->children[name] = std::move(node);
+        return std::nullopt;
+    }
+
+    /// \brief Get the directory containing the entry of given path components,
+    /// optionally creating missing directories on the way, as extraction does.
+    /// Returns nullptr if the path runs through a non-directory.
+    [[nodiscard]] auto FindDirectory(std::vector<std::string> const& components,
+                                     bool create) -> ImportNode* {
+        auto* dir = &root_;
+        for (std::size_t i = 0; i + 1 < components.size(); ++i) {
+            auto it = dir->children.find(components[i]);
+            if (it == dir->children.end()) {
+                if (not create) {
+                    return nullptr;
+                }
+                it = dir->children
+                         .emplace(components[i],
+                                  std::make_unique<ImportNode>())
+                         .first;
+            }
+            if (it->second->type != ObjectType::Tree) {
+                return nullptr;
+            }
+            dir = it->second.get();
+        }
+        return dir;
+    }
+
+    /// \brief Get the entry at the given archive path, if known.
+    [[nodiscard]] auto FindEntry(char const* path) -> ImportNode const* {
+        auto components = SplitEntryPath(path);
+        if (not components or components->empty()) {
+            return nullptr;
+        }
+        auto const* dir = FindDirectory(*components, /*create=*/false);
+        if (dir == nullptr) {
+            return nullptr;
+        }
+        auto it = dir->children.find(components->back());
+        return it == dir->children.end() ? nullptr : it->second.get();
+    }
+
+    /// \brief Read the data of the current entry and write it as a blob.
+    /// Returns nullopt on success, or an error string if failure.
+    [[nodiscard]] auto ReadBlob(
+        archive* a_in,
+        std::size_t size,
+        std::shared_ptr<std::optional<std::string>> const& raw_id,
+        gsl::not_null<TaskSystem*> const& ts) -> std::optional<std::string> {
+        std::optional<std::string> error{};
+        if (size < kStreamBlobThreshold) {
+            std::string content{};
+            content.reserve(size);
+            error = ReadEntryData(
+                a_in, size, [&content](std::string_view chunk) -> bool {
+                    content.append(chunk);
+                    return true;
+                });
+            if (not error) {
+                WriteBuffered(std::move(content), raw_id, ts);
+            }
+            return error;
+        }
+        auto logger = std::make_shared<GitRepo::anon_logger_t>(
+            [&error](auto const& msg, bool fatal) {
+                if (fatal and not error) {
+                    error = fmt::format("ArchiveOps: {}", msg);
+                }
+            });
+        auto id = repo_.WriteBlobStream(
+            size,
+            [a_in, size, &error](GitRepo::BlobChunkSink const& sink) -> bool {
+                error = ReadEntryData(a_in, size, sink);
+                return not error;
+            },
+            logger);
+        if (id) {
+            *raw_id = FromHexString(*id);
+        }
+        return error;
+    }
+
+    /// \brief Write a blob by a worker of the task system. Waits while too
+    /// much content is buffered already.
+    void WriteBuffered(std::string content,
+                       std::shared_ptr<std::optional<std::string>> raw_id,
+                       gsl::not_null<TaskSystem*> const& ts) {
+        auto const size = content.size();
+        {
+            std::unique_lock lock{mutex_};
+            buffer_freed_.wait(lock, [this, size]() {
+                return buffered_bytes_ == 0 or
+                       buffered_bytes_ + size <= kMaxBufferedBlobBytes;
+            });
+            buffered_bytes_ += size;
+        }
+        ts->QueueTask([this,
+                       content = std::move(content),
+                       raw_id = std::move(raw_id)]() {
+            std::optional<std::string> error{};
+            auto logger = std::make_shared<GitRepo::anon_logger_t>(
+                [&error](auto const& msg, bool fatal) {
+                    if (fatal) {
+                        error = msg;
+                    }
+                });
+            if (auto id = repo_.WriteBlob(content, logger)) {
+                *raw_id = FromHexString(*id);
+            }
+            {
+                std::unique_lock lock{mutex_};
+                buffered_bytes_ -= content.size();
+                if (not *raw_id and not write_error_) {
+                    write_error_ = fmt::format(
+                        "ArchiveOps: {}", error.value_or("invalid blob id"));
+                }
+            }
+            buffer_freed_.notify_all();
+        });
+    }
+
+    /// \brief Write the tree of the given directory node, bottom-up.
+    [[nodiscard]] auto WriteTree(ImportNode const& dir)
+        -> expected<std::string, std::string> {
+        GitRepo::tree_entries_t entries{};
+        for (auto const& [name, node] : dir.children) {
+            if (node->type == ObjectType::Tree) {
+                auto raw_id = WriteTree(*node);
+                if (not raw_id) {
+                    return raw_id;
+                }
+                entries[*std::move(raw_id)].emplace_back(name,
+                                                         ObjectType::Tree);
+            }
+            else {
+                if (not node->raw_id or not *node->raw_id) {
+                    return unexpected{fmt::format(
+                        "ArchiveOps: missing blob for entry {}", name)};
+                }
+                entries[**node->raw_id].emplace_back(name, node->type);
+            }
+        }
+        if (auto raw_id = repo_.CreateTree(entries)) {
+            return *std::move(raw_id);
+        }
+        return unexpected{std::string("ArchiveOps: failed to create tree")};
+    }
+};
+
 }  // namespace
 #endif  // BOOTSTRAP_BUILD_TOOL
 
@@ -421,3 +815,69 @@ auto ArchiveOps::ExtractArchive(ArchiveType type,
     }
 #endif  // BOOTSTRAP_BUILD_TOOL
 }
+
+auto ArchiveOps::ImportArchiveToGit(ArchiveType type,
+                                    std::filesystem::path const& source,
+                                    GitCASPtr const& git_cas,
+                                    std::size_t jobs) noexcept
+    -> expected<std::string, std::string> {
+#ifdef BOOTSTRAP_BUILD_TOOL
+    return unexpected{std::string("ArchiveOps: import to Git not supported")};
+#else
+    try {
+        auto repo = GitRepo::Open(git_cas);
+        if (not repo) {
+            return unexpected{
+                std::string("ArchiveOps: failed to open Git repository")};
+        }
+        std::unique_ptr<archive, decltype(&archive_read_closer)> a_in{
+            archive_read_new(), archive_read_closer};
+        if (a_in == nullptr) {
+            return unexpected{
+                std::string("ArchiveOps: archive_read_new failed")};
+        }
+        // enable support for known formats
+        if (auto res = EnableReadFormats(a_in.get(), type)) {
+            return unexpected{*std::move(res)};
+        }
+        // open archive for reading
+        if (archive_read_open_filename(
+                a_in.get(), source.c_str(), kArchiveBlockSize) != ARCHIVE_OK) {
+            return unexpected{std::string("ArchiveOps: ") +
+                              std::string(archive_error_string(a_in.get()))};
+        }
+        ArchiveGitImporter importer{*std::move(repo)};
+        std::optional<std::string> error{};
+        {
+            // all blobs are written when the task system is destroyed
+            TaskSystem ts{std::max(jobs, std::size_t{1})};
+            error = importer.AddEntries(a_in.get(), &ts);
+        }
+        if (error) {
+            return unexpected{*std::move(error)};
+        }
+        auto raw_id = importer.WriteTrees();
+        if (not raw_id) {
+            return raw_id;
+        }
+        return ToHexString(*raw_id);
+    } catch (std::exception const& ex) {
+        return unexpected{fmt::format(
+            "ArchiveOps: import to Git failed with:\n{}", ex.what())};
+    }
+#endif  // BOOTSTRAP_BUILD_TOOL
+}
+
+auto ArchiveOps::ImportArchiveToGit(std::string const& repo_type,
+                                    std::filesystem::path const& source,
+                                    GitCASPtr const& git_cas,
+                                    std::size_t jobs) noexcept
+    -> expected<std::string, std::string> {
+    if (repo_type == "archive") {
+        return ImportArchiveToGit(ArchiveType::TarAuto, source, git_cas, jobs);
+    }
+    if (repo_type == "zip") {
+        return ImportArchiveToGit(ArchiveType::ZipAuto, source, git_cas, jobs);
+    }
+    return unexpected{std::string{"unrecognized repository type"}};
+}
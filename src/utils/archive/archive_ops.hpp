@@ -15,11 +15,15 @@
 #ifndef INCLUDED_SRC_UTILS_ARCHIVE_ARCHIVE_OPS_HPP
 #define INCLUDED_SRC_UTILS_ARCHIVE_ARCHIVE_OPS_HPP
 
+#include <cstddef>
 #include <cstdint>
 #include <filesystem>
 #include <optional>
 #include <string>
 
+#include "src/buildtool/file_system/git_cas.hpp"
+#include "src/utils/cpp/expected.hpp"
+
 extern "C" {
 using archive = struct archive;
 using archive_entry = struct archive_entry;
@@ -81,6 +85,34 @@ class ArchiveOps {
         std::filesystem::path const& destDir) noexcept
         -> std::optional<std::string>;
 
+    /// \brief Import the content of the archive pointed to by source directly
+    /// into the object database of the given Git CAS, without extracting it
+    /// to disk. The resulting tree is the same as when extracting the archive
+    /// and committing the extracted directory. Blobs are compressed and
+    /// written by the given number of parallel jobs, with large blobs being
+    /// streamed, so that memory usage stays bounded. Archives whose extraction
+    /// depends on the file system (special files, paths leaving the
+    /// destination, type conflicts with non-empty directories, hardlinks
+    /// carrying data) are rejected, so that callers can fall back to
+    /// extraction. The tree is not kept alive by any reference.
+    /// Returns the Git identifier of the tree, or an error string if failure.
+    [[nodiscard]] auto static ImportArchiveToGit(
+        ArchiveType type,
+        std::filesystem::path const& source,
+        GitCASPtr const& git_cas,
+        std::size_t jobs) noexcept -> expected<std::string, std::string>;
+
+    /// \brief Import the content of the archive pointed to by source directly
+    /// into the object database of the given Git CAS, with the archive type
+    /// given as repository type: "archive" for any tarball and "zip" for any
+    /// zip-like archive. Returns the Git identifier of the tree, or an error
+    /// string if failure.
+    [[nodiscard]] auto static ImportArchiveToGit(
+        std::string const& repo_type,
+        std::filesystem::path const& source,
+        GitCASPtr const& git_cas,
+        std::size_t jobs) noexcept -> expected<std::string, std::string>;
+
   private:
     /// \brief Copy entry into archive object.
     /// Returns nullopt on success, or an error string if failure.
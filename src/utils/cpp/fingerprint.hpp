@@ -0,0 +1,131 @@
+// Copyright 2026 Huawei Cloud Computing Technology Co., Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef INCLUDED_SRC_UTILS_CPP_FINGERPRINT_HPP
+#define INCLUDED_SRC_UTILS_CPP_FINGERPRINT_HPP
+
+#include <bit>
+#include <compare>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <string>
+#include <string_view>
+
+/// \brief 128-bit non-cryptographic hash, computed by MurmurHash3 (x64
+/// variant). Fast enough to identify and deduplicate in-memory data, but
+/// neither collision resistant against crafted input nor portable between
+/// platforms of different endianness. Hence, it must not be used for anything
+/// persisted or exchanged with other processes; use a cryptographic hash
+/// instead.
+struct Fingerprint final {
+    std::uint64_t high{};
+    std::uint64_t low{};
+
+    /// \brief Compute the fingerprint of the given data.
+    [[nodiscard]] static auto Of(std::string_view data) noexcept
+        -> Fingerprint {
+        static constexpr std::uint64_t kC1 = 0x87c37b91114253d5ULL;
+        static constexpr std::uint64_t kC2 = 0x4cf5ad432745937fULL;
+        auto const mix_k1 = [](std::uint64_t k) {
+            return std::rotl(k * kC1, 31) * kC2;
+        };
+        auto const mix_k2 = [](std::uint64_t k) {
+            return std::rotl(k * kC2, 33) * kC1;
+        };
+
+        std::uint64_t h1 = 0;
+        std::uint64_t h2 = 0;
+        std::size_t const blocks = data.size() / 16;
+        for (std::size_t i = 0; i < blocks; ++i) {
+            std::uint64_t k1{};
+            std::uint64_t k2{};
+            std::memcpy(&k1, data.data() + (i * 16), sizeof(k1));
+            std::memcpy(&k2, data.data() + (i * 16) + 8, sizeof(k2));
+
+            h1 ^= mix_k1(k1);
+            h1 = (std::rotl(h1, 27) + h2) * 5 + 0x52dce729;
+            h2 ^= mix_k2(k2);
+            h2 = (std::rotl(h2, 31) + h1) * 5 + 0x38495ab5;
+        }
+
+        auto const tail = data.substr(blocks * 16);
+        std::uint64_t k1{};
+        std::uint64_t k2{};
+        for (std::size_t i = 0; i < tail.size(); ++i) {
+            auto const byte = static_cast<std::uint64_t>(
+                static_cast<unsigned char>(tail[i]));
+            if (i < 8) {
+                k1 ^= byte << (i * 8);
+            }
+            else {
+                k2 ^= byte << ((i - 8) * 8);
+            }
+        }
+        if (tail.size() > 8) {
+            h2 ^= mix_k2(k2);
+        }
+        if (not tail.empty()) {
+            h1 ^= mix_k1(k1);
+        }
+
+        h1 ^= data.size();
+        h2 ^= data.size();
+        h1 += h2;
+        h2 += h1;
+        h1 = FinalMix(h1);
+        h2 = FinalMix(h2);
+        h1 += h2;
+        h2 += h1;
+        return Fingerprint{.high = h1, .low = h2};
+    }
+
+    /// \brief Append the raw bytes of this fingerprint, e.g., to compute the
+    /// fingerprint of a composite value from the ones of its parts.
+    void AppendTo(std::string* buffer) const {
+        buffer->append(reinterpret_cast<char const*>(&high),  // NOLINT
+                       sizeof(high));
+        buffer->append(reinterpret_cast<char const*>(&low),  // NOLINT
+                       sizeof(low));
+    }
+
+    [[nodiscard]] auto operator==(Fingerprint const& other) const noexcept
+        -> bool = default;
+    [[nodiscard]] auto operator<=>(Fingerprint const& other) const noexcept
+        -> std::strong_ordering = default;
+
+  private:
+    [[nodiscard]] static constexpr auto FinalMix(std::uint64_t k) noexcept
+        -> std::uint64_t {
+        k ^= k >> 33U;
+        k *= 0xff51afd7ed558ccdULL;
+        k ^= k >> 33U;
+        k *= 0xc4ceb9fe1a85ec53ULL;
+        k ^= k >> 33U;
+        return k;
+    }
+};
+
+namespace std {
+template <>
+struct hash<Fingerprint> {
+    [[nodiscard]] auto operator()(Fingerprint const& fp) const noexcept
+        -> std::size_t {
+        return static_cast<std::size_t>(fp.low);
+    }
+};
+}  // namespace std
+
+#endif  // INCLUDED_SRC_UTILS_CPP_FINGERPRINT_HPP
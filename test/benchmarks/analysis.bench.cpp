@@ -0,0 +1,73 @@
+// Copyright 2026 Huawei Cloud Computing Technology Co., Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <cstddef>
+#include <optional>
+#include <thread>
+#include <utility>
+
+#include "catch2/benchmark/catch_benchmark.hpp"
+#include "catch2/catch_test_macros.hpp"
+#include "fmt/core.h"
+#include "nlohmann/json.hpp"
+#include "src/buildtool/build_engine/base_maps/entity_name_data.hpp"
+#include "src/buildtool/build_engine/expression/configuration.hpp"
+#include "src/buildtool/build_engine/expression/expression.hpp"
+#include "src/buildtool/build_engine/target_map/configured_target.hpp"
+#include "src/buildtool/common/repository_config.hpp"
+#include "src/buildtool/common/statistics.hpp"
+#include "src/buildtool/file_system/file_root.hpp"
+#include "src/buildtool/main/analyse.hpp"
+#include "src/buildtool/main/analyse_context.hpp"
+#include "src/buildtool/progress_reporting/progress.hpp"
+#include "src/buildtool/storage/storage.hpp"
+#include "test/benchmarks/workloads.hpp"
+#include "test/utils/hermeticity/test_storage_config.hpp"
+
+TEST_CASE("Analysis: generated target graphs", "[analyse]") {
+    auto const storage_config = TestStorageConfig::Create();
+    auto const storage = Storage::Create(&storage_config.Get());
+
+    for (auto const [targets, depth] :
+         {std::pair<std::size_t, std::size_t>{1000, 10}, {5000, 50}}) {
+        auto const tmp_dir = Workloads::CreateTmpDir();
+        REQUIRE(tmp_dir);
+        REQUIRE(Workloads::GenerateTargetsGraph(
+            tmp_dir->GetPath(), targets, depth));
+
+        RepositoryConfig repo_config{};
+        repo_config.SetInfo(
+            "",
+            RepositoryConfig::RepositoryInfo{FileRoot{tmp_dir->GetPath()}});
+        auto const id = BuildMaps::Target::ConfiguredTarget{
+            .target = BuildMaps::Base::EntityName{"", ".", ""},
+            .config = Configuration{Expression::FromJson(R"({})"_json)}};
+
+        // Every run analyses from scratch, including reading TARGETS files.
+        BENCHMARK(fmt::format("AnalyseTarget, N={}, D={}", targets, depth)) {
+            Statistics stats{};
+            Progress progress{};
+            AnalyseContext ctx{.repo_config = &repo_config,
+                               .storage = &storage,
+                               .statistics = &stats,
+                               .progress = &progress};
+            auto result = AnalyseTarget(&ctx,
+                                        id,
+                                        std::thread::hardware_concurrency(),
+                                        /*request_action_input=*/std::nullopt);
+            REQUIRE(result);
+            return result->target;
+        };
+    }
+}
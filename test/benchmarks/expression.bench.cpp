@@ -0,0 +1,100 @@
+// Copyright 2026 Huawei Cloud Computing Technology Co., Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <cstddef>
+#include <string>
+
+#include "catch2/benchmark/catch_benchmark.hpp"
+#include "catch2/catch_test_macros.hpp"
+#include "fmt/core.h"
+#include "nlohmann/json.hpp"
+#include "src/buildtool/build_engine/expression/configuration.hpp"
+#include "src/buildtool/build_engine/expression/expression.hpp"
+#include "src/buildtool/build_engine/expression/expression_ptr.hpp"
+#include "src/buildtool/build_engine/expression/function_map.hpp"
+
+namespace {
+
+/// \brief Map of N keys, built by a foreach over a range.
+[[nodiscard]] auto MapExpression(std::size_t size) -> nlohmann::json {
+    return nlohmann::json{
+        {"type", "map_union"},
+        {"$1",
+         {{"type", "foreach"},
+          {"var", "x"},
+          {"range", {{"type", "range"}, {"$1", size}}},
+          {"body",
+           {{"type", "singleton_map"},
+            {"key", {{"type", "var"}, {"name", "x"}}},
+            {"value", {{"type", "var"}, {"name", "y"}}}}}}}};
+}
+
+/// \brief Chain of D bindings, each depending on the previous one.
+[[nodiscard]] auto LetExpression(std::size_t depth) -> nlohmann::json {
+    auto bindings = nlohmann::json::array();
+    bindings.push_back(nlohmann::json::array({"v0", 0}));
+    for (std::size_t i = 1; i <= depth; ++i) {
+        auto sum = nlohmann::json{
+            {"type", "+"},
+            {"$1",
+             nlohmann::json::array(
+                 {{{"type", "var"}, {"name", fmt::format("v{}", i - 1)}},
+                  1})}};
+        bindings.push_back(
+            nlohmann::json::array({fmt::format("v{}", i), std::move(sum)}));
+    }
+    return nlohmann::json{
+        {"type", "let*"},
+        {"bindings", std::move(bindings)},
+        {"body", {{"type", "var"}, {"name", fmt::format("v{}", depth)}}}};
+}
+
+}  // namespace
+
+TEST_CASE("Expression: evaluate", "[expression]") {
+    static constexpr std::size_t kSize = 10000;
+    static constexpr std::size_t kDepth = 1000;
+
+    auto const env =
+        Configuration{Expression::FromJson(R"({"y": "value"})"_json)};
+    auto const fcts = FunctionMapPtr{};
+
+    auto const map_expr = Expression::FromJson(MapExpression(kSize));
+    REQUIRE(map_expr);
+    auto const map = map_expr.Evaluate(env, fcts);
+    REQUIRE(map);
+    REQUIRE(map->IsMap());
+    CHECK(map->Map().size() == kSize);
+
+    auto const let_expr = Expression::FromJson(LetExpression(kDepth));
+    REQUIRE(let_expr);
+    auto const number = let_expr.Evaluate(env, fcts);
+    REQUIRE(number);
+    REQUIRE(number->IsNumber());
+    CHECK(number->Number() == static_cast<double>(kDepth));
+
+    BENCHMARK(fmt::format("Evaluate foreach and map_union, N={}", kSize)) {
+        return map_expr.Evaluate(env, fcts);
+    };
+
+    BENCHMARK(fmt::format("Evaluate let*, D={}", kDepth)) {
+        return let_expr.Evaluate(env, fcts);
+    };
+
+    auto const map_json = map->ToJson();
+    BENCHMARK(fmt::format("FromJson and ToHash, N={}", kSize)) {
+        auto const expr = Expression::FromJson(map_json);
+        return expr->ToHash();
+    };
+}
@@ -0,0 +1,39 @@
+// Copyright 2026 Huawei Cloud Computing Technology Co., Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <cstddef>
+#include <filesystem>
+
+#include "catch2/benchmark/catch_benchmark.hpp"
+#include "catch2/catch_test_macros.hpp"
+#include "src/buildtool/storage/file_chunker.hpp"
+#include "test/benchmarks/workloads.hpp"
+
+TEST_CASE("FileChunker: split file", "[file_chunker]") {
+    static constexpr std::size_t kFileSize = std::size_t{16} << 20U;
+
+    auto const tmp_dir = Workloads::CreateTmpDir();
+    REQUIRE(tmp_dir);
+    auto const file = tmp_dir->GetPath() / "large";
+    REQUIRE(Workloads::GenerateFile(file, kFileSize, 0));
+
+    BENCHMARK("NextChunk, 16 MiB") {
+        FileChunker chunker{file};
+        std::size_t chunks = 0;
+        while (chunker.NextChunk()) {
+            ++chunks;
+        }
+        return chunks;
+    };
+}
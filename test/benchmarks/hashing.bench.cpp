@@ -0,0 +1,47 @@
+// Copyright 2026 Huawei Cloud Computing Technology Co., Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <cstddef>
+#include <filesystem>
+#include <string>
+
+#include "catch2/benchmark/catch_benchmark.hpp"
+#include "catch2/catch_test_macros.hpp"
+#include "fmt/core.h"
+#include "src/buildtool/crypto/hash_function.hpp"
+#include "test/benchmarks/workloads.hpp"
+
+TEST_CASE("HashFunction: hash blobs", "[crypto]") {
+    static constexpr std::size_t kDataSize = std::size_t{1} << 20U;  // 1 MiB
+    static constexpr std::size_t kFileSize = std::size_t{16} << 20U;
+
+    auto const tmp_dir = Workloads::CreateTmpDir();
+    REQUIRE(tmp_dir);
+    auto const file = tmp_dir->GetPath() / "blob";
+    REQUIRE(Workloads::GenerateFile(file, kFileSize, 0));
+    auto const data = Workloads::GenerateContent(kDataSize, 1);
+
+    for (auto const type :
+         {HashFunction::Type::GitSHA1, HashFunction::Type::PlainSHA256}) {
+        HashFunction const hash_function{type};
+
+        BENCHMARK(fmt::format("HashBlobData {}, 1 MiB", ToString(type))) {
+            return hash_function.HashBlobData(data);
+        };
+
+        BENCHMARK(fmt::format("HashBlobFile {}, 16 MiB", ToString(type))) {
+            return hash_function.HashBlobFile(file);
+        };
+    }
+}
@@ -0,0 +1,96 @@
+// Copyright 2026 Huawei Cloud Computing Technology Co., Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <string>
+#include <utility>
+
+#include "catch2/benchmark/detail/catch_benchmark_stats.hpp"
+#include "catch2/catch_session.hpp"
+#include "catch2/catch_test_case_info.hpp"
+#include "catch2/reporters/catch_reporter_registrars.hpp"
+#include "catch2/reporters/catch_reporter_streaming_base.hpp"
+#include "nlohmann/json.hpp"
+#include "src/buildtool/file_system/git_context.hpp"
+#include "src/buildtool/storage/file_chunker.hpp"
+#include "test/utils/logging/log_config.hpp"
+
+namespace {
+
+/// \brief Reporter emitting the statistics of all benchmarks as a single JSON
+/// object, so that results of different commits can be compared by
+/// bin/compare-benchmarks.py. All durations are given in nanoseconds.
+class BenchmarkJsonReporter final : public Catch::StreamingReporterBase {
+  public:
+    using StreamingReporterBase::StreamingReporterBase;
+
+    [[nodiscard]] static auto getDescription() -> std::string {
+        return "Reports benchmark statistics as JSON";
+    }
+
+    void testCaseStarting(Catch::TestCaseInfo const& info) override {
+        StreamingReporterBase::testCaseStarting(info);
+        test_case_ = info.name;
+    }
+
+    void benchmarkEnded(Catch::BenchmarkStats<> const& stats) override {
+        auto const estimate = [](auto const& e) {
+            return nlohmann::json{{"point", e.point.count()},
+                                  {"lower_bound", e.lower_bound.count()},
+                                  {"upper_bound", e.upper_bound.count()}};
+        };
+        benchmarks_.push_back(
+            {{"test_case", test_case_},
+             {"name", stats.info.name},
+             {"samples", stats.info.samples},
+             {"iterations", stats.info.iterations},
+             {"mean", estimate(stats.mean)},
+             {"standard_deviation", estimate(stats.standardDeviation)},
+             {"outlier_variance", stats.outlierVariance}});
+    }
+
+    void testCaseEnded(Catch::TestCaseStats const& stats) override {
+        if (stats.totals.assertions.failed > 0) {
+            failed_.push_back(test_case_);
+        }
+        StreamingReporterBase::testCaseEnded(stats);
+    }
+
+    void testRunEnded(Catch::TestRunStats const& stats) override {
+        nlohmann::json result{{"benchmarks", std::move(benchmarks_)},
+                              {"failed", std::move(failed_)}};
+        m_stream << result.dump(2) << '\n';
+        StreamingReporterBase::testRunEnded(stats);
+    }
+
+  private:
+    std::string test_case_;
+    nlohmann::json benchmarks_ = nlohmann::json::array();
+    nlohmann::json failed_ = nlohmann::json::array();
+};
+
+}  // namespace
+
+CATCH_REGISTER_REPORTER("benchmark-json", BenchmarkJsonReporter)
+
+auto main(int argc, char* argv[]) -> int {
+    ConfigureLogging();
+
+    // See test/main.cpp.
+    GitContext::Create();
+
+    // Initialize random content of the file chunker's map.
+    FileChunker::Initialize();
+
+    return Catch::Session().run(argc, argv);
+}
@@ -0,0 +1,115 @@
+// Copyright 2026 Huawei Cloud Computing Technology Co., Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "catch2/benchmark/catch_benchmark.hpp"
+#include "catch2/catch_test_macros.hpp"
+#include "fmt/core.h"
+#include "src/buildtool/multithreading/async_map_consumer.hpp"
+#include "src/buildtool/multithreading/task_system.hpp"
+
+TEST_CASE("TaskSystem: throughput", "[task_system]") {
+    static constexpr std::size_t kTasks = 100000;
+    static constexpr std::size_t kDepth = 16;  // 2^17 - 1 tasks
+
+    BENCHMARK(fmt::format("QueueTask from outside, N={}", kTasks)) {
+        std::atomic<std::size_t> counter{};
+        {
+            TaskSystem ts;
+            for (std::size_t i = 0; i < kTasks; ++i) {
+                ts.QueueTask([&counter]() { ++counter; });
+            }
+        }
+        return counter.load();
+    };
+
+    BENCHMARK(fmt::format("QueueTask from workers, depth {}", kDepth)) {
+        std::atomic<std::size_t> counter{};
+        std::function<void(std::size_t)> spawn{};
+        {
+            TaskSystem ts;
+            spawn = [&ts, &counter, &spawn](std::size_t level) {
+                ts.QueueTask([&spawn, &counter, level]() {
+                    ++counter;
+                    if (level > 0) {
+                        spawn(level - 1);
+                        spawn(level - 1);
+                    }
+                });
+            };
+            spawn(kDepth);
+        }
+        return counter.load();
+    };
+}
+
+TEST_CASE("AsyncMapConsumer: fan-out", "[async_map_consumer]") {
+    static constexpr std::size_t kFanOut = 8;
+    static constexpr std::size_t kKeys = 100000;
+
+    // Key k depends on keys k * kFanOut + 1, ..., k * kFanOut + kFanOut and
+    // its value is the number of keys in the so-spanned tree.
+    auto value_creator = [](auto /*unused*/,
+                            auto setter,
+                            auto logger,
+                            auto subcaller,
+                            auto const& key) {
+        std::vector<std::size_t> children{};
+        for (std::size_t i = 1; i <= kFanOut and key * kFanOut + i < kKeys;
+             ++i) {
+            children.emplace_back(key * kFanOut + i);
+        }
+        if (children.empty()) {
+            (*setter)(std::size_t{1});
+            return;
+        }
+        (*subcaller)(
+            children,
+            [setter](auto const& values) {
+                std::size_t size = 1;
+                for (auto const* value : values) {
+                    size += *value;
+                }
+                (*setter)(std::move(size));
+            },
+            logger);
+    };
+
+    BENCHMARK(fmt::format("ConsumeAfterKeysReady, fan-out {}, N={}",
+                          kFanOut,
+                          kKeys)) {
+        AsyncMapConsumer<std::size_t, std::size_t> map{value_creator};
+        std::size_t result{};
+        bool failed = false;
+        {
+            TaskSystem ts;
+            map.ConsumeAfterKeysReady(
+                &ts,
+                {0},
+                [&result](auto const& values) { result = *values[0]; },
+                [&failed](std::string const& /*unused*/, bool /*unused*/) {
+                    failed = true;
+                });
+        }
+        CHECK(not failed);
+        CHECK(result == kKeys);
+        return result;
+    };
+}
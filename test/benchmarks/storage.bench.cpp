@@ -0,0 +1,109 @@
+// Copyright 2026 Huawei Cloud Computing Technology Co., Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "catch2/benchmark/catch_benchmark.hpp"
+#include "catch2/catch_test_macros.hpp"
+#include "fmt/core.h"
+#include "src/buildtool/common/artifact_digest.hpp"
+#include "src/buildtool/common/artifact_digest_factory.hpp"
+#include "src/buildtool/file_system/object_type.hpp"
+#include "src/buildtool/storage/config.hpp"
+#include "src/buildtool/storage/storage.hpp"
+#include "test/benchmarks/workloads.hpp"
+#include "test/utils/hermeticity/test_storage_config.hpp"
+
+TEST_CASE("LocalCAS: store and look up blobs", "[storage]") {
+    static constexpr std::size_t kBlobCount = 1000;
+    static constexpr std::size_t kBlobSize = 1024;
+
+    auto const storage_config = TestStorageConfig::Create();
+    auto const storage = Storage::Create(&storage_config.Get());
+    auto const& cas = storage.CAS();
+
+    auto const blobs = Workloads::GenerateBlobs(kBlobCount, kBlobSize, 0);
+    std::vector<ArtifactDigest> digests{};
+    digests.reserve(blobs.size());
+    for (auto const& blob : blobs) {
+        auto digest = cas.StoreBlob(blob, /*is_executable=*/false);
+        REQUIRE(digest);
+        digests.emplace_back(*std::move(digest));
+    }
+
+    // Every run stores blobs not yet present in the CAS.
+    std::uint32_t seed = kBlobCount;
+    BENCHMARK_ADVANCED(fmt::format("StoreBlob new, M={}", kBlobCount))
+    (Catch::Benchmark::Chronometer meter) {
+        std::vector<std::vector<std::string>> fresh{};
+        fresh.reserve(static_cast<std::size_t>(meter.runs()));
+        for (int i = 0; i < meter.runs(); ++i) {
+            fresh.emplace_back(
+                Workloads::GenerateBlobs(kBlobCount, kBlobSize, seed));
+            seed += kBlobCount;
+        }
+        meter.measure([&cas, &fresh](int i) {
+            std::size_t stored = 0;
+            for (auto const& blob : fresh[static_cast<std::size_t>(i)]) {
+                stored += cas.StoreBlob(blob, /*is_executable=*/false) ? 1 : 0;
+            }
+            return stored;
+        });
+    };
+
+    BENCHMARK(fmt::format("StoreBlob existing, M={}", kBlobCount)) {
+        std::size_t stored = 0;
+        for (auto const& blob : blobs) {
+            stored += cas.StoreBlob(blob, /*is_executable=*/false) ? 1 : 0;
+        }
+        return stored;
+    };
+
+    BENCHMARK(fmt::format("BlobPath, M={}", kBlobCount)) {
+        std::size_t found = 0;
+        for (auto const& digest : digests) {
+            found += cas.BlobPath(digest, /*is_executable=*/false) ? 1 : 0;
+        }
+        return found;
+    };
+
+    BENCHMARK(fmt::format("BlobPath executable, M={}", kBlobCount)) {
+        std::size_t found = 0;
+        for (auto const& digest : digests) {
+            found += cas.BlobPath(digest, /*is_executable=*/true) ? 1 : 0;
+        }
+        return found;
+    };
+
+    std::vector<ArtifactDigest> missing{};
+    missing.reserve(kBlobCount);
+    for (std::size_t i = 0; i < kBlobCount; ++i) {
+        missing.emplace_back(
+            ArtifactDigestFactory::HashDataAs<ObjectType::File>(
+                storage_config.Get().hash_function,
+                fmt::format("missing-{}", i)));
+    }
+    BENCHMARK(fmt::format("BlobPath missing, M={}", kBlobCount)) {
+        std::size_t found = 0;
+        for (auto const& digest : missing) {
+            found += cas.BlobPath(digest, /*is_executable=*/false) ? 1 : 0;
+        }
+        return found;
+    };
+}
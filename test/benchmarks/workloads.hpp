@@ -0,0 +1,143 @@
+// Copyright 2026 Huawei Cloud Computing Technology Co., Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef INCLUDED_SRC_TEST_BENCHMARKS_WORKLOADS_HPP
+#define INCLUDED_SRC_TEST_BENCHMARKS_WORKLOADS_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>  // std::getenv
+#include <filesystem>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "fmt/core.h"
+#include "nlohmann/json.hpp"
+#include "src/buildtool/file_system/file_system_manager.hpp"
+#include "src/utils/cpp/tmp_dir.hpp"
+
+/// \brief Synthetic workloads for the benchmarks. All content is derived from
+/// a seed, so that results are comparable between commits and machines.
+namespace Workloads {
+
+/// \brief Create a fresh directory under the test-local temporary directory.
+[[nodiscard]] static inline auto CreateTmpDir() noexcept -> TmpDir::Ptr {
+    char const* const env_tmpdir = std::getenv("TEST_TMPDIR");
+    if (env_tmpdir == nullptr) {
+        return nullptr;
+    }
+    return TmpDir::Create(std::filesystem::path{env_tmpdir} / "workloads");
+}
+
+/// \brief Generate random content of the given size.
+[[nodiscard]] static inline auto GenerateContent(std::size_t size,
+                                                 std::uint32_t seed)
+    -> std::string {
+    std::mt19937 rng{seed};
+    std::uniform_int_distribution<int> dist{0, 255};
+    std::string content(size, '\0');
+    for (auto& c : content) {
+        c = static_cast<char>(dist(rng));
+    }
+    return content;
+}
+
+/// \brief Generate pairwise different blobs of the given size.
+[[nodiscard]] static inline auto GenerateBlobs(std::size_t count,
+                                               std::size_t size,
+                                               std::uint32_t seed)
+    -> std::vector<std::string> {
+    std::vector<std::string> blobs{};
+    blobs.reserve(count);
+    for (std::size_t i = 0; i < count; ++i) {
+        // The index makes blobs different even if the random content is not.
+        auto blob = fmt::format("{}:", i);
+        blob += GenerateContent(size - std::min(size, blob.size()),
+                                seed + static_cast<std::uint32_t>(i));
+        blobs.emplace_back(std::move(blob));
+    }
+    return blobs;
+}
+
+/// \brief Write a file of random content of the given size.
+[[nodiscard]] static inline auto GenerateFile(std::filesystem::path const& path,
+                                              std::size_t size,
+                                              std::uint32_t seed) -> bool {
+    return FileSystemManager::WriteFile(GenerateContent(size, seed), path);
+}
+
+/// \brief Generate a target graph with the given number of targets arranged
+/// in the given number of layers below a root target. Each layer is a module
+/// "layer<N>" and every target depends on two targets of the next layer.
+/// Targets are of the built-in type "generic", so that no rule files are
+/// needed. The root target is the default target of the top-level module.
+/// \param root     Directory to write the TARGETS files to.
+/// \param targets  Number of targets, excluding the root target.
+/// \param depth    Number of layers.
+[[nodiscard]] static inline auto GenerateTargetsGraph(
+    std::filesystem::path const& root,
+    std::size_t targets,
+    std::size_t depth) -> bool {
+    if (depth == 0 or targets < depth) {
+        return false;
+    }
+    // The last layer takes the remainder.
+    auto const width = targets / depth;
+    auto layer_size = [targets, depth, width](std::size_t layer) {
+        return layer + 1 < depth ? width : targets - (width * (depth - 1));
+    };
+    for (std::size_t layer = 0; layer < depth; ++layer) {
+        auto const module = fmt::format("layer{}", layer);
+        auto const size = layer_size(layer);
+        auto desc = nlohmann::json::object();
+        for (std::size_t i = 0; i < size; ++i) {
+            auto const out = fmt::format("{}_t{}.txt", module, i);
+            auto target = nlohmann::json{
+                {"type", "generic"},
+                {"outs", nlohmann::json::array({out})},
+                {"cmds",
+                 nlohmann::json::array({fmt::format("echo {} > {}", i, out)})}};
+            if (layer + 1 < depth) {
+                auto const next = layer_size(layer + 1);
+                auto const next_module = fmt::format("layer{}", layer + 1);
+                auto deps = nlohmann::json::array();
+                for (std::size_t j = 0; j < std::min(next, std::size_t{2});
+                     ++j) {
+                    deps.push_back(nlohmann::json::array(
+                        {next_module, fmt::format("t{}", (i + j) % next)}));
+                }
+                target["deps"] = std::move(deps);
+            }
+            desc[fmt::format("t{}", i)] = std::move(target);
+        }
+        if (not FileSystemManager::WriteFile(desc.dump(),
+                                             root / module / "TARGETS")) {
+            return false;
+        }
+    }
+    auto deps = nlohmann::json::array();
+    for (std::size_t i = 0; i < layer_size(0); ++i) {
+        deps.push_back(
+            nlohmann::json::array({"layer0", fmt::format("t{}", i)}));
+    }
+    auto top = nlohmann::json{{"", {{"type", "install"}, {"deps", deps}}}};
+    return FileSystemManager::WriteFile(top.dump(), root / "TARGETS");
+}
+
+}  // namespace Workloads
+
+#endif  // INCLUDED_SRC_TEST_BENCHMARKS_WORKLOADS_HPP
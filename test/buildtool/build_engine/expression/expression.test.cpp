@@ -2133,3 +2133,65 @@ TEST_CASE("Expression hash computation", "[expression]") {
         }
     }
 }
+
+TEST_CASE("Expression fingerprint computation", "[expression]") {
+    using namespace std::string_literals;
+    using path = std::filesystem::path;
+    using number_t = Expression::number_t;
+    using result_t = Expression::result_t;
+    using list_t = Expression::list_t;
+    using map_t = Expression::map_t;
+
+    auto number = ExpressionPtr{number_t{}};
+    auto string = ExpressionPtr{"0"s};
+    auto artifact = ExpressionPtr{ArtifactDescription::CreateTree(path{""})};
+    auto artifact_json = Expression::FromJson(artifact->ToJson());
+    auto exprs = std::vector<ExpressionPtr>{
+        ExpressionPtr{},
+        ExpressionPtr{false},
+        ExpressionPtr{true},
+        number,
+        ExpressionPtr{number_t{-0.0}},
+        ExpressionPtr{number_t{1}},
+        string,
+        ExpressionPtr{""s},
+        artifact,
+        artifact_json,
+        ExpressionPtr{ArtifactDescription::CreateTree(path{" "})},
+        ExpressionPtr{result_t{}},
+        ExpressionPtr{
+            result_t{.artifact_stage = number, .provides = {}, .runfiles = {}}},
+        ExpressionPtr{list_t{}},
+        ExpressionPtr{list_t{number}},
+        ExpressionPtr{list_t{string}},
+        ExpressionPtr{list_t{number, string}},
+        ExpressionPtr{list_t{string, number}},
+        ExpressionPtr{list_t{ExpressionPtr{list_t{number}}}},
+        ExpressionPtr{map_t{}},
+        ExpressionPtr{map_t{{""s, number}}},
+        ExpressionPtr{map_t{{"0"s, number}}},
+        ExpressionPtr{map_t{{"0"s, string}}},
+        Expression::FromJson(R"({"0": 0, "1": 0})"_json),
+        Expression::FromJson(R"({"a": {"b": 0}})"_json),
+        Expression::FromJson(R"({"a": [0, "0"]})"_json)};
+
+    // The fingerprint is deterministic within the process.
+    auto const same = Expression::FromJson(R"({"a": [0, "0"]})"_json);
+    CHECK(same->ToFingerprint() == exprs.back()->ToFingerprint());
+    CHECK(Expression{ArtifactDescription::CreateTree(path{""})}
+              .ToFingerprint() == artifact->ToFingerprint());
+
+    // Distinct instances of equal values are equal, without their hashes.
+    CHECK(same == exprs.back());
+    CHECK(Expression::FromJson(R"({"0": 0, "1": 0})"_json) ==
+          exprs.at(exprs.size() - 3));
+
+    // Fingerprints distinguish expressions exactly as the stable hash does.
+    for (auto const& l : exprs) {
+        for (auto const& r : exprs) {
+            CHECK((l->ToFingerprint() == r->ToFingerprint()) ==
+                  (l->ToHash() == r->ToHash()));
+            CHECK((l == r) == (&l == &r));
+        }
+    }
+}
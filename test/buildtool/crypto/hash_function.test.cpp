@@ -14,12 +14,29 @@
 
 #include "src/buildtool/crypto/hash_function.hpp"
 
+#include <cstddef>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
 #include <string>
 #include <utility>  // std::move
 
 #include "catch2/catch_test_macros.hpp"
+#include "catch2/generators/catch_generators_all.hpp"
 #include "src/buildtool/crypto/hasher.hpp"
 
+namespace {
+
+[[nodiscard]] auto GetTestDir() -> std::filesystem::path {
+    auto* tmp_dir = std::getenv("TEST_TMPDIR");
+    if (tmp_dir != nullptr) {
+        return tmp_dir;
+    }
+    return std::filesystem::current_path();
+}
+
+}  // namespace
+
 TEST_CASE("Hash Function", "[crypto]") {
     std::string bytes{"test"};
 
@@ -63,3 +80,38 @@ TEST_CASE("Hash Function", "[crypto]") {
             "9f86d081884c7d659a2feaa0c55ad015a3bf4f1b2b0b822cd15d6c15b0f00a08");
     }
 }
+
+TEST_CASE("Hash File", "[crypto]") {
+    auto const hash_type = GENERATE(HashFunction::Type::GitSHA1,
+                                    HashFunction::Type::PlainSHA256);
+    HashFunction const hash_function{hash_type};
+
+    // cover empty, small, and large files (with multiple windows)
+    auto const size = GENERATE(std::size_t{0},
+                               std::size_t{100'000},
+                               std::size_t{40} << 20U);
+    std::string content(size, '\0');
+    for (std::size_t i = 0; i < size; ++i) {
+        content[i] = static_cast<char>(i * 7 % 251);
+    }
+
+    auto const path = GetTestDir() / "hash_function_test_file";
+    {
+        std::ofstream out{path, std::ios::binary};
+        out << content;
+    }
+
+    auto const blob = hash_function.HashBlobFile(path);
+    REQUIRE(blob.has_value());
+    CHECK(blob->first.HexString() ==
+          hash_function.HashBlobData(content).HexString());
+    CHECK(blob->second == size);
+
+    auto const tree = hash_function.HashTreeFile(path);
+    REQUIRE(tree.has_value());
+    CHECK(tree->first.HexString() ==
+          hash_function.HashTreeData(content).HexString());
+
+    std::filesystem::remove(path);
+    CHECK_FALSE(hash_function.HashBlobFile(path).has_value());
+}
@@ -14,18 +14,38 @@
 
 #include "src/buildtool/execution_api/remote/bazel/bazel_api.hpp"
 
+#include <cstddef>
+#include <cstdlib>
+#include <map>
+#include <mutex>
 #include <optional>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
 #include <utility>
+#include <vector>
 
 #include "catch2/catch_test_macros.hpp"
+#include "fmt/core.h"
 #include "gsl/gsl"
 #include "src/buildtool/auth/authentication.hpp"
+#include "src/buildtool/common/artifact.hpp"
+#include "src/buildtool/common/artifact_blob.hpp"
+#include "src/buildtool/common/artifact_digest.hpp"
 #include "src/buildtool/common/remote/remote_common.hpp"
 #include "src/buildtool/common/remote/retry_config.hpp"
 #include "src/buildtool/crypto/hash_function.hpp"
 #include "src/buildtool/execution_api/common/execution_api.hpp"
+#include "src/buildtool/execution_api/common/message_limits.hpp"
+#include "src/buildtool/execution_api/common/tree_reader.hpp"
+#include "src/buildtool/execution_api/local/config.hpp"
+#include "src/buildtool/execution_api/local/context.hpp"
+#include "src/buildtool/execution_api/local/local_api.hpp"
+#include "src/buildtool/execution_api/local/local_cas_reader.hpp"
 #include "src/buildtool/execution_api/remote/config.hpp"
+#include "src/buildtool/file_system/object_type.hpp"
 #include "src/buildtool/storage/config.hpp"
+#include "src/buildtool/storage/storage.hpp"
 #include "src/utils/cpp/tmp_dir.hpp"
 #include "test/buildtool/execution_api/common/api_test.hpp"
 #include "test/utils/hermeticity/test_storage_config.hpp"
@@ -65,6 +85,110 @@ class FactoryApi final {
     TmpDir::Ptr temp_space_;
 };
 
+/// \brief Api forwarding uploads to another api and recording the digests
+/// uploaded by each call. Optionally, one of the calls fails instead.
+class RecordingApi final : public IExecutionApi {
+  public:
+    explicit RecordingApi(gsl::not_null<IExecutionApi const*> const& api,
+                          std::optional<std::size_t> fail_at = std::nullopt)
+        : api_{*api}, fail_at_{fail_at} {}
+
+    [[nodiscard]] auto CreateAction(
+        ArtifactDigest const& /*root_digest*/,
+        std::vector<std::string> const& /*command*/,
+        std::string const& /*cwd*/,
+        std::vector<std::string> const& /*output_files*/,
+        std::vector<std::string> const& /*output_dirs*/,
+        std::map<std::string, std::string> const& /*env_vars*/,
+        std::map<std::string, std::string> const& /*properties*/,
+        bool /*force_legacy*/) const noexcept -> IExecutionAction::Ptr final {
+        return nullptr;
+    }
+
+    [[nodiscard]] auto RetrieveToPaths(
+        std::vector<Artifact::ObjectInfo> const& /*artifacts_info*/,
+        std::vector<std::filesystem::path> const& /*output_paths*/,
+        IExecutionApi const* /*alternative*/) const noexcept -> bool final {
+        return false;
+    }
+
+    [[nodiscard]] auto RetrieveToFds(
+        std::vector<Artifact::ObjectInfo> const& /*artifacts_info*/,
+        std::vector<int> const& /*fds*/,
+        bool /*raw_tree*/,
+        IExecutionApi const* /*alternative*/) const noexcept -> bool final {
+        return false;
+    }
+
+    [[nodiscard]] auto RetrieveToCas(
+        std::vector<Artifact::ObjectInfo> const& /*artifacts_info*/,
+        IExecutionApi const& /*api*/) const noexcept -> bool final {
+        return false;
+    }
+
+    [[nodiscard]] auto RetrieveToMemory(
+        Artifact::ObjectInfo const& /*artifact_info*/) const noexcept
+        -> std::optional<std::string> final {
+        return std::nullopt;
+    }
+
+    [[nodiscard]] auto Upload(std::unordered_set<ArtifactBlob>&& blobs,
+                              bool skip_find_missing) const noexcept
+        -> bool final {
+        {
+            std::unique_lock lock{mutex_};
+            if (uploads_.size() == fail_at_) {
+                uploads_.emplace_back();
+                return false;
+            }
+            auto& digests = uploads_.emplace_back();
+            for (auto const& blob : blobs) {
+                digests.emplace_back(blob.GetDigest());
+            }
+        }
+        return api_.Upload(std::move(blobs), skip_find_missing);
+    }
+
+    [[nodiscard]] auto UploadTree(
+        std::vector<DependencyGraph::NamedArtifactNodePtr> const& /*artifacts*/)
+        const noexcept -> std::optional<ArtifactDigest> final {
+        return std::nullopt;
+    }
+
+    [[nodiscard]] auto IsAvailable(ArtifactDigest const& digest) const noexcept
+        -> bool final {
+        return api_.IsAvailable(digest);
+    }
+
+    [[nodiscard]] auto GetMissingDigests(
+        std::unordered_set<ArtifactDigest> const& digests) const noexcept
+        -> std::unordered_set<ArtifactDigest> final {
+        return api_.GetMissingDigests(digests);
+    }
+
+    [[nodiscard]] auto GetHashType() const noexcept
+        -> HashFunction::Type final {
+        return api_.GetHashType();
+    }
+
+    [[nodiscard]] auto GetTempSpace() const noexcept -> TmpDir::Ptr final {
+        return api_.GetTempSpace();
+    }
+
+    /// \brief Digests uploaded by each call, in the order of the calls.
+    [[nodiscard]] auto Uploads() const
+        -> std::vector<std::vector<ArtifactDigest>> {
+        std::unique_lock lock{mutex_};
+        return uploads_;
+    }
+
+  private:
+    IExecutionApi const& api_;
+    std::optional<std::size_t> fail_at_;
+    mutable std::mutex mutex_;
+    mutable std::vector<std::vector<ArtifactDigest>> uploads_;
+};
+
 }  // namespace
 
 TEST_CASE("BazelAPI: No input, no output", "[execution_api]") {
@@ -242,3 +366,124 @@ TEST_CASE("BazelAPI: Run in different output path modes", "[execution_api]") {
         storage_config.Get().CreateTypedTmpDir("test_space")};
     TestOutputPathModes(api_factory, remote_config->platform_properties);
 }
+
+TEST_CASE("BazelAPI: Parallel retrieval to another CAS", "[execution_api]") {
+    auto storage_config = TestStorageConfig::Create();
+    auto remote_config = TestRemoteConfig::ReadFromEnvironment();
+
+    REQUIRE(remote_config);
+    REQUIRE(remote_config->remote_address);
+    auto auth = TestAuthConfig::ReadFromEnvironment();
+    REQUIRE(auth);
+
+    FactoryApi api_factory{
+        &*remote_config->remote_address,
+        &*auth,
+        storage_config.Get().hash_function,
+        storage_config.Get().CreateTypedTmpDir("test_space")};
+    auto api = api_factory();
+
+    // create a tree with nested trees and files not fitting into one batch
+    static constexpr std::size_t kFileSize = 1024UL * 1024;
+    static constexpr std::size_t kLargeFiles = 5;
+    static_assert(kLargeFiles * kFileSize > MessageLimits::kMaxGrpcLength);
+    auto cmd = std::string{
+        "set -e\nmkdir -p out/sub/subsub\n"
+        "echo -n foo > out/sub/subsub/foo\necho -n bar > out/sub/bar\n"};
+    for (std::size_t i = 0; i < kLargeFiles; ++i) {
+        cmd += fmt::format(
+            "head -c {} /dev/urandom > out/sub/large{}\n", kFileSize, i);
+    }
+
+    auto* path = std::getenv("PATH");
+    std::map<std::string, std::string> env{};
+    if (path != nullptr) {
+        env.emplace("PATH", path);
+    }
+
+    auto action = api->CreateAction(*api->UploadTree({}),
+                                    {"/bin/sh", "-c", cmd},
+                                    "",
+                                    {},
+                                    {"out"},
+                                    env,
+                                    remote_config->platform_properties);
+    auto const response = action->Execute();
+    REQUIRE(response);
+    REQUIRE(response->ExitCode() == 0);
+    auto const artifacts = response->Artifacts();
+    REQUIRE(artifacts.has_value());
+    REQUIRE(artifacts.value()->contains("out"));
+    auto const info = artifacts.value()->at("out");
+
+    auto const local_exec_config = CreateLocalExecConfig();
+
+    // synchronize to an empty CAS
+    auto const target_config = TestStorageConfig::Create();
+    auto const target_storage = Storage::Create(&target_config.Get());
+    LocalContext const target_context{
+        .exec_config = &local_exec_config,
+        .storage_config = &target_config.Get(),
+        .storage = &target_storage};
+    LocalApi const target_api{&target_context};
+    RecordingApi const target{&target_api};
+    REQUIRE(api->ParallelRetrieveToCas(
+        {info}, target, /*jobs=*/4, /*use_blob_splitting=*/false));
+
+    // uploads are split into batches not exceeding the size limit
+    auto const uploads = target.Uploads();
+    CHECK(uploads.size() > 1);
+    std::unordered_map<std::string, std::size_t> uploaded_by{};
+    for (std::size_t i = 0; i < uploads.size(); ++i) {
+        std::size_t size = 0;
+        for (auto const& digest : uploads[i]) {
+            size += digest.size();
+            uploaded_by.emplace(digest.hash(), i);
+        }
+        CHECK(size <= MessageLimits::kMaxGrpcLength);
+    }
+
+    // every tree is uploaded only after all of its entries
+    auto const reader = TreeReader<LocalCasReader>{&target_storage.CAS()};
+    using TreeEntries =
+        std::pair<Artifact::ObjectInfo, std::vector<Artifact::ObjectInfo>>;
+    std::vector<TreeEntries> trees{};
+    std::vector<Artifact::ObjectInfo> to_read{info};
+    while (not to_read.empty()) {
+        auto const tree = to_read.back();
+        to_read.pop_back();
+        auto entries = reader.ReadDirectTreeEntries(tree.digest, {});
+        REQUIRE(entries);
+        REQUIRE(uploaded_by.contains(tree.digest.hash()));
+        for (auto const& entry : entries->infos) {
+            REQUIRE(uploaded_by.contains(entry.digest.hash()));
+            CHECK(uploaded_by.at(entry.digest.hash()) <
+                  uploaded_by.at(tree.digest.hash()));
+            if (IsTreeObject(entry.type)) {
+                to_read.emplace_back(entry);
+            }
+        }
+        trees.emplace_back(tree, std::move(entries->infos));
+    }
+    CHECK(trees.size() == 3);
+
+    // if an upload fails partway through, no tree is left without its entries
+    auto const failing_config = TestStorageConfig::Create();
+    auto const failing_storage = Storage::Create(&failing_config.Get());
+    LocalContext const failing_context{
+        .exec_config = &local_exec_config,
+        .storage_config = &failing_config.Get(),
+        .storage = &failing_storage};
+    LocalApi const failing_api{&failing_context};
+    RecordingApi const failing{&failing_api, /*fail_at=*/1};
+    CHECK_FALSE(api->ParallelRetrieveToCas(
+        {info}, failing, /*jobs=*/4, /*use_blob_splitting=*/false));
+    CHECK_FALSE(failing.IsAvailable(info.digest));
+    for (auto const& [tree, entries] : trees) {
+        if (failing.IsAvailable(tree.digest)) {
+            for (auto const& entry : entries) {
+                CHECK(failing.IsAvailable(entry.digest));
+            }
+        }
+    }
+}
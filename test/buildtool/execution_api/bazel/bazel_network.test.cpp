@@ -106,6 +106,9 @@ TEST_CASE("Bazel network: write/read blobs", "[execution_api]") {
     CHECK(*blobs[2].ReadContent() == content_baz);
     CHECK(*blobs[3].ReadContent() == content_bar);
     CHECK(*blobs[4].ReadContent() == content_foo);
+
+    // blobs too large for batching are streamed to a temporary file
+    CHECK(blobs[2].GetFilePath().has_value());
 }
 
 TEST_CASE("Bazel network: read blobs with unknown size", "[execution_api]") {
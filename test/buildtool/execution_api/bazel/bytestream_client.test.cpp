@@ -27,6 +27,7 @@
 #include "src/buildtool/common/remote/remote_common.hpp"
 #include "src/buildtool/crypto/hash_function.hpp"
 #include "src/buildtool/execution_api/remote/config.hpp"
+#include "src/buildtool/file_system/file_system_manager.hpp"
 #include "src/buildtool/file_system/object_type.hpp"
 #include "src/buildtool/storage/config.hpp"
 #include "src/utils/cpp/expected.hpp"
@@ -70,6 +71,21 @@ TEST_CASE("ByteStream Client: Transfer single blob", "[execution_api]") {
         CHECK(*downloaded_content == content);
     }
 
+    SECTION("Upload of a file changed since hashing fails") {
+        std::string instance_name{"remote-execution"};
+        auto const file = temp_space->GetPath() / "file";
+        REQUIRE(FileSystemManager::WriteFile("content", file));
+
+        auto const blob =
+            ArtifactBlob::FromFile(hash_function, ObjectType::File, file);
+        REQUIRE(blob.has_value());
+        REQUIRE(FileSystemManager::WriteFile("changed", file));
+
+        CHECK_FALSE(stream.Write(instance_name, *blob));
+        CHECK_FALSE(
+            stream.Read(instance_name, blob->GetDigest(), temp_space));
+    }
+
     SECTION("Upload large blob") {
         static constexpr std::size_t kLargeSize =
             GRPC_DEFAULT_MAX_RECV_MESSAGE_LENGTH + 1;
@@ -0,0 +1,116 @@
+// Copyright 2026 Huawei Cloud Computing Technology Co., Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "src/buildtool/execution_api/common/blob_compression.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+#include "catch2/catch_test_macros.hpp"
+
+namespace {
+
+[[nodiscard]] auto CreateData(std::size_t size) -> std::string {
+    std::string data{};
+    data.reserve(size);
+    for (std::size_t i = 0; i < size; ++i) {
+        data.push_back(static_cast<char>('a' + (i * i) % 23));
+    }
+    return data;
+}
+
+}  // namespace
+
+TEST_CASE("BlobCompression: Round trip", "[common]") {
+    SECTION("Empty data") {
+        auto const compressed = BlobCompression::Compress("");
+        REQUIRE(compressed);
+        auto const decompressed = BlobCompression::Decompress(*compressed, 0);
+        REQUIRE(decompressed);
+        CHECK(decompressed->empty());
+    }
+
+    SECTION("Large data") {
+        auto const data = CreateData(1024UL * 1024);
+        auto const compressed = BlobCompression::Compress(data);
+        REQUIRE(compressed);
+        CHECK(compressed->size() < data.size());
+        auto const decompressed =
+            BlobCompression::Decompress(*compressed, data.size());
+        REQUIRE(decompressed);
+        CHECK(*decompressed == data);
+    }
+}
+
+TEST_CASE("BlobCompression: Streaming", "[common]") {
+    static constexpr std::size_t kChunkSize = 4000;
+    auto const data = CreateData(512UL * 1024);
+
+    BlobCompression::Compressor compressor{};
+    std::string compressed{};
+    for (std::size_t pos = 0; pos < data.size(); pos += kChunkSize) {
+        auto const chunk = std::string_view{data}.substr(pos, kChunkSize);
+        auto const out =
+            compressor.Update(chunk, pos + kChunkSize >= data.size());
+        REQUIRE(out);
+        compressed += *out;
+    }
+    // finished compressors reject further data
+    CHECK_FALSE(compressor.Update("", true));
+
+    // decompress in chunks not aligned with those of the compressor
+    BlobCompression::Decompressor decompressor{data.size()};
+    std::string decompressed{};
+    for (std::size_t pos = 0; pos < compressed.size(); pos += kChunkSize / 3) {
+        CHECK_FALSE(decompressor.Finished());
+        auto const out = decompressor.Update(
+            std::string_view{compressed}.substr(pos, kChunkSize / 3));
+        REQUIRE(out);
+        decompressed += *out;
+    }
+    CHECK(decompressor.Finished());
+    CHECK(decompressed == data);
+}
+
+TEST_CASE("BlobCompression: Invalid input", "[common]") {
+    auto const data = CreateData(64UL * 1024);
+    auto const compressed = BlobCompression::Compress(data);
+    REQUIRE(compressed);
+
+    SECTION("Size limit exceeded") {
+        CHECK_FALSE(BlobCompression::Decompress(*compressed, data.size() - 1));
+    }
+
+    SECTION("Size mismatch") {
+        CHECK_FALSE(BlobCompression::Decompress(*compressed, data.size() + 1));
+    }
+
+    SECTION("Truncated stream") {
+        CHECK_FALSE(BlobCompression::Decompress(
+            std::string_view{*compressed}.substr(0, compressed->size() / 2),
+            data.size()));
+    }
+
+    SECTION("Trailing data") {
+        CHECK_FALSE(
+            BlobCompression::Decompress(*compressed + "garbage", data.size()));
+    }
+
+    SECTION("Not compressed") {
+        std::string invalid(data.size(), '\xff');
+        CHECK_FALSE(BlobCompression::Decompress(invalid, data.size()));
+    }
+}
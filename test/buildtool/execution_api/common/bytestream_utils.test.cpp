@@ -18,6 +18,7 @@
 #include <string>
 
 #include "catch2/catch_test_macros.hpp"
+#include "fmt/core.h"
 #include "src/buildtool/common/artifact_digest.hpp"
 #include "src/buildtool/common/artifact_digest_factory.hpp"
 #include "src/buildtool/crypto/hash_function.hpp"
@@ -83,6 +84,28 @@ TEST_CASE("ReadRequest", "[common]") {
     auto const parsed_invalid =
         ByteStreamUtils::ReadRequest::FromString(request_invalid);
     CHECK(parsed_invalid == std::nullopt);
+    CHECK_FALSE(parsed->IsCompressed());
+
+    std::string const request_compressed =
+        ByteStreamUtils::ReadRequest::ToString(
+            kLongInstanceName, digest, /*compressed=*/true);
+    auto const parsed_compressed =
+        ByteStreamUtils::ReadRequest::FromString(request_compressed);
+    REQUIRE(parsed_compressed);
+    auto parsed_digest_compressed =
+        parsed_compressed->GetDigest(hash_function.GetType());
+    REQUIRE(parsed_digest_compressed);
+    CHECK(parsed_compressed->IsCompressed());
+    CHECK(parsed_compressed->GetInstanceName() == kLongInstanceName);
+    CHECK(parsed_digest_compressed.value() == digest);
+
+    // only deflate is supported as compressor
+    auto const parsed_unsupported = ByteStreamUtils::ReadRequest::FromString(
+        fmt::format("{}/compressed-blobs/zstd/{}/{}",
+                    kInstanceName,
+                    digest.hash(),
+                    digest.size()));
+    CHECK(parsed_unsupported == std::nullopt);
 }
 
 TEST_CASE("WriteRequest", "[common]") {
@@ -151,4 +174,28 @@ TEST_CASE("WriteRequest", "[common]") {
     auto const parsed_invalid =
         ByteStreamUtils::WriteRequest::FromString(request_invalid);
     CHECK(parsed_invalid == std::nullopt);
+    CHECK_FALSE(parsed->IsCompressed());
+
+    std::string const request_compressed =
+        ByteStreamUtils::WriteRequest::ToString(
+            kLongInstanceName, uuid, digest, /*compressed=*/true);
+    auto const parsed_compressed =
+        ByteStreamUtils::WriteRequest::FromString(request_compressed);
+    REQUIRE(parsed_compressed);
+    auto parsed_digest_compressed =
+        parsed_compressed->GetDigest(hash_function.GetType());
+    REQUIRE(parsed_digest_compressed.has_value());
+    CHECK(parsed_compressed->IsCompressed());
+    CHECK(parsed_compressed->GetInstanceName() == kLongInstanceName);
+    CHECK(parsed_compressed->GetUUID() == uuid);
+    CHECK(parsed_digest_compressed.value() == digest);
+
+    // only deflate is supported as compressor
+    auto const parsed_unsupported = ByteStreamUtils::WriteRequest::FromString(
+        fmt::format("{}/uploads/{}/compressed-blobs/zstd/{}/{}",
+                    kInstanceName,
+                    uuid,
+                    digest.hash(),
+                    digest.size()));
+    CHECK(parsed_unsupported == std::nullopt);
 }
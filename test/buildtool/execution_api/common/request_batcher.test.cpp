@@ -0,0 +1,224 @@
+// Copyright 2026 Huawei Cloud Computing Technology Co., Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "src/buildtool/execution_api/common/request_batcher.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+
+#include "catch2/catch_test_macros.hpp"
+#include "fmt/core.h"
+#include "src/buildtool/common/artifact_digest.hpp"
+#include "src/buildtool/common/artifact_digest_factory.hpp"
+#include "src/buildtool/crypto/hash_function.hpp"
+#include "src/buildtool/file_system/object_type.hpp"
+#include "test/utils/hermeticity/test_hash_function_type.hpp"
+
+namespace {
+
+[[nodiscard]] auto MakeDigest(HashFunction hash_function, std::size_t i)
+    -> ArtifactDigest {
+    return ArtifactDigestFactory::HashDataAs<ObjectType::File>(
+        hash_function, std::to_string(i));
+}
+
+// Capacity of batches large enough to never split the lookups of a test.
+constexpr std::size_t kCapacity = 1024;
+
+}  // namespace
+
+TEST_CASE("Concurrent lookups are batched", "[request_batcher]") {
+    HashFunction const hash_function{TestHashType::ReadFromEnvironment()};
+    static constexpr std::size_t kCallers = 16;
+
+    // every odd digest is missing
+    std::unordered_set<ArtifactDigest> all_missing;
+    for (std::size_t i = 1; i < 2 * kCallers; i += 2) {
+        all_missing.emplace(MakeDigest(hash_function, i));
+    }
+
+    std::atomic<std::size_t> queries{};
+    RequestBatcher<ArtifactDigest> batcher{
+        [&queries, &all_missing](
+            std::unordered_set<ArtifactDigest> const& digests) {
+            ++queries;
+            // keep the query in flight, so that other callers join a batch
+            std::this_thread::sleep_for(std::chrono::milliseconds{100});
+            std::unordered_set<ArtifactDigest> missing;
+            for (auto const& digest : digests) {
+                if (all_missing.contains(digest)) {
+                    missing.emplace(digest);
+                }
+            }
+            return missing;
+        },
+        kCapacity};
+
+    std::vector<std::unordered_set<ArtifactDigest>> results(kCallers);
+    {
+        std::vector<std::jthread> callers;
+        callers.reserve(kCallers);
+        for (std::size_t i = 0; i < kCallers; ++i) {
+            callers.emplace_back([&, i]() {
+                results[i] = batcher.Run(
+                    {MakeDigest(hash_function, 2 * i),
+                     MakeDigest(hash_function, 2 * i + 1)});
+            });
+        }
+    }
+
+    CHECK(queries < kCallers);
+    for (std::size_t i = 0; i < kCallers; ++i) {
+        CHECK(results[i] == std::unordered_set{
+                                MakeDigest(hash_function, 2 * i + 1)});
+    }
+}
+
+TEST_CASE("Lone lookups are not delayed", "[request_batcher]") {
+    HashFunction const hash_function{TestHashType::ReadFromEnvironment()};
+    static constexpr std::size_t kLookups = 100;
+
+    std::vector<std::size_t> batch_sizes;
+    RequestBatcher<ArtifactDigest> batcher{
+        [&batch_sizes](std::unordered_set<ArtifactDigest> const& digests) {
+            batch_sizes.push_back(digests.size());
+            return digests;
+        },
+        kCapacity};
+
+    // Without a request in flight, every lookup is sent right away on its
+    // own, instead of waiting for other callers to join its batch.
+    for (std::size_t i = 0; i < kLookups; ++i) {
+        std::unordered_set digests{MakeDigest(hash_function, i)};
+        CHECK(batcher.Run(digests) == digests);
+        REQUIRE(batch_sizes.size() == i + 1);
+        CHECK(batch_sizes.back() == 1);
+    }
+}
+
+TEST_CASE("Full batches are queried separately", "[request_batcher]") {
+    HashFunction const hash_function{TestHashType::ReadFromEnvironment()};
+
+    std::atomic<std::size_t> queries{};
+    std::atomic<std::size_t> max_size{};
+    RequestBatcher<ArtifactDigest> batcher{
+        [&queries, &max_size](
+            std::unordered_set<ArtifactDigest> const& digests) {
+            ++queries;
+            auto size = max_size.load();
+            while (size < digests.size() and
+                   not max_size.compare_exchange_weak(size, digests.size())) {
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds{50});
+            return digests;
+        },
+        /*capacity=*/4};
+
+    SECTION("Single large request") {
+        std::unordered_set<ArtifactDigest> digests;
+        for (std::size_t i = 0; i < 10; ++i) {
+            digests.emplace(MakeDigest(hash_function, i));
+        }
+        CHECK(batcher.Run(digests) == digests);
+        CHECK(queries == 1);
+    }
+
+    SECTION("Many concurrent requests") {
+        static constexpr std::size_t kCallers = 8;
+        std::vector<std::unordered_set<ArtifactDigest>> results(kCallers);
+        {
+            std::vector<std::jthread> callers;
+            callers.reserve(kCallers);
+            for (std::size_t i = 0; i < kCallers; ++i) {
+                callers.emplace_back([&, i]() {
+                    results[i] =
+                        batcher.Run({MakeDigest(hash_function, i)});
+                });
+            }
+        }
+        CHECK(max_size <= 4);
+        CHECK(queries >= kCallers / 4);
+        for (std::size_t i = 0; i < kCallers; ++i) {
+            CHECK(results[i] ==
+                  std::unordered_set{MakeDigest(hash_function, i)});
+        }
+    }
+}
+
+TEST_CASE("Batches are bounded by the weight of their items",
+          "[request_batcher]") {
+    static constexpr std::size_t kCallers = 8;
+    static constexpr std::size_t kMaxWeight = 10;
+
+    std::atomic<std::size_t> max_weight{};
+    RequestBatcher<std::string> batcher{
+        [&max_weight](std::unordered_set<std::string> const& items) {
+            std::size_t weight = 0;
+            for (auto const& item : items) {
+                weight += item.size();
+            }
+            auto current = max_weight.load();
+            while (current < weight and
+                   not max_weight.compare_exchange_weak(current, weight)) {
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds{50});
+            // items starting with "x" fail
+            std::unordered_set<std::string> failed;
+            for (auto const& item : items) {
+                if (item.starts_with('x')) {
+                    failed.emplace(item);
+                }
+            }
+            return failed;
+        },
+        kMaxWeight,
+        [](std::string const& item) { return item.size(); }};
+
+    std::vector<std::unordered_set<std::string>> results(kCallers);
+    {
+        std::vector<std::jthread> callers;
+        callers.reserve(kCallers);
+        for (std::size_t i = 0; i < kCallers; ++i) {
+            callers.emplace_back([&, i]() {
+                results[i] = batcher.Run({fmt::format("x{:02}", i),
+                                          fmt::format("o{:02}", i)});
+            });
+        }
+    }
+
+    CHECK(max_weight <= kMaxWeight);
+    for (std::size_t i = 0; i < kCallers; ++i) {
+        CHECK(results[i] == std::unordered_set{fmt::format("x{:02}", i)});
+    }
+}
+
+TEST_CASE("Failing requests report all items failed", "[request_batcher]") {
+    HashFunction const hash_function{TestHashType::ReadFromEnvironment()};
+    RequestBatcher<ArtifactDigest> batcher{
+        [](std::unordered_set<ArtifactDigest> const& /*digests*/)
+            -> std::unordered_set<ArtifactDigest> {
+            throw std::runtime_error{"unreachable remote"};
+        },
+        kCapacity};
+
+    std::unordered_set digests{MakeDigest(hash_function, 0),
+                               MakeDigest(hash_function, 1)};
+    CHECK(batcher.Run(digests) == digests);
+}
@@ -0,0 +1,309 @@
+// Copyright 2026 Huawei Cloud Computing Technology Co., Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "src/buildtool/execution_api/execution_service/action_scheduler.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "catch2/catch_test_macros.hpp"
+#include "gsl/gsl"
+
+namespace {
+/// \brief Start an action in a separate thread, recording the order in which
+/// actions are admitted.
+class Waiter final {
+  public:
+    Waiter(gsl::not_null<ActionScheduler*> const& scheduler,
+           std::string client,
+           std::size_t slots,
+           gsl::not_null<std::vector<std::string>*> const& order,
+           gsl::not_null<std::mutex*> const& order_mutex,
+           std::string name)
+        : thread_{[scheduler,
+                   client = std::move(client),
+                   slots,
+                   order,
+                   order_mutex,
+                   name = std::move(name),
+                   this]() {
+              auto reservation = scheduler->Acquire(
+                  client,
+                  slots,
+                  [this](ActionScheduler::QueueState const& /*state*/) {
+                      queued_ = true;
+                  });
+              {
+                  std::unique_lock lock{*order_mutex};
+                  order->push_back(name);
+              }
+              while (not release_) {
+                  std::this_thread::sleep_for(std::chrono::milliseconds{1});
+              }
+          }} {}
+
+    Waiter(Waiter const&) = delete;
+    Waiter(Waiter&&) = delete;
+    auto operator=(Waiter const&) -> Waiter& = delete;
+    auto operator=(Waiter&&) -> Waiter& = delete;
+    ~Waiter() { Release(); }
+
+    [[nodiscard]] auto IsQueued() const noexcept -> bool { return queued_; }
+
+    void Release() {
+        release_ = true;
+        if (thread_.joinable()) {
+            thread_.join();
+        }
+    }
+
+  private:
+    std::atomic<bool> queued_{false};
+    std::atomic<bool> release_{false};
+    std::thread thread_;
+};
+
+void WaitUntil(std::function<bool()> const& condition) {
+    while (not condition()) {
+        std::this_thread::sleep_for(std::chrono::milliseconds{1});
+    }
+}
+}  // namespace
+
+TEST_CASE("Reservations are limited by slots", "[execution_service]") {
+    ActionScheduler scheduler{4};
+    CHECK(scheduler.TotalSlots() == 4);
+
+    {
+        auto first = scheduler.Acquire("client", 3);
+        CHECK(first.Slots() == 3);
+        CHECK(scheduler.FreeSlots() == 1);
+
+        // requests are capped at the size of the pool and take at least one
+        // slot
+        std::optional<ActionScheduler::Reservation> second{};
+        std::thread waiter{[&scheduler, &second] {
+            second.emplace(scheduler.Acquire("client", 10));
+        }};
+        WaitUntil([&scheduler] { return scheduler.QueueDepth() == 1; });
+        CHECK(scheduler.FreeSlots() == 1);
+        { auto moved = std::move(first); }
+        waiter.join();
+        REQUIRE(second);
+        CHECK(second->Slots() == 4);
+        CHECK(scheduler.FreeSlots() == 0);
+        CHECK(scheduler.QueueDepth() == 0);
+    }
+    CHECK(scheduler.FreeSlots() == 4);
+
+    auto zero = scheduler.Acquire("client", 0);
+    CHECK(zero.Slots() == 1);
+}
+
+TEST_CASE("Clients are served round robin", "[execution_service]") {
+    ActionScheduler scheduler{1};
+    std::vector<std::string> order{};
+    std::mutex order_mutex{};
+
+    std::optional<ActionScheduler::Reservation> blocker{
+        scheduler.Acquire("other", 1)};
+
+    // client a queues three actions before client b queues one
+    Waiter a1{&scheduler, "a", 1, &order, &order_mutex, "a1"};
+    WaitUntil([&a1] { return a1.IsQueued(); });
+    Waiter a2{&scheduler, "a", 1, &order, &order_mutex, "a2"};
+    WaitUntil([&a2] { return a2.IsQueued(); });
+    Waiter a3{&scheduler, "a", 1, &order, &order_mutex, "a3"};
+    WaitUntil([&a3] { return a3.IsQueued(); });
+    Waiter b1{&scheduler, "b", 1, &order, &order_mutex, "b1"};
+    WaitUntil([&b1] { return b1.IsQueued(); });
+    CHECK(scheduler.QueueDepth() == 4);
+
+    auto const admitted = [&order, &order_mutex](std::size_t count) {
+        WaitUntil([&order, &order_mutex, count] {
+            std::unique_lock lock{order_mutex};
+            return order.size() == count;
+        });
+    };
+    blocker.reset();
+    admitted(1);
+    a1.Release();
+    admitted(2);
+    b1.Release();
+    admitted(3);
+    a2.Release();
+    admitted(4);
+    a3.Release();
+
+    CHECK(order == std::vector<std::string>{"a1", "b1", "a2", "a3"});
+    CHECK(scheduler.QueueDepth() == 0);
+    CHECK(scheduler.FreeSlots() == 1);
+}
+
+TEST_CASE("Large requests are overtaken a bounded number of times",
+          "[execution_service]") {
+    ActionScheduler scheduler{2};
+    std::vector<std::string> order{};
+    std::mutex order_mutex{};
+    auto const admitted = [&order, &order_mutex](std::size_t count) {
+        WaitUntil([&order, &order_mutex, count] {
+            std::unique_lock lock{order_mutex};
+            return order.size() == count;
+        });
+    };
+
+    std::optional<ActionScheduler::Reservation> blocker{
+        scheduler.Acquire("other", 1)};
+
+    Waiter large{&scheduler, "a", 2, &order, &order_mutex, "large"};
+    WaitUntil([&large] { return large.IsQueued(); });
+
+    // small requests of other clients use the free slot meanwhile, but only
+    // as many times as the pool has slots
+    Waiter small1{&scheduler, "b", 1, &order, &order_mutex, "small1"};
+    admitted(1);
+    small1.Release();
+    Waiter small2{&scheduler, "c", 1, &order, &order_mutex, "small2"};
+    admitted(2);
+    small2.Release();
+    Waiter small3{&scheduler, "d", 1, &order, &order_mutex, "small3"};
+    WaitUntil([&small3] { return small3.IsQueued(); });
+    CHECK(scheduler.FreeSlots() == 1);
+
+    blocker.reset();
+    admitted(3);
+    large.Release();
+    admitted(4);
+    small3.Release();
+    CHECK(order == std::vector<std::string>{
+                       "small1", "small2", "large", "small3"});
+    CHECK(scheduler.FreeSlots() == 2);
+}
+
+TEST_CASE("Submitted actions are admitted by releasing threads",
+          "[execution_service]") {
+    ActionScheduler scheduler{1};
+    std::mutex mutex{};
+    std::vector<ActionScheduler::Reservation> granted{};
+    auto const on_admitted = [&mutex,
+                              &granted](ActionScheduler::Reservation r) {
+        std::unique_lock lock{mutex};
+        granted.emplace_back(std::move(r));
+    };
+    auto const count = [&mutex, &granted]() {
+        std::unique_lock lock{mutex};
+        return granted.size();
+    };
+
+    // admitted right away
+    scheduler.Submit("a", 1, on_admitted);
+    CHECK(count() == 1);
+
+    // queued without a thread waiting for them
+    scheduler.Submit("a", 1, on_admitted);
+    scheduler.Submit("b", 1, on_admitted);
+    CHECK(count() == 1);
+    CHECK(scheduler.QueueDepth() == 2);
+
+    // releasing a reservation admits the next action in the same thread
+    auto const release_one = [&mutex, &granted]() {
+        auto first = [&mutex, &granted]() {
+            std::unique_lock lock{mutex};
+            auto r = std::move(granted.back());
+            granted.pop_back();
+            return r;
+        }();
+    };
+    release_one();
+    CHECK(count() == 1);
+    CHECK(scheduler.QueueDepth() == 1);
+    release_one();
+    CHECK(count() == 1);
+    CHECK(scheduler.QueueDepth() == 0);
+    release_one();
+    CHECK(scheduler.FreeSlots() == 1);
+}
+
+TEST_CASE("Waiting actions learn their position", "[execution_service]") {
+    ActionScheduler scheduler{1, std::chrono::milliseconds{1}};
+    std::mutex mutex{};
+    std::map<std::string, ActionScheduler::QueueState> states{};
+    auto const on_wait = [&mutex, &states](std::string const& name) {
+        return [&mutex, &states, name](
+                   ActionScheduler::QueueState const& state) {
+            std::unique_lock lock{mutex};
+            states.insert_or_assign(name, state);
+        };
+    };
+    auto const state = [&mutex, &states](std::string const& name) {
+        std::unique_lock lock{mutex};
+        auto it = states.find(name);
+        return it != states.end()
+                   ? std::optional<ActionScheduler::QueueState>{it->second}
+                   : std::nullopt;
+    };
+
+    std::optional<ActionScheduler::Reservation> blocker{
+        scheduler.Acquire("other", 1)};
+    std::vector<ActionScheduler::Reservation> granted{};
+    auto const on_admitted = [&mutex,
+                              &granted](ActionScheduler::Reservation r) {
+        std::unique_lock lock{mutex};
+        granted.emplace_back(std::move(r));
+    };
+
+    // client a queues two actions before client b queues one; they are
+    // admitted in the order a1, b1, a2
+    scheduler.Submit("a", 1, on_admitted, on_wait("a1"));
+    scheduler.Submit("a", 1, on_admitted, on_wait("a2"));
+    scheduler.Submit("b", 1, on_admitted, on_wait("b1"));
+    WaitUntil([&state] {
+        auto const a2 = state("a2");
+        return a2 and a2->queue_depth == 3;
+    });
+    CHECK(state("a1")->position == 1);
+    CHECK(state("a2")->position == 3);
+    CHECK(state("b1")->position == 2);
+    // nothing has finished yet, so the waiting time is unknown
+    CHECK_FALSE(state("a2")->eta);
+
+    // once an action finishes, waiting times are estimated
+    std::this_thread::sleep_for(std::chrono::milliseconds{10});
+    blocker.reset();
+    WaitUntil([&state] {
+        auto const a2 = state("a2");
+        return a2 and a2->position == 2 and a2->eta;
+    });
+    CHECK(state("b1")->position == 1);
+    CHECK(state("a2")->eta >= state("b1")->eta);
+
+    // release the remaining actions, without holding the mutex, as the
+    // admission of the next action is recorded by the releasing thread
+    while (scheduler.QueueDepth() > 0 or
+           scheduler.FreeSlots() < scheduler.TotalSlots()) {
+        std::vector<ActionScheduler::Reservation> released{};
+        std::unique_lock lock{mutex};
+        released.swap(granted);
+        lock.unlock();
+    }
+}
@@ -0,0 +1,321 @@
+// Copyright 2026 Huawei Cloud Computing Technology Co., Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <grpcpp/grpcpp.h>
+
+#include "build/bazel/remote/execution/v2/remote_execution.grpc.pb.h"
+#include "catch2/catch_test_macros.hpp"
+#include "fmt/core.h"
+#include "google/bytestream/bytestream.grpc.pb.h"
+#include "google/longrunning/operations.pb.h"
+#include "gsl/gsl"
+#include "src/buildtool/common/artifact_digest.hpp"
+#include "src/buildtool/common/artifact_digest_factory.hpp"
+#include "src/buildtool/common/bazel_digest_factory.hpp"
+#include "src/buildtool/common/bazel_types.hpp"
+#include "src/buildtool/common/protocol_traits.hpp"
+#include "src/buildtool/crypto/hash_function.hpp"
+#include "src/buildtool/execution_api/common/bytestream_utils.hpp"
+#include "src/buildtool/execution_api/execution_service/bytestream_server.hpp"
+#include "src/buildtool/execution_api/execution_service/cas_server.hpp"
+#include "src/buildtool/execution_api/execution_service/execution_server.hpp"
+#include "src/buildtool/execution_api/local/config.hpp"
+#include "src/buildtool/execution_api/local/context.hpp"
+#include "src/buildtool/execution_api/local/local_api.hpp"
+#include "src/buildtool/file_system/file_system_manager.hpp"
+#include "src/buildtool/file_system/git_repo.hpp"
+#include "src/buildtool/file_system/object_type.hpp"
+#include "src/buildtool/storage/config.hpp"
+#include "src/buildtool/storage/storage.hpp"
+#include "test/utils/hermeticity/test_storage_config.hpp"
+
+namespace {
+auto const kInstanceName = std::string{"remote-execution"};
+
+using CASStub = bazel_re::ContentAddressableStorage::Stub;
+
+[[nodiscard]] auto Upload(gsl::not_null<CASStub*> const& cas,
+                          bazel_re::Digest const& digest,
+                          std::string const& content) -> bazel_re::Digest {
+    auto request = bazel_re::BatchUpdateBlobsRequest{};
+    request.set_instance_name(kInstanceName);
+    auto* req = request.add_requests();
+    req->mutable_digest()->CopyFrom(digest);
+    req->set_data(content);
+    auto response = bazel_re::BatchUpdateBlobsResponse{};
+    ::grpc::ClientContext context{};
+    REQUIRE(cas->BatchUpdateBlobs(&context, request, &response).ok());
+    REQUIRE(response.responses_size() == 1);
+    REQUIRE(response.responses(0).status().code() == ::grpc::StatusCode::OK);
+    return digest;
+}
+
+[[nodiscard]] auto UploadBlob(gsl::not_null<CASStub*> const& cas,
+                              HashFunction hash_function,
+                              std::string const& content) -> bazel_re::Digest {
+    return Upload(
+        cas,
+        BazelDigestFactory::HashDataAs<ObjectType::File>(hash_function,
+                                                         content),
+        content);
+}
+
+[[nodiscard]] auto UploadEmptyTree(gsl::not_null<CASStub*> const& cas,
+                                   HashFunction hash_function)
+    -> bazel_re::Digest {
+    if (ProtocolTraits::IsNative(hash_function.GetType())) {
+        auto empty_entries = GitRepo::tree_entries_t{};
+        auto empty_tree = GitRepo::CreateShallowTree(empty_entries);
+        REQUIRE(empty_tree);
+        return Upload(cas,
+                      BazelDigestFactory::HashDataAs<ObjectType::Tree>(
+                          hash_function, empty_tree->second),
+                      empty_tree->second);
+    }
+    return UploadBlob(
+        cas, hash_function, bazel_re::Directory{}.SerializeAsString());
+}
+
+/// \brief Upload an action running the given shell script in an empty input
+/// root, with PATH taken from the test environment.
+[[nodiscard]] auto UploadAction(gsl::not_null<CASStub*> const& cas,
+                                HashFunction hash_function,
+                                std::string const& script)
+    -> bazel_re::Digest {
+    auto cmd = bazel_re::Command{};
+    cmd.add_arguments("/bin/sh");
+    cmd.add_arguments("-c");
+    cmd.add_arguments(script);
+    if (auto const* path_var = std::getenv("PATH")) {
+        auto* var = cmd.add_environment_variables();
+        var->set_name("PATH");
+        var->set_value(path_var);
+    }
+    auto action = bazel_re::Action{};
+    action.mutable_command_digest()->CopyFrom(
+        UploadBlob(cas, hash_function, cmd.SerializeAsString()));
+    action.mutable_input_root_digest()->CopyFrom(
+        UploadEmptyTree(cas, hash_function));
+    return UploadBlob(cas, hash_function, action.SerializeAsString());
+}
+
+/// \brief Counter to wait for events of other threads.
+class Counter final {
+  public:
+    void Increment() {
+        {
+            std::unique_lock lock{mutex_};
+            ++count_;
+        }
+        cv_.notify_all();
+    }
+
+    void WaitFor(std::size_t count) {
+        std::unique_lock lock{mutex_};
+        cv_.wait(lock, [this, count]() { return count_ >= count; });
+    }
+
+  private:
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::size_t count_{};
+};
+}  // namespace
+
+TEST_CASE("Callback services: Cheap calls are served while actions run",
+          "[execution_service]") {
+    auto const storage_config = TestStorageConfig::Create();
+    auto const storage = Storage::Create(&storage_config.Get());
+    LocalExecutionConfig const local_exec_config{};
+
+    // pack the local context instances to be passed
+    LocalContext const local_context{.exec_config = &local_exec_config,
+                                     .storage_config = &storage_config.Get(),
+                                     .storage = &storage};
+
+    auto local_api = LocalApi{&local_context};
+    // a single slot, so that one action runs while the other one is queued
+    auto exec_service = ExecutionServiceImpl{
+        &local_context, &local_api, std::nullopt, /*action_slots=*/1};
+    auto cas_service = CASServiceImpl{&local_context};
+
+    ::grpc::ServerBuilder builder;
+    builder.RegisterService(&exec_service).RegisterService(&cas_service);
+    auto server = builder.BuildAndStart();
+    REQUIRE(server);
+    auto channel = server->InProcessChannel(::grpc::ChannelArguments{});
+    auto cas = bazel_re::ContentAddressableStorage::NewStub(channel);
+    auto execution = bazel_re::Execution::NewStub(channel);
+    auto const hash_function = storage_config.Get().hash_function;
+
+    auto const test_dir = storage_config.Get().CreateTypedTmpDir("callback");
+    REQUIRE(test_dir != nullptr);
+    auto const flag = test_dir->GetPath() / "flag";
+
+    constexpr std::size_t kActions = 2;
+    Counter started{};
+    std::vector<::grpc::Status> statuses(kActions);
+    std::vector<::google::longrunning::Operation> results(kActions);
+    std::vector<std::thread> clients{};
+    for (std::size_t i = 0; i < kActions; ++i) {
+        auto request = bazel_re::ExecuteRequest{};
+        request.set_instance_name(kInstanceName);
+        request.mutable_action_digest()->CopyFrom(UploadAction(
+            cas.get(),
+            hash_function,
+            fmt::format("while [ ! -e {} ]; do sleep 0.01; done; echo {}",
+                        flag.string(),
+                        i)));
+        clients.emplace_back([&, i, request]() {
+            ::grpc::ClientContext context{};
+            auto reader = execution->Execute(&context, request);
+            auto op = ::google::longrunning::Operation{};
+            bool first = true;
+            while (reader->Read(&op)) {
+                if (first) {
+                    started.Increment();
+                    first = false;
+                }
+                results[i] = op;
+            }
+            statuses[i] = reader->Finish();
+        });
+    }
+    // wait until both actions are known to the service
+    started.WaitFor(kActions);
+
+    // the CAS is served, although the actions keep their calls open
+    auto request = bazel_re::FindMissingBlobsRequest{};
+    request.set_instance_name(kInstanceName);
+    request.add_blob_digests()->CopyFrom(
+        BazelDigestFactory::HashDataAs<ObjectType::File>(hash_function,
+                                                         "missing"));
+    auto response = bazel_re::FindMissingBlobsResponse{};
+    ::grpc::ClientContext context{};
+    context.set_deadline(std::chrono::system_clock::now() +
+                         std::chrono::seconds{10});
+    CHECK(cas->FindMissingBlobs(&context, request, &response).ok());
+    CHECK(response.missing_blob_digests_size() == 1);
+
+    CHECK(FileSystemManager::WriteFile("", flag));
+    for (auto& client : clients) {
+        client.join();
+    }
+    for (std::size_t i = 0; i < kActions; ++i) {
+        CHECK(statuses[i].ok());
+        CHECK(results[i].done());
+    }
+}
+
+TEST_CASE("Callback services: Streams are transferred completely",
+          "[execution_service]") {
+    auto const storage_config = TestStorageConfig::Create();
+    auto const storage = Storage::Create(&storage_config.Get());
+    LocalExecutionConfig const local_exec_config{};
+
+    // pack the local context instances to be passed
+    LocalContext const local_context{.exec_config = &local_exec_config,
+                                     .storage_config = &storage_config.Get(),
+                                     .storage = &storage};
+
+    auto cas_service = CASServiceImpl{&local_context};
+    auto bytestream_service = BytestreamServiceImpl{&local_context};
+
+    ::grpc::ServerBuilder builder;
+    builder.RegisterService(&cas_service).RegisterService(&bytestream_service);
+    auto server = builder.BuildAndStart();
+    REQUIRE(server);
+    auto channel = server->InProcessChannel(::grpc::ChannelArguments{});
+    auto cas = bazel_re::ContentAddressableStorage::NewStub(channel);
+    auto bytestream = ::google::bytestream::ByteStream::NewStub(channel);
+    auto const hash_function = storage_config.Get().hash_function;
+
+    SECTION("ByteStream") {
+        // a blob spanning several chunks, the last one incomplete
+        auto const min_size = 3 * ByteStreamUtils::kChunkSize;
+        std::string content{};
+        for (std::size_t i = 0; content.size() < min_size; ++i) {
+            content += fmt::format("line {}\n", i);
+        }
+        auto const digest =
+            ArtifactDigestFactory::HashDataAs<ObjectType::File>(hash_function,
+                                                                content);
+
+        auto write_response = ::google::bytestream::WriteResponse{};
+        {
+            ::grpc::ClientContext context{};
+            auto writer = bytestream->Write(&context, &write_response);
+            auto request = ::google::bytestream::WriteRequest{};
+            request.set_resource_name(ByteStreamUtils::WriteRequest::ToString(
+                kInstanceName, "0123", digest));
+            for (std::size_t pos = 0; pos < content.size();
+                 pos += ByteStreamUtils::kChunkSize) {
+                request.set_write_offset(static_cast<std::int64_t>(pos));
+                *request.mutable_data() =
+                    content.substr(pos, ByteStreamUtils::kChunkSize);
+                request.set_finish_write(pos + ByteStreamUtils::kChunkSize >=
+                                         content.size());
+                REQUIRE(writer->Write(request));
+            }
+            writer->WritesDone();
+            REQUIRE(writer->Finish().ok());
+        }
+        CHECK(write_response.committed_size() ==
+              static_cast<std::int64_t>(content.size()));
+
+        std::string read{};
+        {
+            ::grpc::ClientContext context{};
+            auto request = ::google::bytestream::ReadRequest{};
+            request.set_resource_name(
+                ByteStreamUtils::ReadRequest::ToString(kInstanceName, digest));
+            auto reader = bytestream->Read(&context, request);
+            auto response = ::google::bytestream::ReadResponse{};
+            while (reader->Read(&response)) {
+                read += response.data();
+            }
+            REQUIRE(reader->Finish().ok());
+        }
+        CHECK(read == content);
+    }
+
+    SECTION("GetTree") {
+        auto request = bazel_re::GetTreeRequest{};
+        request.set_instance_name(kInstanceName);
+        request.mutable_root_digest()->CopyFrom(
+            UploadEmptyTree(cas.get(), hash_function));
+        ::grpc::ClientContext context{};
+        auto reader = cas->GetTree(&context, request);
+        std::size_t directories{};
+        auto response = bazel_re::GetTreeResponse{};
+        while (reader->Read(&response)) {
+            directories +=
+                static_cast<std::size_t>(response.directories_size());
+        }
+        REQUIRE(reader->Finish().ok());
+        CHECK(directories == 1);
+    }
+}
@@ -14,18 +14,21 @@
 
 #include "src/buildtool/execution_api/execution_service/cas_server.hpp"
 
+#include <cstddef>
 #include <functional>
 #include <optional>
 #include <string>
 #include <utility>
 #include <vector>
 
+#include <grpcpp/server_context.h>
 #include <grpcpp/support/status.h>
 
 // Don't include "proto"
 // IWYU pragma: no_include "build/bazel/remote/execution/v2/remote_execution.grpc.pb.h"
 #include "catch2/catch_test_macros.hpp"
 #include "gsl/gsl"
+#include "src/buildtool/common/artifact_digest_factory.hpp"
 #include "src/buildtool/common/bazel_digest_factory.hpp"
 #include "src/buildtool/common/bazel_types.hpp"
 #include "src/buildtool/common/protocol_traits.hpp"
@@ -36,6 +39,7 @@
 #include "src/buildtool/file_system/object_type.hpp"
 #include "src/buildtool/storage/config.hpp"
 #include "src/buildtool/storage/storage.hpp"
+#include "src/utils/cpp/hex_string.hpp"
 #include "test/utils/hermeticity/test_hash_function_type.hpp"
 #include "test/utils/hermeticity/test_storage_config.hpp"
 
@@ -52,7 +56,107 @@ namespace {
     req->mutable_digest()->CopyFrom(digest);
     req->set_data(content);
     auto response = bazel_re::BatchUpdateBlobsResponse{};
-    return cas_server->BatchUpdateBlobs(nullptr, &request, &response);
+    ::grpc::ServerContext context{};
+    return cas_server->BatchUpdateBlobs(&context, &request, &response);
+}
+
+// Class to obtain a valid pointer to internal ServerWriter<...> that records
+// all written responses
+class MockGetTreeWriter final
+    : public ::grpc::ServerWriterInterface<bazel_re::GetTreeResponse> {
+  public:
+    MockGetTreeWriter() = default;
+    [[nodiscard]] auto Get()
+        -> ::grpc::ServerWriter<bazel_re::GetTreeResponse>* {
+        // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+        return reinterpret_cast<
+            ::grpc::ServerWriter<bazel_re::GetTreeResponse>*>(this);
+    }
+
+    // stub implementations
+    void SendInitialMetadata() override {}
+    using ::grpc::internal::WriterInterface<bazel_re::GetTreeResponse>::Write;
+    auto Write(bazel_re::GetTreeResponse const& msg,
+               grpc::WriteOptions /*options*/) -> bool override {
+        if (closed) {
+            return false;
+        }
+        responses.push_back(msg);
+        return true;
+    }
+
+    std::vector<bazel_re::GetTreeResponse> responses;
+    bool closed{false};  // simulate a stream closed by the client
+
+  private:
+    MockGetTreeWriter(grpc::internal::Call* /*call*/,
+                      grpc::ServerContext* /*ctx*/) {}
+};
+
+[[nodiscard]] auto GetTree(
+    gsl::not_null<bazel_re::ContentAddressableStorage::Service*> const&
+        cas_server,
+    bazel_re::Digest const& root,
+    int page_size,
+    std::string const& page_token,
+    gsl::not_null<std::vector<bazel_re::Directory>*> const& directories)
+    -> std::pair<grpc::Status, std::string> {
+    auto request = bazel_re::GetTreeRequest{};
+    request.set_instance_name("remote-execution");
+    request.mutable_root_digest()->CopyFrom(root);
+    request.set_page_size(page_size);
+    request.set_page_token(page_token);
+    auto writer = MockGetTreeWriter{};
+    auto status = cas_server->GetTree(nullptr, &request, writer.Get());
+    std::string next_page_token{};
+    for (auto const& response : writer.responses) {
+        for (auto const& dir : response.directories()) {
+            directories->push_back(dir);
+        }
+        next_page_token = response.next_page_token();
+    }
+    return {status, next_page_token};
+}
+
+// Upload a directory with the given subdirectories, in the representation of
+// the current protocol.
+[[nodiscard]] auto UploadDirectory(
+    gsl::not_null<bazel_re::ContentAddressableStorage::Service*> const&
+        cas_server,
+    HashFunction hash_function,
+    std::vector<std::pair<std::string, bazel_re::Digest>> const& subdirs)
+    -> bazel_re::Digest {
+    std::string content{};
+    bazel_re::Digest digest{};
+    if (ProtocolTraits::IsNative(hash_function.GetType())) {
+        auto entries = GitRepo::tree_entries_t{};
+        for (auto const& [name, subdir] : subdirs) {
+            auto const id = ArtifactDigestFactory::FromBazel(
+                hash_function.GetType(), subdir);
+            REQUIRE(id);
+            auto raw_id = FromHexString(id->hash());
+            REQUIRE(raw_id);
+            entries[*raw_id].emplace_back(name, ObjectType::Tree);
+        }
+        auto tree = GitRepo::CreateShallowTree(entries);
+        REQUIRE(tree);
+        content = tree->second;
+        digest = BazelDigestFactory::HashDataAs<ObjectType::Tree>(hash_function,
+                                                                  content);
+    }
+    else {
+        auto dir = bazel_re::Directory{};
+        for (auto const& [name, subdir] : subdirs) {
+            auto* node = dir.add_directories();
+            node->set_name(name);
+            node->mutable_digest()->CopyFrom(subdir);
+        }
+        content = dir.SerializeAsString();
+        digest = BazelDigestFactory::HashDataAs<ObjectType::File>(hash_function,
+                                                                  content);
+    }
+    REQUIRE(Upload(cas_server, "remote-execution", digest, content).ok());
+    return digest;
 }
 }  // namespace
 
@@ -104,3 +208,91 @@ TEST_CASE("CAS Service: upload incomplete tree", "[execution_service]") {
     status = Upload(&cas_server, instance_name, tree_digest, tree->second);
     CHECK(status.ok());
 }
+
+TEST_CASE("CAS Service: GetTree", "[execution_service]") {
+    auto const storage_config = TestStorageConfig::Create();
+    auto const storage = Storage::Create(&storage_config.Get());
+    LocalExecutionConfig const local_exec_config{};
+
+    // pack the local context instances to be passed
+    LocalContext const local_context{.exec_config = &local_exec_config,
+                                     .storage_config = &storage_config.Get(),
+                                     .storage = &storage};
+
+    auto cas_server = CASServiceImpl{&local_context};
+    auto const hash_function = storage_config.Get().hash_function;
+
+    // Create a tree of three distinct directories, with the empty directory
+    // occurring twice.
+    auto const empty = UploadDirectory(&cas_server, hash_function, {});
+    auto const sub =
+        UploadDirectory(&cas_server, hash_function, {{"e", empty}});
+    auto const root =
+        UploadDirectory(&cas_server, hash_function, {{"a", sub}, {"b", empty}});
+
+    SECTION("All directories at once") {
+        std::vector<bazel_re::Directory> directories{};
+        auto [status, token] =
+            GetTree(&cas_server, root, /*page_size=*/0, "", &directories);
+        CHECK(status.ok());
+        CHECK(token.empty());
+        REQUIRE(directories.size() == 3);
+    }
+
+    SECTION("Paged") {
+        std::vector<bazel_re::Directory> directories{};
+        std::string token{};
+        int pages = 0;
+        do {  // NOLINT(cppcoreguidelines-avoid-do-while)
+            auto [status, next_token] = GetTree(
+                &cas_server, root, /*page_size=*/1, token, &directories);
+            REQUIRE(status.ok());
+            token = std::move(next_token);
+            ++pages;
+            REQUIRE(directories.size() == static_cast<std::size_t>(pages));
+        } while (not token.empty());
+        CHECK(pages == 3);
+        // the root comes first
+        CHECK(directories[0].directories_size() == 2);
+    }
+
+    SECTION("Invalid requests") {
+        std::vector<bazel_re::Directory> directories{};
+        auto [status, token] =
+            GetTree(&cas_server, root, /*page_size=*/1, "", &directories);
+        REQUIRE(status.ok());
+        REQUIRE_FALSE(token.empty());
+
+        // tokens are bound to their root
+        auto const other_root =
+            GetTree(&cas_server, sub, /*page_size=*/1, token, &directories);
+        CHECK(other_root.first.error_code() ==
+              grpc::StatusCode::INVALID_ARGUMENT);
+
+        auto const unknown = GetTree(
+            &cas_server, root, /*page_size=*/1, "unknown", &directories);
+        CHECK(unknown.first.error_code() == grpc::StatusCode::INVALID_ARGUMENT);
+
+        auto const missing =
+            ProtocolTraits::IsNative(hash_function.GetType())
+                ? BazelDigestFactory::HashDataAs<ObjectType::Tree>(
+                      hash_function, "missing")
+                : BazelDigestFactory::HashDataAs<ObjectType::File>(
+                      hash_function, "missing");
+        auto const not_found =
+            GetTree(&cas_server, missing, /*page_size=*/0, "", &directories);
+        CHECK(not_found.first.error_code() == grpc::StatusCode::NOT_FOUND);
+    }
+
+    SECTION("Stream closed by client") {
+        auto request = bazel_re::GetTreeRequest{};
+        request.set_instance_name("remote-execution");
+        request.mutable_root_digest()->CopyFrom(root);
+        request.set_page_size(1);
+        auto writer = MockGetTreeWriter{};
+        writer.closed = true;
+        auto const status = cas_server.GetTree(nullptr, &request, writer.Get());
+        CHECK(status.error_code() == grpc::StatusCode::CANCELLED);
+        CHECK(writer.responses.empty());
+    }
+}
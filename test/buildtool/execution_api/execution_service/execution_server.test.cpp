@@ -16,13 +16,17 @@
 
 #include <algorithm>
 #include <compare>
+#include <condition_variable>
+#include <cstddef>
 #include <cstdlib>
 #include <functional>
 #include <iterator>
 #include <map>
 #include <memory>
+#include <mutex>
 #include <optional>
 #include <string>
+#include <thread>
 #include <unordered_set>
 #include <utility>
 #include <vector>
@@ -46,15 +50,18 @@
 #include "src/buildtool/common/protocol_traits.hpp"
 #include "src/buildtool/crypto/hash_function.hpp"
 #include "src/buildtool/execution_api/execution_service/cas_server.hpp"
+#include "src/buildtool/execution_api/execution_service/operation_cache.hpp"
 #include "src/buildtool/execution_api/local/config.hpp"
 #include "src/buildtool/execution_api/local/context.hpp"
 #include "src/buildtool/execution_api/local/local_api.hpp"
 #include "src/buildtool/execution_api/remote/bazel/bazel_capabilities_client.hpp"
+#include "src/buildtool/file_system/file_system_manager.hpp"
 #include "src/buildtool/file_system/git_repo.hpp"
 #include "src/buildtool/file_system/object_type.hpp"
 #include "src/buildtool/storage/config.hpp"
 #include "src/buildtool/storage/storage.hpp"
 #include "src/utils/cpp/expected.hpp"
+#include "src/utils/cpp/hex_string.hpp"
 #include "test/utils/hermeticity/test_hash_function_type.hpp"
 #include "test/utils/hermeticity/test_storage_config.hpp"
 
@@ -63,7 +70,8 @@ namespace {
 auto const kV20 = Capabilities::Version{.major = 2, .minor = 0, .patch = 0};
 auto const kV21 = Capabilities::Version{.major = 2, .minor = 1, .patch = 0};
 
-// Class to obtain a valid pointer to internal ServerWriter<...::Operation>
+// Class to obtain a valid pointer to internal ServerWriter<...::Operation>,
+// recording the written operations
 class MockServerWriter final
     : public ::grpc::ServerWriterInterface<::google::longrunning::Operation> {
   public:
@@ -79,12 +87,33 @@ class MockServerWriter final
     void SendInitialMetadata() override {}
     using ::grpc::internal::WriterInterface<
         google::longrunning::Operation>::Write;
-    auto Write(google::longrunning::Operation const& /*msg*/,
+    auto Write(google::longrunning::Operation const& msg,
                grpc::WriteOptions /*options*/) -> bool override {
+        {
+            std::unique_lock lock{mutex_};
+            written_.push_back(msg);
+        }
+        cv_.notify_all();
         return true;
     }
 
+    /// \brief Wait until at least the given number of operations is written.
+    void WaitForWrites(std::size_t count) {
+        std::unique_lock lock{mutex_};
+        cv_.wait(lock, [this, count]() { return written_.size() >= count; });
+    }
+
+    [[nodiscard]] auto Written()
+        -> std::vector<google::longrunning::Operation> {
+        std::unique_lock lock{mutex_};
+        return written_;
+    }
+
   private:
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::vector<google::longrunning::Operation> written_;
+
     MockServerWriter(grpc::internal::Call* /*call*/,
                      grpc::ServerContext* /*ctx*/) {}
 };
@@ -104,7 +133,8 @@ template <ObjectType kType>
     req->mutable_digest()->CopyFrom(digest);
     req->set_data(content);
     auto response = bazel_re::BatchUpdateBlobsResponse{};
-    if (cas_server->BatchUpdateBlobs(nullptr, &request, &response).ok()) {
+    ::grpc::ServerContext context{};
+    if (cas_server->BatchUpdateBlobs(&context, &request, &response).ok()) {
         return digest;
     }
     return std::nullopt;
@@ -133,10 +163,38 @@ template <ObjectType kType>
     return *digest;
 }
 
-[[nodiscard]] auto Execute(
+/// \brief Store a tree with a file whose content is missing in the CAS, so
+/// that staging it as input root fails. Such a tree cannot be uploaded via the
+/// CAS service, which enforces the tree invariant in native mode.
+[[nodiscard]] auto CreateTreeWithMissingFile(Storage const& storage)
+    -> bazel_re::Digest {
+    auto const hash_function = storage.GetHashFunction();
+    auto const missing = BazelDigestFactory::HashDataAs<ObjectType::File>(
+        hash_function, "missing content");
+    if (ProtocolTraits::IsNative(hash_function.GetType())) {
+        auto const raw_id = FromHexString(missing.hash());
+        REQUIRE(raw_id);
+        auto entries = GitRepo::tree_entries_t{};
+        entries[*raw_id].emplace_back("missing", ObjectType::File);
+        auto const tree = GitRepo::CreateShallowTree(entries);
+        REQUIRE(tree);
+        REQUIRE(storage.CAS().StoreTree(tree->second));
+        return BazelDigestFactory::HashDataAs<ObjectType::Tree>(hash_function,
+                                                                tree->second);
+    }
+    auto dir = bazel_re::Directory{};
+    auto* file = dir.add_files();
+    file->set_name("missing");
+    file->mutable_digest()->CopyFrom(missing);
+    auto const content = dir.SerializeAsString();
+    REQUIRE(storage.CAS().StoreBlob(content));
+    return BazelDigestFactory::HashDataAs<ObjectType::File>(hash_function,
+                                                            content);
+}
+
+[[nodiscard]] auto CreateAction(
     gsl::not_null<bazel_re::ContentAddressableStorage::Service*> const&
         cas_server,
-    gsl::not_null<bazel_re::Execution::Service*> const& exec_server,
     gsl::not_null<const StorageConfig*> const& storage_config,
     std::string const& instance_name,
     bazel_re::Digest const& root_digest,
@@ -146,8 +204,7 @@ template <ObjectType kType>
     std::vector<std::string> output_dirs,
     std::map<std::string, std::string> const& env,
     std::map<std::string, std::string> const& properties,
-    Capabilities::Version const& version) noexcept
-    -> std::optional<ArtifactDigest> {
+    Capabilities::Version const& version) noexcept -> bazel_re::Digest {
     auto get_platform = [&properties]() {
         auto platform = std::make_unique<bazel_re::Platform>();
         std::transform(properties.begin(),
@@ -212,24 +269,70 @@ template <ObjectType kType>
     auto action_digest = Upload<ObjectType::File>(
         cas_server, instance_name, storage_config, action.SerializeAsString());
     REQUIRE(action_digest);
+    return *action_digest;
+}
 
-    // create execute request
+[[nodiscard]] auto CreateExecuteRequest(std::string const& instance_name,
+                                        bazel_re::Digest const& action_digest)
+    -> bazel_re::ExecuteRequest {
     auto request = bazel_re::ExecuteRequest{};
     request.set_instance_name(instance_name);
-    request.mutable_action_digest()->CopyFrom(*action_digest);
+    request.mutable_action_digest()->CopyFrom(action_digest);
+    return request;
+}
+
+[[nodiscard]] auto Execute(
+    gsl::not_null<bazel_re::ContentAddressableStorage::Service*> const&
+        cas_server,
+    gsl::not_null<bazel_re::Execution::Service*> const& exec_server,
+    gsl::not_null<const StorageConfig*> const& storage_config,
+    std::string const& instance_name,
+    bazel_re::Digest const& root_digest,
+    std::string const& cwd,
+    std::vector<std::string> const& argv,
+    std::vector<std::string> output_files,
+    std::vector<std::string> output_dirs,
+    std::map<std::string, std::string> const& env,
+    std::map<std::string, std::string> const& properties,
+    Capabilities::Version const& version) noexcept
+    -> std::optional<ArtifactDigest> {
+    auto const action_digest = CreateAction(cas_server,
+                                            storage_config,
+                                            instance_name,
+                                            root_digest,
+                                            cwd,
+                                            argv,
+                                            std::move(output_files),
+                                            std::move(output_dirs),
+                                            env,
+                                            properties,
+                                            version);
+    auto const request = CreateExecuteRequest(instance_name, action_digest);
 
     // mock server-internal execute call
     auto writer = MockServerWriter{};
     auto status = exec_server->Execute(nullptr, &request, writer.Get());
     if (status.ok()) {
         if (auto just_digest = ArtifactDigestFactory::FromBazel(
-                storage_config->hash_function.GetType(), *action_digest)) {
+                storage_config->hash_function.GetType(), action_digest)) {
             return *std::move(just_digest);
         }
     }
     return std::nullopt;
 }
 
+/// \brief Command waiting for the given file to exist, then running the given
+/// shell commands.
+[[nodiscard]] auto WaitForFile(std::filesystem::path const& file,
+                               std::string const& then)
+    -> std::vector<std::string> {
+    return {"/bin/sh",
+            "-c",
+            fmt::format("while [ ! -e {} ]; do sleep 0.01; done; {}",
+                        file.string(),
+                        then)};
+}
+
 [[nodiscard]] auto ToString(Capabilities::Version const& version)
     -> std::string {
     return fmt::format("{}.{}.{}", version.major, version.minor, version.patch);
@@ -250,7 +353,10 @@ TEST_CASE("Execution Service: Test supported API versions",
 
     auto local_api = LocalApi{&local_context};
     auto exec_server =
-        ExecutionServiceImpl{&local_context, &local_api, std::nullopt};
+        ExecutionServiceImpl{&local_context,
+                             &local_api,
+                             std::nullopt,
+                             /*action_slots=*/0};
 
     auto cas_server = CASServiceImpl{&local_context};
     auto instance_name = std::string{"remote-execution"};
@@ -338,3 +444,293 @@ TEST_CASE("Execution Service: Test supported API versions",
         }
     }
 }
+
+TEST_CASE("Execution Service: Output streams are stored in CAS",
+          "[execution_service]") {
+    auto const storage_config = TestStorageConfig::Create();
+    auto const storage = Storage::Create(&storage_config.Get());
+    LocalExecutionConfig const local_exec_config{};
+
+    // pack the local context instances to be passed
+    LocalContext const local_context{.exec_config = &local_exec_config,
+                                     .storage_config = &storage_config.Get(),
+                                     .storage = &storage};
+
+    auto local_api = LocalApi{&local_context};
+    auto exec_server =
+        ExecutionServiceImpl{&local_context,
+                             &local_api,
+                             std::nullopt,
+                             /*action_slots=*/0};
+
+    auto cas_server = CASServiceImpl{&local_context};
+    auto instance_name = std::string{"remote-execution"};
+
+    auto root_digest =
+        CreateEmptyTree(&cas_server, &storage_config.Get(), instance_name);
+
+    auto env = std::map<std::string, std::string>{};
+    if (auto const* path_var = std::getenv("PATH")) {
+        // server executes locally, make sure it knows about PATH from TEST_ENV
+        env.emplace("PATH", path_var);
+    }
+
+    // stdout larger than a single read chunk, stderr small
+    constexpr std::size_t kStdOutSize = (std::size_t{1} << 20U) + 1;
+    auto action_digest =
+        Execute(&cas_server,
+                &exec_server,
+                &storage_config.Get(),
+                instance_name,
+                root_digest,
+                "",
+                {"/bin/sh",
+                 "-c",
+                 fmt::format("head -c {} /dev/zero; printf err >&2",
+                             kStdOutSize)},
+                {},
+                {},
+                env,
+                {},
+                kV21);
+    REQUIRE(action_digest);
+
+    auto result = storage.ActionCache().CachedResult(*action_digest);
+    REQUIRE(result);
+
+    auto const check_stream = [&](bazel_re::Digest const& digest,
+                                  std::string const& content) {
+        auto const expected = BazelDigestFactory::HashDataAs<ObjectType::File>(
+            storage_config.Get().hash_function, content);
+        CHECK(digest.hash() == expected.hash());
+        CHECK(digest.size_bytes() == expected.size_bytes());
+        auto const just_digest = ArtifactDigestFactory::FromBazel(
+            storage_config.Get().hash_function.GetType(), digest);
+        REQUIRE(just_digest);
+        auto const path =
+            storage.CAS().BlobPath(*just_digest, /*is_executable=*/false);
+        REQUIRE(path);
+        CHECK(FileSystemManager::ReadFile(*path) == content);
+    };
+    check_stream(result->stdout_digest(), std::string(kStdOutSize, '\0'));
+    check_stream(result->stderr_digest(), "err");
+}
+
+TEST_CASE("Execution Service: Identical actions are executed once",
+          "[execution_service]") {
+    auto const storage_config = TestStorageConfig::Create();
+    auto const storage = Storage::Create(&storage_config.Get());
+    LocalExecutionConfig const local_exec_config{};
+
+    // pack the local context instances to be passed
+    LocalContext const local_context{.exec_config = &local_exec_config,
+                                     .storage_config = &storage_config.Get(),
+                                     .storage = &storage};
+
+    auto local_api = LocalApi{&local_context};
+    auto exec_server =
+        ExecutionServiceImpl{&local_context,
+                             &local_api,
+                             std::nullopt,
+                             /*action_slots=*/0};
+
+    auto cas_server = CASServiceImpl{&local_context};
+    auto instance_name = std::string{"remote-execution"};
+
+    auto root_digest =
+        CreateEmptyTree(&cas_server, &storage_config.Get(), instance_name);
+
+    auto env = std::map<std::string, std::string>{};
+    if (auto const* path_var = std::getenv("PATH")) {
+        // server executes locally, make sure it knows about PATH from TEST_ENV
+        env.emplace("PATH", path_var);
+    }
+
+    auto const test_dir = storage_config.Get().CreateTypedTmpDir("coalesce");
+    REQUIRE(test_dir != nullptr);
+    auto const flag = test_dir->GetPath() / "flag";
+    auto const runs = test_dir->GetPath() / "runs";
+
+    auto const action_digest = CreateAction(
+        &cas_server,
+        &storage_config.Get(),
+        instance_name,
+        root_digest,
+        "",
+        WaitForFile(flag, fmt::format("echo run >> {}", runs.string())),
+        {},
+        {},
+        env,
+        {},
+        kV21);
+    auto const request = CreateExecuteRequest(instance_name, action_digest);
+
+    auto owner = MockServerWriter{};
+    auto attached = MockServerWriter{};
+    auto owner_status = ::grpc::Status{};
+    auto attached_status = ::grpc::Status{};
+    std::thread owner_thread{[&]() {
+        owner_status = exec_server.Execute(nullptr, &request, owner.Get());
+    }};
+    // wait until the action is queued and executing
+    owner.WaitForWrites(2);
+    std::thread attached_thread{[&]() {
+        attached_status =
+            exec_server.Execute(nullptr, &request, attached.Get());
+    }};
+    // wait until the current state of the operation is sent
+    attached.WaitForWrites(1);
+    CHECK(FileSystemManager::WriteFile("", flag));
+    owner_thread.join();
+    attached_thread.join();
+
+    CHECK(owner_status.ok());
+    CHECK(attached_status.ok());
+    CHECK(FileSystemManager::ReadFile(runs) == "run\n");
+
+    // both requests got the same updates from the executing state onwards
+    auto const owner_ops = owner.Written();
+    auto const attached_ops = attached.Written();
+    REQUIRE(owner_ops.size() >= 2);
+    REQUIRE(attached_ops.size() == owner_ops.size() - 1);
+    for (std::size_t i = 0; i < attached_ops.size(); ++i) {
+        CHECK(attached_ops[i].SerializeAsString() ==
+              owner_ops[i + 1].SerializeAsString());
+    }
+    CHECK(attached_ops.back().done());
+    CHECK_FALSE(attached_ops.back().has_error());
+}
+
+TEST_CASE("Execution Service: Attached requests learn about failures",
+          "[execution_service]") {
+    auto const storage_config = TestStorageConfig::Create();
+    auto const storage = Storage::Create(&storage_config.Get());
+    LocalExecutionConfig const local_exec_config{};
+
+    // pack the local context instances to be passed
+    LocalContext const local_context{.exec_config = &local_exec_config,
+                                     .storage_config = &storage_config.Get(),
+                                     .storage = &storage};
+
+    // a single slot, so that the failing action can be held in the queue
+    auto local_api = LocalApi{&local_context};
+    auto exec_server =
+        ExecutionServiceImpl{&local_context,
+                             &local_api,
+                             std::nullopt,
+                             /*action_slots=*/1};
+
+    auto cas_server = CASServiceImpl{&local_context};
+    auto instance_name = std::string{"remote-execution"};
+
+    auto root_digest =
+        CreateEmptyTree(&cas_server, &storage_config.Get(), instance_name);
+
+    auto env = std::map<std::string, std::string>{};
+    if (auto const* path_var = std::getenv("PATH")) {
+        // server executes locally, make sure it knows about PATH from TEST_ENV
+        env.emplace("PATH", path_var);
+    }
+
+    auto const test_dir = storage_config.Get().CreateTypedTmpDir("failure");
+    REQUIRE(test_dir != nullptr);
+    auto const flag = test_dir->GetPath() / "flag";
+
+    auto const blocker_request = CreateExecuteRequest(
+        instance_name,
+        CreateAction(&cas_server,
+                     &storage_config.Get(),
+                     instance_name,
+                     root_digest,
+                     "",
+                     WaitForFile(flag, "true"),
+                     {},
+                     {},
+                     env,
+                     {},
+                     kV21));
+    // a file of the input root of this action is missing, so staging its
+    // inputs fails
+    auto const missing_root = CreateTreeWithMissingFile(storage);
+    auto const failing_request = CreateExecuteRequest(
+        instance_name,
+        CreateAction(&cas_server,
+                     &storage_config.Get(),
+                     instance_name,
+                     missing_root,
+                     "",
+                     {"true"},
+                     {},
+                     {},
+                     env,
+                     {},
+                     kV21));
+
+    auto blocker = MockServerWriter{};
+    auto owner = MockServerWriter{};
+    auto attached = MockServerWriter{};
+    auto blocker_status = ::grpc::Status{};
+    auto owner_status = ::grpc::Status{};
+    auto attached_status = ::grpc::Status{};
+    std::thread blocker_thread{[&]() {
+        blocker_status =
+            exec_server.Execute(nullptr, &blocker_request, blocker.Get());
+    }};
+    // wait until the blocker takes the slot
+    blocker.WaitForWrites(2);
+    std::thread owner_thread{[&]() {
+        owner_status =
+            exec_server.Execute(nullptr, &failing_request, owner.Get());
+    }};
+    // wait until the operation is queued
+    owner.WaitForWrites(1);
+    std::thread attached_thread{[&]() {
+        attached_status =
+            exec_server.Execute(nullptr, &failing_request, attached.Get());
+    }};
+    // wait until the current state of the operation is sent
+    attached.WaitForWrites(1);
+    CHECK(FileSystemManager::WriteFile("", flag));
+    blocker_thread.join();
+    owner_thread.join();
+    attached_thread.join();
+
+    CHECK(blocker_status.ok());
+    CHECK_FALSE(owner_status.ok());
+
+    // the attached request does not wait forever, but reports the failure
+    CHECK(attached_status.ok());
+    auto const attached_ops = attached.Written();
+    REQUIRE_FALSE(attached_ops.empty());
+    CHECK(attached_ops.back().done());
+    CHECK(attached_ops.back().error().code() == ::grpc::StatusCode::INTERNAL);
+}
+
+TEST_CASE("Operation cache: Subscribers follow an operation",
+          "[execution_service]") {
+    OperationCache cache{};
+    auto op = ::google::longrunning::Operation{};
+    op.set_name("op");
+
+    std::vector<bool> reported{};
+    auto const listener = [&reported](auto const& current) {
+        reported.push_back(current.done());
+    };
+    CHECK_FALSE(cache.Subscribe("op", listener));
+
+    // the listener is called by the setting thread, nothing waits
+    cache.Set("op", op);
+    REQUIRE(cache.Subscribe("op", listener));
+    CHECK(reported == std::vector<bool>{false});
+    cache.Set("op", op);
+    CHECK(reported == std::vector<bool>{false, false});
+    op.set_done(true);
+    cache.Set("op", op);
+    CHECK(reported == std::vector<bool>{false, false, true});
+
+    // done operations are reported once, and not followed anymore
+    cache.Set("op", op);
+    CHECK(reported.size() == 3);
+    REQUIRE(cache.Subscribe("op", listener));
+    CHECK(reported == std::vector<bool>{false, false, true, true});
+}
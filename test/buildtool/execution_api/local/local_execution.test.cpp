@@ -12,6 +12,8 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <unistd.h>
+
 #include <cstdlib>
 #include <filesystem>
 #include <functional>
@@ -25,6 +27,7 @@
 #include <vector>
 
 #include "catch2/catch_test_macros.hpp"
+#include "catch2/generators/catch_generators_all.hpp"
 #include "fmt/core.h"
 #include "gsl/gsl"
 #include "src/buildtool/common/artifact_blob.hpp"
@@ -61,8 +64,8 @@ constexpr bool kLegacyApi = false;  // do not force legacy api logic
            "test/buildtool/execution_api/local";
 }
 
-[[nodiscard]] inline auto CreateLocalExecConfig() noexcept
-    -> LocalExecutionConfig {
+[[nodiscard]] inline auto CreateLocalExecConfig(
+    bool cached_staging = false) noexcept -> LocalExecutionConfig {
     std::vector<std::string> launcher{"env"};
     auto* env_path = std::getenv("PATH");
     if (env_path != nullptr) {
@@ -72,7 +75,9 @@ constexpr bool kLegacyApi = false;  // do not force legacy api logic
         launcher.emplace_back("PATH=/bin:/usr/bin");
     }
     LocalExecutionConfig::Builder builder;
-    if (auto config = builder.SetLauncher(std::move(launcher)).Build()) {
+    if (auto config = builder.SetLauncher(std::move(launcher))
+                          .SetCachedStaging(cached_staging)
+                          .Build()) {
         return *std::move(config);
     }
     Logger::Log(LogLevel::Error, "Failure setting the local launcher.");
@@ -350,6 +355,132 @@ TEST_CASE("LocalExecution: One input copied to output", "[execution_api]") {
     }
 }
 
+TEST_CASE("LocalExecution: Cached staging of input trees",
+          "[execution_api]") {
+    auto const storage_config = TestStorageConfig::Create();
+    auto const storage = Storage::Create(&storage_config.Get());
+    auto const local_exec_config =
+        CreateLocalExecConfig(/*cached_staging=*/true);
+
+    // pack the local context instances to be passed to LocalApi
+    LocalContext const local_context{.exec_config = &local_exec_config,
+                                     .storage_config = &storage_config.Get(),
+                                     .storage = &storage};
+
+    RepositoryConfig repo_config{};
+
+    auto api = LocalApi(&local_context, &repo_config);
+
+    std::string test_content("test");
+    auto const test_blob = ArtifactBlob::FromMemory(
+        storage_config.Get().hash_function, ObjectType::File, test_content);
+    REQUIRE(test_blob);
+    REQUIRE(api.Upload({*test_blob}, false));
+
+    std::string input_path{"dir/subdir/input"};
+    auto local_artifact_opt = ArtifactDescription::CreateKnown(
+                                  test_blob->GetDigest(), ObjectType::File)
+                                  .ToArtifact();
+    auto local_artifact =
+        DependencyGraph::ArtifactNode{std::move(local_artifact_opt)};
+    auto const root = api.UploadTree({{input_path, &local_artifact}});
+    REQUIRE(root);
+
+    // Inputs are either taken from the staging cache or, if an output is
+    // located inside, staged regularly.
+    auto const output_path = GENERATE(std::string{"output_file"},
+                                      std::string{"dir/subdir/output_file"});
+    std::vector<std::string> const cmdline = {"cp", input_path, output_path};
+
+    // Stage the same trees repeatedly, to also reuse materialized trees.
+    for (int i{}; i < 3; ++i) {
+        auto action = api.CreateAction(
+            *root, cmdline, "", {output_path}, {}, {}, {}, kLegacyApi);
+        REQUIRE(action);
+        action->SetCacheFlag(IExecutionAction::CacheFlag::DoNotCacheOutput);
+        auto output = action->Execute(nullptr);
+        REQUIRE(output);
+        CHECK(output->ExitCode() == 0);
+
+        auto const artifacts = output->Artifacts();
+        REQUIRE(artifacts.has_value());
+        REQUIRE(artifacts.value()->contains(output_path));
+        CHECK(artifacts.value()->at(output_path).digest ==
+              test_blob->GetDigest());
+    }
+}
+
+TEST_CASE("LocalExecution: Cached staging keeps input directories read-only",
+          "[execution_api]") {
+    auto const storage_config = TestStorageConfig::Create();
+    auto const storage = Storage::Create(&storage_config.Get());
+    auto const local_exec_config =
+        CreateLocalExecConfig(/*cached_staging=*/true);
+
+    // pack the local context instances to be passed to LocalApi
+    LocalContext const local_context{.exec_config = &local_exec_config,
+                                     .storage_config = &storage_config.Get(),
+                                     .storage = &storage};
+
+    RepositoryConfig repo_config{};
+
+    auto api = LocalApi(&local_context, &repo_config);
+
+    std::string test_content("test");
+    auto const test_blob = ArtifactBlob::FromMemory(
+        storage_config.Get().hash_function, ObjectType::File, test_content);
+    REQUIRE(test_blob);
+    REQUIRE(api.Upload({*test_blob}, false));
+
+    std::string input_path{"dir/subdir/input"};
+    auto local_artifact_opt = ArtifactDescription::CreateKnown(
+                                  test_blob->GetDigest(), ObjectType::File)
+                                  .ToArtifact();
+    auto local_artifact =
+        DependencyGraph::ArtifactNode{std::move(local_artifact_opt)};
+    auto const root = api.UploadTree({{input_path, &local_artifact}});
+    REQUIRE(root);
+
+    std::string output_path{"output_file"};
+    std::string scratch_path{"dir/subdir/scratch"};
+    std::vector<std::string> const cmdline = {
+        "sh",
+        "-c",
+        fmt::format("touch {} && cp {} {}",
+                    scratch_path,
+                    input_path,
+                    output_path)};
+
+    // The super user stages inputs regularly, i.e., writable.
+    bool const cached = ::geteuid() != 0;
+
+    SECTION("Writing into an input directory fails") {
+        auto action = api.CreateAction(
+            *root, cmdline, "", {output_path}, {}, {}, {}, kLegacyApi);
+        REQUIRE(action);
+        action->SetCacheFlag(IExecutionAction::CacheFlag::DoNotCacheOutput);
+        auto output = action->Execute(nullptr);
+        REQUIRE(output);
+        CHECK((output->ExitCode() == 0) == not cached);
+    }
+
+    SECTION("Writing into the directory of an output succeeds") {
+        auto action = api.CreateAction(*root,
+                                       cmdline,
+                                       "",
+                                       {output_path, scratch_path},
+                                       {},
+                                       {},
+                                       {},
+                                       kLegacyApi);
+        REQUIRE(action);
+        action->SetCacheFlag(IExecutionAction::CacheFlag::DoNotCacheOutput);
+        auto output = action->Execute(nullptr);
+        REQUIRE(output);
+        CHECK(output->ExitCode() == 0);
+    }
+}
+
 TEST_CASE("LocalExecution: Cache failed action's result", "[execution_api]") {
     auto const storage_config = TestStorageConfig::Create();
     auto const storage = Storage::Create(&storage_config.Get());
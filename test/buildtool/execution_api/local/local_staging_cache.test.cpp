@@ -0,0 +1,136 @@
+// Copyright 2026 Huawei Cloud Computing Technology Co., Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "src/buildtool/execution_api/local/local_staging_cache.hpp"
+
+#include <cstddef>
+#include <filesystem>
+#include <map>
+#include <memory>
+#include <string>
+
+#include "catch2/catch_test_macros.hpp"
+#include "src/buildtool/common/artifact_digest.hpp"
+#include "src/buildtool/common/artifact_digest_factory.hpp"
+#include "src/buildtool/file_system/file_system_manager.hpp"
+#include "src/buildtool/file_system/object_type.hpp"
+#include "src/utils/cpp/tmp_dir.hpp"
+#include "test/utils/hermeticity/test_storage_config.hpp"
+
+namespace {
+
+/// \brief Materializes trees consisting of a directory with a single file,
+/// counting the materializations per tree.
+class CountingMaterializer final {
+  public:
+    [[nodiscard]] auto For(std::string const& name)
+        -> LocalStagingCache::Materializer {
+        return [this, name](std::filesystem::path const& dir) {
+            ++count_[name];
+            return FileSystemManager::CreateDirectory(dir / "sub") and
+                   FileSystemManager::WriteFile(name, dir / "sub" / "file");
+        };
+    }
+
+    [[nodiscard]] auto Count(std::string const& name) -> std::size_t {
+        return count_[name];
+    }
+
+  private:
+    std::map<std::string, std::size_t> count_;
+};
+
+}  // namespace
+
+TEST_CASE("LocalStagingCache: Reuse and discard copies", "[execution_api]") {
+    auto const storage_config = TestStorageConfig::Create();
+    auto const& hash_function = storage_config.Get().hash_function;
+    auto const workspace = storage_config.Get().CreateTypedTmpDir("test");
+    REQUIRE(workspace != nullptr);
+    auto const root = workspace->GetPath() / "build_root";
+
+    auto const tree_a = ArtifactDigestFactory::HashDataAs<ObjectType::Tree>(
+        hash_function, "a");
+    auto const tree_b = ArtifactDigestFactory::HashDataAs<ObjectType::Tree>(
+        hash_function, "b");
+    CountingMaterializer materializer{};
+
+    SECTION("Unmodified copies are reused") {
+        auto cache = std::make_shared<LocalStagingCache>(
+            storage_config.Get().CreateTypedTmpDir("staging"));
+        for (int i{}; i < 3; ++i) {
+            LocalStagingCache::StagedTrees staged{cache, root};
+            REQUIRE(staged.Stage(tree_a, root / "a", materializer.For("a")));
+            CHECK(FileSystemManager::IsFile(root / "a" / "sub" / "file"));
+        }
+        CHECK(materializer.Count("a") == 1);
+    }
+
+    SECTION("Modified copies are discarded") {
+        auto cache = std::make_shared<LocalStagingCache>(
+            storage_config.Get().CreateTypedTmpDir("staging"));
+        {
+            LocalStagingCache::StagedTrees staged{cache, root};
+            REQUIRE(staged.Stage(tree_a, root / "a", materializer.For("a")));
+            // modify the copy, restoring its permissions afterwards
+            auto const sub = root / "a" / "sub";
+            LocalStagingCache::MakeWritable(sub);
+            REQUIRE(FileSystemManager::WriteFile("extra", sub / "extra"));
+            std::filesystem::permissions(
+                sub,
+                std::filesystem::perms::owner_write |
+                    std::filesystem::perms::group_write |
+                    std::filesystem::perms::others_write,
+                std::filesystem::perm_options::remove);
+        }
+        // the modified copy is left in the build root
+        REQUIRE(FileSystemManager::IsDirectory(root / "a"));
+        REQUIRE(FileSystemManager::RemoveDirectory(root));
+        {
+            LocalStagingCache::StagedTrees staged{cache, root};
+            REQUIRE(staged.Stage(tree_a, root / "a", materializer.For("a")));
+            CHECK(FileSystemManager::IsFile(root / "a" / "sub" / "file"));
+            CHECK_FALSE(
+                FileSystemManager::Exists(root / "a" / "sub" / "extra"));
+        }
+        CHECK(materializer.Count("a") == 2);
+    }
+
+    SECTION("Least recently released copies are evicted") {
+        // limit the idle copies to a single tree of two entries
+        auto const pool = storage_config.Get().CreateTypedTmpDir("staging");
+        REQUIRE(pool != nullptr);
+        auto cache = std::make_shared<LocalStagingCache>(pool, 2);
+        {
+            // a is released before b
+            LocalStagingCache::StagedTrees staged{cache, root};
+            REQUIRE(staged.Stage(tree_a, root / "a", materializer.For("a")));
+            REQUIRE(staged.Stage(tree_b, root / "b", materializer.For("b")));
+        }
+        std::size_t pooled{};
+        for (auto const& entry :
+             std::filesystem::directory_iterator{pool->GetPath()}) {
+            CHECK(entry.is_directory());
+            ++pooled;
+        }
+        CHECK(pooled == 1);
+        {
+            LocalStagingCache::StagedTrees staged{cache, root};
+            REQUIRE(staged.Stage(tree_a, root / "a", materializer.For("a")));
+            REQUIRE(staged.Stage(tree_b, root / "b", materializer.For("b")));
+        }
+        CHECK(materializer.Count("a") == 2);
+        CHECK(materializer.Count("b") == 1);
+    }
+}
@@ -16,11 +16,13 @@
 
 #include <algorithm>
 #include <chrono>
+#include <cstddef>
 #include <exception>
 #include <filesystem>
 #include <functional>
 #include <map>
 #include <memory>
+#include <mutex>
 #include <optional>
 #include <string>
 #include <unordered_map>
@@ -30,6 +32,7 @@
 #include <vector>
 
 #include "catch2/catch_test_macros.hpp"
+#include "catch2/generators/catch_generators_all.hpp"
 #include "gsl/gsl"
 #include "src/buildtool/auth/authentication.hpp"
 #include "src/buildtool/common/action.hpp"
@@ -56,6 +59,7 @@
 #include "src/buildtool/file_system/file_system_manager.hpp"
 #include "src/buildtool/file_system/object_type.hpp"
 #include "src/buildtool/logging/logger.hpp"
+#include "src/buildtool/multithreading/task_system.hpp"
 #include "src/buildtool/progress_reporting/progress.hpp"
 #include "src/buildtool/storage/config.hpp"
 #include "src/utils/cpp/expected.hpp"
@@ -81,9 +85,17 @@ struct TestApiConfig {
         int exit_code{};
     };
 
+    struct TestUploadConfig {
+        bool takes_ownership{true};
+        // content written to volatile files before they are read, to simulate
+        // a concurrent modification
+        std::optional<std::string> change_files_to;
+    };
+
     std::unordered_map<std::string, TestArtifactConfig> artifacts;
     TestExecutionConfig execution;
     TestResponseConfig response;
+    TestUploadConfig upload;
 };
 
 static auto NamedDigest(std::string const& str) -> ArtifactDigest {
@@ -241,6 +253,13 @@ class TestApi : public IExecutionApi {
                               bool /*unused*/) const noexcept -> bool final {
         return std::all_of(
             blobs.begin(), blobs.end(), [this](auto const& blob) {
+                uploaded_files_.emplace_back(blob.GetFilePath());
+                if (config_.upload.change_files_to and blob.IsVolatile() and
+                    not FileSystemManager::WriteFile(
+                        *config_.upload.change_files_to,
+                        *blob.GetFilePath())) {
+                    return false;
+                }
                 // for local artifacts
                 auto const content = blob.ReadContent();
                 if (content == nullptr) {
@@ -293,10 +312,22 @@ class TestApi : public IExecutionApi {
         return temp_space_;
     }
 
+    [[nodiscard]] auto TakesOwnershipOfFiles() const noexcept -> bool final {
+        return config_.upload.takes_ownership;
+    }
+
+    /// \brief The source files of the uploaded blobs, in upload order;
+    /// std::nullopt for blobs uploaded from memory.
+    [[nodiscard]] auto UploadedFiles() const noexcept
+        -> std::vector<std::optional<std::filesystem::path>> const& {
+        return uploaded_files_;
+    }
+
   private:
     TestApiConfig config_{};
     HashFunction::Type hash_type_;
     TmpDir::Ptr temp_space_;
+    mutable std::vector<std::optional<std::filesystem::path>> uploaded_files_;
 };
 
 [[nodiscard]] auto SetupConfig(std::filesystem::path const& ws)
@@ -431,6 +462,130 @@ TEST_CASE("Executor: Process artifact", "[executor]") {
     }
 }
 
+TEST_CASE("Executor: Stream large local artifacts", "[executor]") {
+    auto const storage_config = TestStorageConfig::Create();
+    auto const workspace = storage_config.Get().CreateTypedTmpDir("workspace");
+    REQUIRE(workspace != nullptr);
+    auto const& ws_path = workspace->GetPath();
+
+    constexpr std::size_t kStreamWindow = 1024;
+    auto const small_content = std::string(kStreamWindow - 1, 's');
+    auto const large_content = std::string(kStreamWindow, 'l');
+    REQUIRE(FileSystemManager::WriteFile(small_content, ws_path / "small"));
+    REQUIRE(FileSystemManager::WriteFile(large_content, ws_path / "large"));
+
+    DependencyGraph g;
+    auto const small_id =
+        g.AddArtifact(ArtifactDescription::CreateLocal("small", ""));
+    auto const large_id =
+        g.AddArtifact(ArtifactDescription::CreateLocal("large", ""));
+    auto const repo_config = SetupConfig(ws_path);
+
+    TestApiConfig config{};
+    config.artifacts[small_content].uploads = true;
+    config.artifacts[large_content].uploads = true;
+    config.upload.takes_ownership = GENERATE(true, false);
+
+    Auth auth{};
+    RetryConfig retry_config{};             // default retry config
+    RemoteExecutionConfig remote_config{};  // default remote config
+    RemoteContext const remote_context{.auth = &auth,
+                                       .retry_config = &retry_config,
+                                       .exec_config = &remote_config};
+
+    auto api = std::make_shared<TestApi>(
+        config,
+        storage_config.Get().hash_function.GetType(),
+        storage_config.Get().CreateTypedTmpDir("temp_space"));
+    Statistics stats{};
+    Progress progress{};
+    auto const apis = CreateTestApiBundle(api);
+    ExecutionContext const exec_context{.repo_config = &repo_config,
+                                        .apis = &apis,
+                                        .remote_context = &remote_context,
+                                        .statistics = &stats,
+                                        .progress = &progress,
+                                        .profile = std::nullopt,
+                                        .stream_window = kStreamWindow};
+    Executor runner{&exec_context};
+
+    CHECK(runner.Process(g.ArtifactNodeWithId(small_id)));
+    CHECK(runner.Process(g.ArtifactNodeWithId(large_id)));
+
+    auto const& uploaded = api->UploadedFiles();
+    REQUIRE(uploaded.size() == 2);
+    // files below the window are uploaded from memory
+    CHECK_FALSE(uploaded[0].has_value());
+    // larger files are uploaded from disk, from a copy if the endpoint takes
+    // ownership of the file
+    REQUIRE(uploaded[1].has_value());
+    CHECK((*uploaded[1] == ws_path / "large") ==
+          not config.upload.takes_ownership);
+    CHECK(FileSystemManager::IsFile(ws_path / "large"));
+}
+
+TEST_CASE("Executor: Upload copy of changed local artifacts", "[executor]") {
+    auto const storage_config = TestStorageConfig::Create();
+    auto const workspace = storage_config.Get().CreateTypedTmpDir("workspace");
+    REQUIRE(workspace != nullptr);
+    auto const& ws_path = workspace->GetPath();
+
+    constexpr std::size_t kStreamWindow = 1024;
+    auto const large_content = std::string(kStreamWindow, 'l');
+    auto const changed_content = std::string(kStreamWindow, 'c');
+    REQUIRE(FileSystemManager::WriteFile(large_content, ws_path / "large"));
+
+    DependencyGraph g;
+    auto const large_id =
+        g.AddArtifact(ArtifactDescription::CreateLocal("large", ""));
+    auto const repo_config = SetupConfig(ws_path);
+
+    TestApiConfig config{};
+    config.artifacts[large_content].uploads = true;
+    config.artifacts[changed_content].uploads = true;
+    config.upload.takes_ownership = false;
+    config.upload.change_files_to = changed_content;
+
+    Auth auth{};
+    RetryConfig retry_config{};             // default retry config
+    RemoteExecutionConfig remote_config{};  // default remote config
+    RemoteContext const remote_context{.auth = &auth,
+                                       .retry_config = &retry_config,
+                                       .exec_config = &remote_config};
+
+    auto api = std::make_shared<TestApi>(
+        config,
+        storage_config.Get().hash_function.GetType(),
+        storage_config.Get().CreateTypedTmpDir("temp_space"));
+    Statistics stats{};
+    Progress progress{};
+    auto const apis = CreateTestApiBundle(api);
+    ExecutionContext const exec_context{.repo_config = &repo_config,
+                                        .apis = &apis,
+                                        .remote_context = &remote_context,
+                                        .statistics = &stats,
+                                        .progress = &progress,
+                                        .profile = std::nullopt,
+                                        .stream_window = kStreamWindow};
+    Executor runner{&exec_context};
+
+    auto const* node = g.ArtifactNodeWithId(large_id);
+    CHECK(runner.Process(node));
+
+    // the file changed after hashing, so its upload in place is rejected and
+    // a copy is uploaded instead
+    auto const& uploaded = api->UploadedFiles();
+    REQUIRE(uploaded.size() == 2);
+    REQUIRE(uploaded[0].has_value());
+    CHECK(*uploaded[0] == ws_path / "large");
+    REQUIRE(uploaded[1].has_value());
+    CHECK(*uploaded[1] != ws_path / "large");
+
+    auto const& info = node->Content().Info();
+    REQUIRE(info);
+    CHECK(info->digest == NamedDigest(changed_content));
+}
+
 TEST_CASE("Executor: Process action", "[executor]") {
     auto const storage_config = TestStorageConfig::Create();
     std::filesystem::path workspace_path{
@@ -619,3 +774,95 @@ TEST_CASE("Executor: Process action", "[executor]") {
         CHECK(not runner.Process(g.ArtifactNodeWithId(output2_id)));
     }
 }
+
+TEST_CASE("Executor: Process action asynchronously", "[executor]") {
+    auto const storage_config = TestStorageConfig::Create();
+    std::filesystem::path workspace_path{
+        "test/buildtool/execution_engine/executor"};
+
+    DependencyGraph g;
+    auto [config, repo_config] = CreateTest(&g, workspace_path);
+
+    HashFunction const hash_function = storage_config.Get().hash_function;
+
+    auto const local_cpp_id =
+        ArtifactDescription::CreateLocal("local.cpp", "").Id();
+
+    auto const known_cpp_id = ArtifactDescription::CreateKnown(
+                                  NamedDigest("known.cpp"), ObjectType::File)
+                                  .Id();
+
+    ActionIdentifier const action_id{"test_action"};
+    auto const output1_id =
+        ArtifactDescription::CreateAction(action_id, "output1.exe").Id();
+
+    Auth auth{};
+    RetryConfig retry_config{};             // default retry config
+    RemoteExecutionConfig remote_config{};  // default remote config
+    RemoteContext const remote_context{.auth = &auth,
+                                       .retry_config = &retry_config,
+                                       .exec_config = &remote_config};
+
+    // process the action node asynchronously, returning all results reported
+    auto process_async = [&g, &action_id](Executor const& runner) {
+        std::mutex mutex{};
+        std::vector<bool> results{};
+        {
+            TaskSystem ts{2};
+            runner.Process(g.ActionNodeWithId(action_id),
+                           &ts,
+                           [&mutex, &results](bool success) {
+                               std::unique_lock lock{mutex};
+                               results.push_back(success);
+                           });
+        }
+        return results;
+    };
+
+    SECTION("Processing succeeds for a cache hit") {
+        auto api = std::make_shared<TestApi>(
+            config,
+            hash_function.GetType(),
+            storage_config.Get().CreateTypedTmpDir("temp_space"));
+        Statistics stats{};
+        Progress progress{};
+        auto const apis = CreateTestApiBundle(api);
+        ExecutionContext const exec_context{.repo_config = &repo_config,
+                                            .apis = &apis,
+                                            .remote_context = &remote_context,
+                                            .statistics = &stats,
+                                            .progress = &progress,
+                                            .profile = std::nullopt};
+        Executor runner{&exec_context};
+
+        CHECK(runner.Process(g.ArtifactNodeWithId(local_cpp_id)));
+        CHECK(runner.Process(g.ArtifactNodeWithId(known_cpp_id)));
+        CHECK(process_async(runner) == std::vector<bool>{true});
+        CHECK(stats.ActionsCachedCounter() == 1);
+        CHECK(runner.Process(g.ArtifactNodeWithId(output1_id)));
+    }
+
+    SECTION("Processing fails if execution failed") {
+        config.execution.failed = true;
+
+        auto api = std::make_shared<TestApi>(
+            config,
+            hash_function.GetType(),
+            storage_config.Get().CreateTypedTmpDir("temp_space"));
+        Statistics stats{};
+        Progress progress{};
+        auto const apis = CreateTestApiBundle(api);
+        ExecutionContext const exec_context{.repo_config = &repo_config,
+                                            .apis = &apis,
+                                            .remote_context = &remote_context,
+                                            .statistics = &stats,
+                                            .progress = &progress,
+                                            .profile = std::nullopt};
+        Executor runner{&exec_context};
+
+        CHECK(runner.Process(g.ArtifactNodeWithId(local_cpp_id)));
+        CHECK(runner.Process(g.ArtifactNodeWithId(known_cpp_id)));
+        CHECK(process_async(runner) == std::vector<bool>{false});
+        CHECK(not runner.Process(g.ArtifactNodeWithId(output1_id)));
+    }
+}
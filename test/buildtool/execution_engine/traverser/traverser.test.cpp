@@ -16,6 +16,7 @@
 
 #include <algorithm>
 #include <atomic>
+#include <chrono>
 #include <filesystem>
 #include <functional>
 #include <iterator>
@@ -30,6 +31,7 @@
 
 #include "catch2/catch_test_macros.hpp"
 #include "catch2/matchers/catch_matchers_all.hpp"
+#include "fmt/core.h"
 #include "gsl/gsl"
 #include "nlohmann/json.hpp"
 #include "src/buildtool/common/action.hpp"
@@ -899,3 +901,97 @@ TEST_CASE("lib2 depends on lib1, executable depends on lib1 and lib2") {
         CHECK(build_info.Name() == name);
     }
 }
+
+namespace {
+
+// Executor recording the order in which actions are processed. Uploads are
+// slow, so that all actions are discovered before any of them is ready. Use a
+// single job, so that the recorded order is the dispatch order.
+class OrderRecordingExecutor {
+  public:
+    [[nodiscard]] auto Process(
+        gsl::not_null<DependencyGraph::ActionNode const*> const& action)
+        const noexcept -> bool {
+        try {
+            std::lock_guard lock{mutex_};
+            order_.push_back(action->Content().Id());
+            return true;
+        } catch (...) {
+            return false;
+        }
+    }
+
+    [[nodiscard]] auto Process(
+        gsl::not_null<DependencyGraph::ArtifactNode const*> const& /*artifact*/)
+        const noexcept -> bool {
+        std::this_thread::sleep_for(std::chrono::milliseconds{300});
+        return true;
+    }
+
+    [[nodiscard]] auto Order() const -> std::vector<std::string> {
+        std::lock_guard lock{mutex_};
+        return order_;
+    }
+
+  private:
+    mutable std::mutex mutex_;
+    mutable std::vector<std::string> order_;
+};
+
+}  // namespace
+
+TEST_CASE("Actions with the longest critical path run first", "[traverser]") {
+    TestProject p;
+    auto const src = ArtifactDescription::CreateLocal("src", "repo").ToJson();
+
+    // a chain of three actions next to many independent ones
+    CHECK(p.AddOutputInputPair("chain1", {"out1"}, {src}));
+    CHECK(p.AddOutputInputPair(
+        "chain2",
+        {"out2"},
+        {ArtifactDescription::CreateAction("chain1", "out1").ToJson()}));
+    CHECK(p.AddOutputInputPair(
+        "chain3",
+        {"out3"},
+        {ArtifactDescription::CreateAction("chain2", "out2").ToJson()}));
+    for (int i = 0; i < 10; ++i) {
+        CHECK(p.AddOutputInputPair(
+            fmt::format("single{}", i), {fmt::format("single{}", i)}, {src}));
+    }
+
+    DependencyGraph g;
+    CHECK(p.FillGraph(&g));
+    std::atomic<bool> failed{};
+    OrderRecordingExecutor runner{};
+    {
+        Traverser traverser(runner, g, 1, &failed);
+        CHECK(traverser.Traverse());
+    }
+    CHECK_FALSE(failed);
+
+    auto const order = runner.Order();
+    REQUIRE(order.size() == 13);
+    CHECK(order.front() == "chain1");
+
+    SECTION("Duration estimates weigh the critical paths") {
+        failed = false;
+        DependencyGraph g2;
+        CHECK(p.FillGraph(&g2));
+        OrderRecordingExecutor slow_single_runner{};
+        {
+            Traverser traverser(
+                slow_single_runner,
+                g2,
+                1,
+                &failed,
+                [](DependencyGraph::ActionNode const& action) {
+                    return action.Content().Id() == "single7" ? 10.0 : 1.0;
+                });
+            CHECK(traverser.Traverse());
+        }
+        CHECK_FALSE(failed);
+        auto const weighted_order = slow_single_runner.Order();
+        REQUIRE(weighted_order.size() == 13);
+        CHECK(weighted_order.front() == "single7");
+    }
+}
@@ -371,6 +371,32 @@ TEST_CASE_METHOD(CopyFileFixture, "CopyFile", "[file_system]") {
     }
 }
 
+TEST_CASE("CopyFile content sizes", "[file_system]") {
+    auto storage_config = TestStorageConfig::Create();
+
+    auto temp_dir = storage_config.Get().CreateTypedTmpDir("test");
+    REQUIRE(temp_dir);
+
+    // Empty content, content smaller than a chunk, and content spanning
+    // several chunks of the user-space fallback copy.
+    auto const size = GENERATE(std::size_t{0}, std::size_t{10}, 300'000UL);
+    std::string content(size, 'x');
+    for (std::size_t i{}; i < content.size(); ++i) {
+        content[i] = static_cast<char>('a' + (i % 26));
+    }
+    auto const source = temp_dir->GetPath() / "source";
+    REQUIRE(FileSystemManager::WriteFile(content, source));
+
+    auto const fd_less = GENERATE(false, true);
+    auto const target = temp_dir->GetPath() / "target";
+    CHECK(FileSystemManager::CopyFile(source, target, fd_less));
+    CHECK(FileSystemManager::ReadFile(target) == content);
+
+    // Copying over an existing file replaces its content.
+    CHECK(FileSystemManager::CopyFile(source, target, fd_less));
+    CHECK(FileSystemManager::ReadFile(target) == content);
+}
+
 TEST_CASE("CopyFile equivalent", "[file_system]") {
     auto storage_config = TestStorageConfig::Create();
 
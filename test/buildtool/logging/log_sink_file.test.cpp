@@ -14,6 +14,10 @@
 
 #include "src/buildtool/logging/log_sink_file.hpp"
 
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <cstdlib>
 #include <filesystem>
 #include <fstream>
 #include <string>
@@ -26,6 +30,7 @@
 #include "src/buildtool/logging/log_config.hpp"
 #include "src/buildtool/logging/log_level.hpp"
 #include "src/buildtool/logging/log_sink_cmdline.hpp"
+#include "src/buildtool/logging/logger.hpp"
 
 [[nodiscard]] static auto NumberOfLines(std::filesystem::path const& file_path)
     -> int {
@@ -117,4 +122,135 @@ TEST_CASE("LogSinkFile", "[logging]") {
                     Catch::Matchers::ContainsSubstring("this is thread"));
         }
     }
+
+    SECTION("Asynchronous mode") {
+        int const num_threads = 20;
+        {
+            LogSinkFile sink{
+                filename, LogSinkFile::Mode::Append, /*async=*/true};
+
+            // errors are written immediately
+            sink.Emit(nullptr, LogLevel::Error, "first\nsecond");
+            CHECK(NumberOfLines(filename) == 3);
+
+            std::vector<std::thread> threads{};
+            for (int id{}; id < num_threads; ++id) {
+                threads.emplace_back(
+                    [&](int tid) {
+                        sink.Emit(nullptr,
+                                  LogLevel::Info,
+                                  "this is thread " + std::to_string(tid));
+                    },
+                    id);
+            }
+            for (auto& thread : threads) {
+                thread.join();
+            }
+        }
+
+        // all messages are written once the sink is destroyed
+        auto lines = GetLines(filename);
+        CHECK(lines.size() == num_threads + 3);
+        for (auto const& line : lines) {
+            CHECK_THAT(
+                line,
+                Catch::Matchers::ContainsSubstring("somecontent") or
+                    Catch::Matchers::ContainsSubstring("first") or
+                    Catch::Matchers::ContainsSubstring("second") or
+                    Catch::Matchers::ContainsSubstring("this is thread"));
+        }
+    }
+
+    SECTION("Asynchronous and synchronous sinks of the same file") {
+        int const num_threads = 20;
+        {
+            LogSinkFile async_sink{
+                filename, LogSinkFile::Mode::Append, /*async=*/true};
+            LogSinkFile sync_sink{filename, LogSinkFile::Mode::Append};
+
+            std::vector<std::thread> threads{};
+            for (int id{}; id < num_threads; ++id) {
+                threads.emplace_back(
+                    [&](int tid) {
+                        auto const& sink = (tid % 2 == 0) ? async_sink
+                                                          : sync_sink;
+                        sink.Emit(nullptr,
+                                  LogLevel::Info,
+                                  "this is thread " + std::to_string(tid));
+                    },
+                    id);
+            }
+            for (auto& thread : threads) {
+                thread.join();
+            }
+        }
+
+        // batches of the writer thread do not interleave with other records
+        auto lines = GetLines(filename);
+        CHECK(lines.size() == num_threads + 1);
+        for (auto const& line : lines) {
+            CHECK_THAT(
+                line,
+                Catch::Matchers::ContainsSubstring("somecontent") or
+                    Catch::Matchers::ContainsSubstring("this is thread"));
+        }
+    }
+
+    SECTION("Asynchronous mode in forked child") {
+        {
+            LogSinkFile sink{
+                filename, LogSinkFile::Mode::Append, /*async=*/true};
+            // start the writer thread of the parent
+            sink.Emit(nullptr, LogLevel::Error, "parent");
+
+            auto const pid = ::fork();
+            REQUIRE(pid >= 0);
+            if (pid == 0) {
+                // the writer of the parent does not exist here; a hang is
+                // reported as failure by the alarm
+                ::alarm(10);
+                sink.Emit(nullptr, LogLevel::Error, "child");
+                std::_Exit(NumberOfLines(filename) == 3 ? 0 : 1);
+            }
+            int status{};
+            REQUIRE(::waitpid(pid, &status, 0) == pid);
+            CHECK(WIFEXITED(status));
+            CHECK(WEXITSTATUS(status) == 0);
+            sink.Emit(nullptr, LogLevel::Info, "parent again");
+        }
+
+        auto lines = GetLines(filename);
+        REQUIRE(lines.size() == 4);
+        CHECK_THAT(lines[1], Catch::Matchers::ContainsSubstring("parent"));
+        CHECK_THAT(lines[2], Catch::Matchers::ContainsSubstring("child"));
+        CHECK_THAT(lines[3],
+                   Catch::Matchers::ContainsSubstring("parent again"));
+    }
+
+    SECTION("Asynchronous mode on exit with queued records") {
+        int const num_records = 1000;
+        auto const pid = ::fork();
+        REQUIRE(pid >= 0);
+        if (pid == 0) {
+            ::alarm(10);
+            // the sink is owned by the logging config, a static object
+            LogConfig::SetSinks({LogSinkFile::CreateFactory(
+                filename, LogSinkFile::Mode::Append, /*async=*/true)});
+            for (int id{}; id < num_records; ++id) {
+                Logger::Log(LogLevel::Info, "record {}", id);
+            }
+            // records still queued are written on exit
+            std::exit(0);
+        }
+        int status{};
+        REQUIRE(::waitpid(pid, &status, 0) == pid);
+        CHECK(WIFEXITED(status));
+        CHECK(WEXITSTATUS(status) == 0);
+
+        auto lines = GetLines(filename);
+        REQUIRE(lines.size() == num_records + 1);
+        CHECK_THAT(lines.back(),
+                   Catch::Matchers::ContainsSubstring(
+                       "record " + std::to_string(num_records - 1)));
+    }
 }
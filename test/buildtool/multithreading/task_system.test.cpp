@@ -21,7 +21,9 @@
 #include <cstddef>
 #include <cstdint>
 #include <functional>
+#include <future>
 #include <iterator>
+#include <memory>
 #include <mutex>
 #include <numeric>  // std::iota
 #include <ratio>
@@ -321,3 +323,46 @@ TEST_CASE("Shut down a running task system", "[task_system]") {
     CHECK(count > 0);
     CHECK(finished);
 }
+
+TEST_CASE("Deferred tasks", "[task_system]") {
+    using namespace std::chrono_literals;
+
+    SECTION("Finish waits for deferred task queued from foreign thread") {
+        std::atomic<bool> executed{false};
+        std::thread foreign{};
+        {
+            TaskSystem ts{2};
+            ts.QueueTask([&ts, &executed, &foreign]() {
+                // simulate completion callback of an asynchronous operation
+                foreign = std::thread{
+                    [deferred = std::make_shared<TaskSystem::DeferredTask>(
+                         ts.DeferTask()),
+                     &executed]() {
+                        std::this_thread::sleep_for(100ms);
+                        deferred->Queue([&executed]() { executed = true; });
+                    }};
+            });
+            ts.Finish();
+            CHECK(executed);
+        }
+        foreign.join();
+    }
+
+    SECTION("Destroying unused handle releases deferred task") {
+        TaskSystem ts{2};
+        { auto deferred = ts.DeferTask(); }
+        auto finished = std::async(std::launch::async, [&ts]() {
+            ts.Finish();
+            return true;
+        });
+        REQUIRE(finished.wait_for(5s) == std::future_status::ready);
+        CHECK(finished.get());
+
+        // the workload is drained, so tasks queued later are run and waited
+        // for by the next Finish()
+        std::atomic<bool> executed{false};
+        ts.QueueTask([&executed]() { executed = true; });
+        ts.Finish();
+        CHECK(executed);
+    }
+}
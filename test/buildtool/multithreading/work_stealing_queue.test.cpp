@@ -0,0 +1,118 @@
+// Copyright 2026 Huawei Cloud Computing Technology Co., Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "src/buildtool/multithreading/work_stealing_queue.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "catch2/catch_test_macros.hpp"
+#include "src/buildtool/multithreading/task.hpp"
+
+namespace {
+
+[[nodiscard]] auto MakeTask(int* result, int value) -> std::unique_ptr<Task> {
+    return std::make_unique<Task>([result, value]() { *result = value; });
+}
+
+}  // namespace
+
+TEST_CASE("Empty queue", "[work_stealing_queue]") {
+    WorkStealingQueue queue{};
+    CHECK(queue.Empty());
+    CHECK(queue.Pop() == nullptr);
+    CHECK(queue.Steal() == nullptr);
+}
+
+TEST_CASE("Owner pops LIFO, thieves steal FIFO", "[work_stealing_queue]") {
+    WorkStealingQueue queue{};
+    int result{};
+    for (int i = 0; i < 3; ++i) {
+        queue.Push(MakeTask(&result, i));
+    }
+    CHECK_FALSE(queue.Empty());
+
+    auto stolen = queue.Steal();
+    REQUIRE(stolen);
+    (*stolen)();
+    CHECK(result == 0);
+
+    auto popped = queue.Pop();
+    REQUIRE(popped);
+    (*popped)();
+    CHECK(result == 2);
+
+    popped = queue.Pop();
+    REQUIRE(popped);
+    (*popped)();
+    CHECK(result == 1);
+
+    CHECK(queue.Empty());
+    CHECK(queue.Pop() == nullptr);
+}
+
+TEST_CASE("Queue grows beyond initial capacity", "[work_stealing_queue]") {
+    constexpr int kNumTasks = 100;
+    WorkStealingQueue queue{/*initial_capacity=*/4};
+    std::vector<int> results(kNumTasks, -1);
+    for (int i = 0; i < kNumTasks; ++i) {
+        queue.Push(MakeTask(&results[static_cast<std::size_t>(i)], i));
+    }
+    while (auto task = queue.Steal()) {
+        (*task)();
+    }
+    for (int i = 0; i < kNumTasks; ++i) {
+        CHECK(results[static_cast<std::size_t>(i)] == i);
+    }
+}
+
+TEST_CASE("Each task is taken exactly once", "[work_stealing_queue]") {
+    constexpr std::size_t kNumTasks = 10000;
+    constexpr std::size_t kNumThieves = 4;
+    WorkStealingQueue queue{/*initial_capacity=*/16};
+    std::atomic<std::size_t> executed{};
+    std::atomic<bool> done{false};
+
+    std::vector<std::thread> thieves{};
+    thieves.reserve(kNumThieves);
+    for (std::size_t i = 0; i < kNumThieves; ++i) {
+        thieves.emplace_back([&queue, &executed, &done]() {
+            while (not done or not queue.Empty()) {
+                if (auto task = queue.Steal()) {
+                    (*task)();
+                }
+            }
+        });
+    }
+
+    for (std::size_t i = 0; i < kNumTasks; ++i) {
+        queue.Push(std::make_unique<Task>([&executed]() { ++executed; }));
+        if (i % 3 == 0) {
+            if (auto task = queue.Pop()) {
+                (*task)();
+            }
+        }
+    }
+    while (auto task = queue.Pop()) {
+        (*task)();
+    }
+    done = true;
+    for (auto& thief : thieves) {
+        thief.join();
+    }
+    CHECK(executed == kNumTasks);
+}
@@ -0,0 +1,128 @@
+// Copyright 2026 Huawei Cloud Computing Technology Co., Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "src/buildtool/profile/trace.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <set>
+#include <string>
+
+#include "catch2/catch_test_macros.hpp"
+#include "nlohmann/json.hpp"
+#include "src/buildtool/file_system/file_system_manager.hpp"
+#include "src/buildtool/multithreading/task_system.hpp"
+
+namespace {
+
+[[nodiscard]] auto CountSpans(nlohmann::json const& trace,
+                              std::string const& name) -> std::size_t {
+    std::size_t count{};
+    for (auto const& event : trace["traceEvents"]) {
+        if (event["name"] == name) {
+            ++count;
+        }
+    }
+    return count;
+}
+
+}  // namespace
+
+TEST_CASE("Trace records spans of all threads", "[trace]") {
+    std::filesystem::path const file{"test/trace.json"};
+    REQUIRE(FileSystemManager::CreateDirectory(file.parent_path()));
+
+    {
+        TraceSpan const span{"test", "not recorded"};
+    }
+    Trace::Start();
+    {
+        TaskSystem ts{4};
+        for (int i = 0; i < 100; ++i) {
+            ts.QueueTask([i]() {
+                TraceSpan const span{"test", "work", std::to_string(i)};
+            });
+        }
+    }
+    REQUIRE(Trace::Stop(file));
+    {
+        TraceSpan const span{"test", "not recorded"};
+    }
+
+    std::ifstream is{file};
+    auto const trace = nlohmann::json::parse(is);
+    CHECK(CountSpans(trace, "not recorded") == 0);
+    CHECK(CountSpans(trace, "work") == 100);
+    CHECK(CountSpans(trace, "task") == 100);
+    for (auto const& event : trace["traceEvents"]) {
+        if (event["name"] == "work") {
+            CHECK(event["ph"] == "X");
+            CHECK(event["dur"].get<std::int64_t>() >= 0);
+            CHECK(event["args"].contains("detail"));
+        }
+    }
+
+    SECTION("Restarting discards previous spans") {
+        Trace::Start();
+        {
+            TraceSpan const span{"test", "again"};
+        }
+        REQUIRE(Trace::Stop(file));
+        std::ifstream again{file};
+        auto const restarted = nlohmann::json::parse(again);
+        CHECK(CountSpans(restarted, "work") == 0);
+        CHECK(CountSpans(restarted, "again") == 1);
+    }
+}
+
+TEST_CASE("Async spans are recorded as begin and end events", "[trace]") {
+    std::filesystem::path const file{"test/trace.json"};
+    REQUIRE(FileSystemManager::CreateDirectory(file.parent_path()));
+
+    Trace::Start();
+    {
+        // spans started here are finished by the tasks, on other threads
+        TaskSystem ts{4};
+        for (int i = 0; i < 10; ++i) {
+            auto span = std::make_shared<AsyncTraceSpan>("test", "execute");
+            ts.QueueTask([span]() { span->Finish(); });
+        }
+        // not finished explicitly, recorded on destruction
+        AsyncTraceSpan const pending{"test", "execute"};
+    }
+    REQUIRE(Trace::Stop(file));
+
+    std::ifstream is{file};
+    auto const trace = nlohmann::json::parse(is);
+    CHECK(CountSpans(trace, "execute") == 22);
+    std::set<std::uint64_t> begun{};
+    std::set<std::uint64_t> ended{};
+    for (auto const& event : trace["traceEvents"]) {
+        if (event["name"] == "execute") {
+            auto const id = event["id"].get<std::uint64_t>();
+            if (event["ph"] == "b") {
+                CHECK(begun.emplace(id).second);
+            }
+            else {
+                CHECK(event["ph"] == "e");
+                CHECK(ended.emplace(id).second);
+            }
+        }
+    }
+    CHECK(begun.size() == 11);
+    CHECK(begun == ended);
+}
@@ -0,0 +1,119 @@
+// Copyright 2026 Huawei Cloud Computing Technology Co., Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "src/buildtool/storage/action_duration_history.hpp"
+
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "catch2/catch_test_macros.hpp"
+#include "src/buildtool/common/action.hpp"
+#include "test/utils/hermeticity/test_storage_config.hpp"
+
+namespace {
+
+[[nodiscard]] auto CreateAction(std::string const& id,
+                                std::vector<std::string> const& command)
+    -> Action {
+    return Action{id, command, {}};
+}
+
+}  // namespace
+
+TEST_CASE("ActionDurationHistory: Command shape", "[storage]") {
+    CHECK(ActionDurationHistory::CommandShape({}).empty());
+    CHECK(ActionDurationHistory::CommandShape(
+              {"/usr/bin/c++", "-c", "foo.cpp", "-o", "foo.o", "-O2"}) ==
+          "c++ .cpp .o");
+    CHECK(ActionDurationHistory::CommandShape(
+              {"c++", "-c", "bar.cpp", "-o", "out/bar.o", "-I./include"}) ==
+          "c++ .cpp .o");
+    CHECK(ActionDurationHistory::CommandShape({"sh", "-c", "echo hello"}) ==
+          "sh");
+}
+
+TEST_CASE("ActionDurationHistory: Record and estimate", "[storage]") {
+    auto const storage_config = TestStorageConfig::Create();
+    auto const compile_foo =
+        CreateAction("foo", {"c++", "-c", "foo.cpp", "-o", "foo.o"});
+    auto const compile_bar =
+        CreateAction("bar", {"c++", "-c", "bar.cpp", "-o", "bar.o"});
+    auto const link = CreateAction("link", {"c++", "-o", "main", "foo.o"});
+
+    {
+        ActionDurationHistory history{&storage_config.Get()};
+        CHECK_FALSE(history.Estimate(compile_foo));
+
+        history.Record(compile_foo, 4.0);
+        auto estimate = history.Estimate(compile_foo);
+        REQUIRE(estimate);
+        CHECK(*estimate == 4.0);
+
+        // similar actions are estimated by their command shape
+        estimate = history.Estimate(compile_bar);
+        REQUIRE(estimate);
+        CHECK(*estimate == 4.0);
+        CHECK_FALSE(history.Estimate(link));
+
+        // measurements are smoothed
+        history.Record(compile_foo, 14.0);
+        estimate = history.Estimate(compile_foo);
+        REQUIRE(estimate);
+        CHECK(*estimate > 4.0);
+        CHECK(*estimate < 14.0);
+        REQUIRE(history.Save());
+    }
+
+    SECTION("History is persisted") {
+        ActionDurationHistory history{&storage_config.Get()};
+        auto estimate = history.Estimate(compile_foo);
+        REQUIRE(estimate);
+        CHECK(*estimate > 4.0);
+        CHECK(*estimate < 14.0);
+        CHECK(history.Estimate(compile_bar));
+        CHECK_FALSE(history.Estimate(link));
+
+        // updates are merged with the persisted entries
+        history.Record(link, 1.0);
+        REQUIRE(history.Save());
+        CHECK(history.Estimate(compile_foo) == estimate);
+        CHECK(history.Estimate(link) == 1.0);
+    }
+
+    SECTION("Tree actions are estimated as zero") {
+        ActionDurationHistory history{&storage_config.Get()};
+        auto const tree = Action::CreateTreeAction("tree");
+        CHECK(history.Estimate(tree) == 0.0);
+    }
+}
+
+TEST_CASE("ActionDurationHistory: Concurrent processes", "[storage]") {
+    auto const storage_config = TestStorageConfig::Create();
+    auto const compile = CreateAction("compile", {"c++", "-c", "foo.cpp"});
+    auto const link = CreateAction("link", {"ld", "-o", "main", "foo.o"});
+
+    // both histories map the (empty) table before either is saved
+    ActionDurationHistory first{&storage_config.Get()};
+    ActionDurationHistory second{&storage_config.Get()};
+    first.Record(compile, 2.0);
+    REQUIRE(first.Save());
+    second.Record(link, 3.0);
+    REQUIRE(second.Save());
+
+    // the second history did not drop the entries saved by the first one
+    ActionDurationHistory merged{&storage_config.Get()};
+    CHECK(merged.Estimate(compile) == 2.0);
+    CHECK(merged.Estimate(link) == 3.0);
+}
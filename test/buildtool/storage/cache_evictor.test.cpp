@@ -0,0 +1,104 @@
+// Copyright 2026 Huawei Cloud Computing Technology Co., Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "src/buildtool/storage/cache_evictor.hpp"
+
+#include <chrono>
+#include <cstddef>
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "catch2/catch_test_macros.hpp"
+#include "src/buildtool/common/artifact_digest.hpp"
+#include "src/buildtool/common/artifact_digest_factory.hpp"
+#include "src/buildtool/common/bazel_types.hpp"
+#include "src/buildtool/file_system/object_type.hpp"
+#include "src/buildtool/storage/config.hpp"
+#include "src/buildtool/storage/storage.hpp"
+#include "test/utils/hermeticity/test_storage_config.hpp"
+
+namespace {
+
+/// \brief Let the change time advance, even for coarse file-system clocks.
+void Wait() {
+    std::this_thread::sleep_for(std::chrono::milliseconds{20});
+}
+
+/// \brief Position of the file of the given object below the given directory.
+[[nodiscard]] auto PositionOf(std::vector<CacheEvictor::Victim> const& plan,
+                              std::filesystem::path const& dir,
+                              std::string const& hash)
+    -> std::optional<std::size_t> {
+    for (std::size_t i = 0; i < plan.size(); ++i) {
+        auto const& path = plan[i].path;
+        if (path.parent_path().parent_path() == dir and
+            path.parent_path().filename().string() +
+                    path.filename().string() ==
+                hash) {
+            return i;
+        }
+    }
+    return std::nullopt;
+}
+
+}  // namespace
+
+TEST_CASE("CacheEvictor: Plan orders all entries by last use",
+          "[storage]") {
+    auto const storage_config = TestStorageConfig::Create();
+    auto const& config = storage_config.Get();
+    auto const gen_config = config.CreateGenerationConfig(1);
+    auto const generation = Generation::Create(&config, 1);
+    auto const& cas = generation.CAS();
+
+    auto const old_blob = cas.StoreBlob("untouched for long");
+    REQUIRE(old_blob);
+    Wait();
+    auto const output = cas.StoreBlob("output of an action");
+    REQUIRE(output);
+    Wait();
+    auto const action_id = ArtifactDigestFactory::HashDataAs<ObjectType::File>(
+        config.hash_function, "action");
+    bazel_re::ActionResult result{};
+    auto* file = result.add_output_files();
+    file->set_path("out");
+    *file->mutable_digest() = ArtifactDigestFactory::ToBazel(*output);
+    REQUIRE(generation.ActionCache().StoreResult(action_id, result));
+    Wait();
+    auto const new_blob = cas.StoreBlob("recently added");
+    REQUIRE(new_blob);
+
+    auto const plan = CacheEvictor::Plan(config, 1);
+    REQUIRE(plan);
+
+    auto const old_pos = PositionOf(*plan, gen_config.cas_f, old_blob->hash());
+    auto const entry_pos =
+        PositionOf(*plan, gen_config.action_cache, action_id.hash());
+    auto const output_pos = PositionOf(*plan, gen_config.cas_f, output->hash());
+    auto const new_pos = PositionOf(*plan, gen_config.cas_f, new_blob->hash());
+    REQUIRE(old_pos);
+    REQUIRE(entry_pos);
+    REQUIRE(output_pos);
+    REQUIRE(new_pos);
+
+    // Blobs not used for longer than a cache entry are evicted first.
+    CHECK(*old_pos < *entry_pos);
+    // Referenced blobs are kept as long as the cache entry referencing them,
+    // and evicted right after it.
+    CHECK(*entry_pos < *output_pos);
+    CHECK(*output_pos < *new_pos);
+}
@@ -0,0 +1,118 @@
+// Copyright 2026 Huawei Cloud Computing Technology Co., Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "src/buildtool/storage/file_digest_cache.hpp"
+
+#include <filesystem>
+#include <optional>
+#include <string>
+
+#include "catch2/catch_test_macros.hpp"
+#include "src/buildtool/common/artifact.hpp"
+#include "src/buildtool/common/artifact_digest_factory.hpp"
+#include "src/buildtool/file_system/file_system_manager.hpp"
+#include "src/buildtool/file_system/object_type.hpp"
+#include "test/utils/hermeticity/test_storage_config.hpp"
+
+namespace {
+
+[[nodiscard]] auto CreateInfo(StorageConfig const& config,
+                              std::string const& content)
+    -> Artifact::ObjectInfo {
+    return Artifact::ObjectInfo{
+        .digest = ArtifactDigestFactory::HashDataAs<ObjectType::File>(
+            config.hash_function, content),
+        .type = ObjectType::File};
+}
+
+}  // namespace
+
+TEST_CASE("FileDigestCache: Lookup after store", "[storage]") {
+    auto const storage_config = TestStorageConfig::Create();
+    auto const file = storage_config.Get().build_root / "file";
+    std::string const content{"content"};
+    auto const info = CreateInfo(storage_config.Get(), content);
+
+    // old timestamp, so the entry is not racy
+    REQUIRE(FileSystemManager::WriteFileAs<ObjectType::File,
+                                           /*kSetEpochTime=*/true>(content,
+                                                                   file));
+    auto const stat = FileDigestCache::Stat(file);
+    REQUIRE(stat);
+
+    FileDigestCache cache{&storage_config.Get()};
+    CHECK_FALSE(cache.Lookup(file, *stat));
+    cache.Store(file, *stat, info);
+    auto const cached = cache.Lookup(file, *stat);
+    REQUIRE(cached);
+    CHECK(*cached == info);
+
+    SECTION("Modified file is not served") {
+        REQUIRE(FileSystemManager::WriteFileAs<ObjectType::File,
+                                               /*kSetEpochTime=*/true>(
+            content + " modified", file));
+        auto const new_stat = FileDigestCache::Stat(file);
+        REQUIRE(new_stat);
+        CHECK_FALSE(cache.Lookup(file, *new_stat));
+    }
+
+    SECTION("Entries are persisted") {
+        REQUIRE(cache.Save());
+        FileDigestCache reloaded{&storage_config.Get()};
+        auto const persisted = reloaded.Lookup(file, *stat);
+        REQUIRE(persisted);
+        CHECK(*persisted == info);
+    }
+
+    SECTION("Entries of concurrent processes are merged") {
+        auto const other_file = storage_config.Get().build_root / "other";
+        std::string const other_content{"other content"};
+        auto const other_info =
+            CreateInfo(storage_config.Get(), other_content);
+        REQUIRE(FileSystemManager::WriteFileAs<ObjectType::File,
+                                               /*kSetEpochTime=*/true>(
+            other_content, other_file));
+        auto const other_stat = FileDigestCache::Stat(other_file);
+        REQUIRE(other_stat);
+
+        // loaded before the first cache is saved
+        FileDigestCache other{&storage_config.Get()};
+        other.Store(other_file, *other_stat, other_info);
+        REQUIRE(cache.Save());
+        REQUIRE(other.Save());
+
+        FileDigestCache reloaded{&storage_config.Get()};
+        auto const persisted = reloaded.Lookup(file, *stat);
+        REQUIRE(persisted);
+        CHECK(*persisted == info);
+        auto const other_persisted = reloaded.Lookup(other_file, *other_stat);
+        REQUIRE(other_persisted);
+        CHECK(*other_persisted == other_info);
+    }
+}
+
+TEST_CASE("FileDigestCache: Racy files are not stored", "[storage]") {
+    auto const storage_config = TestStorageConfig::Create();
+    auto const file = storage_config.Get().build_root / "file";
+    std::string const content{"content"};
+
+    // fresh timestamp, so a further modification might go unnoticed
+    REQUIRE(FileSystemManager::WriteFile(content, file));
+    auto const stat = FileDigestCache::Stat(file);
+    REQUIRE(stat);
+
+    FileDigestCache cache{&storage_config.Get()};
+    cache.Store(file, *stat, CreateInfo(storage_config.Get(), content));
+    CHECK_FALSE(cache.Lookup(file, *stat));
+}
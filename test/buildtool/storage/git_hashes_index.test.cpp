@@ -0,0 +1,142 @@
+// Copyright 2026 Huawei Cloud Computing Technology Co., Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "src/buildtool/storage/git_hashes_index.hpp"
+
+#include <filesystem>
+#include <string>
+
+#include "catch2/catch_test_macros.hpp"
+#include "fmt/core.h"
+#include "src/buildtool/common/git_hashes_converter.hpp"
+#include "src/buildtool/file_system/file_system_manager.hpp"
+#include "test/utils/hermeticity/test_storage_config.hpp"
+
+namespace {
+
+// git blob id and SHA256 hash of "content"
+auto const kGitHash = std::string{"6b584e8ece562ebffc15d38808cd6b98fc3d97ea"};
+auto const kCompatHash = std::string{
+    "ed7002b439e9ac845f22357d822bac1444730fbdb6016d3ec9432297b9ec9f73"};
+
+}  // namespace
+
+TEST_CASE("GitHashesIndex: Lookup after store", "[storage]") {
+    auto const storage_config = TestStorageConfig::Create();
+    {
+        GitHashesIndex index{&storage_config.Get()};
+        CHECK_FALSE(index.Lookup(kGitHash));
+        index.Store(kGitHash, kCompatHash);
+        CHECK(index.Lookup(kGitHash) == kCompatHash);
+
+        // malformed hashes are ignored
+        index.Store("not a hash", kCompatHash);
+        CHECK_FALSE(index.Lookup("not a hash"));
+        REQUIRE(index.Save());
+    }
+
+    SECTION("Index is persisted") {
+        GitHashesIndex index{&storage_config.Get()};
+        CHECK(index.Lookup(kGitHash) == kCompatHash);
+    }
+
+    SECTION("Entries are uplinked from older generations") {
+        // few entries are only appended to the log of the index
+        auto const log_file = storage_config.Get().GenerationCacheRoot(0) /
+                              "git-sha256-index.log";
+        auto const old_log_file = storage_config.Get().GenerationCacheRoot(1) /
+                                  "git-sha256-index.log";
+        REQUIRE(FileSystemManager::IsFile(log_file));
+        REQUIRE(
+            FileSystemManager::CreateDirectory(old_log_file.parent_path()));
+        REQUIRE(FileSystemManager::Rename(log_file, old_log_file));
+
+        {
+            GitHashesIndex index{&storage_config.Get()};
+            CHECK(index.Lookup(kGitHash) == kCompatHash);
+            REQUIRE(index.Save());
+        }
+        CHECK(FileSystemManager::IsFile(log_file));
+
+        // the entry survives the rotation of the old generation
+        REQUIRE(FileSystemManager::RemoveFile(old_log_file));
+        GitHashesIndex index{&storage_config.Get()};
+        CHECK(index.Lookup(kGitHash) == kCompatHash);
+    }
+}
+
+TEST_CASE("GitHashesIndex: Log is merged into the table", "[storage]") {
+    auto const storage_config = TestStorageConfig::Create();
+    auto const index_file =
+        storage_config.Get().GenerationCacheRoot(0) / "git-sha256-index";
+    auto const log_file =
+        storage_config.Get().GenerationCacheRoot(0) / "git-sha256-index.log";
+    auto const git_hash = [](int i) { return fmt::format("{:040x}", i); };
+    auto const compat_hash = [](int i) { return fmt::format("{:064x}", i); };
+
+    // entries of concurrent instances are all kept
+    {
+        GitHashesIndex first{&storage_config.Get()};
+        GitHashesIndex second{&storage_config.Get()};
+        first.Store(kGitHash, kCompatHash);
+        second.Store(git_hash(0), compat_hash(0));
+        REQUIRE(first.Save());
+        REQUIRE(second.Save());
+    }
+    CHECK(FileSystemManager::IsFile(log_file));
+    CHECK_FALSE(FileSystemManager::IsFile(index_file));
+
+    // many new entries are merged into the table
+    int const count = 1 << 17;
+    {
+        GitHashesIndex index{&storage_config.Get()};
+        for (int i = 1; i < count; ++i) {
+            index.Store(git_hash(i), compat_hash(i));
+        }
+        REQUIRE(index.Save());
+    }
+    CHECK(FileSystemManager::IsFile(index_file));
+    CHECK_FALSE(FileSystemManager::IsFile(log_file));
+
+    GitHashesIndex index{&storage_config.Get()};
+    CHECK(index.Lookup(kGitHash) == kCompatHash);
+    CHECK(index.Lookup(git_hash(0)) == compat_hash(0));
+    CHECK(index.Lookup(git_hash(count - 1)) == compat_hash(count - 1));
+}
+
+TEST_CASE("GitHashesIndex: Backing the hashes converter", "[storage]") {
+    auto const storage_config = TestStorageConfig::Create();
+    GitHashesIndex index{&storage_config.Get()};
+    auto& converter = GitHashesConverter::Instance();
+
+    // converted blobs are added to the store passed
+    CHECK_FALSE(converter.LookupGitEntry(kGitHash, "repo", &index));
+    CHECK(converter.RegisterGitEntry(kGitHash, "content", "repo", &index) ==
+          kCompatHash);
+    CHECK(index.Lookup(kGitHash) == kCompatHash);
+
+    // blobs converted by earlier invocations are found in the store, without
+    // their content
+    auto const other_git_hash =
+        std::string{"0123456789abcdef0123456789abcdef01234567"};
+    auto const other_compat_hash = std::string(64, 'a');
+    index.Store(other_git_hash, other_compat_hash);
+    CHECK_FALSE(converter.LookupGitEntry(other_git_hash, "repo", nullptr));
+    CHECK(converter.LookupGitEntry(other_git_hash, "repo", &index) ==
+          other_compat_hash);
+    auto const entry = converter.GetGitEntry(other_compat_hash);
+    REQUIRE(entry);
+    CHECK(entry->first == other_git_hash);
+    CHECK(entry->second == "repo");
+}
@@ -0,0 +1,98 @@
+#!/bin/sh
+# Copyright 2026 Huawei Cloud Computing Technology Co., Ltd.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+set -eu
+
+readonly ROOT="$(pwd)"
+readonly JUST="${ROOT}/bin/tool-under-test"
+readonly BUILDROOT="${TEST_TMPDIR}/build-root"
+readonly OUT="${TEST_TMPDIR}/out"
+# Keep the socket path short, as required for Unix domain sockets.
+readonly SOCKET_DIR="$(mktemp -d)"
+readonly SOCKET="${SOCKET_DIR}/just.sock"
+readonly DAEMON_LOG="${ROOT}/daemon.log"
+
+mkdir -p src
+cd src
+touch ROOT
+cat > TARGETS <<'EOF2'
+{ "hello":
+  { "type": "generic"
+  , "outs": ["hello.txt"]
+  , "cmds": ["echo Hello World > hello.txt"]
+  }
+, "fail":
+  {"type": "generic", "outs": ["never.txt"], "cmds": ["false"]}
+}
+EOF2
+cat > repos.json <<EOF2
+{"repositories": {"": {"workspace_root": ["file", "$(pwd)"]}}}
+EOF2
+
+"${JUST}" daemon --socket "${SOCKET}" > "${DAEMON_LOG}" 2>&1 &
+DAEMON_PID=$!
+trap 'kill ${DAEMON_PID} 2>/dev/null || :; rm -rf "${SOCKET_DIR}"' EXIT
+for _ in $(seq 50)
+do
+  [ -S "${SOCKET}" ] && break
+  sleep 0.1
+done
+[ -S "${SOCKET}" ]
+
+# Commands sent to the daemon must not fall back to running locally.
+run_by_daemon() {
+  "${JUST}" "$@" --daemon-socket "${SOCKET}" \
+    --local-build-root "${BUILDROOT}" -C repos.json > "${ROOT}/log" 2>&1 \
+    && RESULT=0 || RESULT=$?
+  cat "${ROOT}/log"
+  grep 'running locally' "${ROOT}/log" && exit 1 || :
+}
+
+echo
+echo Successful build
+echo
+run_by_daemon install -o "${OUT}" hello
+[ ${RESULT} -eq 0 ]
+grep World "${OUT}/hello.txt"
+
+echo
+echo Failing build
+echo
+run_by_daemon build fail
+[ ${RESULT} -eq 1 ]
+
+echo
+echo Analysis failure
+echo
+run_by_daemon build does-not-exist
+[ ${RESULT} -eq 8 ]
+
+echo
+echo Building again after the failures
+echo
+rm -rf "${OUT}"
+run_by_daemon install -o "${OUT}" hello
+[ ${RESULT} -eq 0 ]
+grep World "${OUT}/hello.txt"
+
+echo
+echo Terminating the daemon
+echo
+kill ${DAEMON_PID}
+wait ${DAEMON_PID}
+cat "${DAEMON_LOG}"
+[ ! -e "${SOCKET}" ]
+
+echo
+echo OK
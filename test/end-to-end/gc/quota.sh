@@ -0,0 +1,98 @@
+#!/bin/sh
+# Copyright 2026 Huawei Cloud Computing Technology Co., Ltd.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+set -eu
+
+readonly JUST="${PWD}/bin/tool-under-test"
+readonly LBR="${TEST_TMPDIR}/local-build-root"
+readonly JUST_ARGS="--local-build-root ${LBR}"
+
+readonly JUST_MR="${PWD}/bin/mr-tool-under-test"
+readonly LBR_MR="${TEST_TMPDIR}/local-build-root-mr"
+readonly JUST_MR_ARGS="--norc --local-build-root ${LBR_MR} --just ${JUST}"
+
+readonly OUT="${TEST_TMPDIR}/out"
+mkdir -p "${OUT}"
+
+CACHE="${LBR}/protocol-dependent"
+COMPATIBLE_ARGS=""
+if [ -n "${COMPATIBLE:-}" ]; then
+  COMPATIBLE_ARGS="--compatible"
+fi
+
+# Number of cache and CAS entries in all generations
+cache_entries() {
+  find "${CACHE}" -path "${CACHE}/generation-*" -type f \
+       \( -path '*/cas*' -o -path '*/ac/*' -o -path '*/tc/*' \) | wc -l
+}
+
+mkdir work && cd work
+
+touch ROOT
+cat > repos.json <<'EOF'
+{ "repositories":
+  { "":
+    {"repository": {"type": "file", "path": ".", "pragma": {"to_git": true}}}
+  }
+}
+EOF
+
+cat > TARGETS <<'EOF'
+{ "file":
+  { "type": "generic"
+  , "outs": ["out.txt"]
+  , "cmds": ["echo foo > out.txt"]
+  }
+, "": {"type": "install", "dirs": [["file", "out"]]}
+}
+EOF
+
+cat TARGETS
+
+# Build to fill the cache
+"${JUST_MR}" ${JUST_MR_ARGS} build ${JUST_ARGS} ${COMPATIBLE_ARGS} \
+          -L '["env", "PATH='"${PATH}"'"]' 2>&1
+BEFORE=$(cache_entries)
+echo "Cache entries after build: ${BEFORE}"
+[ "${BEFORE}" -gt 0 ]
+
+# A sufficiently large quota must not lose any cache entries
+"${JUST_MR}" ${JUST_MR_ARGS} gc ${JUST_ARGS} --max-cache-size 1000000000 \
+  --log-limit 4 -f "${OUT}/gc" 2>&1
+AFTER=$(cache_entries)
+echo "Cache entries after gc with large quota: ${AFTER}"
+[ "${AFTER}" -eq "${BEFORE}" ]
+grep 'Rotating generations' "${OUT}/gc" && exit 1
+
+# Options reducing the cache in different ways are incompatible
+"${JUST_MR}" ${JUST_MR_ARGS} gc ${JUST_ARGS} --max-cache-size 0 --all 2>&1 \
+  && exit 1
+"${JUST_MR}" ${JUST_MR_ARGS} gc ${JUST_ARGS} --max-cache-size 0 --no-rotate \
+  2>&1 && exit 1
+
+# An empty quota evicts everything, rotating generations once
+"${JUST_MR}" ${JUST_MR_ARGS} gc ${JUST_ARGS} --max-cache-size 0 \
+  --log-limit 4 -f "${OUT}/gc2" 2>&1
+grep 'Rotating generations' "${OUT}/gc2"
+AFTER=$(cache_entries)
+echo "Cache entries after gc with empty quota: ${AFTER}"
+[ "${AFTER}" -eq 0 ]
+
+# The cache is still usable
+"${JUST_MR}" ${JUST_MR_ARGS} install ${JUST_ARGS} ${COMPATIBLE_ARGS} \
+          -L '["env", "PATH='"${PATH}"'"]' -o "${OUT}/install" 2>&1
+grep foo "${OUT}/install/out/out.txt"
+
+echo OK
@@ -0,0 +1,58 @@
+#!/bin/sh
+# Copyright 2026 Huawei Cloud Computing Technology Co., Ltd.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+set -eu
+
+readonly JUST="${PWD}/bin/tool-under-test"
+readonly LBR="${TEST_TMPDIR}/local-build-root"
+readonly TRACE="${PWD}/trace.json"
+readonly WRK_DIR="${PWD}/work"
+
+REMOTE_EXECUTION_ARGS=""
+if [ -n "${REMOTE_EXECUTION_ADDRESS:-}" ]
+then
+    REMOTE_EXECUTION_ARGS="-r ${REMOTE_EXECUTION_ADDRESS}"
+    if [ -n "${COMPATIBLE:-}" ]
+    then
+        REMOTE_EXECUTION_ARGS="${REMOTE_EXECUTION_ARGS} --compatible"
+    fi
+fi
+
+mkdir -p "${WRK_DIR}"
+cd "${WRK_DIR}"
+touch ROOT
+cat > TARGETS <<'EOF'
+{ "":
+  { "type": "install"
+  , "files": {"a": "a", "b": "b"}
+  }
+, "a": {"type": "generic", "outs": ["a"], "cmds": ["echo A > a"]}
+, "b": {"type": "generic", "outs": ["b"], "cmds": ["echo B > b"]}
+}
+EOF
+
+# Every executed action shows up as execute span, recorded as pair of async
+# begin and end events with a common id.
+"${JUST}" build --local-build-root "${LBR}" ${REMOTE_EXECUTION_ARGS} \
+          --trace "${TRACE}" 2>&1
+cat "${TRACE}"
+[ "$(jq '[.traceEvents | .[] | select(.name == "execute" and .ph == "b")]
+         | length' "${TRACE}")" -eq 2 ]
+[ "$(jq '[.traceEvents | .[] | select(.name == "execute" and .ph == "e")]
+         | length' "${TRACE}")" -eq 2 ]
+[ "$(jq '[.traceEvents | .[] | select(.name == "execute") | .id]
+         | unique | length' "${TRACE}")" -eq 2 ]
+
+echo OK
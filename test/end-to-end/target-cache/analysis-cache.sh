@@ -0,0 +1,143 @@
+#!/bin/sh
+# Copyright 2026 Huawei Cloud Computing Technology Co., Ltd.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+set -eu
+
+readonly JUST="${PWD}/bin/tool-under-test"
+readonly JUST_MR="${PWD}/bin/mr-tool-under-test"
+readonly LBR="${TEST_TMPDIR}/local-build-root"
+readonly OUT="${TEST_TMPDIR}/out"
+readonly LOG="${TEST_TMPDIR}/log.txt"
+
+mkdir work && cd work
+
+touch ROOT
+cat <<'EOF' > repos.json
+{ "repositories":
+  { "":
+    {"repository": {"type": "file", "path": ".", "pragma": {"to_git": true}}}
+  }
+}
+EOF
+
+cat <<'EOF' > RULES
+{ "greet":
+  { "string_fields": ["name"]
+  , "target_fields": ["deps"]
+  , "config_vars": ["GREETING"]
+  , "expression":
+    { "type": "let*"
+    , "bindings":
+      [ [ "deps"
+        , { "type": "disjoint_map_union"
+          , "$1":
+            { "type": "foreach"
+            , "var": "x"
+            , "range": {"type": "FIELD", "name": "deps"}
+            , "body":
+              {"type": "DEP_ARTIFACTS", "dep": {"type": "var", "name": "x"}}
+            }
+          }
+        ]
+      , [ "name"
+        , {"type": "join", "$1": {"type": "FIELD", "name": "name"}}
+        ]
+      , [ "out"
+        , { "type": "ACTION"
+          , "inputs":
+            { "type": "to_subdir"
+            , "subdir": "deps"
+            , "$1": {"type": "var", "name": "deps"}
+            }
+          , "outs": [{"type": "var", "name": "name"}]
+          , "cmd":
+            [ "sh"
+            , "-c"
+            , { "type": "join"
+              , "$1":
+                [ "(echo "
+                , {"type": "var", "name": "GREETING", "default": "Hello"}
+                , " "
+                , {"type": "var", "name": "name"}
+                , "; cat deps/* 2>/dev/null || :) > "
+                , {"type": "var", "name": "name"}
+                ]
+              }
+            ]
+          }
+        ]
+      ]
+    , "body": {"type": "RESULT", "artifacts": {"type": "var", "name": "out"}}
+    }
+  }
+}
+EOF
+
+cat <<'EOF' > TARGETS
+{ "world": {"type": "greet", "name": ["world"]}
+, "universe": {"type": "greet", "name": ["universe"], "deps": ["world"]}
+}
+EOF
+
+# First analysis fills the analysis cache
+"${JUST_MR}" --just "${JUST}" --local-build-root "${LBR}" --norc \
+             install -o "${OUT}/first" -f "${LOG}" --log-limit 5 universe 2>&1
+echo
+cat "${OUT}/first/universe"
+grep 'Hello universe' "${OUT}/first/universe"
+grep 'Hello world' "${OUT}/first/universe"
+[ -z "$(grep 'taken from analysis cache' "${LOG}")" ]
+echo
+
+# Analysing again, in a different but irrelevant configuration, the targets
+# are taken from the analysis cache, with the same result.
+rm -f "${LOG}"
+"${JUST_MR}" --just "${JUST}" --local-build-root "${LBR}" --norc \
+             install -o "${OUT}/second" -f "${LOG}" --log-limit 5 \
+             -D '{"UNRELATED": "foo"}' universe 2>&1
+echo
+grep 'Target .*universe.* taken from analysis cache' "${LOG}"
+grep 'Target .*world.* taken from analysis cache' "${LOG}"
+cmp "${OUT}/first/universe" "${OUT}/second/universe"
+echo
+
+# A relevant change in the configuration is honored.
+rm -f "${LOG}"
+"${JUST_MR}" --just "${JUST}" --local-build-root "${LBR}" --norc \
+             install -o "${OUT}/third" -f "${LOG}" --log-limit 5 \
+             -D '{"GREETING": "Hi"}' universe 2>&1
+echo
+cat "${OUT}/third/universe"
+grep 'Hi universe' "${OUT}/third/universe"
+grep 'Hi world' "${OUT}/third/universe"
+echo
+
+# Changing the target definitions invalidates the cache.
+cat <<'EOF' > TARGETS
+{ "world": {"type": "greet", "name": ["world"]}
+, "universe": {"type": "greet", "name": ["universe"], "deps": []}
+}
+EOF
+rm -f "${LOG}"
+"${JUST_MR}" --just "${JUST}" --local-build-root "${LBR}" --norc \
+             install -o "${OUT}/fourth" -f "${LOG}" --log-limit 5 universe 2>&1
+echo
+cat "${OUT}/fourth/universe"
+grep 'Hello universe' "${OUT}/fourth/universe"
+[ -z "$(grep 'world' "${OUT}/fourth/universe")" ]
+[ -z "$(grep 'taken from analysis cache' "${LOG}")" ]
+echo
+
+echo OK
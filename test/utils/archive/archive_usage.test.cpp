@@ -23,15 +23,22 @@
 #include <cstdlib>
 #include <filesystem>
 #include <functional>
+#include <memory>
 #include <optional>
 #include <string>
+#include <string_view>
 #include <unordered_map>
 #include <utility>
 #include <vector>
 
 #include "catch2/catch_test_macros.hpp"
 #include "catch2/generators/catch_generators_all.hpp"
+#include "catch2/matchers/catch_matchers_all.hpp"
+#include "fmt/core.h"
 #include "src/buildtool/file_system/file_system_manager.hpp"
+#include "src/buildtool/file_system/git_repo.hpp"
+#include "src/buildtool/logging/log_level.hpp"
+#include "src/buildtool/logging/logger.hpp"
 #include "src/utils/archive/archive_ops.hpp"
 
 extern "C" {
@@ -49,6 +56,7 @@ using hardlinks_t = std::unordered_map<std::string, std::string>;
 constexpr std::size_t kBlockSize = 10240;
 constexpr int kFilePerm = 0644;
 constexpr int kDirectoryPerm = 0755;
+constexpr int kExecutablePerm = 0755;
 
 auto const kExpected = filetree_t{{"foo", {"foo", AE_IFREG}},
                                   {"bar/", {"", AE_IFDIR}},
@@ -333,6 +341,127 @@ void enable_read_format_and_filter(archive* ar, ArchiveType type) {
     }
 }
 
+struct ImportEntry {
+    std::string path;
+    mode_t type{AE_IFREG};
+    std::string content{};
+    int perm{kFilePerm};
+    std::string symlink{};
+};
+
+void write_pax_archive(std::filesystem::path const& path,
+                       std::vector<ImportEntry> const& entries) {
+    auto* a = archive_write_new();
+    REQUIRE(a != nullptr);
+    REQUIRE(archive_write_set_format_pax(a) == ARCHIVE_OK);
+    REQUIRE(archive_write_open_filename(a, path.c_str()) == ARCHIVE_OK);
+
+    archive_entry* entry = archive_entry_new();
+    for (auto const& e : entries) {
+        archive_entry_set_pathname(entry, e.path.c_str());
+        archive_entry_set_filetype(entry, e.type);
+        archive_entry_set_perm(entry, e.perm);
+        // a sub-second mtime gives every entry a pax extended header
+        archive_entry_set_mtime(entry, 1, 1);
+        if (e.type == AE_IFLNK) {
+            archive_entry_set_symlink(entry, e.symlink.c_str());
+        }
+        auto const size = e.type == AE_IFREG ? e.content.size() : 0;
+        archive_entry_set_size(entry, static_cast<int64_t>(size));
+        REQUIRE(archive_write_header(a, entry) == ARCHIVE_OK);
+        if (size > 0) {
+            REQUIRE(archive_write_data(a, e.content.data(), size) ==
+                    static_cast<ssize_t>(size));
+        }
+        entry = archive_entry_clear(entry);
+    }
+    archive_entry_free(entry);
+    REQUIRE(archive_write_close(a) == ARCHIVE_OK);
+    REQUIRE(archive_write_free(a) == ARCHIVE_OK);
+}
+
+/// \brief Turn the regular file entry of given name into a hardlink to target
+/// keeping its data. The libarchive writers drop the data of hardlinks, so
+/// the ustar header of the entry is patched in place.
+void make_hardlink_with_data(std::filesystem::path const& path,
+                             std::string const& name,
+                             std::string const& target) {
+    constexpr std::size_t kTarBlock = 512;
+    constexpr std::size_t kNameSize = 100;
+    constexpr std::size_t kChecksumOffset = 148;
+    constexpr std::size_t kChecksumSize = 8;
+    constexpr std::size_t kTypeOffset = 156;
+    constexpr std::size_t kLinkNameOffset = 157;
+
+    auto data = FileSystemManager::ReadFile(path);
+    REQUIRE(data);
+    bool patched{false};
+    for (std::size_t pos = 0; pos + kTarBlock <= data->size();
+         pos += kTarBlock) {
+        auto header = std::string_view{*data}.substr(pos, kTarBlock);
+        if (header.substr(0, kNameSize).find('\0') != name.size() or
+            not header.starts_with(name) or header[kTypeOffset] != '0') {
+            continue;
+        }
+        data->at(pos + kTypeOffset) = '1';
+        data->replace(pos + kLinkNameOffset, target.size(), target);
+        data->replace(pos + kChecksumOffset, kChecksumSize, kChecksumSize, ' ');
+        unsigned int checksum{};
+        for (std::size_t i = pos; i < pos + kTarBlock; ++i) {
+            checksum += static_cast<unsigned char>(data->at(i));
+        }
+        data->replace(pos + kChecksumOffset,
+                      kChecksumSize,
+                      fmt::format("{:06o}", checksum) + std::string{"\0 ", 2});
+        patched = true;
+        break;
+    }
+    REQUIRE(patched);
+    REQUIRE(FileSystemManager::WriteFile(*data, path));
+}
+
+/// \brief Check that importing the tarball to Git gives the same tree as
+/// extracting it and committing the extracted directory.
+void check_import_matches_extraction(std::filesystem::path const& test_dir,
+                                     std::filesystem::path const& archive) {
+    auto repo = GitRepo::InitAndOpen(test_dir / "repo", /*is_bare=*/false);
+    REQUIRE(repo);
+    auto tree_id = ArchiveOps::ImportArchiveToGit(
+        "archive", archive, repo->GetGitCAS(), /*jobs=*/2);
+    if (not tree_id) {
+        FAIL(tree_id.error());
+    }
+
+    auto const extract_dir = test_dir / "extracted";
+    auto res =
+        ArchiveOps::ExtractArchive(ArchiveType::TarAuto, archive, extract_dir);
+    if (res != std::nullopt) {
+        FAIL(*res);
+    }
+    auto logger = std::make_shared<GitRepo::anon_logger_t>(
+        [](auto const& msg, bool fatal) {
+            Logger::Log(fatal ? LogLevel::Error : LogLevel::Progress,
+                        std::string(msg));
+        });
+    auto commit = repo->CommitDirectory(extract_dir, "extracted", logger);
+    REQUIRE(commit);
+    auto committed_tree = repo->GetSubtreeFromCommit(*commit, ".", logger);
+    REQUIRE(committed_tree);
+    CHECK(*tree_id == *committed_tree);
+}
+
+/// \brief Import the tarball to Git, expecting a failure with given message.
+void check_import_rejected(std::filesystem::path const& test_dir,
+                           std::filesystem::path const& archive,
+                           std::string const& message) {
+    auto repo = GitRepo::InitAndOpen(test_dir / "repo", /*is_bare=*/false);
+    REQUIRE(repo);
+    auto tree_id = ArchiveOps::ImportArchiveToGit(
+        "archive", archive, repo->GetGitCAS(), /*jobs=*/2);
+    REQUIRE_FALSE(tree_id);
+    CHECK_THAT(tree_id.error(), Catch::Matchers::ContainsSubstring(message));
+}
+
 }  // namespace
 
 TEST_CASE("Archive read context", "[archive_context]") {
@@ -513,3 +642,155 @@ TEST_CASE("ArchiveOps hardlink extraction", "[archive_ops]") {
                   std::filesystem::path(extract_dir) / "hardlink_target") == 2);
     }
 }
+
+TEST_CASE("ArchiveOps import to Git", "[archive_ops]") {
+    // get the scenario
+    auto test_index = GENERATE(
+        Catch::Generators::range<std::size_t>(0, kTestScenarios.size()));
+    auto const& scenario = kTestScenarios[test_index];
+    // hardlinks only for tar-family formats
+    auto const hardlinks = test_index < kTestScenariosTar.size()
+                               ? hardlinks_t{{"bar/link", "foo"}}
+                               : hardlinks_t{};
+
+    auto const test_dir = std::filesystem::path{scenario.test_dir + "_import"};
+    REQUIRE(FileSystemManager::RemoveDirectory(test_dir));
+    REQUIRE(FileSystemManager::CreateDirectory(test_dir));
+    auto const archive_path = test_dir / scenario.filename;
+    {
+        auto* out = archive_write_new();
+        REQUIRE(out != nullptr);
+        enable_write_format_and_filter(out, scenario.type);
+        write_archive(out, archive_path.string(), kExpected, hardlinks);
+        REQUIRE(archive_write_free(out) == ARCHIVE_OK);
+    }
+
+    auto repo = GitRepo::InitAndOpen(test_dir / "repo", /*is_bare=*/false);
+    REQUIRE(repo);
+    auto tree_id = ArchiveOps::ImportArchiveToGit(
+        scenario.type, archive_path, repo->GetGitCAS(), /*jobs=*/2);
+    if (not tree_id) {
+        FAIL(tree_id.error());
+    }
+
+    // the tree must be the same as when extracting and committing
+    auto const extract_dir = test_dir / "extracted";
+    auto res = ArchiveOps::ExtractArchive(
+        scenario.type, archive_path, extract_dir);
+    if (res != std::nullopt) {
+        FAIL(*res);
+    }
+    auto logger = std::make_shared<GitRepo::anon_logger_t>(
+        [](auto const& msg, bool fatal) {
+            Logger::Log(fatal ? LogLevel::Error : LogLevel::Progress,
+                        std::string(msg));
+        });
+    auto commit = repo->CommitDirectory(extract_dir, "extracted", logger);
+    REQUIRE(commit);
+    auto committed_tree = repo->GetSubtreeFromCommit(*commit, ".", logger);
+    REQUIRE(committed_tree);
+    CHECK(*tree_id == *committed_tree);
+}
+
+TEST_CASE("ArchiveOps import to Git matches extraction", "[archive_ops]") {
+    auto const test_dir = std::filesystem::path{"test_import_entries"};
+    REQUIRE(FileSystemManager::RemoveDirectory(test_dir));
+    REQUIRE(FileSystemManager::CreateDirectory(test_dir));
+    auto const archive_path = test_dir / "test.tar";
+
+    SECTION("Executable bits") {
+        write_pax_archive(archive_path,
+                          {{.path = "foo", .content = "foo"},
+                           {.path = "bin/run",
+                            .content = "#!/bin/sh\n",
+                            .perm = kExecutablePerm}});
+    }
+    SECTION("Symlinks") {
+        write_pax_archive(archive_path,
+                          {{.path = "bar/baz", .content = "baz"},
+                           {.path = "link",
+                            .type = AE_IFLNK,
+                            .symlink = "bar/baz"}});
+    }
+    SECTION("Later entries replace earlier ones") {
+        write_pax_archive(archive_path,
+                          {{.path = "foo", .content = "old"},
+                           {.path = "bar/baz", .content = "baz"},
+                           {.path = "foo", .content = "new"},
+                           {.path = "bar/baz",
+                            .type = AE_IFLNK,
+                            .symlink = "../foo"}});
+    }
+    SECTION("Directories and files replace each other") {
+        write_pax_archive(
+            archive_path,
+            {{.path = "foo/", .type = AE_IFDIR, .perm = kDirectoryPerm},
+             {.path = "foo", .content = "foo"},
+             {.path = "bar", .content = "bar"},
+             {.path = "bar/", .type = AE_IFDIR, .perm = kDirectoryPerm},
+             {.path = "bar/baz", .content = "baz"}});
+    }
+    SECTION("Large blobs are streamed") {
+        // above the threshold for streaming blobs to the object database
+        constexpr std::size_t kLargeSize = (16UL * 1024 * 1024) + 1;
+        std::string content(kLargeSize, '\0');
+        for (std::size_t i = 0; i < content.size(); ++i) {
+            content[i] = static_cast<char>('a' + (i % 26));
+        }
+        write_pax_archive(
+            archive_path,
+            {{.path = "foo", .content = "foo"},
+             {.path = "large", .content = std::move(content)}});
+    }
+
+    check_import_matches_extraction(test_dir, archive_path);
+}
+
+TEST_CASE("ArchiveOps import to Git rejects unsafe entries", "[archive_ops]") {
+    auto const test_dir = std::filesystem::path{"test_import_rejected"};
+    REQUIRE(FileSystemManager::RemoveDirectory(test_dir));
+    REQUIRE(FileSystemManager::CreateDirectory(test_dir));
+    auto const archive_path = test_dir / "test.tar";
+
+    SECTION("Paths leaving the destination") {
+        write_pax_archive(archive_path,
+                          {{.path = "foo", .content = "foo"},
+                           {.path = "../evil", .content = "evil"}});
+        check_import_rejected(
+            test_dir, archive_path, "leaves the destination");
+    }
+    SECTION("Paths through symlinks") {
+        write_pax_archive(archive_path,
+                          {{.path = "bar/baz", .content = "baz"},
+                           {.path = "link",
+                            .type = AE_IFLNK,
+                            .symlink = "bar"},
+                           {.path = "link/evil", .content = "evil"}});
+        check_import_rejected(
+            test_dir, archive_path, "is below a non-directory");
+    }
+    SECTION("Files replacing non-empty directories") {
+        write_pax_archive(archive_path,
+                          {{.path = "bar/baz", .content = "baz"},
+                           {.path = "bar", .content = "bar"}});
+        check_import_rejected(
+            test_dir, archive_path, "replaces a non-empty directory");
+    }
+    SECTION("Hardlinks carrying data") {
+        write_pax_archive(archive_path,
+                          {{.path = "foo", .content = "foo"},
+                           {.path = "link", .content = "data"}});
+        make_hardlink_with_data(archive_path, "link", "foo");
+        check_import_rejected(test_dir, archive_path, "carries data");
+    }
+    SECTION("Unknown repository types") {
+        write_pax_archive(archive_path, {{.path = "foo", .content = "foo"}});
+        auto repo =
+            GitRepo::InitAndOpen(test_dir / "repo", /*is_bare=*/false);
+        REQUIRE(repo);
+        auto tree_id = ArchiveOps::ImportArchiveToGit(
+            "git", archive_path, repo->GetGitCAS(), /*jobs=*/1);
+        REQUIRE_FALSE(tree_id);
+        CHECK(tree_id.error() == "unrecognized repository type");
+    }
+}
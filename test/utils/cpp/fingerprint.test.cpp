@@ -0,0 +1,51 @@
+// Copyright 2026 Huawei Cloud Computing Technology Co., Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "src/utils/cpp/fingerprint.hpp"
+
+#include <string>
+#include <unordered_set>
+
+#include "catch2/catch_test_macros.hpp"
+
+TEST_CASE("Reference values", "[fingerprint]") {
+    // MurmurHash3_x64_128 with seed 0
+    CHECK(Fingerprint::Of("") == Fingerprint{});
+    CHECK(Fingerprint::Of("hello") ==
+          Fingerprint{.high = 0xcbd8a7b341bd9b02ULL,
+                      .low = 0x5b1e906a48ae1d19ULL});
+    CHECK(Fingerprint::Of("The quick brown fox jumps over the lazy dog") ==
+          Fingerprint{.high = 0xe34bbc7bbc071b6cULL,
+                      .low = 0x7a433ca9c49a9347ULL});
+}
+
+TEST_CASE("Distinct inputs", "[fingerprint]") {
+    // Cover all tail lengths and multiple blocks.
+    std::unordered_set<Fingerprint> seen{};
+    std::string data{};
+    for (int i = 0; i < 64; ++i) {
+        CHECK(seen.emplace(Fingerprint::Of(data)).second);
+        CHECK(Fingerprint::Of(data) == Fingerprint::Of(std::string{data}));
+        data += static_cast<char>('a' + (i % 26));
+    }
+    CHECK(Fingerprint::Of(std::string(1, '\0')) != Fingerprint::Of(""));
+}
+
+TEST_CASE("Append to buffer", "[fingerprint]") {
+    auto const fp = Fingerprint::Of("hello");
+    std::string buffer{"x"};
+    fp.AppendTo(&buffer);
+    CHECK(buffer.size() == 1 + sizeof(Fingerprint));
+    CHECK(Fingerprint::Of(buffer) != fp);
+}